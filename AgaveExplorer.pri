@@ -10,11 +10,57 @@ include($$NEEDED_PRI)
 
 INCLUDEPATH += "$$PWD/"
 
+QT += sql
+
+LIBS += -lz
+
 SOURCES += \
     $$PWD/utilFuncs/agavesetupdriver.cpp \
     $$PWD/utilFuncs/authform.cpp \
     $$PWD/utilFuncs/copyrightdialog.cpp \
     $$PWD/utilFuncs/singlelinedialog.cpp \
+    $$PWD/utilFuncs/agavenetmanager.cpp \
+    $$PWD/utilFuncs/coalescedreply.cpp \
+    $$PWD/utilFuncs/agaverestlink.cpp \
+    $$PWD/utilFuncs/requestscheduler.cpp \
+    $$PWD/utilFuncs/requestretry.cpp \
+    $$PWD/utilFuncs/concurrencycontroller.cpp \
+    $$PWD/utilFuncs/pagedfolderlister.cpp \
+    $$PWD/utilFuncs/remotenameindex.cpp \
+    $$PWD/utilFuncs/remotetreecrawler.cpp \
+    $$PWD/utilFuncs/remotetreeeditor.cpp \
+    $$PWD/utilFuncs/streamingdownload.cpp \
+    $$PWD/utilFuncs/rangeddownload.cpp \
+    $$PWD/utilFuncs/tarextractor.cpp \
+    $$PWD/utilFuncs/tarstreamreader.cpp \
+    $$PWD/utilFuncs/streamhasher.cpp \
+    $$PWD/utilFuncs/hashingfilereader.cpp \
+    $$PWD/utilFuncs/bulktransfer.cpp \
+    $$PWD/utilFuncs/bulkjoboperation.cpp \
+    $$PWD/utilFuncs/folderdownload.cpp \
+    $$PWD/utilFuncs/folderupload.cpp \
+    $$PWD/utilFuncs/archivedownload.cpp \
+    $$PWD/utilFuncs/archiveupload.cpp \
+    $$PWD/utilFuncs/transferjournal.cpp \
+    $$PWD/utilFuncs/jobrecord.cpp \
+    $$PWD/utilFuncs/remotejobmodel.cpp \
+    $$PWD/utilFuncs/jobfiltermodel.cpp \
+    $$PWD/utilFuncs/jobsubmitqueue.cpp \
+    $$PWD/utilFuncs/inputstager.cpp \
+    $$PWD/utilFuncs/contentindex.cpp \
+    $$PWD/utilFuncs/jobpoller.cpp \
+    $$PWD/utilFuncs/jobcallbacklistener.cpp \
+    $$PWD/utilFuncs/joboutputfetcher.cpp \
+    $$PWD/utilFuncs/jobhistorystore.cpp \
+    $$PWD/utilFuncs/parametertable.cpp \
+    $$PWD/utilFuncs/parametersweepdialog.cpp \
+    $$PWD/utilFuncs/jobworkflow.cpp \
+    $$PWD/utilFuncs/workflowdialog.cpp \
+    $$PWD/utilFuncs/logtail.cpp \
+    $$PWD/utilFuncs/logtaildialog.cpp \
+    $$PWD/utilFuncs/transportbenchmark.cpp \
+    $$PWD/utilFuncs/archivebenchmark.cpp \
+    $$PWD/utilFuncs/callbackcheck.cpp \
     $$PWD/ae_globals.cpp \   
     $$PWD/commonUI/FooterWidget.cpp \
     $$PWD/commonUI/HeaderWidget.cpp
@@ -24,6 +70,48 @@ HEADERS += \
     $$PWD/utilFuncs/authform.h \
     $$PWD/utilFuncs/copyrightdialog.h \
     $$PWD/utilFuncs/singlelinedialog.h \
+    $$PWD/utilFuncs/agavenetmanager.h \
+    $$PWD/utilFuncs/coalescedreply.h \
+    $$PWD/utilFuncs/agaverestlink.h \
+    $$PWD/utilFuncs/requestscheduler.h \
+    $$PWD/utilFuncs/requestretry.h \
+    $$PWD/utilFuncs/concurrencycontroller.h \
+    $$PWD/utilFuncs/pagedfolderlister.h \
+    $$PWD/utilFuncs/remotenameindex.h \
+    $$PWD/utilFuncs/remotetreecrawler.h \
+    $$PWD/utilFuncs/remotetreeeditor.h \
+    $$PWD/utilFuncs/streamingdownload.h \
+    $$PWD/utilFuncs/rangeddownload.h \
+    $$PWD/utilFuncs/tarextractor.h \
+    $$PWD/utilFuncs/tarstreamreader.h \
+    $$PWD/utilFuncs/streamhasher.h \
+    $$PWD/utilFuncs/hashingfilereader.h \
+    $$PWD/utilFuncs/bulktransfer.h \
+    $$PWD/utilFuncs/bulkjoboperation.h \
+    $$PWD/utilFuncs/folderdownload.h \
+    $$PWD/utilFuncs/folderupload.h \
+    $$PWD/utilFuncs/archivedownload.h \
+    $$PWD/utilFuncs/archiveupload.h \
+    $$PWD/utilFuncs/transferjournal.h \
+    $$PWD/utilFuncs/jobrecord.h \
+    $$PWD/utilFuncs/remotejobmodel.h \
+    $$PWD/utilFuncs/jobfiltermodel.h \
+    $$PWD/utilFuncs/jobsubmitqueue.h \
+    $$PWD/utilFuncs/inputstager.h \
+    $$PWD/utilFuncs/contentindex.h \
+    $$PWD/utilFuncs/jobpoller.h \
+    $$PWD/utilFuncs/jobcallbacklistener.h \
+    $$PWD/utilFuncs/joboutputfetcher.h \
+    $$PWD/utilFuncs/jobhistorystore.h \
+    $$PWD/utilFuncs/parametertable.h \
+    $$PWD/utilFuncs/parametersweepdialog.h \
+    $$PWD/utilFuncs/jobworkflow.h \
+    $$PWD/utilFuncs/workflowdialog.h \
+    $$PWD/utilFuncs/logtail.h \
+    $$PWD/utilFuncs/logtaildialog.h \
+    $$PWD/utilFuncs/transportbenchmark.h \
+    $$PWD/utilFuncs/archivebenchmark.h \
+    $$PWD/utilFuncs/callbackcheck.h \
     $$PWD/ae_globals.h \
     $$PWD/commonUI/FooterWidget.h \
     $$PWD/commonUI/HeaderWidget.h
@@ -31,7 +119,10 @@ HEADERS += \
 FORMS += \
     $$PWD/utilFuncs/authform.ui \
     $$PWD/utilFuncs/copyrightdialog.ui \
-    $$PWD/utilFuncs/singlelinedialog.ui
+    $$PWD/utilFuncs/singlelinedialog.ui \
+    $$PWD/utilFuncs/parametersweepdialog.ui \
+    $$PWD/utilFuncs/workflowdialog.ui \
+    $$PWD/utilFuncs/logtaildialog.ui
 
 RESOURCES += \
     $$PWD/commonUI/commonResources.qrc \
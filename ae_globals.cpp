@@ -149,3 +149,45 @@ FileOperator * ae_globals::get_file_handle()
     if (theDriver == nullptr) return nullptr;
     return theDriver->getFileHandler();
 }
+
+AgaveRestLink * ae_globals::get_rest_link()
+{
+    if (theDriver == nullptr) return nullptr;
+    return theDriver->getRestLink();
+}
+
+RemoteJobModel * ae_globals::get_job_model()
+{
+    if (theDriver == nullptr) return nullptr;
+    return theDriver->getJobModel();
+}
+
+JobSubmitQueue * ae_globals::get_job_queue()
+{
+    if (theDriver == nullptr) return nullptr;
+    return theDriver->getJobQueue();
+}
+
+JobPoller * ae_globals::get_job_poller()
+{
+    if (theDriver == nullptr) return nullptr;
+    return theDriver->getJobPoller();
+}
+
+JobOutputFetcher * ae_globals::get_output_fetcher()
+{
+    if (theDriver == nullptr) return nullptr;
+    return theDriver->getOutputFetcher();
+}
+
+JobHistoryStore * ae_globals::get_job_history()
+{
+    if (theDriver == nullptr) return nullptr;
+    return theDriver->getJobHistory();
+}
+
+ContentIndex * ae_globals::get_content_index()
+{
+    if (theDriver == nullptr) return nullptr;
+    return theDriver->getContentIndex();
+}
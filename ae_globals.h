@@ -57,6 +57,13 @@ class AgaveSetupDriver;
 class RemoteDataInterface;
 class FileOperator;
 class JobOperator;
+class AgaveRestLink;
+class RemoteJobModel;
+class JobPoller;
+class JobOutputFetcher;
+class JobHistoryStore;
+class ContentIndex;
+class JobSubmitQueue;
 
 /*! \brief The ae_globals are a set of static methods, intended as global functions for AgaveExplorer programs.
  *
@@ -120,6 +127,27 @@ public:
     /*! \brief Uses driver object to get FileOperator for this program.
      */
     static FileOperator * get_file_handle();
+    /*! \brief Uses driver object to get the AgaveRestLink, for direct requests to the Agave server.
+     */
+    static AgaveRestLink * get_rest_link();
+    /*! \brief Uses driver object to get the RemoteJobModel, holding the list of remote jobs.
+     */
+    static RemoteJobModel * get_job_model();
+    /*! \brief Uses driver object to get the JobSubmitQueue, through which jobs are submitted.
+     */
+    static JobSubmitQueue * get_job_queue();
+    /*! \brief Uses driver object to get the JobPoller, which keeps the list of remote jobs up to date.
+     */
+    static JobPoller * get_job_poller();
+    /*! \brief Uses driver object to get the JobOutputFetcher, which downloads the output of jobs as they finish.
+     */
+    static JobOutputFetcher * get_output_fetcher();
+    /*! \brief Uses driver object to get the JobHistoryStore, the local record of past jobs.
+     */
+    static JobHistoryStore * get_job_history();
+    /*! \brief Uses driver object to get the ContentIndex, used to copy content already on the server instead of uploading it. Is nullptr unless dedupeUploads is given.
+     */
+    static ContentIndex * get_content_index();
 
 private:    
     static AgaveSetupDriver * theDriver;
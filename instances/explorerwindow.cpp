@@ -43,9 +43,37 @@
 #include "remoteFiles/fileoperator.h"
 #include "remoteFiles/filerecursiveoperator.h"
 
-#include "remoteJobs/joboperator.h"
-
 #include "utilFuncs/singlelinedialog.h"
+#include "utilFuncs/pagedfolderlister.h"
+#include "utilFuncs/remotetreecrawler.h"
+#include "utilFuncs/streamingdownload.h"
+#include "utilFuncs/folderdownload.h"
+#include "utilFuncs/folderupload.h"
+#include "utilFuncs/archivedownload.h"
+#include "utilFuncs/archiveupload.h"
+#include "utilFuncs/transferjournal.h"
+#include "utilFuncs/agaverestlink.h"
+#include "utilFuncs/requestscheduler.h"
+#include "utilFuncs/remotejobmodel.h"
+#include "utilFuncs/jobsubmitqueue.h"
+#include "utilFuncs/jobpoller.h"
+#include "utilFuncs/joboutputfetcher.h"
+#include "utilFuncs/jobhistorystore.h"
+#include "utilFuncs/contentindex.h"
+#include "utilFuncs/bulkjoboperation.h"
+#include "utilFuncs/parametersweepdialog.h"
+#include "utilFuncs/workflowdialog.h"
+#include "utilFuncs/logtaildialog.h"
+
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QHeaderView>
+#include <QEvent>
+#include <QRegExp>
+#include <QStatusBar>
+#include <QMessageBox>
+#include <QUrl>
+#include <QFileInfo>
 
 #include "explorerdriver.h"
 #include "ae_globals.h"
@@ -66,10 +94,45 @@ ExplorerWindow::ExplorerWindow(QWidget *parent) :
     ui->agaveAppList->setModel(&taskListModel);
 
     ui->remoteFileView->linkToFileOperator(ae_globals::get_file_handle());
-    ui->jobTable->setOperator(ae_globals::get_job_handle());
+    jobSortModel.setJobModel(ae_globals::get_job_model());
+    ui->jobTable->setModel(&jobSortModel);
+    ui->jobTable->setSortingEnabled(true);
+    ui->jobTable->sortByColumn(RemoteJobModel::CREATED_COL, Qt::DescendingOrder);
+    ui->jobTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    ui->jobTable->setSelectionMode(QAbstractItemView::ExtendedSelection);
+    //Fixed row and column sizes keep the view from measuring every row of a long job list
+    ui->jobTable->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    ui->jobTable->verticalHeader()->setVisible(false);
+    ui->jobTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Interactive);
+    ui->jobTable->horizontalHeader()->setStretchLastSection(true);
+
+    jobFilterOptionsChanged();
+    QObject::connect(ui->jobFilterInput, SIGNAL(textChanged(QString)), this, SLOT(jobFilterChanged()));
+    QObject::connect(ui->jobAppFilter, SIGNAL(currentIndexChanged(int)), this, SLOT(jobFilterChanged()));
+    QObject::connect(ui->jobStatusFilter, SIGNAL(currentIndexChanged(int)), this, SLOT(jobFilterChanged()));
+    QObject::connect(ui->jobAgeFilter, SIGNAL(currentIndexChanged(int)), this, SLOT(jobFilterChanged()));
+    QObject::connect(ae_globals::get_job_model(), SIGNAL(jobListRefreshed(RequestState)), this, SLOT(jobFilterOptionsChanged()));
+
+    QObject::connect(ae_globals::get_job_queue(), SIGNAL(submissionDone(int,RequestState,JobRecord)),
+                     this, SLOT(jobSubmissionDone(int,RequestState,JobRecord)));
+    QObject::connect(ae_globals::get_job_queue(), SIGNAL(queueChanged(int,int)), this, SLOT(jobQueueChanged(int,int)));
+    QObject::connect(ui->agaveSweepButton, SIGNAL(clicked(bool)), this, SLOT(agaveSweepInvoked()));
+    QObject::connect(ui->agaveWorkflowButton, SIGNAL(clicked(bool)), this, SLOT(agaveWorkflowInvoked()));
+    QObject::connect(ae_globals::get_output_fetcher(), SIGNAL(outputFetchDone(QString,RequestState,QString)),
+                     this, SLOT(jobOutputFetched(QString,RequestState,QString)));
 
     ui->selectedFileLabel->connectFileTreeWidget(ui->remoteFileView);
     ui->selectedFileInfo->connectFileTreeWidget(ui->remoteFileView);
+
+    ui->fileSearchResults->setVisible(false);
+    QObject::connect(ui->fileSearchInput, SIGNAL(textChanged(QString)), this, SLOT(runFileSearch(QString)));
+    QObject::connect(ui->fileCrawlButton, SIGNAL(clicked(bool)), this, SLOT(crawlRemoteTree()));
+
+    QObject::connect(&treeEditor, SIGNAL(editDone(RequestState,QString)), this, SLOT(treeEditDone(RequestState,QString)));
+    QObject::connect(&treeEditor, SIGNAL(pendingCountChanged(int)), this, SLOT(treeEditsPending(int)));
+    QObject::connect(&treeEditor, SIGNAL(folderChanged(QString,QList<FileMetaData>)), this, SLOT(treeFolderChanged(QString,QList<FileMetaData>)));
+    //Folders listed by the FileOperator, such as when the user opens them, are indexed as well
+    QObject::connect(ae_globals::get_file_handle(), SIGNAL(fileSystemChange(FileNodeRef)), this, SLOT(fileSystemChanged(FileNodeRef)));
 }
 
 ExplorerWindow::~ExplorerWindow()
@@ -77,6 +140,15 @@ ExplorerWindow::~ExplorerWindow()
     delete ui;
 }
 
+void ExplorerWindow::changeEvent(QEvent * theEvent)
+{
+    if (theEvent->type() == QEvent::WindowStateChange)
+    {
+        ae_globals::get_job_poller()->setWindowVisible(!this->isMinimized());
+    }
+    QMainWindow::changeEvent(theEvent);
+}
+
 void ExplorerWindow::startAndShow()
 {
     QObject::connect(ui->remoteFileView, SIGNAL(customContextMenuRequested(QPoint)),
@@ -91,9 +163,20 @@ void ExplorerWindow::startAndShow()
     ui->header->appendWidget(username);
 
     QPushButton * logoutButton = new QPushButton("Logout");
-    QObject::connect(logoutButton, SIGNAL(clicked(bool)), ae_globals::get_Driver(), SLOT(shutdown()));
+    QObject::connect(logoutButton, SIGNAL(clicked(bool)), ae_globals::get_Driver(), SLOT(logout()));
     ui->header->appendWidget(logoutButton);
     this->show();
+
+    //Jobs from earlier sessions fill the table while the server is asked for the current list
+    ae_globals::get_job_history()->openStore(ae_globals::get_connection()->getUserName());
+    if (ae_globals::get_content_index() != nullptr)
+    {
+        ae_globals::get_content_index()->openIndex(ae_globals::get_connection()->getUserName());
+    }
+    jobFilterOptionsChanged();
+    ae_globals::get_job_poller()->startPolling();
+
+    offerTransferResume();
 }
 
 void ExplorerWindow::addAppToList(QString appName)
@@ -141,6 +224,7 @@ void ExplorerWindow::agaveAppSelected(QModelIndex clickedItem)
         QLabel * tmpLabel = new QLabel(*itr);
         QLineEdit * tmpInput = new QLineEdit();
         tmpInput->setObjectName(paramName);
+        tmpInput->setPlaceholderText("Remote path, or file:///local/path to upload");
 
         panelLayout->addWidget(tmpLabel,rowNum,0);
         panelLayout->addWidget(tmpInput,rowNum,1);
@@ -150,10 +234,9 @@ void ExplorerWindow::agaveAppSelected(QModelIndex clickedItem)
 
 void ExplorerWindow::agaveCommandInvoked()
 {
-    if (waitingOnCommand)
-    {
-        return;
-    }
+    QStringList autoFetchSettings;
+    if (!getAutoFetchSettings(&autoFetchSettings)) return;
+
     QString workingDir = ui->remoteFileView->getSelectedFile().getFullPath();
 
     QStringList inputList = agaveParamLists.value(selectedAgaveApp);
@@ -173,21 +256,104 @@ void ExplorerWindow::agaveCommandInvoked()
         }
     }
 
-    RemoteDataReply * theTask = ae_globals::get_connection()->runRemoteJob(selectedAgaveApp,allInputs,workingDir);
-    if (theTask == nullptr)
+    QStringList missingInputs;
+    for (auto itr = allInputs.cbegin(); itr != allInputs.cend(); itr++)
+    {
+        QUrl valueURL(itr.value());
+        if (valueURL.isLocalFile() && !QFileInfo::exists(valueURL.toLocalFile())) missingInputs.append(itr.key());
+    }
+    if (!missingInputs.isEmpty())
+    {
+        ae_globals::displayPopup(QString("Local file not found for: %1").arg(missingInputs.join(", ")), "Missing Inputs");
+        return;
+    }
+
+    int ticket = ae_globals::get_job_queue()->submitJob(selectedAgaveApp, allInputs, workingDir);
+    directSubmissions.insert(ticket);
+    if (!autoFetchSettings.isEmpty()) autoFetchTickets.insert(ticket, autoFetchSettings);
+}
+
+void ExplorerWindow::agaveSweepInvoked()
+{
+    if (!agaveParamLists.contains(selectedAgaveApp))
+    {
+        ae_globals::displayPopup("Please select an app for the parameter sweep.", "No App Selected");
+        return;
+    }
+
+    QStringList autoFetchSettings;
+    if (!getAutoFetchSettings(&autoFetchSettings)) return;
+
+    QString workingDir = ui->remoteFileView->getSelectedFile().getFullPath();
+    ParameterSweepDialog * sweepDialog = new ParameterSweepDialog(selectedAgaveApp, agaveParamLists.value(selectedAgaveApp), workingDir, this);
+    if (!autoFetchSettings.isEmpty())
+    {
+        sweepDialog->setAutoFetch(autoFetchSettings.first(), autoFetchSettings.mid(1));
+    }
+    sweepDialog->show();
+}
+
+void ExplorerWindow::agaveWorkflowInvoked()
+{
+    WorkflowDialog * workflowDialog = new WorkflowDialog(this);
+    workflowDialog->show();
+}
+
+void ExplorerWindow::jobSubmissionDone(int ticket, RequestState finalState, JobRecord newJob)
+{
+    //Sweeps report on their own submissions
+    if (!directSubmissions.remove(ticket)) return;
+    QStringList autoFetchSettings = autoFetchTickets.take(ticket);
+    if (finalState == RequestState::GOOD)
+    {
+        if (!autoFetchSettings.isEmpty())
+        {
+            ae_globals::get_output_fetcher()->watchJob(newJob.id, autoFetchSettings.first(), autoFetchSettings.mid(1));
+        }
+        return;
+    }
+
+    qCDebug(agaveAppLayer, "Unable to invoke task");
+    ae_globals::displayPopup(QString("Unable to submit job %1").arg(newJob.name));
+}
+
+void ExplorerWindow::jobOutputFetched(QString jobId, RequestState finalState, QString localFolder)
+{
+    if (finalState == RequestState::GOOD)
     {
-        qCDebug(agaveAppLayer, "Unable to invoke task");
+        this->statusBar()->showMessage(QString("Output of job %1 downloaded to %2").arg(jobId, localFolder), 10000);
         return;
     }
-    waitingOnCommand = true;
-    QObject::connect(theTask, SIGNAL(haveJobReply(RequestState,QJsonDocument)),
-                     this, SLOT(finishedAppInvoke(RequestState,QJsonDocument)));
+    this->statusBar()->showMessage(QString("Unable to download output of job %1").arg(jobId), 10000);
 }
 
-void ExplorerWindow::finishedAppInvoke(RequestState, QJsonDocument)
+bool ExplorerWindow::getAutoFetchSettings(QStringList * autoFetchSettings)
 {
-    waitingOnCommand = false;
-    ae_globals::get_job_handle()->demandJobDataRefresh();
+    autoFetchSettings->clear();
+    if (!ui->agaveAutoFetchCheck->isChecked()) return true;
+
+    QString localDest = ui->agaveAutoFetchDest->text();
+    if (!ae_globals::isExtantLocalFolder(localDest))
+    {
+        ae_globals::displayPopup("Please give an existing local folder for the job output.", "No Output Folder");
+        return false;
+    }
+
+    autoFetchSettings->append(localDest);
+    QStringList filterPatterns = ui->agaveAutoFetchFilter->text().split(QRegExp("[\\s,]+"));
+    filterPatterns.removeAll(QString());
+    autoFetchSettings->append(filterPatterns);
+    return true;
+}
+
+void ExplorerWindow::jobQueueChanged(int waitingCount, int runningCount)
+{
+    if ((waitingCount == 0) && (runningCount == 0))
+    {
+        this->statusBar()->clearMessage();
+        return;
+    }
+    this->statusBar()->showMessage(QString("Submitting jobs: %1 sent, %2 waiting . . .").arg(runningCount).arg(waitingCount));
 }
 
 void ExplorerWindow::customFileMenu(QPoint pos)
@@ -209,6 +375,13 @@ void ExplorerWindow::customFileMenu(QPoint pos)
     if (targetNode.isNil()) return;
     if (targetNode.getFileType() == FileType::INVALID) return;
 
+    if (treeEditor.isPending(targetNode.getFullPath()))
+    {
+        fileMenu.addAction("Change Pending . . .");
+        fileMenu.exec(QCursor::pos());
+        return;
+    }
+
     //We don't let the user fiddle with the username folder
     if (!(targetNode.isRootNode()))
     {
@@ -224,7 +397,9 @@ void ExplorerWindow::customFileMenu(QPoint pos)
     {
         fileMenu.addAction("Upload File Here",this, SLOT(uploadMenuItem()));
         fileMenu.addAction("Upload Folder Here",this, SLOT(uploadFolderMenuItem()));
+        fileMenu.addAction("Upload Folder Here as Archive",this, SLOT(uploadArchiveMenuItem()));
         fileMenu.addAction("Download Folder",this, SLOT(downloadFolderMenuItem()));
+        fileMenu.addAction("Download Folder as Archive",this, SLOT(downloadArchiveMenuItem()));
         fileMenu.addAction("Create New Folder",this, SLOT(createFolderMenuItem()));
     }
     if (targetNode.getFileType() == FileType::FILE)
@@ -238,6 +413,7 @@ void ExplorerWindow::customFileMenu(QPoint pos)
         {
             fileMenu.addAction("Retrive File",this, SLOT(retriveMenuItem()));
         }
+        fileMenu.addAction("Follow File . . .",this, SLOT(followFileMenuItem()));
     }
 
     if ((targetNode.getFileType() == FileType::DIR) || (targetNode.getFileType() == FileType::FILE))
@@ -258,7 +434,10 @@ void ExplorerWindow::copyMenuItem()
         return;
     }
 
-    ae_globals::get_Driver()->getFileHandler()->sendCopyReq(targetNode, newNamePopup.getInputText());
+    if (!treeEditor.startEdit(TreeEditKind::COPY, targetNode, newNamePopup.getInputText()))
+    {
+        ae_globals::get_Driver()->getFileHandler()->sendCopyReq(targetNode, newNamePopup.getInputText());
+    }
 }
 
 void ExplorerWindow::moveMenuItem()
@@ -270,7 +449,10 @@ void ExplorerWindow::moveMenuItem()
         return;
     }
 
-    ae_globals::get_Driver()->getFileHandler()->sendMoveReq(targetNode,newNamePopup.getInputText());
+    if (!treeEditor.startEdit(TreeEditKind::MOVE, targetNode, newNamePopup.getInputText()))
+    {
+        ae_globals::get_Driver()->getFileHandler()->sendMoveReq(targetNode,newNamePopup.getInputText());
+    }
 }
 
 void ExplorerWindow::renameMenuItem()
@@ -282,12 +464,19 @@ void ExplorerWindow::renameMenuItem()
         return;
     }
 
-    ae_globals::get_Driver()->getFileHandler()->sendRenameReq(targetNode, newNamePopup.getInputText());
+    if (!treeEditor.startEdit(TreeEditKind::RENAME, targetNode, newNamePopup.getInputText()))
+    {
+        ae_globals::get_Driver()->getFileHandler()->sendRenameReq(targetNode, newNamePopup.getInputText());
+    }
 }
 
 void ExplorerWindow::deleteMenuItem()
 {
-    if (ae_globals::get_Driver()->getFileHandler()->deletePopup(targetNode))
+    if (!ae_globals::get_Driver()->getFileHandler()->deletePopup(targetNode))
+    {
+        return;
+    }
+    if (!treeEditor.startEdit(TreeEditKind::REMOVE, targetNode))
     {
         ae_globals::get_Driver()->getFileHandler()->sendDeleteReq(targetNode);
     }
@@ -308,22 +497,104 @@ void ExplorerWindow::uploadFolderMenuItem()
 {
     SingleLineDialog uploadNamePopup("Please input full path of folder to upload:", "");
 
+    if (!activeFolderTransfer.isNull() || !activeArchiveTransfer.isNull())
+    {
+        ae_globals::displayPopup("Please wait for the current folder transfer to finish.", "Transfer In Progress");
+        return;
+    }
+
     if (uploadNamePopup.exec() != QDialog::Accepted)
     {
         return;
     }
-    ae_globals::get_Driver()->getFileHandler()->getRecursiveOp()->enactRecursiveUpload(targetNode, uploadNamePopup.getInputText());
+
+    FolderUpload * theUpload = new FolderUpload(uploadNamePopup.getInputText(), targetNode.getFullPath(), this);
+    theUpload->setJournal(TransferJournal::createJournal("upload", uploadNamePopup.getInputText(), targetNode.getFullPath()));
+    theUpload->setContentIndex(ae_globals::get_content_index());
+    if (!startFolderTransfer(theUpload))
+    {
+        ae_globals::get_Driver()->getFileHandler()->getRecursiveOp()->enactRecursiveUpload(targetNode, uploadNamePopup.getInputText());
+    }
+}
+
+void ExplorerWindow::uploadArchiveMenuItem()
+{
+    SingleLineDialog uploadNamePopup("Please input full path of folder to upload:", "");
+
+    if (!activeFolderTransfer.isNull() || !activeArchiveTransfer.isNull())
+    {
+        ae_globals::displayPopup("Please wait for the current folder transfer to finish.", "Transfer In Progress");
+        return;
+    }
+
+    if (uploadNamePopup.exec() != QDialog::Accepted)
+    {
+        return;
+    }
+
+    //The folder is sent as one archive and unpacked by a job on the server, which is quicker than one request per file when there are many small files
+    ArchiveUpload * theUpload = new ArchiveUpload(uploadNamePopup.getInputText(), targetNode.getFullPath(), this);
+    QObject::connect(theUpload, SIGNAL(archiveProgress(QString)), this, SLOT(archiveTransferProgress(QString)));
+    QObject::connect(theUpload, SIGNAL(transferDone(RequestState,int,int)), this, SLOT(archiveUploadDone(RequestState,int,int)));
+    if (!theUpload->startTransfer())
+    {
+        theUpload->deleteLater();
+        ae_globals::displayPopup(QString("Unable to upload %1 as an archive.").arg(uploadNamePopup.getInputText()));
+        return;
+    }
+    activeArchiveTransfer = theUpload;
+    archiveUploadTarget = targetNode;
 }
 
 void ExplorerWindow::downloadFolderMenuItem()
 {
+    if (!activeFolderTransfer.isNull() || !activeArchiveTransfer.isNull())
+    {
+        ae_globals::displayPopup("Please wait for the current folder transfer to finish.", "Transfer In Progress");
+        return;
+    }
+
     SingleLineDialog downloadNamePopup("Please input full path of folder download destination:", "");
 
     if (downloadNamePopup.exec() != QDialog::Accepted)
     {
         return;
     }
-    ae_globals::get_Driver()->getFileHandler()->getRecursiveOp()->enactRecursiveDownload(targetNode, downloadNamePopup.getInputText());
+
+    FolderDownload * theDownload = new FolderDownload(targetNode.getFullPath(), downloadNamePopup.getInputText(), this);
+    theDownload->setJournal(TransferJournal::createJournal("download", downloadNamePopup.getInputText(), targetNode.getFullPath()));
+    if (!startFolderTransfer(theDownload))
+    {
+        ae_globals::get_Driver()->getFileHandler()->getRecursiveOp()->enactRecursiveDownload(targetNode, downloadNamePopup.getInputText());
+    }
+}
+
+void ExplorerWindow::downloadArchiveMenuItem()
+{
+    if (!activeFolderTransfer.isNull() || !activeArchiveTransfer.isNull())
+    {
+        ae_globals::displayPopup("Please wait for the current folder transfer to finish.", "Transfer In Progress");
+        return;
+    }
+
+    SingleLineDialog downloadNamePopup("Please input full path of folder download destination:", "");
+
+    if (downloadNamePopup.exec() != QDialog::Accepted)
+    {
+        return;
+    }
+
+    //The folder is packed by a job on the server, which is quicker than one request per file when there are many small files
+    ArchiveDownload * theDownload = new ArchiveDownload(targetNode.getFullPath(), downloadNamePopup.getInputText(), this);
+    QObject::connect(theDownload, SIGNAL(archiveProgress(QString)), this, SLOT(archiveTransferProgress(QString)));
+    QObject::connect(theDownload, SIGNAL(transferDone(RequestState,int,int)), this, SLOT(folderTransferDone(RequestState,int,int)));
+    if (!theDownload->startTransfer())
+    {
+        theDownload->deleteLater();
+        ae_globals::displayPopup("Unable to start the compress job for this folder.");
+        return;
+    }
+    activeArchiveTransfer = theDownload;
 }
 
 void ExplorerWindow::createFolderMenuItem()
@@ -334,7 +605,10 @@ void ExplorerWindow::createFolderMenuItem()
     {
         return;
     }
-    ae_globals::get_Driver()->getFileHandler()->sendCreateFolderReq(targetNode, newFolderNamePopup.getInputText());
+    if (!treeEditor.startEdit(TreeEditKind::MKDIR, targetNode, newFolderNamePopup.getInputText()))
+    {
+        ae_globals::get_Driver()->getFileHandler()->sendCreateFolderReq(targetNode, newFolderNamePopup.getInputText());
+    }
 }
 
 void ExplorerWindow::downloadMenuItem()
@@ -345,7 +619,14 @@ void ExplorerWindow::downloadMenuItem()
     {
         return;
     }
-    ae_globals::get_Driver()->getFileHandler()->sendDownloadReq(targetNode, downloadNamePopup.getInputText());
+
+    StreamingDownload * theDownload = new StreamingDownload(targetNode.getFullPath(), downloadNamePopup.getInputText(), this);
+    QObject::connect(theDownload, SIGNAL(downloadDone(RequestState,QString,qint64)), this, SLOT(fileDownloadDone(RequestState,QString,qint64)));
+    if (!theDownload->startDownload())
+    {
+        theDownload->deleteLater();
+        ae_globals::get_Driver()->getFileHandler()->sendDownloadReq(targetNode, downloadNamePopup.getInputText());
+    }
 }
 
 void ExplorerWindow::readMenuItem()
@@ -360,56 +641,588 @@ void ExplorerWindow::retriveMenuItem()
     ae_globals::get_Driver()->getFileHandler()->sendDownloadBuffReq(targetNode);
 }
 
+void ExplorerWindow::followFileMenuItem()
+{
+    //A running job picked in the job table is offered as the job to follow
+    QString defaultJobId;
+    QModelIndex selectedJob = jobSortModel.mapToSource(ui->jobTable->currentIndex());
+    if (selectedJob.isValid())
+    {
+        JobRecord theJob = ae_globals::get_job_model()->getJob(selectedJob.row());
+        if (!theJob.isTerminal()) defaultJobId = theJob.id;
+    }
+
+    SingleLineDialog jobIdPopup("Stop following when this job ends (leave empty to follow until stopped):", defaultJobId);
+    if (jobIdPopup.exec() != QDialog::Accepted)
+    {
+        return;
+    }
+
+    LogTailDialog * tailDialog = new LogTailDialog(targetNode.getFullPath(), jobIdPopup.getInputText().trimmed(), this);
+    if (!tailDialog->startFollowing())
+    {
+        tailDialog->deleteLater();
+        ae_globals::displayPopup("Unable to follow the file without a connection to the server.", "Follow File");
+        return;
+    }
+    tailDialog->show();
+}
+
 void ExplorerWindow::refreshMenuItem()
 {
-    targetNode.enactFolderRefresh();
+    if (targetNode.getFileType() != FileType::DIR)
+    {
+        targetNode.enactFolderRefresh();
+        return;
+    }
+    refreshFolder(targetNode);
 }
 
-void ExplorerWindow::jobRightClickMenu(QPoint pos)
+void ExplorerWindow::refreshFolder(FileNodeRef folderNode)
 {
-    if (ae_globals::get_job_handle() == nullptr)
+    QString folderPath = folderNode.getFullPath();
+    if (pagedListingTargets.contains(folderPath)) return;
+
+    PagedFolderLister * theLister = new PagedFolderLister(folderPath, this);
+    QObject::connect(theLister, SIGNAL(pageMerged(QString,QList<FileMetaData>)),
+                     this, SLOT(mergeListingPage(QString,QList<FileMetaData>)));
+    QObject::connect(theLister, SIGNAL(listingDone(RequestState,QString,QList<FileMetaData>,FileSizeMap)),
+                     this, SLOT(pagedListingDone(RequestState,QString,QList<FileMetaData>)));
+
+    if (!theLister->startListing())
     {
+        //Without session credentials for direct requests, we fall back on the single request listing
+        theLister->deleteLater();
+        folderNode.enactFolderRefresh();
         return;
     }
-    QMenu jobMenu;
+    pagedListingTargets.insert(folderPath, folderNode);
+}
 
-    if (ae_globals::get_job_handle()->currentlyPerformingJobOperation())
+void ExplorerWindow::mergeListingPage(QString folderPath, QList<FileMetaData> newEntries)
+{
+    FileTreeNode * folderNode = ae_globals::get_file_handle()->getFileNodeFromNodeRef(pagedListingTargets.value(folderPath));
+    if (folderNode == nullptr) return;
+
+    //Each delivery replaces the whole listing, so the children already shown are delivered again with the new page.
+    //Entries deleted on the server are only dropped once the listing is done.
+    QSet<QString> newPaths;
+    for (const FileMetaData &anEntry : newEntries)
+    {
+        newPaths.insert(anEntry.getFullPath());
+    }
+
+    QList<FileMetaData> lsData;
+    //Note: LS data for a node begins with the entry for the folder itself
+    lsData.append(folderNode->getFileData());
+    for (FileTreeNode * aChild : folderNode->getChildList())
     {
-        jobMenu.addAction("Currently Performing Job Operation . . .");
-        jobMenu.exec(QCursor::pos());
+        if (newPaths.contains(aChild->getFileData().getFullPath())) continue;
+        lsData.append(aChild->getFileData());
+    }
+    lsData.append(newEntries);
+    folderNode->deliverLSdata(RequestState::GOOD, &lsData);
+}
+
+void ExplorerWindow::pagedListingDone(RequestState finalState, QString folderPath, QList<FileMetaData> allEntries)
+{
+    FileNodeRef folderRef = pagedListingTargets.take(folderPath);
+    if (finalState == RequestState::GOOD)
+    {
+        FileTreeNode * folderNode = ae_globals::get_file_handle()->getFileNodeFromNodeRef(folderRef);
+        if (folderNode != nullptr)
+        {
+            QList<FileMetaData> lsData = allEntries;
+            lsData.prepend(folderNode->getFileData());
+            folderNode->deliverLSdata(RequestState::GOOD, &lsData);
+        }
+        fileNameIndex.updateFolder(folderPath, allEntries);
+        runFileSearch(ui->fileSearchInput->text());
         return;
     }
 
-    if (ae_globals::get_job_handle()->currentlyRefreshingJobs())
+    qCDebug(agaveAppLayer, "Paged listing of %s failed, using single request listing.", qPrintable(folderPath));
+    if (!folderRef.isNil())
+    {
+        folderRef.enactFolderRefresh();
+    }
+}
+
+void ExplorerWindow::jobRightClickMenu(QPoint pos)
+{
+    RemoteJobModel * jobModel = ae_globals::get_job_model();
+    if (jobModel == nullptr)
     {
-        jobMenu.addAction("Currently Refreshing Job Info . . .");
-        jobMenu.exec(QCursor::pos());
         return;
     }
+    QMenu jobMenu;
 
     jobMenu.addAction("Refresh Job Info", this, SLOT(demandJobRefresh()));
+    jobMenu.addAction("Show Job Timing Statistics", this, SLOT(showJobTimingStats()));
 
-    QModelIndex targetIndex = ui->jobTable->indexAt(pos);
-    ui->jobTable->jobEntryTouched(targetIndex);
+    QModelIndex targetIndex = jobSortModel.mapToSource(ui->jobTable->indexAt(pos));
+    targetJob = jobModel->getJob(targetIndex.row());
 
-    targetJob = ui->jobTable->getSelectedJob();
+    //Bulk actions apply to every selected job, or to the clicked job if it is not selected
+    targetJobs.clear();
+    QModelIndexList selectedRows = ui->jobTable->selectionModel()->selectedRows();
+    if (!targetJob.id.isEmpty() && !ui->jobTable->selectionModel()->isRowSelected(ui->jobTable->indexAt(pos).row(), QModelIndex()))
+    {
+        selectedRows.clear();
+        selectedRows.append(ui->jobTable->indexAt(pos));
+    }
+    int stoppableJobs = 0;
+    for (const QModelIndex &aRow : selectedRows)
+    {
+        JobRecord aJob = jobModel->getJob(jobSortModel.mapToSource(aRow).row());
+        if (aJob.id.isEmpty() || jobsInOperation.contains(aJob.id)) continue;
+        targetJobs.append(aJob);
+        if (!aJob.isTerminal()) stoppableJobs++;
+    }
 
-    if (targetJob.isValidEntry())
+    if (targetJobs.size() == 1)
     {
         jobMenu.addAction("Delete This Job Entry", this, SLOT(deleteJobDataEntry()));
+        if (stoppableJobs > 0) jobMenu.addAction("Stop This Job", this, SLOT(stopSelectedJobs()));
+        jobMenu.addAction("Resubmit This Job", this, SLOT(resubmitSelectedJobs()));
+    }
+    else if (targetJobs.size() > 1)
+    {
+        jobMenu.addAction(QString("Delete %1 Job Entries").arg(targetJobs.size()), this, SLOT(deleteJobDataEntry()));
+        if (stoppableJobs > 0) jobMenu.addAction(QString("Stop %1 Running Jobs").arg(stoppableJobs), this, SLOT(stopSelectedJobs()));
+        jobMenu.addAction(QString("Resubmit %1 Jobs").arg(targetJobs.size()), this, SLOT(resubmitSelectedJobs()));
+    }
+
+    JobOutputFetcher * theFetcher = ae_globals::get_output_fetcher();
+    if (!targetJob.id.isEmpty() && theFetcher->isWatched(targetJob.id))
+    {
+        jobMenu.addAction("Cancel Output Download", this, SLOT(cancelJobOutputFetch()));
+    }
+    else if (targetJob.status == "FINISHED")
+    {
+        jobMenu.addAction("Download Job Output . . .", this, SLOT(fetchJobOutput()));
+    }
+    else if (!targetJob.id.isEmpty() && !targetJob.isTerminal())
+    {
+        jobMenu.addAction("Download Output When Finished . . .", this, SLOT(fetchJobOutput()));
     }
 
     jobMenu.exec(QCursor::pos());
 }
 
+void ExplorerWindow::jobFilterChanged()
+{
+    static const int ageFilterDays[] = {0, 1, 7, 30};
+
+    jobSortModel.setTextFilter(ui->jobFilterInput->text());
+    jobSortModel.setAppFilter(ui->jobAppFilter->currentData().toString());
+    jobSortModel.setStatusFilter(ui->jobStatusFilter->currentData().toString());
+    int ageIndex = ui->jobAgeFilter->currentIndex();
+    jobSortModel.setMaxAgeDays(((ageIndex >= 0) && (ageIndex < 4)) ? ageFilterDays[ageIndex] : 0);
+
+    ui->jobFilterStatus->setText(QString("%1 of %2 jobs").arg(jobSortModel.rowCount()).arg(ae_globals::get_job_model()->rowCount()));
+}
+
+void ExplorerWindow::jobFilterOptionsChanged()
+{
+    RemoteJobModel * jobModel = ae_globals::get_job_model();
+
+    //The lists are rebuilt without signals, so that the filter is applied once at the end
+    QString oldApp = ui->jobAppFilter->currentData().toString();
+    ui->jobAppFilter->blockSignals(true);
+    ui->jobAppFilter->clear();
+    ui->jobAppFilter->addItem("All Apps", QString());
+    for (const QString &anApp : jobModel->getKnownApps())
+    {
+        ui->jobAppFilter->addItem(anApp, anApp);
+    }
+    ui->jobAppFilter->setCurrentIndex(qMax(0, ui->jobAppFilter->findData(oldApp)));
+    ui->jobAppFilter->blockSignals(false);
+
+    QString oldStatus = ui->jobStatusFilter->currentData().toString();
+    ui->jobStatusFilter->blockSignals(true);
+    ui->jobStatusFilter->clear();
+    ui->jobStatusFilter->addItem("All Statuses", QString());
+    for (const QString &aStatus : jobModel->getKnownStatuses())
+    {
+        ui->jobStatusFilter->addItem(QString("%1 (%2)").arg(aStatus).arg(jobModel->countJobsWithStatus(aStatus)), aStatus);
+    }
+    ui->jobStatusFilter->setCurrentIndex(qMax(0, ui->jobStatusFilter->findData(oldStatus)));
+    ui->jobStatusFilter->blockSignals(false);
+
+    jobFilterChanged();
+}
+
+void ExplorerWindow::showJobTimingStats()
+{
+    QList<JobTimingStats> allStats = ae_globals::get_job_history()->getTimingStats();
+    if (allStats.isEmpty())
+    {
+        ae_globals::displayPopup("No finished jobs with known run times have been recorded yet.", "Job Timing Statistics");
+        return;
+    }
+
+    QString statsText;
+    for (const JobTimingStats &appStats : allStats)
+    {
+        statsText.append(QString("%1 (%2 jobs)\n").arg(appStats.appId).arg(appStats.jobsTimed));
+        statsText.append(QString("    Queue wait: median %1, 90%: %2, max %3\n")
+                         .arg(formatDuration(appStats.waitP50), formatDuration(appStats.waitP90), formatDuration(appStats.waitMax)));
+        statsText.append(QString("    Run time: median %1, 90%: %2, max %3\n")
+                         .arg(formatDuration(appStats.runP50), formatDuration(appStats.runP90), formatDuration(appStats.runMax)));
+    }
+    ae_globals::displayPopup(statsText, "Job Timing Statistics");
+}
+
+QString ExplorerWindow::formatDuration(qint64 durationSecs)
+{
+    if (durationSecs < 0) return "unknown";
+    return QString("%1:%2:%3").arg(durationSecs / 3600).arg((durationSecs / 60) % 60, 2, 10, QChar('0')).arg(durationSecs % 60, 2, 10, QChar('0'));
+}
+
 void ExplorerWindow::demandJobRefresh()
 {
-    if (ae_globals::get_job_handle()->currentlyRefreshingJobs()) return;
-    ae_globals::get_job_handle()->demandJobDataRefresh();
+    ae_globals::get_job_poller()->pollNow(true);
+}
+
+void ExplorerWindow::fetchJobOutput()
+{
+    if (targetJob.id.isEmpty()) return;
+
+    SingleLineDialog downloadNamePopup("Please input full path of job output destination:", "");
+    if (downloadNamePopup.exec() != QDialog::Accepted)
+    {
+        return;
+    }
+    if (!ae_globals::isExtantLocalFolder(downloadNamePopup.getInputText()))
+    {
+        ae_globals::displayPopup("Please give an existing local folder for the job output.", "No Output Folder");
+        return;
+    }
+    ae_globals::get_output_fetcher()->watchJob(targetJob.id, downloadNamePopup.getInputText());
+}
+
+void ExplorerWindow::cancelJobOutputFetch()
+{
+    ae_globals::get_output_fetcher()->unwatchJob(targetJob.id);
 }
 
 void ExplorerWindow::deleteJobDataEntry()
 {
-    if (ae_globals::get_job_handle()->currentlyPerformingJobOperation()) return;
-    ae_globals::get_job_handle()->deleteJobDataEntry(&targetJob);
+    if (targetJobs.isEmpty()) return;
+
+    if (targetJobs.size() > 1)
+    {
+        QMessageBox::StandardButton userChoice = QMessageBox::question(this, "Delete Jobs",
+                                                                       QString("Delete the records of %1 jobs?").arg(targetJobs.size()),
+                                                                       QMessageBox::Yes | QMessageBox::No);
+        if (userChoice != QMessageBox::Yes) return;
+    }
+
+    QStringList jobIds;
+    for (const JobRecord &aJob : targetJobs)
+    {
+        jobIds.append(aJob.id);
+    }
+    startJobOperation(BulkJobOperation::JobAction::DELETE, jobIds);
+}
+
+void ExplorerWindow::stopSelectedJobs()
+{
+    QStringList jobIds;
+    for (const JobRecord &aJob : targetJobs)
+    {
+        if (!aJob.isTerminal()) jobIds.append(aJob.id);
+    }
+    startJobOperation(BulkJobOperation::JobAction::STOP, jobIds);
+}
+
+void ExplorerWindow::resubmitSelectedJobs()
+{
+    QStringList jobIds;
+    for (const JobRecord &aJob : targetJobs)
+    {
+        jobIds.append(aJob.id);
+    }
+    startJobOperation(BulkJobOperation::JobAction::RESUBMIT, jobIds);
+}
+
+void ExplorerWindow::startJobOperation(BulkJobOperation::JobAction theAction, QStringList jobIds)
+{
+    if (jobIds.isEmpty()) return;
+
+    BulkJobOperation * theOperation = new BulkJobOperation(theAction, jobIds, this);
+    theOperation->setMaxInFlight(ae_globals::get_rest_link()->getScheduler()->getClassMaxLimit(RequestPriority::BULK));
+    QObject::connect(theOperation, SIGNAL(transferProgress(int,int,qint64)), this, SLOT(jobOperationProgress(int,int,qint64)));
+    QObject::connect(theOperation, SIGNAL(transferDone(RequestState,int,int)), this, SLOT(jobOperationDone(RequestState,int,int)));
+
+    if (!theOperation->startTransfer())
+    {
+        QObject::disconnect(theOperation, nullptr, this, nullptr);
+        theOperation->cancelTransfer();
+        ae_globals::displayPopup(QString("Unable to %1 jobs.").arg(BulkJobOperation::getActionName(theAction).toLower()));
+        return;
+    }
+    jobsInOperation.unite(QSet<QString>::fromList(theOperation->getJobIds()));
+}
+
+void ExplorerWindow::jobOperationProgress(int jobsDone, int jobsTotal, qint64)
+{
+    BulkJobOperation * theOperation = qobject_cast<BulkJobOperation *>(sender());
+    if (theOperation == nullptr) return;
+
+    this->statusBar()->showMessage(QString("%1 jobs: %2 of %3 done, %4 failed . . .")
+                                   .arg(BulkJobOperation::getActionName(theOperation->getAction()))
+                                   .arg(jobsDone).arg(jobsTotal).arg(theOperation->getFailures().size()));
+}
+
+void ExplorerWindow::jobOperationDone(RequestState finalState, int jobsDone, int jobsFailed)
+{
+    BulkJobOperation * theOperation = qobject_cast<BulkJobOperation *>(sender());
+    if (theOperation == nullptr) return;
+
+    for (const QString &aJobId : theOperation->getJobIds())
+    {
+        jobsInOperation.remove(aJobId);
+    }
+
+    QString actionName = BulkJobOperation::getActionName(theOperation->getAction());
+    if (finalState == RequestState::GOOD)
+    {
+        this->statusBar()->showMessage(QString("%1 jobs: %2 done").arg(actionName).arg(jobsDone), 10000);
+        return;
+    }
+    this->statusBar()->clearMessage();
+
+    //Only the first few failures are listed, so that the popup stays on screen
+    const int maxListed = 10;
+    QMap<QString, QString> allFailures = theOperation->getFailures();
+    QString failureText = QString("%1 jobs: %2 done, %3 failed.\n").arg(actionName).arg(jobsDone).arg(jobsFailed);
+    int listed = 0;
+    for (auto itr = allFailures.cbegin(); (itr != allFailures.cend()) && (listed < maxListed); itr++, listed++)
+    {
+        failureText.append(QString("\n%1: %2").arg(itr.key(), itr.value()));
+    }
+    if (allFailures.size() > maxListed)
+    {
+        failureText.append(QString("\n. . . and %1 more").arg(allFailures.size() - maxListed));
+    }
+    ae_globals::displayPopup(failureText, "Job Operation Incomplete");
+}
+
+void ExplorerWindow::runFileSearch(QString searchText)
+{
+    ui->fileSearchResults->clear();
+    if (searchText.trimmed().isEmpty())
+    {
+        ui->fileSearchResults->setVisible(false);
+        ui->fileSearchStatus->setText(QString("%1 paths indexed").arg(fileNameIndex.indexedPathCount()));
+        return;
+    }
+
+    QElapsedTimer searchTimer;
+    searchTimer.start();
+    QStringList foundPaths = fileNameIndex.search(searchText);
+    qint64 searchTime = searchTimer.elapsed();
+
+    ui->fileSearchResults->addItems(foundPaths);
+    ui->fileSearchResults->setVisible(true);
+    ui->fileSearchStatus->setText(QString("%1 matches in %2 ms").arg(foundPaths.size()).arg(searchTime));
+}
+
+void ExplorerWindow::crawlRemoteTree()
+{
+    if (crawlRunning) return;
+
+    QString rootPath = "/";
+    rootPath.append(ae_globals::get_connection()->getUserName());
+
+    RemoteTreeCrawler * theCrawler = new RemoteTreeCrawler(rootPath, &fileNameIndex, this);
+    QObject::connect(theCrawler, SIGNAL(crawlDone(RequestState,int)), this, SLOT(remoteCrawlDone(RequestState,int)));
+    if (!theCrawler->startCrawl())
+    {
+        theCrawler->deleteLater();
+        ae_globals::displayPopup("Unable to index remote folders until the connection to DesignSafe is established.", "Not Connected");
+        return;
+    }
+
+    crawlRunning = true;
+    ui->fileCrawlButton->setEnabled(false);
+    ui->fileCrawlButton->setText("Indexing . . .");
+}
+
+void ExplorerWindow::remoteCrawlDone(RequestState finalState, int foldersListed)
+{
+    crawlRunning = false;
+    ui->fileCrawlButton->setEnabled(true);
+    ui->fileCrawlButton->setText("Index All Folders");
+
+    if (finalState != RequestState::GOOD)
+    {
+        qCDebug(agaveAppLayer, "Remote folder index incomplete, %d folders listed.", foldersListed);
+    }
+    runFileSearch(ui->fileSearchInput->text());
+}
+
+void ExplorerWindow::fileDownloadDone(RequestState finalState, QString localPath, qint64)
+{
+    if (finalState == RequestState::GOOD) return;
+
+    ae_globals::displayPopup(QString("Unable to download file to %1").arg(localPath));
+}
+
+void ExplorerWindow::folderTransferDone(RequestState finalState, int unitsDone, int unitsFailed)
+{
+    if (finalState == RequestState::GOOD)
+    {
+        ae_globals::displayPopup(QString("Folder transfer complete. %1 files transferred.").arg(unitsDone), "Transfer Complete");
+        return;
+    }
+
+    ae_globals::displayPopup(QString("Folder transfer incomplete. %1 files transferred, %2 files failed.").arg(unitsDone).arg(unitsFailed));
+}
+
+void ExplorerWindow::archiveTransferProgress(QString message)
+{
+    this->statusBar()->showMessage(message, 10000);
+}
+
+void ExplorerWindow::archiveUploadDone(RequestState finalState, int unitsDone, int unitsFailed)
+{
+    folderTransferDone(finalState, unitsDone, unitsFailed);
+
+    //The extract job wrote into the folder without our knowledge, so it is listed again
+    FileNodeRef uploadTarget = archiveUploadTarget;
+    archiveUploadTarget = FileNodeRef();
+    if ((finalState == RequestState::GOOD) && !uploadTarget.isNil())
+    {
+        refreshFolder(uploadTarget);
+    }
+}
+
+bool ExplorerWindow::startFolderTransfer(BulkTransfer * theTransfer, bool keepJournal)
+{
+    QObject::connect(theTransfer, SIGNAL(transferDone(RequestState,int,int)), this, SLOT(folderTransferDone(RequestState,int,int)));
+
+    //Units wait in the scheduler, which decides how many actually run at once
+    AgaveRestLink * theLink = ae_globals::get_rest_link();
+    if (theLink != nullptr)
+    {
+        theTransfer->setMaxInFlight(theLink->getScheduler()->getClassMaxLimit(RequestPriority::BULK));
+    }
+
+    if (!theTransfer->startTransfer())
+    {
+        QObject::disconnect(theTransfer, nullptr, this, nullptr);
+        //Cancelling removes the journal, which must stay for a transfer that is being resumed
+        if (keepJournal) theTransfer->setJournal(nullptr);
+        theTransfer->cancelTransfer();
+        return false;
+    }
+    activeFolderTransfer = theTransfer;
+    return true;
+}
+
+void ExplorerWindow::offerTransferResume(int attemptNum)
+{
+    //Transfers need session credentials, which may not be known right after login
+    AgaveRestLink * theLink = ae_globals::get_rest_link();
+    if ((theLink == nullptr) || !theLink->credentialsAvailable())
+    {
+        if (attemptNum < 30)
+        {
+            QTimer::singleShot(1000, this, [this, attemptNum]() { offerTransferResume(attemptNum + 1); });
+        }
+        return;
+    }
+
+    for (const QString &aJournalFile : TransferJournal::findUnfinishedJournals())
+    {
+        TransferJournal * theJournal = TransferJournal::openJournal(aJournalFile);
+        if (theJournal == nullptr) continue;
+
+        BulkTransfer * theTransfer = nullptr;
+        QString transferText;
+        if (theJournal->getDirection() == "upload")
+        {
+            FolderUpload * theUpload = new FolderUpload(theJournal->getLocalPath(), theJournal->getRemotePath(), this);
+            theUpload->setContentIndex(ae_globals::get_content_index());
+            theTransfer = theUpload;
+            transferText = QString("An upload of %1 to %2 did not finish.").arg(theJournal->getLocalPath(), theJournal->getRemotePath());
+        }
+        else if (theJournal->getDirection() == "download")
+        {
+            theTransfer = new FolderDownload(theJournal->getRemotePath(), theJournal->getLocalPath(), this);
+            transferText = QString("A download of %1 to %2 did not finish.").arg(theJournal->getRemotePath(), theJournal->getLocalPath());
+        }
+        else
+        {
+            theJournal->discardJournal();
+            delete theJournal;
+            continue;
+        }
+
+        QMessageBox::StandardButton userChoice = QMessageBox::question(this, "Resume Transfer", transferText + " Resume it now? Files already transferred will be skipped.",
+                                                                       QMessageBox::Yes | QMessageBox::No | QMessageBox::Cancel);
+
+        if (userChoice == QMessageBox::Yes)
+        {
+            theTransfer->setJournal(theJournal);
+            if (!startFolderTransfer(theTransfer, true))
+            {
+                ae_globals::displayPopup("Unable to resume transfer. It will be offered again on the next launch.");
+            }
+            //Only one folder transfer runs at a time. Any others are offered on the next launch.
+            return;
+        }
+
+        delete theTransfer;
+        if (userChoice == QMessageBox::No)
+        {
+            theJournal->discardJournal();
+        }
+        delete theJournal;
+        if (userChoice == QMessageBox::Cancel) return;
+    }
+}
+
+void ExplorerWindow::treeEditDone(RequestState finalState, QString description)
+{
+    if (finalState == RequestState::GOOD) return;
+
+    ae_globals::displayPopup(QString("Unable to complete remote file change: %1").arg(description));
+}
+
+void ExplorerWindow::treeEditsPending(int editsPending)
+{
+    if (editsPending == 0)
+    {
+        this->statusBar()->clearMessage();
+        return;
+    }
+    this->statusBar()->showMessage(QString("%1 remote file change(s) pending . . .").arg(editsPending));
+}
+
+void ExplorerWindow::treeFolderChanged(QString folderPath, QList<FileMetaData> folderContents)
+{
+    fileNameIndex.updateFolder(folderPath, folderContents);
+}
+
+void ExplorerWindow::fileSystemChanged(FileNodeRef changedFile)
+{
+    FileTreeNode * folderNode = ae_globals::get_file_handle()->getFileNodeFromNodeRef(changedFile);
+    if ((folderNode != nullptr) && (folderNode->getFileData().getFileType() != FileType::DIR))
+    {
+        folderNode = folderNode->getParentNode();
+    }
+    if (folderNode == nullptr) return;
+
+    QList<FileMetaData> folderContents;
+    for (FileTreeNode * aChild : folderNode->getChildList())
+    {
+        folderContents.append(aChild->getFileData());
+    }
+    //A folder with no entries cannot be told apart from one not yet listed, and is left alone
+    if (folderContents.isEmpty()) return;
+    fileNameIndex.updateFolder(folderNode->getFileData().getFullPath(), folderContents);
 }
@@ -41,14 +41,21 @@
 #include <QLineEdit>
 #include <QMenu>
 #include <QJsonDocument>
+#include <QPointer>
+#include <QSet>
 
+#include "filemetadata.h"
 #include "remoteFiles/filenoderef.h"
-#include "remotejobdata.h"
+#include "utilFuncs/remotenameindex.h"
+#include "utilFuncs/remotetreeeditor.h"
+#include "utilFuncs/jobrecord.h"
+#include "utilFuncs/jobfiltermodel.h"
+#include "utilFuncs/bulkjoboperation.h"
 
 class RemoteFileTree;
-class FileMetaData;
 class FileTreeNode;
 class FileOperator;
+class BulkTransfer;
 
 class ExplorerDriver;
 class RemoteDataInterface;
@@ -70,11 +77,18 @@ public:
 
     void addAppToList(QString appName);
 
+protected:
+    void changeEvent(QEvent * theEvent);
+
 private slots:
     void agaveAppSelected(QModelIndex clickedItem);
 
     void agaveCommandInvoked();
-    void finishedAppInvoke(RequestState finalState, QJsonDocument rawReply);
+    void agaveSweepInvoked();
+    void agaveWorkflowInvoked();
+    void jobSubmissionDone(int ticket, RequestState finalState, JobRecord newJob);
+    void jobQueueChanged(int waitingCount, int runningCount);
+    void jobOutputFetched(QString jobId, RequestState finalState, QString localFolder);
 
     void customFileMenu(QPoint pos);
 
@@ -85,31 +99,79 @@ private slots:
 
     void uploadMenuItem();
     void uploadFolderMenuItem();
+    void uploadArchiveMenuItem();
     void downloadFolderMenuItem();
+    void downloadArchiveMenuItem();
 
     void createFolderMenuItem();
     void downloadMenuItem();
     void readMenuItem();
     void retriveMenuItem();
+    void followFileMenuItem();
     void refreshMenuItem();
 
     void jobRightClickMenu(QPoint);
+    void jobFilterChanged();
+    void jobFilterOptionsChanged();
+    void showJobTimingStats();
 
     void demandJobRefresh();
     void deleteJobDataEntry();
+    void stopSelectedJobs();
+    void resubmitSelectedJobs();
+    void fetchJobOutput();
+    void cancelJobOutputFetch();
+    void jobOperationProgress(int jobsDone, int jobsTotal, qint64);
+    void jobOperationDone(RequestState finalState, int jobsDone, int jobsFailed);
+
+    void mergeListingPage(QString folderPath, QList<FileMetaData> newEntries);
+    void pagedListingDone(RequestState finalState, QString folderPath, QList<FileMetaData> allEntries);
+
+    void runFileSearch(QString searchText);
+    void crawlRemoteTree();
+    void remoteCrawlDone(RequestState finalState, int foldersListed);
+
+    void treeEditDone(RequestState finalState, QString description);
+    void treeEditsPending(int editsPending);
+    void treeFolderChanged(QString folderPath, QList<FileMetaData> folderContents);
+    void fileSystemChanged(FileNodeRef changedFile);
+
+    void fileDownloadDone(RequestState finalState, QString localPath, qint64 bytesWritten);
+    void folderTransferDone(RequestState finalState, int unitsDone, int unitsFailed);
+    void archiveTransferProgress(QString message);
+    void archiveUploadDone(RequestState finalState, int unitsDone, int unitsFailed);
 
 private:
+    bool startFolderTransfer(BulkTransfer * theTransfer, bool keepJournal = false);
+    void refreshFolder(FileNodeRef folderNode);
+    bool getAutoFetchSettings(QStringList * autoFetchSettings);
+    static QString formatDuration(qint64 durationSecs);
+    void startJobOperation(BulkJobOperation::JobAction theAction, QStringList jobIds);
+    void offerTransferResume(int attemptNum = 0);
+
     Ui::ExplorerWindow *ui;
 
     FileNodeRef targetNode;
-    RemoteJobData targetJob;
+    JobRecord targetJob;
+    QList<JobRecord> targetJobs;
+    QSet<QString> jobsInOperation;
+    JobFilterModel jobSortModel;
 
     QStandardItemModel taskListModel;
     QString selectedAgaveApp;
+    QSet<int> directSubmissions;
+    QMap<int, QStringList> autoFetchTickets;
 
     QMap<QString, QStringList> agaveParamLists;
+    QMap<QString, FileNodeRef> pagedListingTargets;
+
+    RemoteNameIndex fileNameIndex;
+    RemoteTreeEditor treeEditor;
+    bool crawlRunning = false;
 
-    bool waitingOnCommand = false;
+    QPointer<BulkTransfer> activeFolderTransfer;
+    QPointer<QObject> activeArchiveTransfer;
+    FileNodeRef archiveUploadTarget;
 };
 
 #endif // EXPLORERWINDOW_H
@@ -38,6 +38,9 @@
 #include <QSslSocket>
 
 #include "instances/explorerdriver.h"
+#include "utilFuncs/transportbenchmark.h"
+#include "utilFuncs/archivebenchmark.h"
+#include "utilFuncs/callbackcheck.h"
 #include "remotedatainterface.h"
 #include "ae_globals.h"
 
@@ -45,6 +48,27 @@ int main(int argc, char *argv[])
 {
     QApplication mainRunLoop(argc, argv);
 
+    TransportBenchmark * theBenchmark = TransportBenchmark::createFromArgs(argc, argv);
+    if (theBenchmark != nullptr)
+    {
+        theBenchmark->startBenchmark();
+        return mainRunLoop.exec();
+    }
+
+    ArchiveBenchmark * theArchiveBenchmark = ArchiveBenchmark::createFromArgs(argc, argv);
+    if (theArchiveBenchmark != nullptr)
+    {
+        theArchiveBenchmark->startBenchmark();
+        return mainRunLoop.exec();
+    }
+
+    CallbackCheck * theCallbackCheck = CallbackCheck::createFromArgs(argc, argv);
+    if (theCallbackCheck != nullptr)
+    {
+        theCallbackCheck->startCheck();
+        return mainRunLoop.exec();
+    }
+
     ExplorerDriver programDriver(argc, argv, nullptr);
     programDriver.loadStyleFiles();
     programDriver.startup();
@@ -0,0 +1,591 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "agavenetmanager.h"
+
+#include "agaverestlink.h"
+#include "coalescedreply.h"
+
+#include <QSettings>
+#include <QSslConfiguration>
+#include <QStandardPaths>
+#include <QDir>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QUrlQuery>
+
+QMutex AgaveNetManager::authLock;
+QByteArray AgaveNetManager::lastAuthHeader;
+
+QMutex AgaveNetManager::sessionLock;
+QHash<QString, AgaveNetManager::SavedSession> AgaveNetManager::savedSessions;
+bool AgaveNetManager::sessionsLoaded = false;
+
+double TransportMetrics::averageHandshakeMs() const
+{
+    if (newConnections == 0) return 0.0;
+    return double(totalHandshakeMs) / newConnections;
+}
+
+QString TransportMetrics::toString() const
+{
+    QString ret = QString("%1 requests (%2 HTTP/2, %3 HTTP/1.1), %4 new connections, %5 reused, %6 ms average connection setup, peak %7 concurrent")
+            .arg(requestsFinished).arg(http2Replies).arg(http1Replies).arg(newConnections).arg(reusedConnections)
+            .arg(averageHandshakeMs(), 0, 'f', 1).arg(peakConcurrentRequests);
+
+    if (resumptionAttempts > 0)
+    {
+        double offeredAverage = double(totalOfferedHandshakeMs) / resumptionAttempts;
+        ret.append(QString(", saved TLS session offered on %1 of %2 new connections (%3 ms average setup when offered")
+                   .arg(resumptionAttempts).arg(newConnections).arg(offeredAverage, 0, 'f', 1));
+        if (newConnections > resumptionAttempts)
+        {
+            double otherAverage = double(totalHandshakeMs - totalOfferedHandshakeMs) / (newConnections - resumptionAttempts);
+            ret.append(QString(", %1 ms otherwise").arg(otherAverage, 0, 'f', 1));
+        }
+        ret.append(")");
+    }
+    return ret;
+}
+
+AgaveNetManager::AgaveNetManager(QObject * parent) : QNetworkAccessManager(parent)
+{
+    transportModeValue.store(int(TransportMode::HTTP1));
+    metricsClock.start();
+}
+
+AgaveNetManager::~AgaveNetManager()
+{
+    //Note: The base destructor deletes the replies, after the members of this class are gone
+    for (QNetworkReply * aReply : findChildren<QNetworkReply *>())
+    {
+        QObject::disconnect(aReply, nullptr, this, nullptr);
+    }
+}
+
+void AgaveNetManager::setTransportMode(TransportMode newMode)
+{
+    transportModeValue.store(int(newMode));
+}
+
+TransportMode AgaveNetManager::getTransportMode()
+{
+    return TransportMode(transportModeValue.load());
+}
+
+TransportMetrics AgaveNetManager::getTransportMetrics()
+{
+    QMutexLocker lock(&metricsLock);
+    return myMetrics;
+}
+
+void AgaveNetManager::setSessionCacheEnabled(bool enabled)
+{
+    sessionCacheEnabled = enabled;
+
+    //Earlier versions saved session data in the settings, which anyone may read
+    QSettings oldSettings("SimCenter", "AgaveExplorer");
+    oldSettings.remove("tlsSessions");
+
+    if (!enabled)
+    {
+        clearSavedSessions();
+        return;
+    }
+    QMutexLocker lock(&sessionLock);
+    if (!sessionsLoaded) loadSessions();
+}
+
+void AgaveNetManager::clearSavedSessions()
+{
+    QMutexLocker lock(&sessionLock);
+    savedSessions.clear();
+    sessionsLoaded = true;
+    QFile::remove(getSessionFilePath());
+}
+
+int AgaveNetManager::getCoalescableCount()
+{
+    return coalescableCount.load();
+}
+
+int AgaveNetManager::getCoalescedCount()
+{
+    return coalescedCount.load();
+}
+
+double AgaveNetManager::getCoalescingHitRate()
+{
+    int totalCount = coalescableCount.load();
+    if (totalCount == 0) return 0.0;
+    return double(coalescedCount.load()) / totalCount;
+}
+
+QByteArray AgaveNetManager::getAuthHeader()
+{
+    QMutexLocker lock(&authLock);
+    return lastAuthHeader;
+}
+
+QNetworkReply * AgaveNetManager::createRequest(Operation op, const QNetworkRequest &originalReq, QIODevice * outgoingData)
+{
+    //Note: The token request itself uses Basic auth, only bearer tokens are session credentials
+    QByteArray authHeader = originalReq.rawHeader("Authorization");
+    if (authHeader.startsWith("Bearer"))
+    {
+        bool firstCredentials;
+        {
+            QMutexLocker lock(&authLock);
+            firstCredentials = lastAuthHeader.isEmpty();
+            lastAuthHeader = authHeader;
+        }
+
+        if (firstCredentials) emit credentialsAvailable();
+    }
+
+    QNetworkRequest prioritizedReq(originalReq);
+    if (!originalReq.attribute(AgaveRestLink::scheduledAttribute).toBool())
+    {
+        bool isUpload = ((op == PostOperation) || (op == PutOperation)) &&
+                originalReq.header(QNetworkRequest::ContentTypeHeader).toString().startsWith("multipart");
+        prioritizedReq.setPriority(isUpload ? QNetworkRequest::LowPriority : QNetworkRequest::HighPriority);
+    }
+    prioritizedReq.setAttribute(QNetworkRequest::HTTP2AllowedAttribute, getTransportMode() == TransportMode::HTTP2);
+    offerCachedSession(&prioritizedReq);
+
+    if ((op == PutOperation) || (op == PostOperation) || (op == DeleteOperation))
+    {
+        dropSharedGets(getRemotePath(prioritizedReq.url()));
+
+        //A move, copy or rename also changes its destination
+        QString destinationPath = getActionDestination(prioritizedReq, outgoingData);
+        if (!destinationPath.isEmpty()) dropSharedGets(destinationPath);
+    }
+    if (canCoalesce(op, prioritizedReq))
+    {
+        return joinSharedGet(prioritizedReq, outgoingData);
+    }
+    return sendNetworkRequest(op, prioritizedReq, outgoingData);
+}
+
+void AgaveNetManager::sharedGetProgress(qint64 bytesReceived)
+{
+    QNetworkReply * sharedReply = qobject_cast<QNetworkReply *>(sender());
+    if (!callerHeldGets.contains(sharedReply)) return;
+    callerHeldGets.insert(sharedReply, bytesReceived);
+}
+
+void AgaveNetManager::sharedGetFinished()
+{
+    QNetworkReply * sharedReply = qobject_cast<QNetworkReply *>(sender());
+    if (!sharedGetKeys.contains(sharedReply)) return;
+
+    QByteArray requestKey = sharedGetKeys.take(sharedReply);
+    if (sharedGets.value(requestKey) == sharedReply) sharedGets.remove(requestKey);
+    QList<QPointer<CoalescedReply>> waiterList = sharedGetWaiters.take(sharedReply);
+    waiterList.removeAll(QPointer<CoalescedReply>());
+
+    bool callerHeld = callerHeldGets.contains(sharedReply);
+    qint64 bytesReceived = callerHeldGets.take(sharedReply);
+    if (!callerHeld)
+    {
+        QByteArray replyContents = sharedReply->readAll();
+        for (const QPointer<CoalescedReply> &aWaiter : waiterList)
+        {
+            aWaiter->deliverResult(sharedReply, replyContents);
+        }
+        sharedReply->deleteLater();
+        return;
+    }
+    if (waiterList.isEmpty()) return;
+
+    //The first caller reads the reply after this, so it is only peeked, and only if that caller has not read any of it yet
+    if ((sharedReply->error() != QNetworkReply::OperationCanceledError) && (sharedReply->bytesAvailable() == bytesReceived))
+    {
+        QByteArray replyContents = sharedReply->peek(bytesReceived);
+        for (const QPointer<CoalescedReply> &aWaiter : waiterList)
+        {
+            aWaiter->deliverResult(sharedReply, replyContents);
+        }
+        return;
+    }
+
+    //Otherwise, the callers which joined are given a network request of their own
+    QNetworkReply * newReply = sendNetworkRequest(GetOperation, sharedReply->request(), nullptr);
+    sharedGetWaiters.insert(newReply, waiterList);
+    watchSharedGet(newReply, requestKey);
+}
+
+void AgaveNetManager::replyDestroyed(QObject * theObject)
+{
+    //Note: Only the address of the reply may be used here, as it is partly destroyed
+    QNetworkReply * theReply = static_cast<QNetworkReply *>(theObject);
+    replyStartTimes.remove(theReply);
+    encryptedReplies.remove(theReply);
+    sessionOffered.remove(theReply);
+
+    //A caller which deletes a shared reply before it finishes leaves the callers which joined it without a result
+    if (!sharedGetKeys.contains(theReply)) return;
+    QByteArray requestKey = sharedGetKeys.take(theReply);
+    if (sharedGets.value(requestKey) == theReply) sharedGets.remove(requestKey);
+    callerHeldGets.remove(theReply);
+
+    QList<QPointer<CoalescedReply>> waiterList = sharedGetWaiters.take(theReply);
+    waiterList.removeAll(QPointer<CoalescedReply>());
+    if (waiterList.isEmpty()) return;
+
+    QNetworkReply * newReply = sendNetworkRequest(GetOperation, waiterList.first()->request(), nullptr);
+    sharedGetWaiters.insert(newReply, waiterList);
+    watchSharedGet(newReply, requestKey);
+}
+
+void AgaveNetManager::waiterAborted()
+{
+    CoalescedReply * theWaiter = qobject_cast<CoalescedReply *>(sender());
+
+    for (auto itr = sharedGetWaiters.begin(); itr != sharedGetWaiters.end(); itr++)
+    {
+        if (!itr.value().removeAll(theWaiter)) continue;
+
+        bool waitersLeft = false;
+        for (const QPointer<CoalescedReply> &aWaiter : itr.value())
+        {
+            if (!aWaiter.isNull()) waitersLeft = true;
+        }
+
+        //The network request is only aborted once no caller wants it
+        if (!waitersLeft && !callerHeldGets.contains(itr.key()))
+        {
+            itr.key()->abort();
+        }
+        return;
+    }
+}
+
+bool AgaveNetManager::canCoalesce(Operation op, const QNetworkRequest &theRequest)
+{
+    if (op != GetOperation) return false;
+    if (!theRequest.rawHeader("Range").isEmpty()) return false;
+    if (theRequest.url().path().contains("/files/v2/media/")) return false;
+    return true;
+}
+
+QNetworkReply * AgaveNetManager::joinSharedGet(const QNetworkRequest &theRequest, QIODevice * outgoingData)
+{
+    QByteArray requestKey = theRequest.url().toEncoded();
+    requestKey.append('\n');
+    requestKey.append(theRequest.rawHeader("Authorization"));
+
+    coalescableCount.fetchAndAddRelaxed(1);
+
+    QNetworkReply * sharedReply = sharedGets.value(requestKey, nullptr);
+    if (sharedReply == nullptr)
+    {
+        //The first caller gets the network reply itself, with no copy of its contents unless another caller joins
+        sharedReply = sendNetworkRequest(GetOperation, theRequest, outgoingData);
+        sharedGets.insert(requestKey, sharedReply);
+        callerHeldGets.insert(sharedReply, 0);
+        watchSharedGet(sharedReply, requestKey);
+        return sharedReply;
+    }
+    coalescedCount.fetchAndAddRelaxed(1);
+
+    CoalescedReply * newWaiter = new CoalescedReply(theRequest, this);
+    sharedGetWaiters[sharedReply].append(newWaiter);
+    QObject::connect(newWaiter, SIGNAL(replyAborted()), this, SLOT(waiterAborted()));
+    return newWaiter;
+}
+
+void AgaveNetManager::watchSharedGet(QNetworkReply * sharedReply, QByteArray requestKey)
+{
+    //Note: These are connected before the caller gets the reply, so they run before the caller's own slots
+    sharedGetKeys.insert(sharedReply, requestKey);
+    QObject::connect(sharedReply, SIGNAL(downloadProgress(qint64,qint64)), this, SLOT(sharedGetProgress(qint64)));
+    QObject::connect(sharedReply, SIGNAL(finished()), this, SLOT(sharedGetFinished()));
+}
+
+void AgaveNetManager::dropSharedGets(const QString &changedPath)
+{
+    //Requests already in flight keep their callers, but later callers send a new request
+    for (auto itr = sharedGets.begin(); itr != sharedGets.end(); )
+    {
+        QString sharedPath = getRemotePath(QUrl::fromEncoded(itr.key().left(itr.key().indexOf('\n'))));
+        if ((sharedPath == changedPath) || sharedPath.startsWith(changedPath + "/") || changedPath.startsWith(sharedPath + "/"))
+        {
+            itr = sharedGets.erase(itr);
+        }
+        else
+        {
+            itr++;
+        }
+    }
+}
+
+QString AgaveNetManager::getActionDestination(const QNetworkRequest &theRequest, QIODevice * outgoingData)
+{
+    //File actions give the destination in the "path" field of a small form or JSON body, which is peeked without being consumed
+    if ((outgoingData == nullptr) || outgoingData->isSequential()) return QString();
+    if (outgoingData->bytesAvailable() > maxActionBodyBytes) return QString();
+
+    QString contentType = theRequest.header(QNetworkRequest::ContentTypeHeader).toString();
+    QByteArray requestBody = outgoingData->peek(outgoingData->bytesAvailable());
+    QString actionPath;
+    if (contentType.contains("json"))
+    {
+        actionPath = QJsonDocument::fromJson(requestBody).object().value("path").toString();
+    }
+    else if (contentType.startsWith("application/x-www-form-urlencoded"))
+    {
+        actionPath = QUrlQuery(QString::fromUtf8(requestBody)).queryItemValue("path", QUrl::FullyDecoded);
+    }
+    if (actionPath.isEmpty()) return QString();
+
+    //A rename or mkdir gives only a name, in the folder of the changed path
+    if (!actionPath.contains('/'))
+    {
+        actionPath = getRemotePath(theRequest.url()).section('/', 0, -2) + "/" + actionPath;
+    }
+    if (!actionPath.startsWith('/')) actionPath.prepend('/');
+    while (actionPath.endsWith('/'))
+    {
+        actionPath.chop(1);
+    }
+    return actionPath;
+}
+
+QString AgaveNetManager::getRemotePath(const QUrl &theUrl)
+{
+    //File requests name the storage system after /system/, and the rest is the remote path, so that listings and file actions on one path match
+    QString ret = theUrl.path();
+    int systemIndex = ret.indexOf("/system/");
+    if (systemIndex >= 0)
+    {
+        ret = ret.mid(systemIndex + 8);
+        int pathIndex = ret.indexOf('/');
+        ret = (pathIndex < 0) ? QString() : ret.mid(pathIndex);
+    }
+    while (ret.endsWith('/'))
+    {
+        ret.chop(1);
+    }
+    return ret;
+}
+
+QNetworkReply * AgaveNetManager::sendNetworkRequest(Operation op, const QNetworkRequest &theRequest, QIODevice * outgoingData)
+{
+    QNetworkReply * theReply = QNetworkAccessManager::createRequest(op, theRequest, outgoingData);
+
+    replyStartTimes.insert(theReply, metricsClock.elapsed());
+    QObject::connect(theReply, SIGNAL(destroyed(QObject*)), this, SLOT(replyDestroyed(QObject*)));
+    if (sessionCacheEnabled && !theRequest.sslConfiguration().sessionTicket().isEmpty())
+    {
+        sessionOffered.insert(theReply);
+    }
+    QObject::connect(theReply, SIGNAL(encrypted()), this, SLOT(replyEncrypted()));
+    QObject::connect(theReply, SIGNAL(finished()), this, SLOT(replyMetricsDone()));
+
+    QMutexLocker lock(&metricsLock);
+    if (replyStartTimes.size() > myMetrics.peakConcurrentRequests)
+    {
+        myMetrics.peakConcurrentRequests = replyStartTimes.size();
+    }
+    return theReply;
+}
+
+void AgaveNetManager::replyEncrypted()
+{
+    QNetworkReply * theReply = qobject_cast<QNetworkReply *>(sender());
+    if (!replyStartTimes.contains(theReply)) return;
+
+    //Note: encrypted() is only emitted for a reply which set up a new TLS connection
+    encryptedReplies.insert(theReply);
+    qint64 handshakeTime = metricsClock.elapsed() - replyStartTimes.value(theReply);
+
+    bool attemptedResume = sessionOffered.contains(theReply);
+    storeSession(theReply);
+
+    QMutexLocker lock(&metricsLock);
+    myMetrics.newConnections++;
+    myMetrics.totalHandshakeMs += handshakeTime;
+    if (attemptedResume)
+    {
+        myMetrics.resumptionAttempts++;
+        myMetrics.totalOfferedHandshakeMs += handshakeTime;
+    }
+}
+
+void AgaveNetManager::replyMetricsDone()
+{
+    QNetworkReply * theReply = qobject_cast<QNetworkReply *>(sender());
+    if (!replyStartTimes.contains(theReply)) return;
+
+    replyStartTimes.remove(theReply);
+    bool madeNewConnection = encryptedReplies.remove(theReply);
+    sessionOffered.remove(theReply);
+
+    //Note: Under TLS 1.3, the session ticket may only arrive after the handshake
+    if (madeNewConnection) storeSession(theReply);
+
+    QMutexLocker lock(&metricsLock);
+    myMetrics.requestsFinished++;
+    if (theReply->error() == QNetworkReply::NoError)
+    {
+        if (!madeNewConnection) myMetrics.reusedConnections++;
+        if (theReply->attribute(QNetworkRequest::HTTP2WasUsedAttribute).toBool())
+        {
+            myMetrics.http2Replies++;
+        }
+        else
+        {
+            myMetrics.http1Replies++;
+        }
+    }
+}
+
+void AgaveNetManager::offerCachedSession(QNetworkRequest * theRequest)
+{
+    if (!sessionCacheEnabled) return;
+    if (theRequest->url().scheme() != "https") return;
+
+    QSslConfiguration sessionConfig = theRequest->sslConfiguration();
+    sessionConfig.setSslOption(QSsl::SslOptionDisableSessionPersistence, false);
+    sessionConfig.setSslOption(QSsl::SslOptionDisableSessionTickets, false);
+
+    QByteArray cachedTicket;
+    {
+        QMutexLocker lock(&sessionLock);
+        QString sessionKey = getSessionKey(theRequest->url());
+        if (savedSessions.contains(sessionKey))
+        {
+            if (savedSessions.value(sessionKey).expiryTime > QDateTime::currentDateTimeUtc())
+            {
+                cachedTicket = savedSessions.value(sessionKey).ticket;
+            }
+            else
+            {
+                savedSessions.remove(sessionKey);
+            }
+        }
+    }
+    if (!cachedTicket.isEmpty())
+    {
+        sessionConfig.setSessionTicket(cachedTicket);
+    }
+    theRequest->setSslConfiguration(sessionConfig);
+}
+
+void AgaveNetManager::storeSession(QNetworkReply * theReply)
+{
+    if (!sessionCacheEnabled) return;
+
+    QSslConfiguration replyConfig = theReply->sslConfiguration();
+    QByteArray newTicket = replyConfig.sessionTicket();
+    if (newTicket.isEmpty()) return;
+
+    //The server says how long it will accept the ticket. If it does not, the ticket is kept for a short time only.
+    int lifetimeSecs = replyConfig.sessionTicketLifeTimeHint();
+    if (lifetimeSecs <= 0) lifetimeSecs = defaultTicketLifetimeSecs;
+    lifetimeSecs = qMin(lifetimeSecs, maxTicketLifetimeSecs);
+
+    QMutexLocker lock(&sessionLock);
+    QString sessionKey = getSessionKey(theReply->url());
+    if (savedSessions.value(sessionKey).ticket == newTicket) return;
+
+    SavedSession newSession;
+    newSession.ticket = newTicket;
+    newSession.expiryTime = QDateTime::currentDateTimeUtc().addSecs(lifetimeSecs);
+    savedSessions.insert(sessionKey, newSession);
+    saveSessions();
+}
+
+QString AgaveNetManager::getSessionKey(const QUrl &theUrl)
+{
+    return QString("%1:%2").arg(theUrl.host()).arg(theUrl.port(443));
+}
+
+QString AgaveNetManager::getSessionFilePath()
+{
+    return QDir(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)).absoluteFilePath("tlsSessions.json");
+}
+
+void AgaveNetManager::loadSessions()
+{
+    sessionsLoaded = true;
+
+    QFile sessionFile(getSessionFilePath());
+    if (!sessionFile.open(QIODevice::ReadOnly)) return;
+    QJsonObject fileContents = QJsonDocument::fromJson(sessionFile.readAll()).object();
+
+    QDateTime currentTime = QDateTime::currentDateTimeUtc();
+    for (auto itr = fileContents.constBegin(); itr != fileContents.constEnd(); itr++)
+    {
+        QJsonObject sessionEntry = itr.value().toObject();
+        SavedSession oldSession;
+        oldSession.ticket = QByteArray::fromBase64(sessionEntry.value("ticket").toString().toLatin1());
+        oldSession.expiryTime = QDateTime::fromMSecsSinceEpoch(qint64(sessionEntry.value("expires").toDouble()), Qt::UTC);
+        if (oldSession.ticket.isEmpty() || (oldSession.expiryTime <= currentTime)) continue;
+        savedSessions.insert(itr.key(), oldSession);
+    }
+}
+
+void AgaveNetManager::saveSessions()
+{
+    QDir storeFolder(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation));
+    if (!storeFolder.mkpath(".")) return;
+
+    QJsonObject fileContents;
+    QDateTime currentTime = QDateTime::currentDateTimeUtc();
+    for (auto itr = savedSessions.cbegin(); itr != savedSessions.cend(); itr++)
+    {
+        if (itr.value().expiryTime <= currentTime) continue;
+        QJsonObject sessionEntry;
+        sessionEntry.insert("ticket", QString::fromLatin1(itr.value().ticket.toBase64()));
+        sessionEntry.insert("expires", double(itr.value().expiryTime.toMSecsSinceEpoch()));
+        fileContents.insert(itr.key(), sessionEntry);
+    }
+
+    //Session data holds the secret of the session, so only the user may read the file.
+    //Note: The permissions are set before anything is written.
+    QFile sessionFile(getSessionFilePath());
+    if (!sessionFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) return;
+    if (!sessionFile.setPermissions(QFileDevice::ReadOwner | QFileDevice::WriteOwner))
+    {
+        sessionFile.close();
+        sessionFile.remove();
+        return;
+    }
+    sessionFile.write(QJsonDocument(fileContents).toJson(QJsonDocument::Compact));
+}
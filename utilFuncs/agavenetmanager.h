@@ -0,0 +1,209 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef AGAVENETMANAGER_H
+#define AGAVENETMANAGER_H
+
+#include <QNetworkAccessManager>
+#include <QNetworkRequest>
+#include <QMutex>
+#include <QHash>
+#include <QPointer>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QSet>
+#include <QDateTime>
+
+class CoalescedReply;
+
+/*! \brief The TransportMode selects the HTTP version offered to the Agave server.
+ *
+ *  In HTTP2 mode, HTTP/2 is offered during the TLS handshake, and many requests share one connection. If the server does not accept it, HTTP/1.1 is used instead.
+ */
+enum class TransportMode {HTTP1, HTTP2};
+
+/*! \brief The TransportMetrics are counters of how the requests of an AgaveNetManager used the network.
+ */
+struct TransportMetrics
+{
+    int requestsFinished = 0;
+    int http2Replies = 0;
+    int http1Replies = 0;
+    int newConnections = 0;
+    int reusedConnections = 0;
+    qint64 totalHandshakeMs = 0;
+    int peakConcurrentRequests = 0;
+
+    //Qt does not report whether a session was resumed, only whether one was offered
+    int resumptionAttempts = 0;
+    qint64 totalOfferedHandshakeMs = 0;
+
+    double averageHandshakeMs() const;
+    QString toString() const;
+};
+
+/*! \brief The AgaveNetManager is the QNetworkAccessManager used for all traffic to the Agave server.
+ *
+ *  Every request made by the AgaveHandler, as well as every direct request made through the AgaveRestLink, passes through createRequest() of this object.
+ *  This gives the AgaveExplorer one place to observe the session credentials and to adjust how requests are sent.
+ *
+ *  Requests of the AgaveHandler are not scheduled by the RequestScheduler. Instead, uploads from the AgaveHandler are given low priority, and its other requests high priority,
+ *  so that the network manager does not hold folder listings and job requests behind a long recursive upload.
+ *
+ *  Identical GET requests in flight at the same time share one network request. The first caller gets the network reply itself,
+ *  and each caller which joins it gets a CoalescedReply, with a copy of the result. File contents are not coalesced.
+ *  A PUT, POST or DELETE on a path stops later GETs of that path, its subfolders and its parent folders from joining a request sent before the change.
+ *  For a move, copy or rename, the same is done for the destination path, taken from the "path" field of the request body.
+ *  If the first caller deletes its reply before it finishes, the callers which joined it are given a network request of their own.
+ *
+ *  The AgaveNetManager also counts connection setups, connection reuse and HTTP versions, for getTransportMetrics().
+ *
+ *  If the session cache is enabled, the TLS session ticket of each server is kept, and offered again on later connections, so that the server may resume it with a short handshake.
+ *  Tickets are saved to a file which only the user may read, so that the next run can resume them too. Each is kept only as long as the server says it is good for,
+ *  and all are removed by clearSavedSessions() on logout.
+ */
+class AgaveNetManager : public QNetworkAccessManager
+{
+    Q_OBJECT
+public:
+    explicit AgaveNetManager(QObject * parent = nullptr);
+    ~AgaveNetManager();
+
+    /*! \brief Returns the most recent bearer Authorization header sent to the Agave server.
+     *
+     *  Returns an empty array if no authenticated request has been made yet. This method is thread-safe.
+     */
+    static QByteArray getAuthHeader();
+
+    /*! \brief Returns the number of GET requests which could have shared a network request.
+     */
+    int getCoalescableCount();
+    /*! \brief Returns the number of GET requests which shared a network request already in flight.
+     */
+    int getCoalescedCount();
+    /*! \brief Returns the fraction of coalescable GET requests which shared a network request.
+     */
+    double getCoalescingHitRate();
+
+    /*! \brief Sets the HTTP version offered for later requests. The default is HTTP1.
+     */
+    void setTransportMode(TransportMode newMode);
+    TransportMode getTransportMode();
+
+    /*! \brief Returns a copy of the transport counters. This method is thread-safe.
+     */
+    TransportMetrics getTransportMetrics();
+
+    /*! \brief Enables keeping and resuming TLS sessions across connections and across runs of the program. The default is disabled.
+     */
+    void setSessionCacheEnabled(bool enabled);
+    /*! \brief Forgets all saved TLS sessions, and removes the file in which they are kept. This should be called on logout.
+     */
+    static void clearSavedSessions();
+
+signals:
+    /*! \brief Emitted by the manager which captures the first bearer Authorization header, once session credentials can be used.
+     *
+     *  This may be emitted from the thread of the AgaveHandler.
+     */
+    void credentialsAvailable();
+
+protected:
+    virtual QNetworkReply * createRequest(Operation op, const QNetworkRequest &originalReq, QIODevice * outgoingData = nullptr);
+
+private slots:
+    void sharedGetProgress(qint64 bytesReceived);
+    void sharedGetFinished();
+    void waiterAborted();
+    void replyDestroyed(QObject * theObject);
+
+    void replyEncrypted();
+    void replyMetricsDone();
+
+private:
+    bool canCoalesce(Operation op, const QNetworkRequest &theRequest);
+    QNetworkReply * joinSharedGet(const QNetworkRequest &theRequest, QIODevice * outgoingData);
+    void watchSharedGet(QNetworkReply * sharedReply, QByteArray requestKey);
+    void dropSharedGets(const QString &changedPath);
+    static QString getActionDestination(const QNetworkRequest &theRequest, QIODevice * outgoingData);
+    static QString getRemotePath(const QUrl &theUrl);
+    QNetworkReply * sendNetworkRequest(Operation op, const QNetworkRequest &theRequest, QIODevice * outgoingData);
+
+    void offerCachedSession(QNetworkRequest * theRequest);
+    void storeSession(QNetworkReply * theReply);
+    static QString getSessionKey(const QUrl &theUrl);
+    static QString getSessionFilePath();
+    static void loadSessions();
+    static void saveSessions();
+
+    QHash<QByteArray, QNetworkReply *> sharedGets;
+    QHash<QNetworkReply *, QByteArray> sharedGetKeys;
+    QHash<QNetworkReply *, QList<QPointer<CoalescedReply>>> sharedGetWaiters;
+    //Shared requests whose network reply was handed to the first caller, with the bytes received so far
+    QHash<QNetworkReply *, qint64> callerHeldGets;
+
+    QAtomicInt coalescableCount;
+    QAtomicInt coalescedCount;
+
+    QAtomicInt transportModeValue;
+    QElapsedTimer metricsClock;
+    QHash<QNetworkReply *, qint64> replyStartTimes;
+    QSet<QNetworkReply *> encryptedReplies;
+    QMutex metricsLock;
+    TransportMetrics myMetrics;
+
+    bool sessionCacheEnabled = false;
+    QSet<QNetworkReply *> sessionOffered;
+
+    struct SavedSession
+    {
+        QByteArray ticket;
+        QDateTime expiryTime;
+    };
+    //Saved sessions are shared by all managers, keyed by host and port
+    static QMutex sessionLock;
+    static QHash<QString, SavedSession> savedSessions;
+    static bool sessionsLoaded;
+
+    static const int maxActionBodyBytes = 4096;
+
+    static const int defaultTicketLifetimeSecs = 3600;
+    static const int maxTicketLifetimeSecs = 604800;
+
+    static QMutex authLock;
+    static QByteArray lastAuthHeader;
+};
+
+#endif // AGAVENETMANAGER_H
@@ -0,0 +1,312 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "agaverestlink.h"
+
+#include "agavenetmanager.h"
+#include "requestscheduler.h"
+#include "hashingfilereader.h"
+#include "filemetadata.h"
+
+#include <QHttpMultiPart>
+#include <QFileInfo>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QUrl>
+
+#include <climits>
+
+AgaveRestLink::AgaveRestLink(QString tenantURL, QString storageSystem, QObject * parent) : QObject(parent)
+{
+    myTenantURL = tenantURL;
+    myStorageSystem = storageSystem;
+    directManager = new AgaveNetManager(this);
+    myScheduler = new RequestScheduler(this);
+}
+
+bool AgaveRestLink::credentialsAvailable()
+{
+    return !AgaveNetManager::getAuthHeader().isEmpty();
+}
+
+QString AgaveRestLink::getStorageSystem()
+{
+    return myStorageSystem;
+}
+
+RequestScheduler * AgaveRestLink::getScheduler()
+{
+    return myScheduler;
+}
+
+AgaveNetManager * AgaveRestLink::getNetManager()
+{
+    return directManager;
+}
+
+QNetworkReply * AgaveRestLink::sendGet(QString urlSuffix, QUrlQuery query)
+{
+    if (!credentialsAvailable()) return nullptr;
+
+    return directManager->get(buildRequest(urlSuffix, query));
+}
+
+QNetworkReply * AgaveRestLink::requestListingPage(QString remotePath, int offset, int limit)
+{
+    QUrlQuery pageQuery;
+    pageQuery.addQueryItem("offset", QString::number(offset));
+    pageQuery.addQueryItem("limit", QString::number(limit));
+
+    return sendGet(buildSystemPath("/files/v2/listings/system/", remotePath), pageQuery);
+}
+
+QNetworkReply * AgaveRestLink::requestFileContents(QString remotePath, qint64 rangeStart, qint64 rangeEnd)
+{
+    if (!credentialsAvailable()) return nullptr;
+
+    QNetworkRequest theRequest = buildRequest(buildSystemPath("/files/v2/media/system/", remotePath), QUrlQuery());
+    if (rangeEnd >= 0)
+    {
+        theRequest.setRawHeader("Range", QString("bytes=%1-%2").arg(qMax(rangeStart, qint64(0))).arg(rangeEnd).toLatin1());
+    }
+    else if (rangeStart > 0)
+    {
+        theRequest.setRawHeader("Range", QString("bytes=%1-").arg(rangeStart).toLatin1());
+    }
+    return directManager->get(theRequest);
+}
+
+QNetworkReply * AgaveRestLink::requestMakeFolder(QString parentPath, QString folderName)
+{
+    return requestFileAction(parentPath, "mkdir", folderName);
+}
+
+QNetworkReply * AgaveRestLink::requestFileAction(QString remotePath, QString action, QString actionPath)
+{
+    if (!credentialsAvailable()) return nullptr;
+
+    QNetworkRequest theRequest = buildRequest(buildSystemPath("/files/v2/media/system/", remotePath), QUrlQuery());
+    theRequest.setHeader(QNetworkRequest::ContentTypeHeader, "application/x-www-form-urlencoded");
+
+    QUrlQuery actionBody;
+    actionBody.addQueryItem("action", action);
+    actionBody.addQueryItem("path", actionPath);
+    return directManager->put(theRequest, actionBody.toString(QUrl::FullyEncoded).toLatin1());
+}
+
+QNetworkReply * AgaveRestLink::requestDelete(QString remotePath)
+{
+    if (!credentialsAvailable()) return nullptr;
+
+    return directManager->deleteResource(buildRequest(buildSystemPath("/files/v2/media/system/", remotePath), QUrlQuery()));
+}
+
+QNetworkReply * AgaveRestLink::requestFileUpload(QString localFile, QString remoteFolder, StreamHasher * contentHasher)
+{
+    if (!credentialsAvailable()) return nullptr;
+
+    QIODevice * uploadSource = nullptr;
+    if (contentHasher != nullptr)
+    {
+        uploadSource = new HashingFileReader(localFile, contentHasher);
+    }
+    else
+    {
+        uploadSource = new QFile(localFile);
+    }
+    if (!uploadSource->open(QIODevice::ReadOnly))
+    {
+        delete uploadSource;
+        return nullptr;
+    }
+
+    return requestStreamUpload(uploadSource, QFileInfo(localFile).fileName(), remoteFolder);
+}
+
+QNetworkReply * AgaveRestLink::requestStreamUpload(QIODevice * uploadSource, QString fileName, QString remoteFolder)
+{
+    if (!credentialsAvailable())
+    {
+        delete uploadSource;
+        return nullptr;
+    }
+
+    QHttpMultiPart * uploadBody = new QHttpMultiPart(QHttpMultiPart::FormDataType);
+    uploadSource->setParent(uploadBody);
+
+    QHttpPart filePart;
+    filePart.setHeader(QNetworkRequest::ContentDispositionHeader,
+                       QString("form-data; name=\"fileToUpload\"; filename=\"%1\"").arg(fileName));
+    filePart.setHeader(QNetworkRequest::ContentTypeHeader, "application/octet-stream");
+    filePart.setBodyDevice(uploadSource);
+    uploadBody->append(filePart);
+
+    QNetworkRequest theRequest = buildRequest(buildSystemPath("/files/v2/media/system/", remoteFolder), QUrlQuery());
+    QNetworkReply * ret = directManager->post(theRequest, uploadBody);
+    uploadBody->setParent(ret);
+    return ret;
+}
+
+QNetworkReply * AgaveRestLink::requestJobList(int offset, int limit, QDateTime updatedAfter)
+{
+    QUrlQuery pageQuery;
+    pageQuery.addQueryItem("offset", QString::number(offset));
+    pageQuery.addQueryItem("limit", QString::number(limit));
+    if (updatedAfter.isValid())
+    {
+        pageQuery.addQueryItem("lastUpdated.after", updatedAfter.toUTC().toString(Qt::ISODate));
+    }
+
+    return sendGet("/jobs/v2", pageQuery);
+}
+
+QNetworkReply * AgaveRestLink::requestJobDetails(QString jobId)
+{
+    return sendGet(QString("/jobs/v2/%1").arg(jobId));
+}
+
+QNetworkReply * AgaveRestLink::requestJobAction(QString jobId, QString action)
+{
+    if (!credentialsAvailable()) return nullptr;
+
+    QNetworkRequest theRequest = buildRequest(QString("/jobs/v2/%1").arg(jobId), QUrlQuery());
+    theRequest.setHeader(QNetworkRequest::ContentTypeHeader, "application/x-www-form-urlencoded");
+
+    QUrlQuery actionBody;
+    actionBody.addQueryItem("action", action);
+    return directManager->post(theRequest, actionBody.toString(QUrl::FullyEncoded).toLatin1());
+}
+
+QNetworkReply * AgaveRestLink::requestJobDelete(QString jobId)
+{
+    if (!credentialsAvailable()) return nullptr;
+
+    return directManager->deleteResource(buildRequest(QString("/jobs/v2/%1").arg(jobId), QUrlQuery()));
+}
+
+QNetworkReply * AgaveRestLink::requestJobNotification(QString jobId, QString callbackUrl)
+{
+    if (!credentialsAvailable()) return nullptr;
+
+    QJsonObject notificationBody;
+    notificationBody.insert("associatedUuid", jobId);
+    notificationBody.insert("event", "*");
+    notificationBody.insert("url", callbackUrl);
+    notificationBody.insert("persistent", true);
+
+    QNetworkRequest theRequest = buildRequest("/notifications/v2", QUrlQuery());
+    theRequest.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+    return directManager->post(theRequest, QJsonDocument(notificationBody).toJson(QJsonDocument::Compact));
+}
+
+QNetworkReply * AgaveRestLink::requestNotificationList(int offset, int limit)
+{
+    QUrlQuery pageQuery;
+    pageQuery.addQueryItem("offset", QString::number(offset));
+    pageQuery.addQueryItem("limit", QString::number(limit));
+
+    return sendGet("/notifications/v2", pageQuery);
+}
+
+QNetworkReply * AgaveRestLink::requestNotificationDelete(QString notificationId)
+{
+    if (!credentialsAvailable()) return nullptr;
+
+    return directManager->deleteResource(buildRequest(QString("/notifications/v2/%1").arg(notificationId), QUrlQuery()));
+}
+
+bool AgaveRestLink::parseFileEntry(const QJsonObject &rawEntry, FileMetaData * parsedEntry, qint64 * fullSize)
+{
+    QString entryName = rawEntry.value("name").toString();
+    QString entryPath = rawEntry.value("path").toString();
+    QString entryType = rawEntry.value("type").toString();
+
+    if (entryName.isEmpty() || (entryName == ".") || entryPath.isEmpty()) return false;
+
+    if (!entryPath.startsWith('/')) entryPath.prepend('/');
+    parsedEntry->setFullFilePath(entryPath);
+    //Note: toInt() gives 0 for any length too large for an int
+    qint64 entryLength = qint64(rawEntry.value("length").toDouble());
+    parsedEntry->setSize(int(qMin(entryLength, qint64(INT_MAX))));
+    if (fullSize != nullptr) *fullSize = entryLength;
+
+    if (entryType == "dir")
+    {
+        parsedEntry->setType(FileType::DIR);
+    }
+    else if (entryType == "file")
+    {
+        parsedEntry->setType(FileType::FILE);
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+QJsonValue AgaveRestLink::getReplyResult(QByteArray rawReply)
+{
+    QJsonDocument parsedReply = QJsonDocument::fromJson(rawReply);
+    if (!parsedReply.isObject()) return QJsonValue(QJsonValue::Undefined);
+
+    QJsonObject replyObject = parsedReply.object();
+    if (replyObject.value("status").toString() != "success") return QJsonValue(QJsonValue::Undefined);
+
+    return replyObject.value("result");
+}
+
+QString AgaveRestLink::buildSystemPath(QString apiPath, QString remotePath)
+{
+    QString ret = apiPath;
+    ret.append(myStorageSystem);
+    if (!remotePath.startsWith('/')) ret.append('/');
+    ret.append(remotePath);
+    return ret;
+}
+
+QNetworkRequest AgaveRestLink::buildRequest(QString urlSuffix, QUrlQuery query)
+{
+    QUrl requestURL(myTenantURL);
+    requestURL.setPath(urlSuffix);
+    requestURL.setQuery(query);
+
+    QNetworkRequest theRequest(requestURL);
+    theRequest.setRawHeader("Authorization", AgaveNetManager::getAuthHeader());
+    theRequest.setPriority(myScheduler->getLaunchPriority());
+    theRequest.setAttribute(scheduledAttribute, true);
+    return theRequest;
+}
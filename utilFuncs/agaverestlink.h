@@ -0,0 +1,197 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef AGAVERESTLINK_H
+#define AGAVERESTLINK_H
+
+#include <QObject>
+#include <QDateTime>
+#include <QUrlQuery>
+#include <QNetworkReply>
+#include <QJsonObject>
+
+class AgaveNetManager;
+class RequestScheduler;
+class FileMetaData;
+class StreamHasher;
+
+/*! \brief The AgaveRestLink sends requests directly to the Agave REST API, for operations that the RemoteDataInterface does not offer.
+ *
+ *  The AgaveRestLink lives in the GUI thread, with its own AgaveNetManager, and reuses the session credentials of the AgaveHandler.
+ *  As such, it can only be used after a successful login. Replies are returned as raw QNetworkReply objects, which the caller owns.
+ *
+ *  Requests should be started through the RequestScheduler of the link, from getScheduler(), rather than sent right away.
+ */
+class AgaveRestLink : public QObject
+{
+    Q_OBJECT
+public:
+    /*! \brief Constructs a new AgaveRestLink for the given Agave tenant.
+     *
+     *  \param tenantURL The base URL of the Agave server, such as https://agave.designsafe-ci.org
+     *  \param storageSystem The name of the storage system used for the remote file system
+     *  \param parent The driver object is typically the parent.
+     */
+    explicit AgaveRestLink(QString tenantURL, QString storageSystem, QObject * parent = nullptr);
+
+    /*! \brief Returns true if the AgaveHandler has established session credentials which this link can use.
+     */
+    bool credentialsAvailable();
+
+    QString getStorageSystem();
+    RequestScheduler * getScheduler();
+    AgaveNetManager * getNetManager();
+
+    /*! \brief Requests made by the AgaveRestLink carry this attribute, so that the AgaveNetManager does not change their priority.
+     */
+    static const QNetworkRequest::Attribute scheduledAttribute = QNetworkRequest::User;
+
+    /*! \brief Sends an authenticated GET request to the Agave server.
+     *
+     *  \param urlSuffix The API path, appended to the tenant URL, such as /files/v2/listings/system/...
+     *  \param query Any query parameters for the request.
+     *
+     *  Returns nullptr if no session credentials are available.
+     */
+    QNetworkReply * sendGet(QString urlSuffix, QUrlQuery query = QUrlQuery());
+
+    /*! \brief Requests one page of the listing of a remote folder.
+     *
+     *  \param remotePath Full path of the remote folder, such as /username/folder
+     *  \param offset The index of the first entry in the page
+     *  \param limit The maximum number of entries in the page
+     */
+    QNetworkReply * requestListingPage(QString remotePath, int offset, int limit);
+
+    /*! \brief Requests the contents of a remote file.
+     *
+     *  \param remotePath Full path of the remote file
+     *  \param rangeStart If greater than zero, only the bytes from this offset onward are requested.
+     *  \param rangeEnd If not negative, the offset of the last byte requested.
+     *
+     *  The reply is not buffered by the caller, and should be read as data arrives.
+     */
+    QNetworkReply * requestFileContents(QString remotePath, qint64 rangeStart = 0, qint64 rangeEnd = -1);
+
+    /*! \brief Requests that a new folder be made on the remote system.
+     *
+     *  \param parentPath Full path of the existing remote folder in which to make the new folder
+     *  \param folderName Name of the new folder
+     */
+    QNetworkReply * requestMakeFolder(QString parentPath, QString folderName);
+
+    /*! \brief Requests an action on a remote file or folder, such as rename, move or copy.
+     *
+     *  \param remotePath Full path of the remote file or folder
+     *  \param action The Agave file action: "rename", "move" or "copy"
+     *  \param actionPath For rename, the new name. For move and copy, the full path of the destination.
+     */
+    QNetworkReply * requestFileAction(QString remotePath, QString action, QString actionPath);
+
+    /*! \brief Requests that a remote file or folder be deleted.
+     */
+    QNetworkReply * requestDelete(QString remotePath);
+
+    /*! \brief Uploads a local file into a remote folder, under the same file name.
+     *
+     *  \param localFile Full path of the local file
+     *  \param remoteFolder Full path of the remote folder
+     *  \param contentHasher If given, receives the bytes of the file as they are sent
+     *
+     *  The file is read from disk as it is sent, and is not held whole in memory. Returns nullptr if the local file cannot be read.
+     */
+    QNetworkReply * requestFileUpload(QString localFile, QString remoteFolder, StreamHasher * contentHasher = nullptr);
+    /*! \brief Uploads the contents of an open device into a remote folder, under the given file name.
+     *
+     *  The device must be open, not sequential, and give its full size. The reply takes ownership of the device, which is read as it is sent.
+     */
+    QNetworkReply * requestStreamUpload(QIODevice * uploadSource, QString fileName, QString remoteFolder);
+
+    /*! \brief Requests one page of the job list of the user, newest first.
+     *
+     *  \param offset The index of the first job in the page
+     *  \param limit The maximum number of jobs in the page
+     *  \param updatedAfter If valid, only jobs updated after this time are listed
+     */
+    QNetworkReply * requestJobList(int offset, int limit, QDateTime updatedAfter = QDateTime());
+
+    /*! \brief Requests the full record of one job, which includes fields, such as the archive path, that the job list leaves out.
+     */
+    QNetworkReply * requestJobDetails(QString jobId);
+
+    /*! \brief Requests an action on a job, such as "stop" or "resubmit".
+     *
+     *  A resubmitted job is a new job, whose record is the result of the reply.
+     */
+    QNetworkReply * requestJobAction(QString jobId, QString action);
+
+    /*! \brief Requests that the record of a job be deleted.
+     */
+    QNetworkReply * requestJobDelete(QString jobId);
+
+    /*! \brief Asks the server to post every status change of a job to a callback URL.
+     *
+     *  The URL may hold Agave template variables, such as ${JOB_ID} and ${JOB_STATUS}, which the server fills in for each event.
+     */
+    QNetworkReply * requestJobNotification(QString jobId, QString callbackUrl);
+    /*! \brief Requests one page of the notification subscriptions of the user.
+     */
+    QNetworkReply * requestNotificationList(int offset, int limit);
+    /*! \brief Requests that a notification subscription be deleted, so that the server stops posting to its URL.
+     */
+    QNetworkReply * requestNotificationDelete(QString notificationId);
+
+    /*! \brief Converts one entry of an Agave file listing into FileMetaData.
+     *
+     *  Returns false if the entry is not a file or folder, or if it is the "." entry of the listed folder.
+     *  FileMetaData holds the size as an int, so files of 2 GB or more need fullSize for their real size.
+     */
+    static bool parseFileEntry(const QJsonObject &rawEntry, FileMetaData * parsedEntry, qint64 * fullSize = nullptr);
+
+    /*! \brief Returns the "result" value of an Agave reply, or an invalid QJsonValue if the reply is not a success.
+     */
+    static QJsonValue getReplyResult(QByteArray rawReply);
+
+protected:
+    QNetworkRequest buildRequest(QString urlSuffix, QUrlQuery query);
+    QString buildSystemPath(QString apiPath, QString remotePath);
+
+    AgaveNetManager * directManager = nullptr;
+    RequestScheduler * myScheduler = nullptr;
+    QString myTenantURL;
+    QString myStorageSystem;
+};
+
+#endif // AGAVERESTLINK_H
@@ -37,6 +37,16 @@
 
 #include "ae_globals.h"
 #include "utilFuncs/authform.h"
+#include "utilFuncs/agavenetmanager.h"
+#include "utilFuncs/agaverestlink.h"
+#include "utilFuncs/requestscheduler.h"
+#include "utilFuncs/remotejobmodel.h"
+#include "utilFuncs/jobsubmitqueue.h"
+#include "utilFuncs/jobpoller.h"
+#include "utilFuncs/jobcallbacklistener.h"
+#include "utilFuncs/joboutputfetcher.h"
+#include "utilFuncs/jobhistorystore.h"
+#include "utilFuncs/contentindex.h"
 #include "remoteFiles/fileoperator.h"
 #include "remoteJobs/joboperator.h"
 
@@ -74,6 +84,34 @@ AgaveSetupDriver::AgaveSetupDriver(int argc, char *argv[], QObject *parent) : QO
         {
             offlineMode = true;
         }
+        if (strcmp(argv[i],"enableHttp2") == 0)
+        {
+            http2Enabled = true;
+        }
+        if (strcmp(argv[i],"noSessionResume") == 0)
+        {
+            sessionCacheEnabled = false;
+        }
+        if (strcmp(argv[i],"dedupeUploads") == 0)
+        {
+            dedupeUploads = true;
+        }
+        if (strncmp(argv[i],"bulkBandwidthKBps=",18) == 0)
+        {
+            bulkBandwidthLimit = QString(argv[i] + 18).toLongLong() * 1024;
+        }
+        if (strncmp(argv[i],"jobCallbackPort=",16) == 0)
+        {
+            jobCallbackPort = QString(argv[i] + 16).toUShort();
+        }
+        if (strncmp(argv[i],"jobCallbackURL=",15) == 0)
+        {
+            jobCallbackURL = QString(argv[i] + 15);
+        }
+        if (strncmp(argv[i],"jobCallbackBind=",16) == 0)
+        {
+            jobCallbackBind = QString(argv[i] + 16);
+        }
     }
     if (offlineMode)
     {
@@ -107,17 +145,56 @@ void AgaveSetupDriver::createAndStartAgaveThread()
 
     remoteInterfacesThread->start();
 
-    theNetManager = new QNetworkAccessManager();
+    QString tenantURL = "https://agave.designsafe-ci.org";
+    QString storageSystem = "designsafe.storage.default";
+
+    TransportMode theMode = http2Enabled ? TransportMode::HTTP2 : TransportMode::HTTP1;
+
+    theNetManager = new AgaveNetManager();
+    theNetManager->setTransportMode(theMode);
+    theNetManager->setSessionCacheEnabled(sessionCacheEnabled);
     theNetManager->moveToThread(remoteInterfacesThread);
 
     myDataInterface = new AgaveHandler(theNetManager);
     myDataInterface->moveToThread(remoteInterfacesThread);
-    myDataInterface->setAgaveConnectionParams("https://agave.designsafe-ci.org", "SimCenter_CWE_GUI", "designsafe.storage.default");
+    myDataInterface->setAgaveConnectionParams(tenantURL, "SimCenter_CWE_GUI", storageSystem);
     QObject::connect(myDataInterface, SIGNAL(connectionStateChanged(RemoteDataInterfaceState)),
                      this, SLOT(newConnectionState(RemoteDataInterfaceState)));
 
     myJobHandle = new JobOperator(myDataInterface, this);
     myFileHandle = new FileOperator(myDataInterface, this);
+
+    myRestLink = new AgaveRestLink(tenantURL, storageSystem, this);
+    myRestLink->getScheduler()->setBulkBandwidthLimit(bulkBandwidthLimit);
+    //Transfers and crawls find their own level of concurrency, interactive requests keep a fixed limit
+    myRestLink->getScheduler()->setAdaptiveLimit(RequestPriority::BULK, 8);
+    myRestLink->getScheduler()->setAdaptiveLimit(RequestPriority::BACKGROUND, 8);
+
+    myJobModel = new RemoteJobModel(this);
+    myJobQueue = new JobSubmitQueue(myJobModel, this);
+    myJobPoller = new JobPoller(myJobModel, this);
+    QObject::connect(theNetManager, SIGNAL(credentialsAvailable()), myJobPoller, SLOT(credentialsAvailable()));
+    myOutputFetcher = new JobOutputFetcher(myJobModel, this);
+    myJobHistory = new JobHistoryStore(myJobModel, this);
+    if (dedupeUploads)
+    {
+        myContentIndex = new ContentIndex(this);
+    }
+    if (jobCallbackPort != 0)
+    {
+        myCallbackListener = new JobCallbackListener(this);
+        if (myCallbackListener->startListening(jobCallbackPort, jobCallbackURL, jobCallbackBind))
+        {
+            QObject::connect(myCallbackListener, SIGNAL(jobStatusPushed(QString,QString)),
+                             myJobPoller, SLOT(jobStatusPushed(QString,QString)));
+            QObject::connect(myJobModel, SIGNAL(jobListRefreshed(RequestState)),
+                             myCallbackListener, SLOT(jobListRefreshed(RequestState)));
+            myJobQueue->setCallbackListener(myCallbackListener);
+            myJobPoller->setPushActive(true);
+        }
+    }
+    myRestLink->getNetManager()->setTransportMode(theMode);
+    myRestLink->getNetManager()->setSessionCacheEnabled(sessionCacheEnabled);
 }
 
 void AgaveSetupDriver::setDebugLogging(bool loggingEnabled)
@@ -169,6 +246,41 @@ FileOperator * AgaveSetupDriver::getFileHandler()
     return myFileHandle;
 }
 
+AgaveRestLink * AgaveSetupDriver::getRestLink()
+{
+    return myRestLink;
+}
+
+RemoteJobModel * AgaveSetupDriver::getJobModel()
+{
+    return myJobModel;
+}
+
+JobSubmitQueue * AgaveSetupDriver::getJobQueue()
+{
+    return myJobQueue;
+}
+
+JobPoller * AgaveSetupDriver::getJobPoller()
+{
+    return myJobPoller;
+}
+
+JobOutputFetcher * AgaveSetupDriver::getOutputFetcher()
+{
+    return myOutputFetcher;
+}
+
+JobHistoryStore * AgaveSetupDriver::getJobHistory()
+{
+    return myJobHistory;
+}
+
+ContentIndex * AgaveSetupDriver::getContentIndex()
+{
+    return myContentIndex;
+}
+
 void AgaveSetupDriver::getAuthReply(RequestState authReply)
 {
     if ((authReply == RequestState::GOOD) && (authWindow != nullptr) && (authWindow->isVisible()))
@@ -223,8 +335,32 @@ void AgaveSetupDriver::shutdown()
     return;
 }
 
+void AgaveSetupDriver::logout()
+{
+    AgaveNetManager::clearSavedSessions();
+    shutdown();
+}
+
+void AgaveSetupDriver::logNetworkMetrics()
+{
+    if (theNetManager != nullptr)
+    {
+        qCDebug(agaveAppLayer, "Agave handler requests coalesced: %d of %d (%.1f%%)", theNetManager->getCoalescedCount(),
+                theNetManager->getCoalescableCount(), theNetManager->getCoalescingHitRate() * 100.0);
+        qCDebug(agaveAppLayer, "Agave handler transport: %s", qPrintable(theNetManager->getTransportMetrics().toString()));
+    }
+    if (myRestLink != nullptr)
+    {
+        AgaveNetManager * directManager = myRestLink->getNetManager();
+        qCDebug(agaveAppLayer, "Direct requests coalesced: %d of %d (%.1f%%)", directManager->getCoalescedCount(),
+                directManager->getCoalescableCount(), directManager->getCoalescingHitRate() * 100.0);
+        qCDebug(agaveAppLayer, "Direct request transport: %s", qPrintable(directManager->getTransportMetrics().toString()));
+    }
+}
+
 void AgaveSetupDriver::shutdownCallback()
 {
+    logNetworkMetrics();
     qCDebug(agaveAppLayer, "Invoking final exit");
     QCoreApplication::instance()->exit(0);
 }
@@ -49,6 +49,15 @@ class AgaveHandler;
 class AuthForm;
 class JobOperator;
 class FileOperator;
+class AgaveRestLink;
+class RemoteJobModel;
+class JobSubmitQueue;
+class JobPoller;
+class JobCallbackListener;
+class JobOutputFetcher;
+class JobHistoryStore;
+class ContentIndex;
+class AgaveNetManager;
 
 /*! \brief The AgaveSetupDriver in an astract class for a driver object for certain SimCenter programs that invoke Agave.
  *
@@ -91,6 +100,13 @@ public:
     RemoteDataInterface *getDataConnection();
     JobOperator * getJobHandler();
     FileOperator * getFileHandler();
+    AgaveRestLink * getRestLink();
+    RemoteJobModel * getJobModel();
+    JobSubmitQueue * getJobQueue();
+    JobPoller * getJobPoller();
+    JobOutputFetcher * getOutputFetcher();
+    JobHistoryStore * getJobHistory();
+    ContentIndex * getContentIndex();
 
     virtual QString getBanner() = 0;
     virtual QString getVersion() = 0;
@@ -106,13 +122,19 @@ private slots:
     void newConnectionState(RemoteDataInterfaceState newState);
     void shutdownCallback();
 
+private:
+    void logNetworkMetrics();
+
 public slots:
     void shutdown();
+    /*! \brief Forgets the saved TLS sessions of this user, then shuts down.
+     */
+    void logout();
 
 protected:
     virtual void closeAuthScreen() = 0;
 
-    QNetworkAccessManager * theNetManager = nullptr;
+    AgaveNetManager * theNetManager = nullptr;
     QThread * remoteInterfacesThread = nullptr;
 
     AuthForm * authWindow = nullptr;
@@ -120,11 +142,26 @@ protected:
     AgaveHandler * myDataInterface = nullptr;
     JobOperator * myJobHandle = nullptr;
     FileOperator * myFileHandle = nullptr;
+    AgaveRestLink * myRestLink = nullptr;
+    RemoteJobModel * myJobModel = nullptr;
+    JobSubmitQueue * myJobQueue = nullptr;
+    JobPoller * myJobPoller = nullptr;
+    JobCallbackListener * myCallbackListener = nullptr;
+    JobOutputFetcher * myOutputFetcher = nullptr;
+    JobHistoryStore * myJobHistory = nullptr;
+    ContentIndex * myContentIndex = nullptr;
 
     static QStringList enabledDebugs;
     bool shutdownStarted = false;
     bool debugLoggingEnabled = false;
     bool offlineMode = false;
+    qint64 bulkBandwidthLimit = 0;
+    bool http2Enabled = false;
+    bool sessionCacheEnabled = true;
+    bool dedupeUploads = false;
+    quint16 jobCallbackPort = 0;
+    QString jobCallbackURL;
+    QString jobCallbackBind;
 };
 
 #endif // AGAVESETUPDRIVER_H
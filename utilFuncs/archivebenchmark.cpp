@@ -0,0 +1,285 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "archivebenchmark.h"
+
+#include "agavenetmanager.h"
+#include "rangeddownload.h"
+#include "tarextractor.h"
+#include "remotedatainterface.h"
+
+#include <QCoreApplication>
+#include <QNetworkReply>
+#include <QTemporaryDir>
+#include <QFile>
+#include <QDir>
+#include <QUrl>
+
+ArchiveBenchmark * ArchiveBenchmark::createFromArgs(int argc, char *argv[])
+{
+    QString fileTemplate;
+    QString archiveTemplate;
+    int maxCount = 256;
+    int compressOverheadMs = 0;
+
+    for (int i = 0; i < argc; i++)
+    {
+        if (strncmp(argv[i],"archiveBenchmark=",17) == 0)
+        {
+            fileTemplate = QString(argv[i] + 17);
+        }
+        if (strncmp(argv[i],"archiveBenchmarkTar=",20) == 0)
+        {
+            archiveTemplate = QString(argv[i] + 20);
+        }
+        if (strncmp(argv[i],"benchmarkCount=",15) == 0)
+        {
+            maxCount = QString(argv[i] + 15).toInt();
+        }
+        if (strncmp(argv[i],"compressOverheadMs=",19) == 0)
+        {
+            compressOverheadMs = QString(argv[i] + 19).toInt();
+        }
+    }
+
+    if (fileTemplate.isEmpty() || archiveTemplate.isEmpty() || (maxCount < 1)) return nullptr;
+    return new ArchiveBenchmark(fileTemplate, archiveTemplate, maxCount, compressOverheadMs);
+}
+
+ArchiveBenchmark::ArchiveBenchmark(QString fileTemplate, QString archiveTemplate, int maxCount, int compressOverheadMs, QObject * parent) : QObject(parent)
+{
+    myFileTemplate = fileTemplate;
+    myArchiveTemplate = archiveTemplate;
+    myMaxCount = maxCount;
+    myCompressOverheadMs = qMax(0, compressOverheadMs);
+}
+
+void ArchiveBenchmark::startBenchmark()
+{
+    qInfo("Archive benchmark: up to %d files from %s, archives from %s, %d ms packing overhead",
+          myMaxCount, qPrintable(myFileTemplate), qPrintable(myArchiveTemplate), myCompressOverheadMs);
+
+    benchmarkManager = new AgaveNetManager(this);
+    QObject::connect(benchmarkManager, SIGNAL(sslErrors(QNetworkReply*,QList<QSslError>)),
+                     this, SLOT(ignoreSslErrors(QNetworkReply*,QList<QSslError>)));
+
+    currentCount = 1;
+    runPerFile();
+}
+
+void ArchiveBenchmark::runPerFile()
+{
+    delete workFolder;
+    workFolder = new QTemporaryDir();
+
+    nextFile = 0;
+    filesLeft = currentCount;
+    modeErrors = 0;
+    modeTimer.start();
+
+    for (int i = 0; i < filesInFlight; i++)
+    {
+        sendNextFile();
+    }
+}
+
+void ArchiveBenchmark::sendNextFile()
+{
+    if (nextFile >= currentCount) return;
+
+    QNetworkReply * theReply = benchmarkManager->get(QNetworkRequest(QUrl(myFileTemplate.arg(nextFile))));
+    theReply->setProperty("fileNum", nextFile);
+    QObject::connect(theReply, SIGNAL(finished()), this, SLOT(fileReplyDone()));
+    nextFile++;
+}
+
+void ArchiveBenchmark::fileReplyDone()
+{
+    QNetworkReply * theReply = qobject_cast<QNetworkReply *>(sender());
+    if (theReply == nullptr) return;
+
+    QFile localFile(QDir(workFolder->path()).absoluteFilePath(QString("file%1").arg(theReply->property("fileNum").toInt())));
+    if ((theReply->error() != QNetworkReply::NoError) || !localFile.open(QIODevice::WriteOnly))
+    {
+        modeErrors++;
+    }
+    else
+    {
+        localFile.write(theReply->readAll());
+    }
+    theReply->deleteLater();
+
+    filesLeft--;
+    if (filesLeft > 0)
+    {
+        sendNextFile();
+        return;
+    }
+
+    perFileMs = modeTimer.elapsed();
+    perFileErrors = modeErrors;
+    runArchive();
+}
+
+void ArchiveBenchmark::runArchive()
+{
+    delete workFolder;
+    workFolder = new QTemporaryDir();
+
+    modeErrors = 0;
+    modeTimer.start();
+
+    //The size is needed to split the archive into ranges
+    QNetworkRequest sizeRequest(QUrl(myArchiveTemplate.arg(currentCount)));
+    QNetworkReply * theReply = benchmarkManager->head(sizeRequest);
+    QObject::connect(theReply, SIGNAL(finished()), this, SLOT(archiveSizeReplied()));
+}
+
+void ArchiveBenchmark::archiveSizeReplied()
+{
+    QNetworkReply * theReply = qobject_cast<QNetworkReply *>(sender());
+    if (theReply == nullptr) return;
+    theReply->deleteLater();
+
+    qint64 archiveSize = theReply->header(QNetworkRequest::ContentLengthHeader).toLongLong();
+    if ((theReply->error() != QNetworkReply::NoError) || (archiveSize <= 0))
+    {
+        modeErrors++;
+        finishCount();
+        return;
+    }
+
+    QString localArchive = QDir(workFolder->path()).absoluteFilePath("archive.partial");
+    QDir().mkpath(QDir(workFolder->path()).absoluteFilePath("unpacked"));
+
+    archiveExtractor = new TarExtractor(localArchive, QDir(workFolder->path()).absoluteFilePath("unpacked"), this);
+    QObject::connect(archiveExtractor, SIGNAL(extractionDone(bool,int,QString)), this, SLOT(archiveExtracted(bool,int,QString)));
+
+    RangedDownload * theDownload = new RangedDownload(QString(), localArchive, archiveSize, this);
+    theDownload->setDirectSource(benchmarkManager, theReply->url());
+    QObject::connect(theDownload, SIGNAL(contiguousBytesChanged(qint64)), this, SLOT(archiveBytesReady(qint64)));
+    QObject::connect(theDownload, SIGNAL(downloadDone(RequestState,QString,qint64)), this, SLOT(archiveDownloaded(RequestState,QString,qint64)));
+    if (!theDownload->startDownload())
+    {
+        theDownload->deleteLater();
+        modeErrors++;
+        archiveExtractor->disconnect(this);
+        archiveExtractor->deleteLater();
+        archiveExtractor = nullptr;
+        finishCount();
+    }
+}
+
+void ArchiveBenchmark::archiveBytesReady(qint64 contiguousBytes)
+{
+    if (archiveExtractor == nullptr) return;
+    archiveExtractor->dataAvailable(contiguousBytes);
+}
+
+void ArchiveBenchmark::archiveDownloaded(RequestState finalState, QString, qint64 bytesWritten)
+{
+    if (archiveExtractor == nullptr) return;
+    if (finalState != RequestState::GOOD)
+    {
+        archiveExtractor->cancelExtraction();
+        return;
+    }
+    archiveExtractor->finishData(bytesWritten);
+}
+
+void ArchiveBenchmark::archiveExtracted(bool success, int filesWritten, QString errorText)
+{
+    if (!success)
+    {
+        qInfo("Archive of %d files failed: %s", currentCount, qPrintable(errorText));
+        modeErrors++;
+    }
+    else if (filesWritten != currentCount)
+    {
+        qInfo("Archive of %d files held %d files", currentCount, filesWritten);
+    }
+
+    archiveExtractor->disconnect(this);
+    archiveExtractor->deleteLater();
+    archiveExtractor = nullptr;
+    finishCount();
+}
+
+void ArchiveBenchmark::ignoreSslErrors(QNetworkReply * theReply, const QList<QSslError> &)
+{
+    theReply->ignoreSslErrors();
+}
+
+void ArchiveBenchmark::finishCount()
+{
+    qint64 archiveMs = modeTimer.elapsed() + myCompressOverheadMs;
+
+    results.append(QString("%1 files: per file %2 ms (%3 errors), archive %4 ms (%5 errors)").arg(currentCount, 6)
+                   .arg(perFileMs, 8).arg(perFileErrors).arg(archiveMs, 8).arg(modeErrors));
+
+    if ((crossoverCount < 0) && (modeErrors == 0) && (archiveMs < perFileMs))
+    {
+        crossoverCount = currentCount;
+    }
+
+    if (currentCount < myMaxCount)
+    {
+        currentCount = qMin(currentCount * 2, myMaxCount);
+        runPerFile();
+        return;
+    }
+
+    printResults();
+}
+
+void ArchiveBenchmark::printResults()
+{
+    delete workFolder;
+    workFolder = nullptr;
+
+    for (const QString &aResult : results)
+    {
+        qInfo("%s", qPrintable(aResult));
+    }
+    if (crossoverCount < 0)
+    {
+        qInfo("Archive download was not faster at any count up to %d files", myMaxCount);
+    }
+    else
+    {
+        qInfo("Archive download is faster from %d files", crossoverCount);
+    }
+    QCoreApplication::instance()->exit(0);
+}
@@ -0,0 +1,112 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef ARCHIVEBENCHMARK_H
+#define ARCHIVEBENCHMARK_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QList>
+
+class QNetworkReply;
+class QSslError;
+class QTemporaryDir;
+class AgaveNetManager;
+class TarExtractor;
+enum class RequestState;
+
+/*! \brief The ArchiveBenchmark compares downloading a folder one file at a time against downloading it as one archive, and finds the number of files at which the archive becomes faster.
+ *
+ *  The benchmark is run from the command line, instead of the normal program, with:
+ *
+ *  AgaveExplorer archiveBenchmark=https://localhost:8443/small/file%1.txt archiveBenchmarkTar=https://localhost:8443/packed/first%1.tgz benchmarkCount=1024 compressOverheadMs=15000
+ *
+ *  For each count of files, doubling from 1 to benchmarkCount, files 0 to count - 1 are fetched from the first template, six at a time, and written to disk.
+ *  Then the archive for that count, a tar or gzipped tar of the same files, is fetched from the second template with a RangedDownload and unpacked with a TarExtractor.
+ *  The compressOverheadMs, which defaults to 0, is added to each archive time, to stand for the time the compress job takes on the server.
+ *
+ *  The server should be a local stand-in for the Agave server which honors Range headers. Certificate errors are ignored. The results are printed when all counts are done.
+ */
+class ArchiveBenchmark : public QObject
+{
+    Q_OBJECT
+public:
+    /*! \brief Returns a new ArchiveBenchmark if the command line asks for one, or nullptr otherwise.
+     */
+    static ArchiveBenchmark * createFromArgs(int argc, char *argv[]);
+
+    void startBenchmark();
+
+    static const int filesInFlight = 6;
+
+private slots:
+    void fileReplyDone();
+    void archiveSizeReplied();
+    void archiveBytesReady(qint64 contiguousBytes);
+    void archiveDownloaded(RequestState finalState, QString localPath, qint64 bytesWritten);
+    void archiveExtracted(bool success, int filesWritten, QString errorText);
+    void ignoreSslErrors(QNetworkReply * theReply, const QList<QSslError> &errors);
+
+private:
+    explicit ArchiveBenchmark(QString fileTemplate, QString archiveTemplate, int maxCount, int compressOverheadMs, QObject * parent = nullptr);
+
+    void runPerFile();
+    void sendNextFile();
+    void runArchive();
+    void finishCount();
+    void printResults();
+
+    QString myFileTemplate;
+    QString myArchiveTemplate;
+    int myMaxCount;
+    int myCompressOverheadMs;
+
+    AgaveNetManager * benchmarkManager = nullptr;
+    QTemporaryDir * workFolder = nullptr;
+    TarExtractor * archiveExtractor = nullptr;
+    QElapsedTimer modeTimer;
+
+    int currentCount = 0;
+    int nextFile = 0;
+    int filesLeft = 0;
+    int modeErrors = 0;
+    qint64 perFileMs = 0;
+    int perFileErrors = 0;
+
+    QList<QString> results;
+    int crossoverCount = -1;
+};
+
+#endif // ARCHIVEBENCHMARK_H
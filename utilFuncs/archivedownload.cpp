@@ -0,0 +1,297 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "archivedownload.h"
+
+#include "jobworkflow.h"
+#include "rangeddownload.h"
+#include "tarextractor.h"
+#include "pagedfolderlister.h"
+#include "agaverestlink.h"
+#include "requestscheduler.h"
+#include "remotedatainterface.h"
+#include "ae_globals.h"
+
+#include <QNetworkReply>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QFile>
+#include <QDir>
+
+ArchiveDownload::ArchiveDownload(QString remoteFolder, QString localDest, QObject * parent) : QObject(parent)
+{
+    myRemoteFolder = remoteFolder;
+    while (myRemoteFolder.endsWith('/') && (myRemoteFolder.size() > 1))
+    {
+        myRemoteFolder.chop(1);
+    }
+    myLocalDest = localDest;
+}
+
+ArchiveDownload::~ArchiveDownload()
+{
+    if (!archiveFetch.isNull())
+    {
+        archiveFetch->disconnect(this);
+        archiveFetch->cancelDownload();
+    }
+}
+
+bool ArchiveDownload::startTransfer()
+{
+    if (transferStarted) return false;
+
+    AgaveRestLink * theLink = ae_globals::get_rest_link();
+    if ((theLink == nullptr) || (!theLink->credentialsAvailable())) return false;
+
+    if (!QDir().mkpath(myLocalDest))
+    {
+        qCDebug(agaveAppLayer, "Unable to make download destination: %s", qPrintable(myLocalDest));
+        return false;
+    }
+
+    QJsonObject compressInputs;
+    compressInputs.insert("compression_type", "tgz");
+    QJsonObject compressStep;
+    compressStep.insert("name", "compress");
+    compressStep.insert("app", "compress");
+    compressStep.insert("workingDir", myRemoteFolder);
+    compressStep.insert("inputs", compressInputs);
+    QJsonObject workflowObject;
+    workflowObject.insert("steps", QJsonArray({compressStep}));
+
+    compressWorkflow = new JobWorkflow(ae_globals::get_job_model(), this);
+    QString errorText;
+    if (!compressWorkflow->loadJSON(QJsonDocument(workflowObject).toJson(), &errorText) || !compressWorkflow->startWorkflow())
+    {
+        qCDebug(agaveAppLayer, "Unable to start compress job: %s", qPrintable(errorText));
+        compressWorkflow->deleteLater();
+        compressWorkflow = nullptr;
+        return false;
+    }
+
+    QObject::connect(compressWorkflow, SIGNAL(stepChanged(QString)), this, SLOT(compressStepChanged(QString)));
+    QObject::connect(compressWorkflow, SIGNAL(workflowDone(RequestState)), this, SLOT(compressDone(RequestState)));
+    transferStarted = true;
+    emit archiveProgress(QString("Packing %1 on the server . . .").arg(myRemoteFolder));
+    return true;
+}
+
+void ArchiveDownload::cancelTransfer()
+{
+    finishTransfer(RequestState::EXPLICIT_ERROR, "Archive download cancelled");
+}
+
+QString ArchiveDownload::getRemoteFolder()
+{
+    return myRemoteFolder;
+}
+
+QString ArchiveDownload::getLocalDest()
+{
+    return myLocalDest;
+}
+
+void ArchiveDownload::compressStepChanged(QString stepName)
+{
+    if (transferFinished || (compressWorkflow == nullptr)) return;
+    emit archiveProgress(QString("Packing %1 on the server: %2").arg(myRemoteFolder, compressWorkflow->getStepMessage(stepName)));
+}
+
+void ArchiveDownload::compressDone(RequestState finalState)
+{
+    if (transferFinished) return;
+
+    QString outputFolder = compressWorkflow->getStepOutputPath("compress");
+    if ((finalState != RequestState::GOOD) || outputFolder.isEmpty())
+    {
+        finishTransfer(RequestState::EXPLICIT_ERROR, QString("Unable to pack %1: %2").arg(myRemoteFolder, compressWorkflow->getStepMessage("compress")));
+        return;
+    }
+
+    PagedFolderLister * theLister = new PagedFolderLister(outputFolder, this);
+    theLister->setPriority(RequestPriority::BULK);
+    QObject::connect(theLister, SIGNAL(listingDone(RequestState,QString,QList<FileMetaData>,FileSizeMap)),
+                     this, SLOT(archiveListed(RequestState,QString,QList<FileMetaData>,FileSizeMap)));
+    if (!theLister->startListing())
+    {
+        theLister->deleteLater();
+        finishTransfer(RequestState::NO_CONNECT, "Unable to list the packed archive");
+    }
+}
+
+void ArchiveDownload::archiveListed(RequestState finalState, QString, QList<FileMetaData> allEntries, FileSizeMap fileSizes)
+{
+    if (transferFinished) return;
+    if (finalState != RequestState::GOOD)
+    {
+        finishTransfer(finalState, "Unable to list the packed archive");
+        return;
+    }
+
+    //The job folder also holds the job's logs, so the archive is the largest archive file there
+    remoteArchive.clear();
+    archiveSize = -1;
+    for (const FileMetaData &anEntry : allEntries)
+    {
+        if (anEntry.getFileType() != FileType::FILE) continue;
+        if (!isArchiveName(anEntry.getFullPath().section('/', -1))) continue;
+        qint64 entrySize = fileSizes.value(anEntry.getFullPath(), -1);
+        if (entrySize <= archiveSize) continue;
+
+        remoteArchive = anEntry.getFullPath();
+        archiveSize = entrySize;
+    }
+
+    if (remoteArchive.isEmpty())
+    {
+        finishTransfer(RequestState::EXPLICIT_ERROR, "The compress job did not produce an archive");
+        return;
+    }
+
+    localArchive = QDir(myLocalDest).absoluteFilePath(QString(".%1.partial").arg(remoteArchive.section('/', -1)));
+    RangedDownload * theDownload = new RangedDownload(remoteArchive, localArchive, archiveSize, this);
+    AgaveRestLink * theLink = ae_globals::get_rest_link();
+    if (theLink != nullptr)
+    {
+        theDownload->setRangeCount(theLink->getScheduler()->getClassMaxLimit(RequestPriority::BULK));
+    }
+
+    archiveExtractor = new TarExtractor(localArchive, myLocalDest, this);
+    QObject::connect(archiveExtractor, SIGNAL(extractionProgress(int)), this, SLOT(extractionProgress(int)));
+    QObject::connect(archiveExtractor, SIGNAL(extractionDone(bool,int,QString)), this, SLOT(extractionDone(bool,int,QString)));
+
+    QObject::connect(theDownload, SIGNAL(contiguousBytesChanged(qint64)), this, SLOT(archiveBytesReady(qint64)));
+    QObject::connect(theDownload, SIGNAL(downloadDone(RequestState,QString,qint64)), this, SLOT(archiveDownloaded(RequestState,QString,qint64)));
+    if (!theDownload->startDownload())
+    {
+        theDownload->deleteLater();
+        finishTransfer(RequestState::EXPLICIT_ERROR, "Unable to write the archive to the local folder");
+        return;
+    }
+    archiveFetch = theDownload;
+    emit archiveProgress(QString("Downloading %1 (%2 bytes) . . .").arg(remoteArchive).arg(archiveSize));
+}
+
+void ArchiveDownload::archiveBytesReady(qint64 contiguousBytes)
+{
+    if (transferFinished) return;
+    archiveExtractor->dataAvailable(contiguousBytes);
+}
+
+void ArchiveDownload::archiveDownloaded(RequestState finalState, QString, qint64 bytesWritten)
+{
+    if (transferFinished) return;
+    if (finalState != RequestState::GOOD)
+    {
+        finishTransfer(finalState, QString("Download of %1 failed").arg(remoteArchive));
+        return;
+    }
+
+    downloadComplete = true;
+    archiveExtractor->finishData(bytesWritten);
+    emit archiveProgress(QString("Unpacking into %1: %2 files . . .").arg(myLocalDest).arg(archiveExtractor->getFilesWritten()));
+}
+
+void ArchiveDownload::extractionProgress(int filesWritten)
+{
+    if (transferFinished || !downloadComplete) return;
+    emit archiveProgress(QString("Unpacking into %1: %2 files . . .").arg(myLocalDest).arg(filesWritten));
+}
+
+void ArchiveDownload::extractionDone(bool success, int filesWritten, QString errorText)
+{
+    if (transferFinished) return;
+    if (!success)
+    {
+        qCDebug(agaveAppLayer, "Unable to unpack %s: %s", qPrintable(remoteArchive), qPrintable(errorText));
+        finishTransfer(RequestState::EXPLICIT_ERROR, QString("Unable to unpack the archive: %1").arg(errorText));
+        return;
+    }
+    finishTransfer(RequestState::GOOD, QString("Downloaded %1 files into %2").arg(filesWritten).arg(myLocalDest));
+}
+
+bool ArchiveDownload::isArchiveName(QString fileName)
+{
+    return fileName.endsWith(".tgz") || fileName.endsWith(".tar.gz") || fileName.endsWith(".tar");
+}
+
+void ArchiveDownload::deleteRemoteArchive()
+{
+    AgaveRestLink * theLink = ae_globals::get_rest_link();
+    if ((theLink == nullptr) || remoteArchive.isEmpty()) return;
+
+    //The delete outlives this object, so the rest link owns it
+    QString archivePath = remoteArchive;
+    theLink->getScheduler()->scheduleRequest(RequestPriority::BACKGROUND, theLink, [theLink, archivePath]()
+    {
+        QNetworkReply * theReply = theLink->requestDelete(archivePath);
+        if (theReply == nullptr) return theReply;
+        QObject::connect(theReply, SIGNAL(finished()), theReply, SLOT(deleteLater()));
+        return theReply;
+    });
+}
+
+void ArchiveDownload::finishTransfer(RequestState finalState, QString message)
+{
+    if (transferFinished) return;
+    transferFinished = true;
+
+    if (compressWorkflow != nullptr)
+    {
+        compressWorkflow->disconnect(this);
+        if (compressWorkflow->isRunning()) compressWorkflow->cancelWorkflow();
+    }
+    if (!archiveFetch.isNull())
+    {
+        archiveFetch->disconnect(this);
+        archiveFetch->cancelDownload();
+    }
+    int filesWritten = 0;
+    if (archiveExtractor != nullptr)
+    {
+        archiveExtractor->disconnect(this);
+        filesWritten = archiveExtractor->getFilesWritten();
+        archiveExtractor->cancelExtraction();
+    }
+
+    if (!localArchive.isEmpty()) QFile::remove(localArchive);
+    deleteRemoteArchive();
+
+    emit archiveProgress(message);
+    emit transferDone(finalState, filesWritten, (finalState == RequestState::GOOD) ? 0 : 1);
+    this->deleteLater();
+}
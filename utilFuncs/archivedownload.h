@@ -0,0 +1,114 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef ARCHIVEDOWNLOAD_H
+#define ARCHIVEDOWNLOAD_H
+
+#include <QObject>
+#include <QPointer>
+
+#include "filemetadata.h"
+#include "pagedfolderlister.h"
+
+class JobWorkflow;
+class RangedDownload;
+class TarExtractor;
+enum class RequestState;
+
+/*! \brief The ArchiveDownload copies a remote folder to a local folder as a single archive, instead of one request per file.
+ *
+ *  The remote folder is packed by a job of the "compress" app, and the archive is found in the archive folder of that job.
+ *  The archive is fetched with a RangedDownload, and a TarExtractor unpacks it into the local folder while it downloads.
+ *  Once the folder is unpacked, the local archive is removed, and the remote archive is deleted.
+ *
+ *  This pays for one job, rather than a round trip per file, so it is faster for folders of many small files, and slower for folders of a few files.
+ *
+ *  The transferDone() signal matches that of a BulkTransfer. The ArchiveDownload deletes itself after emitting transferDone().
+ */
+class ArchiveDownload : public QObject
+{
+    Q_OBJECT
+public:
+    /*! \brief Constructs a new ArchiveDownload.
+     *
+     *  \param remoteFolder Full path of the remote folder
+     *  \param localDest Full path of the local folder, into which the contents of the remote folder are written. It is made if it does not exist.
+     *  \param parent The object requesting the download is typically the parent
+     */
+    explicit ArchiveDownload(QString remoteFolder, QString localDest, QObject * parent = nullptr);
+    ~ArchiveDownload();
+
+    /*! \brief Begins the download by submitting the compress job. Returns false if the job cannot be submitted, or the local folder cannot be made.
+     */
+    bool startTransfer();
+    void cancelTransfer();
+
+    QString getRemoteFolder();
+    QString getLocalDest();
+
+signals:
+    void archiveProgress(QString message);
+    void transferDone(RequestState finalState, int filesDone, int filesFailed);
+
+private slots:
+    void compressStepChanged(QString stepName);
+    void compressDone(RequestState finalState);
+    void archiveListed(RequestState finalState, QString folderPath, QList<FileMetaData> allEntries, FileSizeMap fileSizes);
+    void archiveBytesReady(qint64 contiguousBytes);
+    void archiveDownloaded(RequestState finalState, QString localPath, qint64 bytesWritten);
+    void extractionProgress(int filesWritten);
+    void extractionDone(bool success, int filesWritten, QString errorText);
+
+private:
+    static bool isArchiveName(QString fileName);
+    void deleteRemoteArchive();
+    void finishTransfer(RequestState finalState, QString message);
+
+    QString myRemoteFolder;
+    QString myLocalDest;
+
+    JobWorkflow * compressWorkflow = nullptr;
+    QPointer<RangedDownload> archiveFetch;
+    TarExtractor * archiveExtractor = nullptr;
+
+    QString remoteArchive;
+    QString localArchive;
+    qint64 archiveSize = 0;
+    bool transferStarted = false;
+    bool downloadComplete = false;
+    bool transferFinished = false;
+};
+
+#endif // ARCHIVEDOWNLOAD_H
@@ -0,0 +1,262 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "archiveupload.h"
+
+#include "tarstreamreader.h"
+#include "jobworkflow.h"
+#include "agaverestlink.h"
+#include "requestscheduler.h"
+#include "remotedatainterface.h"
+#include "ae_globals.h"
+
+#include <QNetworkReply>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QTimer>
+#include <QDir>
+
+ArchiveUpload::ArchiveUpload(QString localFolder, QString remoteDest, QObject * parent) : QObject(parent)
+{
+    myLocalFolder = QDir::cleanPath(localFolder);
+    myRemoteDest = remoteDest;
+    while (myRemoteDest.endsWith('/') && (myRemoteDest.size() > 1))
+    {
+        myRemoteDest.chop(1);
+    }
+}
+
+ArchiveUpload::~ArchiveUpload()
+{
+    if (uploadReply != nullptr)
+    {
+        uploadReply->disconnect(this);
+        uploadReply->abort();
+        uploadReply->deleteLater();
+    }
+}
+
+bool ArchiveUpload::startTransfer()
+{
+    if (transferStarted) return false;
+
+    AgaveRestLink * theLink = ae_globals::get_rest_link();
+    if ((theLink == nullptr) || (!theLink->credentialsAvailable())) return false;
+
+    QFileInfo folderInfo(myLocalFolder);
+    if (!folderInfo.isDir()) return false;
+
+    //The name is unique to this upload, so that it does not replace a file the user has
+    archiveName = QString("%1-upload-%2.tar").arg(folderInfo.fileName()).arg(QDateTime::currentMSecsSinceEpoch());
+    transferStarted = true;
+    theLink->getScheduler()->scheduleRequest(RequestPriority::BULK, this, [this]() { return sendUpload(); });
+    emit archiveProgress(QString("Packing %1 for upload . . .").arg(myLocalFolder));
+    return true;
+}
+
+void ArchiveUpload::cancelTransfer()
+{
+    finishTransfer(RequestState::EXPLICIT_ERROR, "Archive upload cancelled");
+}
+
+QString ArchiveUpload::getLocalFolder()
+{
+    return myLocalFolder;
+}
+
+QString ArchiveUpload::getRemoteDest()
+{
+    return myRemoteDest;
+}
+
+QNetworkReply * ArchiveUpload::sendUpload()
+{
+    if (transferFinished) return nullptr;
+
+    TarStreamReader * theReader = new TarStreamReader(myLocalFolder);
+    if (!theReader->open(QIODevice::ReadOnly))
+    {
+        delete theReader;
+        finishTransfer(RequestState::EXPLICIT_ERROR, QString("Unable to read %1").arg(myLocalFolder));
+        return nullptr;
+    }
+    fileCount = theReader->getFileCount();
+    uploadSource = theReader;
+
+    uploadAttempts++;
+    uploadReply = ae_globals::get_rest_link()->requestStreamUpload(theReader, archiveName, myRemoteDest);
+    if (uploadReply == nullptr)
+    {
+        finishTransfer(RequestState::NO_CONNECT, "Unable to start the archive upload");
+        return nullptr;
+    }
+
+    QObject::connect(uploadReply, SIGNAL(uploadProgress(qint64,qint64)), this, SLOT(uploadProgress(qint64,qint64)));
+    QObject::connect(uploadReply, SIGNAL(finished()), this, SLOT(uploadDone()));
+    return uploadReply;
+}
+
+void ArchiveUpload::uploadProgress(qint64 bytesSent, qint64 bytesTotal)
+{
+    if (transferFinished || (bytesTotal <= 0)) return;
+    emit archiveProgress(QString("Uploading %1 files from %2: %3% . . .").arg(fileCount).arg(myLocalFolder).arg(bytesSent * 100 / bytesTotal));
+}
+
+void ArchiveUpload::uploadDone()
+{
+    QNetworkReply * theReply = uploadReply;
+    if (transferFinished || (theReply == nullptr) || (sender() != theReply)) return;
+    uploadReply = nullptr;
+    theReply->disconnect(this);
+    theReply->deleteLater();
+
+    //The reader goes with the reply, so what it found must be taken now
+    QStringList failedFiles;
+    if (!uploadSource.isNull()) failedFiles = uploadSource->getFailedFiles();
+
+    if (theReply->error() != QNetworkReply::NoError)
+    {
+        qCDebug(agaveAppLayer, "Archive upload of %s failed: %s", qPrintable(myLocalFolder), qPrintable(theReply->errorString()));
+        RetryHint failureHint = RequestRetry::classifyReply(theReply);
+        if (!failureHint.retryable || (uploadAttempts >= RequestRetry::maxAttempts))
+        {
+            finishTransfer(RequestState::NO_CONNECT, QString("Unable to upload %1").arg(myLocalFolder));
+            return;
+        }
+
+        QTimer::singleShot(RequestRetry::backoffDelayMs(uploadAttempts, failureHint), this, [this]()
+        {
+            if (transferFinished) return;
+            ae_globals::get_rest_link()->getScheduler()->scheduleRequest(RequestPriority::BULK, this, [this]() { return sendUpload(); });
+        });
+        return;
+    }
+
+    archiveUploaded = true;
+    if (!failedFiles.isEmpty())
+    {
+        qCDebug(agaveAppLayer, "Files changed while packing %s, first: %s", qPrintable(myLocalFolder), qPrintable(failedFiles.first()));
+        finishTransfer(RequestState::EXPLICIT_ERROR, QString("%1 files could not be read, or changed while they were uploaded").arg(failedFiles.size()));
+        return;
+    }
+    startExtract();
+}
+
+void ArchiveUpload::startExtract()
+{
+    QJsonObject extractStep;
+    extractStep.insert("name", "extract");
+    extractStep.insert("app", "extract");
+    extractStep.insert("workingDir", QString("%1/%2").arg(myRemoteDest, archiveName));
+    extractStep.insert("inputs", QJsonObject());
+    QJsonObject workflowObject;
+    workflowObject.insert("steps", QJsonArray({extractStep}));
+
+    extractWorkflow = new JobWorkflow(ae_globals::get_job_model(), this);
+    QString errorText;
+    if (!extractWorkflow->loadJSON(QJsonDocument(workflowObject).toJson(), &errorText) || !extractWorkflow->startWorkflow())
+    {
+        qCDebug(agaveAppLayer, "Unable to start extract job: %s", qPrintable(errorText));
+        finishTransfer(RequestState::EXPLICIT_ERROR, "Unable to start the extract job");
+        return;
+    }
+
+    QObject::connect(extractWorkflow, SIGNAL(stepChanged(QString)), this, SLOT(extractStepChanged(QString)));
+    QObject::connect(extractWorkflow, SIGNAL(workflowDone(RequestState)), this, SLOT(extractDone(RequestState)));
+    emit archiveProgress(QString("Unpacking %1 on the server . . .").arg(archiveName));
+}
+
+void ArchiveUpload::extractStepChanged(QString stepName)
+{
+    if (transferFinished || (extractWorkflow == nullptr)) return;
+    emit archiveProgress(QString("Unpacking %1 on the server: %2").arg(archiveName, extractWorkflow->getStepMessage(stepName)));
+}
+
+void ArchiveUpload::extractDone(RequestState finalState)
+{
+    if (transferFinished) return;
+    if (finalState != RequestState::GOOD)
+    {
+        finishTransfer(RequestState::EXPLICIT_ERROR, QString("Unable to unpack %1: %2").arg(archiveName, extractWorkflow->getStepMessage("extract")));
+        return;
+    }
+    finishTransfer(RequestState::GOOD, QString("Uploaded %1 files into %2").arg(fileCount).arg(myRemoteDest));
+}
+
+void ArchiveUpload::deleteRemoteArchive()
+{
+    AgaveRestLink * theLink = ae_globals::get_rest_link();
+    if ((theLink == nullptr) || !archiveUploaded) return;
+
+    //The delete outlives this object, so the rest link owns it
+    QString archivePath = QString("%1/%2").arg(myRemoteDest, archiveName);
+    theLink->getScheduler()->scheduleRequest(RequestPriority::BACKGROUND, theLink, [theLink, archivePath]()
+    {
+        QNetworkReply * theReply = theLink->requestDelete(archivePath);
+        if (theReply == nullptr) return theReply;
+        QObject::connect(theReply, SIGNAL(finished()), theReply, SLOT(deleteLater()));
+        return theReply;
+    });
+}
+
+void ArchiveUpload::finishTransfer(RequestState finalState, QString message)
+{
+    if (transferFinished) return;
+    transferFinished = true;
+
+    if (uploadReply != nullptr)
+    {
+        uploadReply->disconnect(this);
+        uploadReply->abort();
+        uploadReply->deleteLater();
+        uploadReply = nullptr;
+    }
+    //A job already unpacking the archive still needs it
+    bool extractRunning = false;
+    if (extractWorkflow != nullptr)
+    {
+        extractWorkflow->disconnect(this);
+        extractRunning = extractWorkflow->isRunning() && (extractWorkflow->getStepState("extract") != JobWorkflow::StepState::WAITING);
+        if (extractWorkflow->isRunning()) extractWorkflow->cancelWorkflow();
+    }
+    if (!extractRunning) deleteRemoteArchive();
+
+    emit archiveProgress(message);
+    emit transferDone(finalState, (finalState == RequestState::GOOD) ? fileCount : 0, (finalState == RequestState::GOOD) ? 0 : fileCount);
+    this->deleteLater();
+}
@@ -0,0 +1,111 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef ARCHIVEUPLOAD_H
+#define ARCHIVEUPLOAD_H
+
+#include <QObject>
+#include <QPointer>
+
+#include "requestretry.h"
+
+class QNetworkReply;
+class JobWorkflow;
+class TarStreamReader;
+enum class RequestState;
+
+/*! \brief The ArchiveUpload copies a local folder into a remote folder as a single archive, instead of one request per file.
+ *
+ *  The local folder is packed into a tar archive by a TarStreamReader as it is sent, so no archive is written to local disk.
+ *  Once the archive is uploaded, a job of the "extract" app unpacks it beside itself, and the archive is then deleted.
+ *
+ *  This pays for one job, rather than a round trip per file, so it is faster for folders of many small files, and slower for folders of a few large files.
+ *  An upload which fails part way is sent again from the start, up to RequestRetry::maxAttempts times.
+ *
+ *  The transferDone() signal matches that of a BulkTransfer. The ArchiveUpload deletes itself after emitting transferDone().
+ */
+class ArchiveUpload : public QObject
+{
+    Q_OBJECT
+public:
+    /*! \brief Constructs a new ArchiveUpload.
+     *
+     *  \param localFolder Full path of the local folder to upload
+     *  \param remoteDest Full path of an existing remote folder. A folder with the name of the local folder is made inside it.
+     *  \param parent The object requesting the upload is typically the parent
+     */
+    explicit ArchiveUpload(QString localFolder, QString remoteDest, QObject * parent = nullptr);
+    ~ArchiveUpload();
+
+    /*! \brief Begins the upload. Returns false if the local folder does not exist or direct requests are not available.
+     */
+    bool startTransfer();
+    void cancelTransfer();
+
+    QString getLocalFolder();
+    QString getRemoteDest();
+
+signals:
+    void archiveProgress(QString message);
+    void transferDone(RequestState finalState, int filesDone, int filesFailed);
+
+private slots:
+    void uploadProgress(qint64 bytesSent, qint64 bytesTotal);
+    void uploadDone();
+    void extractStepChanged(QString stepName);
+    void extractDone(RequestState finalState);
+
+private:
+    QNetworkReply * sendUpload();
+    void startExtract();
+    void deleteRemoteArchive();
+    void finishTransfer(RequestState finalState, QString message);
+
+    QString myLocalFolder;
+    QString myRemoteDest;
+    QString archiveName;
+
+    QNetworkReply * uploadReply = nullptr;
+    QPointer<TarStreamReader> uploadSource;
+    JobWorkflow * extractWorkflow = nullptr;
+
+    int fileCount = 0;
+    int uploadAttempts = 0;
+    bool transferStarted = false;
+    bool archiveUploaded = false;
+    bool transferFinished = false;
+};
+
+#endif // ARCHIVEUPLOAD_H
@@ -0,0 +1,183 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "bulkjoboperation.h"
+
+#include "agaverestlink.h"
+#include "requestscheduler.h"
+#include "remotejobmodel.h"
+#include "jobrecord.h"
+#include "remotedatainterface.h"
+#include "ae_globals.h"
+
+#include <QNetworkReply>
+#include <QJsonDocument>
+
+BulkJobOperation::BulkJobOperation(JobAction theAction, QStringList jobIds, QObject * parent) : BulkTransfer(parent)
+{
+    myAction = theAction;
+    myJobIds = jobIds;
+    myJobIds.removeDuplicates();
+    myJobIds.removeAll(QString());
+}
+
+bool BulkJobOperation::startTransfer()
+{
+    if (myJobIds.isEmpty() || (ae_globals::get_rest_link() == nullptr)) return false;
+
+    for (const QString &aJobId : myJobIds)
+    {
+        TransferUnit jobUnit;
+        jobUnit.remotePath = aJobId;
+        enqueueUnit(jobUnit);
+    }
+    setPlanningDone();
+    return true;
+}
+
+BulkJobOperation::JobAction BulkJobOperation::getAction()
+{
+    return myAction;
+}
+
+QStringList BulkJobOperation::getJobIds()
+{
+    return myJobIds;
+}
+
+QMap<QString, QString> BulkJobOperation::getFailures()
+{
+    return failedJobs;
+}
+
+QString BulkJobOperation::getActionName(JobAction theAction)
+{
+    switch (theAction)
+    {
+    case JobAction::DELETE: return "Delete";
+    case JobAction::STOP: return "Stop";
+    case JobAction::RESUBMIT: return "Resubmit";
+    }
+    return QString();
+}
+
+bool BulkJobOperation::launchUnit(int unitId)
+{
+    //The scheduler holds the request until a BULK slot is free
+    ae_globals::get_rest_link()->getScheduler()->scheduleRequest(RequestPriority::BULK, this, [this, unitId]()
+    {
+        AgaveRestLink * theLink = ae_globals::get_rest_link();
+        QString jobId = unitList.at(unitId).remotePath;
+
+        QNetworkReply * theReply = nullptr;
+        if (myAction == JobAction::DELETE) theReply = theLink->requestJobDelete(jobId);
+        else if (myAction == JobAction::STOP) theReply = theLink->requestJobAction(jobId, "stop");
+        else theReply = theLink->requestJobAction(jobId, "resubmit");
+
+        if (theReply == nullptr)
+        {
+            failedJobs.insert(jobId, "Unable to send request");
+            unitComplete(unitId, false, 0);
+            return theReply;
+        }
+        runningRequests.insert(theReply, unitId);
+        QObject::connect(theReply, SIGNAL(finished()), this, SLOT(jobActionReplied()));
+        return theReply;
+    });
+    return true;
+}
+
+void BulkJobOperation::abortRunningUnits()
+{
+    QList<QNetworkReply *> toCancel = runningRequests.keys();
+    runningRequests.clear();
+    for (QNetworkReply * aReply : toCancel)
+    {
+        QObject::disconnect(aReply, nullptr, this, nullptr);
+        aReply->abort();
+        aReply->deleteLater();
+    }
+}
+
+void BulkJobOperation::jobActionReplied()
+{
+    QNetworkReply * theReply = qobject_cast<QNetworkReply *>(sender());
+    if (!runningRequests.contains(theReply)) return;
+    int unitId = runningRequests.take(theReply);
+    theReply->deleteLater();
+
+    QString jobId = unitList.at(unitId).remotePath;
+    RemoteJobModel * jobModel = ae_globals::get_job_model();
+
+    QByteArray rawReply = theReply->readAll();
+    QJsonValue replyResult = AgaveRestLink::getReplyResult(rawReply);
+    bool success = (theReply->error() == QNetworkReply::NoError);
+
+    //A job which is already gone does not need to be deleted again
+    if (!success && (myAction == JobAction::DELETE) &&
+            (theReply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 404))
+    {
+        success = true;
+    }
+
+    if (!success)
+    {
+        RetryHint failureHint;
+        if (myAction != JobAction::RESUBMIT) failureHint = RequestRetry::classifyReply(theReply);
+        QString reason = QJsonDocument::fromJson(rawReply).object().value("message").toString();
+        failedJobs.insert(jobId, reason.isEmpty() ? theReply->errorString() : reason);
+        unitComplete(unitId, false, 0, failureHint);
+        return;
+    }
+
+    failedJobs.remove(jobId);
+    if (myAction == JobAction::DELETE)
+    {
+        jobModel->removeJob(jobId);
+    }
+    else if (myAction == JobAction::STOP)
+    {
+        jobModel->updateJobStatus(jobId, "STOPPED");
+    }
+    else
+    {
+        JobRecord newJob;
+        if (JobRecord::parseJobEntry(replyResult.toObject(), &newJob))
+        {
+            jobModel->upsertJob(newJob);
+        }
+    }
+    unitComplete(unitId, true, 0);
+}
@@ -0,0 +1,94 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef BULKJOBOPERATION_H
+#define BULKJOBOPERATION_H
+
+#include "bulktransfer.h"
+
+#include <QMap>
+#include <QStringList>
+
+class QNetworkReply;
+
+/*! \brief The BulkJobOperation deletes, stops or resubmits many remote jobs at once.
+ *
+ *  Each job is one unit of the BulkTransfer, with the job ID as its remote path, so the jobs share its bounded concurrency, retries and progress signals.
+ *  Requests are sent through the scheduler at BULK priority. Deletes and stops are retried on transient failures. Resubmits are not, since a repeated
+ *  resubmit would start a second new job.
+ *
+ *  The RemoteJobModel is updated as each job succeeds. The jobs which failed, and why, can be read with getFailures() when transferDone() is emitted.
+ */
+class BulkJobOperation : public BulkTransfer
+{
+    Q_OBJECT
+public:
+    enum class JobAction {DELETE, STOP, RESUBMIT};
+
+    /*! \brief Constructs a new BulkJobOperation.
+     *
+     *  \param theAction The action to perform on every job
+     *  \param jobIds The IDs of the jobs
+     *  \param parent The object requesting the operation is typically the parent
+     */
+    explicit BulkJobOperation(JobAction theAction, QStringList jobIds, QObject * parent = nullptr);
+
+    virtual bool startTransfer();
+
+    JobAction getAction();
+    QStringList getJobIds();
+    /*! \brief Returns the jobs which have failed so far, with the reason each failed.
+     */
+    QMap<QString, QString> getFailures();
+
+    /*! \brief Returns the action as a verb, such as "Delete", for display.
+     */
+    static QString getActionName(JobAction theAction);
+
+protected:
+    virtual bool launchUnit(int unitId);
+    virtual void abortRunningUnits();
+
+private slots:
+    void jobActionReplied();
+
+private:
+    JobAction myAction;
+    QStringList myJobIds;
+    QMap<QString, QString> failedJobs;
+    QMap<QNetworkReply *, int> runningRequests;
+};
+
+#endif // BULKJOBOPERATION_H
@@ -0,0 +1,225 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "bulktransfer.h"
+
+#include "transferjournal.h"
+#include "remotedatainterface.h"
+#include "ae_globals.h"
+
+#include <QTimer>
+#include <QDir>
+
+BulkTransfer::BulkTransfer(QObject * parent) : QObject(parent) {}
+
+void BulkTransfer::cancelTransfer()
+{
+    if (transferFinished) return;
+
+    transferCancelled = true;
+    waitingUnits.clear();
+    abortRunningUnits();
+    finishTransfer(RequestState::EXPLICIT_ERROR);
+}
+
+void BulkTransfer::setMaxInFlight(int newMax)
+{
+    if (newMax < 1) return;
+    maxInFlight = newMax;
+    launchWaitingUnits();
+}
+
+int BulkTransfer::getMaxInFlight()
+{
+    return maxInFlight;
+}
+
+void BulkTransfer::setJournal(TransferJournal * theJournal)
+{
+    myJournal = theJournal;
+    if (myJournal != nullptr) myJournal->setParent(this);
+}
+
+void BulkTransfer::enqueueUnit(const TransferUnit &newUnit)
+{
+    if (transferFinished) return;
+
+    unitList.append(newUnit);
+
+    if (myJournal != nullptr)
+    {
+        if (myJournal->unitAlreadyDone(newUnit))
+        {
+            unitsDone++;
+            bytesDone += qMax(newUnit.fileSize, qint64(0));
+            emit transferProgress(unitsDone, unitList.size(), bytesDone);
+            return;
+        }
+        myJournal->recordPlanned(newUnit);
+    }
+
+    waitingUnits.enqueue(unitList.size() - 1);
+    launchWaitingUnits();
+}
+
+void BulkTransfer::setPlanningDone(bool planningGood)
+{
+    planningDone = true;
+    if (!planningGood) planningFailed = true;
+    launchWaitingUnits();
+}
+
+void BulkTransfer::setChecksumManifest(QString manifestPath, QString localBasePath)
+{
+    checksumManifest.setFileName(manifestPath);
+    manifestBasePath = localBasePath;
+
+    QIODevice::OpenMode manifestMode = QIODevice::WriteOnly | QIODevice::Text;
+    if ((myJournal != nullptr) && myJournal->hasFinishedUnits())
+    {
+        manifestMode |= QIODevice::Append;
+    }
+    else
+    {
+        manifestMode |= QIODevice::Truncate;
+    }
+
+    if (!checksumManifest.open(manifestMode))
+    {
+        qCDebug(agaveAppLayer, "Unable to write checksum manifest: %s", qPrintable(manifestPath));
+    }
+}
+
+void BulkTransfer::unitComplete(int unitId, bool success, qint64 bytesMoved, RetryHint failureHint)
+{
+    if (transferFinished) return;
+
+    unitsInFlight--;
+    if (!success && failureHint.retryable)
+    {
+        int attemptNum = ++unitAttempts[unitId];
+        if (attemptNum < RequestRetry::maxAttempts)
+        {
+            int retryDelay = RequestRetry::backoffDelayMs(attemptNum, failureHint);
+            qCDebug(agaveAppLayer, "Retrying transfer of %s in %d ms", qPrintable(unitList.at(unitId).remotePath), retryDelay);
+
+            unitsAwaitingRetry++;
+            QTimer::singleShot(retryDelay, this, [this, unitId]() { retryUnit(unitId); });
+            launchWaitingUnits();
+            return;
+        }
+    }
+
+    if (myJournal != nullptr)
+    {
+        if (success) myJournal->recordDone(unitList.at(unitId));
+        else myJournal->recordFailed(unitList.at(unitId));
+    }
+
+    if (success)
+    {
+        addToManifest(unitList.at(unitId));
+        unitsDone++;
+        bytesDone += bytesMoved;
+    }
+    else
+    {
+        qCDebug(agaveAppLayer, "Transfer failed for %s", qPrintable(unitList.at(unitId).remotePath));
+        unitsFailed++;
+    }
+
+    emit transferProgress(unitsDone, unitList.size(), bytesDone);
+    launchWaitingUnits();
+}
+
+void BulkTransfer::launchWaitingUnits()
+{
+    if (transferFinished) return;
+
+    while ((unitsInFlight < maxInFlight) && (!waitingUnits.isEmpty()))
+    {
+        int unitId = waitingUnits.dequeue();
+        unitsInFlight++;
+        if (myJournal != nullptr) myJournal->recordStarted(unitList.at(unitId));
+        if (!launchUnit(unitId))
+        {
+            if (myJournal != nullptr) myJournal->recordFailed(unitList.at(unitId));
+            unitsInFlight--;
+            unitsFailed++;
+        }
+    }
+
+    if (planningDone && (unitsInFlight == 0) && (unitsAwaitingRetry == 0) && waitingUnits.isEmpty())
+    {
+        bool allGood = (!planningFailed) && (unitsFailed == 0);
+        finishTransfer(allGood ? RequestState::GOOD : RequestState::EXPLICIT_ERROR);
+    }
+}
+
+void BulkTransfer::addToManifest(const TransferUnit &theUnit)
+{
+    if (!checksumManifest.isOpen() || theUnit.contentHash.isEmpty()) return;
+
+    QByteArray manifestLine = theUnit.contentHash;
+    manifestLine.append("  ");
+    manifestLine.append(QDir(manifestBasePath).relativeFilePath(theUnit.localPath).toUtf8());
+    manifestLine.append('\n');
+    checksumManifest.write(manifestLine);
+    checksumManifest.flush();
+}
+
+void BulkTransfer::retryUnit(int unitId)
+{
+    if (transferFinished) return;
+
+    unitsAwaitingRetry--;
+    waitingUnits.prepend(unitId);
+    launchWaitingUnits();
+}
+
+void BulkTransfer::finishTransfer(RequestState finalState)
+{
+    if (transferFinished) return;
+    transferFinished = true;
+
+    if (myJournal != nullptr)
+    {
+        if (transferCancelled) myJournal->discardJournal();
+        else if (finalState == RequestState::GOOD) myJournal->recordComplete();
+    }
+
+    emit transferDone(finalState, unitsDone, unitsFailed);
+    this->deleteLater();
+}
@@ -0,0 +1,144 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef BULKTRANSFER_H
+#define BULKTRANSFER_H
+
+#include <QObject>
+#include <QVector>
+#include <QQueue>
+#include <QHash>
+#include <QFile>
+
+#include "requestretry.h"
+
+enum class RequestState;
+class TransferJournal;
+
+/*! \brief A TransferUnit is one file moved as part of a BulkTransfer.
+ */
+struct TransferUnit
+{
+    QString localPath;
+    QString remotePath;
+    qint64 fileSize = -1;
+    QByteArray contentHash;
+};
+
+/*! \brief The BulkTransfer is an abstract class for transfers made of many files, such as the upload or download of a folder.
+ *
+ *  Subclasses plan the transfer by calling enqueueUnit() for each file, and setPlanningDone() when all files are known.
+ *  Units may begin before planning is done. The BulkTransfer runs up to getMaxInFlight() units at once, calling launchUnit() for each.
+ *  Subclasses call unitComplete() as each unit ends. A unit which fails in a way which may be transient is retried,
+ *  after a jittered backoff from RequestRetry, up to RequestRetry::maxAttempts times, without holding up the other units.
+ *
+ *  If a TransferJournal is given with setJournal(), each unit is recorded in it, and units the journal shows already done are skipped.
+ *  The journal is removed when the transfer finishes, or is cancelled, and is kept if any unit fails, so that the transfer can be resumed.
+ *
+ *  Subclasses may set the contentHash of a unit before reporting it complete. If a checksum manifest is set with setChecksumManifest(),
+ *  the checksum of each unit is then added to it, in the format of sha256sum.
+ *
+ *  The BulkTransfer deletes itself after emitting transferDone().
+ */
+class BulkTransfer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit BulkTransfer(QObject * parent = nullptr);
+
+    /*! \brief Begins the transfer. Returns false if the transfer could not be started.
+     */
+    virtual bool startTransfer() = 0;
+    void cancelTransfer();
+
+    void setMaxInFlight(int newMax);
+    int getMaxInFlight();
+
+    /*! \brief Sets the journal for this transfer, which this transfer then owns. Must be called before startTransfer().
+     */
+    void setJournal(TransferJournal * theJournal);
+
+signals:
+    void transferProgress(int unitsDone, int unitsKnown, qint64 bytesDone);
+    void transferDone(RequestState finalState, int unitsDone, int unitsFailed);
+
+protected:
+    void enqueueUnit(const TransferUnit &newUnit);
+    void setPlanningDone(bool planningGood = true);
+
+    /*! \brief Sets a file to hold the checksums of transferred units, which are listed relative to the given local folder.
+     *
+     *  The manifest is started over, unless the transfer is resuming from a journal.
+     */
+    void setChecksumManifest(QString manifestPath, QString localBasePath);
+
+    /*! \brief Begins one unit of the transfer. Returns false if the unit could not be started, which counts as a failure.
+     */
+    virtual bool launchUnit(int unitId) = 0;
+    void unitComplete(int unitId, bool success, qint64 bytesMoved, RetryHint failureHint = RetryHint());
+
+    /*! \brief Called during cancelTransfer(), so that subclasses can stop any running units.
+     */
+    virtual void abortRunningUnits() = 0;
+
+    QVector<TransferUnit> unitList;
+
+private:
+    void launchWaitingUnits();
+    void retryUnit(int unitId);
+    void finishTransfer(RequestState finalState);
+
+    void addToManifest(const TransferUnit &theUnit);
+
+    TransferJournal * myJournal = nullptr;
+    QFile checksumManifest;
+    QString manifestBasePath;
+
+    QQueue<int> waitingUnits;
+    int maxInFlight = 1;
+    int unitsInFlight = 0;
+    int unitsAwaitingRetry = 0;
+    QHash<int, int> unitAttempts;
+    int unitsDone = 0;
+    int unitsFailed = 0;
+    qint64 bytesDone = 0;
+
+    bool planningDone = false;
+    bool planningFailed = false;
+    bool transferFinished = false;
+    bool transferCancelled = false;
+};
+
+#endif // BULKTRANSFER_H
@@ -0,0 +1,134 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "callbackcheck.h"
+
+#include "jobcallbacklistener.h"
+
+#include <QCoreApplication>
+#include <QNetworkAccessManager>
+#include <QNetworkRequest>
+#include <QNetworkReply>
+#include <QUrl>
+
+CallbackCheck * CallbackCheck::createFromArgs(int argc, char *argv[])
+{
+    quint16 localPort = 0;
+
+    for (int i = 0; i < argc; i++)
+    {
+        if (strncmp(argv[i],"jobCallbackCheck=",17) == 0)
+        {
+            localPort = QString(argv[i] + 17).toUShort();
+        }
+    }
+
+    if (localPort == 0) return nullptr;
+    return new CallbackCheck(localPort);
+}
+
+CallbackCheck::CallbackCheck(quint16 localPort, QObject * parent) : QObject(parent)
+{
+    myPort = localPort;
+}
+
+void CallbackCheck::startCheck()
+{
+    theListener = new JobCallbackListener(this);
+    if (!theListener->startListening(myPort, QString("http://127.0.0.1:%1").arg(myPort)))
+    {
+        qInfo("Callback check: unable to listen on port %d", myPort);
+        QCoreApplication::instance()->exit(1);
+        return;
+    }
+    QObject::connect(theListener, SIGNAL(jobStatusPushed(QString,QString)), this, SLOT(statusPushed(QString,QString)));
+    theManager = new QNetworkAccessManager(this);
+
+    //The callback URL ends with /jobs/<token>/${JOB_ID}/${JOB_STATUS}
+    QString templateUrl = theListener->getCallbackUrl();
+    QString tokenUrl = templateUrl.section('/', 0, -3);
+    QString wrongTokenUrl = templateUrl.section('/', 0, -4) + "/00000000000000000000000000000000";
+
+    pendingCases.append({"Status post", "POST", tokenUrl + "/job-0001/running", "{}", 200, "job-0001 RUNNING"});
+    pendingCases.append({"Status get", "GET", tokenUrl + "/job-0002/QUEUED", QByteArray(), 200, "job-0002 QUEUED"});
+    pendingCases.append({"Wrong token", "POST", wrongTokenUrl + "/job-0003/RUNNING", QByteArray(), 404, QString()});
+    pendingCases.append({"No token", "POST", templateUrl.section('/', 0, -4) + "/job-0004/RUNNING", QByteArray(), 404, QString()});
+    pendingCases.append({"Unfilled template", "POST", templateUrl, QByteArray(), 200, QString()});
+    pendingCases.append({"Extra path part", "POST", tokenUrl + "/job-0005/RUNNING/extra", QByteArray(), 404, QString()});
+    pendingCases.append({"Wrong method", "PUT", tokenUrl + "/job-0006/RUNNING", QByteArray(), 405, QString()});
+
+    qInfo("Callback check: %d cases against %s", pendingCases.size(), qPrintable(tokenUrl.section('/', 0, 2)));
+    runNextCase();
+}
+
+void CallbackCheck::statusPushed(QString jobId, QString newStatus)
+{
+    pushesSeen.append(QString("%1 %2").arg(jobId, newStatus));
+}
+
+void CallbackCheck::replyDone()
+{
+    QNetworkReply * theReply = qobject_cast<QNetworkReply *>(sender());
+    if (theReply == nullptr) return;
+    theReply->deleteLater();
+
+    int statusCode = theReply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    QString pushSeen = pushesSeen.join(", ");
+    bool casePassed = (statusCode == currentCase.expectedCode) && (pushSeen == currentCase.expectedPush);
+    if (!casePassed) failedCases++;
+
+    qInfo("%s: %s (HTTP %d, pushed \"%s\")", casePassed ? "PASS" : "FAIL", qPrintable(currentCase.name), statusCode, qPrintable(pushSeen));
+    runNextCase();
+}
+
+void CallbackCheck::runNextCase()
+{
+    if (pendingCases.isEmpty())
+    {
+        qInfo("Callback check: %d failed", failedCases);
+        theListener->stopListening();
+        QCoreApplication::instance()->exit((failedCases == 0) ? 0 : 1);
+        return;
+    }
+
+    currentCase = pendingCases.takeFirst();
+    pushesSeen.clear();
+
+    //Note: The listener answers each request with Connection: close, so each case uses a new connection
+    QNetworkRequest caseRequest((QUrl(currentCase.url)));
+    caseRequest.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+    QNetworkReply * theReply = theManager->sendCustomRequest(caseRequest, currentCase.method, currentCase.body);
+    QObject::connect(theReply, SIGNAL(finished()), this, SLOT(replyDone()));
+}
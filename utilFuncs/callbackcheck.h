@@ -0,0 +1,95 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef CALLBACKCHECK_H
+#define CALLBACKCHECK_H
+
+#include <QObject>
+#include <QList>
+#include <QStringList>
+#include <QByteArray>
+
+class QNetworkAccessManager;
+class JobCallbackListener;
+
+/*! \brief The CallbackCheck posts a set of requests to a local JobCallbackListener, and checks how each is answered.
+ *
+ *  The check is run from the command line, instead of the normal program, with:
+ *
+ *  AgaveExplorer jobCallbackCheck=18123
+ *
+ *  Where 18123 is a free local port. It stands in for the Agave server, so that the request parser and the token check can be tried without a login.
+ *  Each case is printed as it finishes, and the program exits with 1 if any case failed.
+ */
+class CallbackCheck : public QObject
+{
+    Q_OBJECT
+public:
+    /*! \brief Returns a new CallbackCheck if the command line asks for one, or nullptr otherwise.
+     */
+    static CallbackCheck * createFromArgs(int argc, char *argv[]);
+
+    void startCheck();
+
+private slots:
+    void statusPushed(QString jobId, QString newStatus);
+    void replyDone();
+
+private:
+    explicit CallbackCheck(quint16 localPort, QObject * parent = nullptr);
+
+    struct CheckCase
+    {
+        QString name;
+        QByteArray method;
+        QString url;
+        QByteArray body;
+        int expectedCode;
+        QString expectedPush;
+    };
+
+    void runNextCase();
+
+    quint16 myPort;
+    JobCallbackListener * theListener = nullptr;
+    QNetworkAccessManager * theManager = nullptr;
+
+    QList<CheckCase> pendingCases;
+    CheckCase currentCase;
+    QStringList pushesSeen;
+    int failedCases = 0;
+};
+
+#endif // CALLBACKCHECK_H
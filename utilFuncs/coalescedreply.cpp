@@ -0,0 +1,114 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "coalescedreply.h"
+
+CoalescedReply::CoalescedReply(const QNetworkRequest &theRequest, QObject * parent) : QNetworkReply(parent)
+{
+    setRequest(theRequest);
+    setUrl(theRequest.url());
+    setOperation(QNetworkAccessManager::GetOperation);
+    open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+}
+
+void CoalescedReply::deliverResult(QNetworkReply * sharedReply, const QByteArray &replyContents)
+{
+    if (wasAborted) return;
+
+    contentBuffer = replyContents;
+    readPosition = 0;
+
+    setUrl(sharedReply->url());
+    setAttribute(QNetworkRequest::HttpStatusCodeAttribute, sharedReply->attribute(QNetworkRequest::HttpStatusCodeAttribute));
+    setAttribute(QNetworkRequest::HttpReasonPhraseAttribute, sharedReply->attribute(QNetworkRequest::HttpReasonPhraseAttribute));
+    for (const QPair<QByteArray, QByteArray> &aHeader : sharedReply->rawHeaderPairs())
+    {
+        setRawHeader(aHeader.first, aHeader.second);
+    }
+    setHeader(QNetworkRequest::ContentLengthHeader, contentBuffer.size());
+    setError(sharedReply->error(), sharedReply->errorString());
+
+    QMetaObject::invokeMethod(this, "emitDelivery", Qt::QueuedConnection);
+}
+
+void CoalescedReply::abort()
+{
+    if (wasAborted || isFinished()) return;
+    wasAborted = true;
+
+    setError(QNetworkReply::OperationCanceledError, "Operation canceled");
+    emit replyAborted();
+    emit error(QNetworkReply::OperationCanceledError);
+    setFinished(true);
+    emit finished();
+}
+
+qint64 CoalescedReply::bytesAvailable() const
+{
+    return (contentBuffer.size() - readPosition) + QIODevice::bytesAvailable();
+}
+
+bool CoalescedReply::isSequential() const
+{
+    return true;
+}
+
+qint64 CoalescedReply::readData(char * data, qint64 maxSize)
+{
+    qint64 readSize = qMin(maxSize, qint64(contentBuffer.size()) - readPosition);
+    if (readSize <= 0) return (isFinished() ? -1 : 0);
+
+    memcpy(data, contentBuffer.constData() + readPosition, readSize);
+    readPosition += readSize;
+    return readSize;
+}
+
+void CoalescedReply::emitDelivery()
+{
+    if (wasAborted) return;
+
+    emit metaDataChanged();
+    if (!contentBuffer.isEmpty())
+    {
+        emit downloadProgress(contentBuffer.size(), contentBuffer.size());
+        emit readyRead();
+    }
+    if (error() != QNetworkReply::NoError)
+    {
+        emit error(error());
+    }
+    setFinished(true);
+    emit finished();
+}
@@ -0,0 +1,78 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef COALESCEDREPLY_H
+#define COALESCEDREPLY_H
+
+#include <QNetworkReply>
+#include <QByteArray>
+#include <QList>
+#include <QPair>
+
+/*! \brief The CoalescedReply is a QNetworkReply which gets its contents from a request shared with other callers.
+ *
+ *  The AgaveNetManager returns a CoalescedReply for each caller which joins an identical GET request already in flight, so that only one network request is made.
+ *  When the shared request finishes, its status, headers and contents are copied into every CoalescedReply.
+ */
+class CoalescedReply : public QNetworkReply
+{
+    Q_OBJECT
+public:
+    explicit CoalescedReply(const QNetworkRequest &theRequest, QObject * parent = nullptr);
+
+    /*! \brief Copies the result of the shared request into this reply, and emits the usual signals afterward, from the event loop.
+     */
+    void deliverResult(QNetworkReply * sharedReply, const QByteArray &replyContents);
+
+    virtual void abort();
+    virtual qint64 bytesAvailable() const;
+    virtual bool isSequential() const;
+
+signals:
+    void replyAborted();
+
+protected:
+    virtual qint64 readData(char * data, qint64 maxSize);
+
+private slots:
+    void emitDelivery();
+
+private:
+    QByteArray contentBuffer;
+    qint64 readPosition = 0;
+    bool wasAborted = false;
+};
+
+#endif // COALESCEDREPLY_H
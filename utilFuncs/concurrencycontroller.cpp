@@ -0,0 +1,108 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "concurrencycontroller.h"
+
+ConcurrencyController::ConcurrencyController(int startLimit, int minLimit, int maxLimit)
+{
+    lowestLimit = qMax(1, minLimit);
+    highestLimit = qMax(lowestLimit, maxLimit);
+    currentLimit = qBound(lowestLimit, startLimit, highestLimit);
+    completionsSinceDecrease = currentLimit;
+}
+
+void ConcurrencyController::recordSuccess(qint64 latencyMs)
+{
+    completionsSinceDecrease++;
+
+    if (latencyMs >= 0)
+    {
+        bool congested = (usualLatencyMs > 0) && (latencyMs > usualLatencyMs * latencyCongestionFactor);
+        if (usualLatencyMs < 0)
+        {
+            usualLatencyMs = latencyMs;
+        }
+        else
+        {
+            usualLatencyMs += (latencyMs - usualLatencyMs) * latencyAverageWeight;
+        }
+
+        if (congested)
+        {
+            decreaseLimit();
+            return;
+        }
+    }
+
+    successesInWindow++;
+    if (successesInWindow >= currentLimit)
+    {
+        successesInWindow = 0;
+        if (currentLimit < highestLimit) currentLimit++;
+    }
+}
+
+void ConcurrencyController::recordCongestion()
+{
+    completionsSinceDecrease++;
+    decreaseLimit();
+}
+
+int ConcurrencyController::getLimit() const
+{
+    return currentLimit;
+}
+
+int ConcurrencyController::getMaxLimit() const
+{
+    return highestLimit;
+}
+
+void ConcurrencyController::setMaxLimit(int newMax)
+{
+    highestLimit = qMax(lowestLimit, newMax);
+    if (currentLimit > highestLimit) currentLimit = highestLimit;
+}
+
+void ConcurrencyController::decreaseLimit()
+{
+    successesInWindow = 0;
+
+    //Requests started under the old limit are still ending, and do not show the effect of the last decrease
+    if (completionsSinceDecrease < currentLimit) return;
+
+    completionsSinceDecrease = 0;
+    currentLimit = qMax(lowestLimit, currentLimit / 2);
+}
@@ -0,0 +1,78 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef CONCURRENCYCONTROLLER_H
+#define CONCURRENCYCONTROLLER_H
+
+#include <QtGlobal>
+
+/*! \brief The ConcurrencyController picks how many requests may be in flight at once, with additive increase and multiplicative decrease (AIMD).
+ *
+ *  The limit grows by one after a full window of requests succeeds, and is halved when the server shows congestion:
+ *  a 429 or 5xx status, or a latency far above the usual latency of recent requests.
+ *  Every latency sample is folded into the usual latency, so that a lasting rise in latency, as on a slower link, stops counting as congestion.
+ *  After a decrease, further congestion is ignored until the requests already in flight have ended, so that one burst of errors only halves the limit once.
+ */
+class ConcurrencyController
+{
+public:
+    ConcurrencyController(int startLimit = 2, int minLimit = 1, int maxLimit = 16);
+
+    /*! \brief Records a request which ended without congestion. A latency of -1 gives no latency sample, as for a request with a large body.
+     */
+    void recordSuccess(qint64 latencyMs = -1);
+    void recordCongestion();
+
+    int getLimit() const;
+    int getMaxLimit() const;
+    void setMaxLimit(int newMax);
+
+private:
+    void decreaseLimit();
+
+    int currentLimit;
+    int lowestLimit;
+    int highestLimit;
+
+    int successesInWindow = 0;
+    int completionsSinceDecrease = 0;
+    double usualLatencyMs = -1;
+
+    //Latency this many times the usual latency counts as congestion
+    static constexpr double latencyCongestionFactor = 3.0;
+    static constexpr double latencyAverageWeight = 0.1;
+};
+
+#endif // CONCURRENCYCONTROLLER_H
@@ -0,0 +1,354 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "contentindex.h"
+
+#include "agaverestlink.h"
+#include "requestscheduler.h"
+#include "requestretry.h"
+#include "remotedatainterface.h"
+#include "filemetadata.h"
+#include "ae_globals.h"
+
+#include <QNetworkReply>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QBuffer>
+
+const QString ContentIndex::indexFileName = "contentIndex.json";
+
+ContentIndex::ContentIndex(QObject * parent) : QObject(parent)
+{
+    saveTimer.setSingleShot(true);
+    saveTimer.setInterval(saveDelayMs);
+    QObject::connect(&saveTimer, SIGNAL(timeout()), this, SLOT(saveIndex()));
+}
+
+void ContentIndex::openIndex(QString userName)
+{
+    if (!indexFolder.isEmpty() || userName.isEmpty()) return;
+    indexFolder = QString("/%1/.agaveExplorer").arg(userName);
+
+    ae_globals::get_rest_link()->getScheduler()->scheduleRequest(RequestPriority::BACKGROUND, this, [this]()
+    {
+        QNetworkReply * theReply = ae_globals::get_rest_link()->requestFileContents(getIndexPath());
+        if (theReply == nullptr)
+        {
+            indexRead = true;
+            emit indexOpened(RequestState::NO_CONNECT);
+            return theReply;
+        }
+        QObject::connect(theReply, SIGNAL(finished()), this, SLOT(indexFetched()));
+        return theReply;
+    });
+}
+
+bool ContentIndex::isOpen()
+{
+    return indexRead;
+}
+
+QString ContentIndex::getIndexPath()
+{
+    return QString("%1/%2").arg(indexFolder, indexFileName);
+}
+
+bool ContentIndex::hasContent(QByteArray hexHash, qint64 fileSize)
+{
+    if (!contentEntries.contains(hexHash)) return false;
+    return (contentEntries.value(hexHash).fileSize == fileSize) && !contentEntries.value(hexHash).remotePaths.isEmpty();
+}
+
+void ContentIndex::recordContent(QByteArray hexHash, qint64 fileSize, QString remotePath)
+{
+    if (hexHash.isEmpty() || remotePath.isEmpty()) return;
+
+    ContentEntry &theEntry = contentEntries[hexHash];
+    if (theEntry.fileSize != fileSize) theEntry.remotePaths.clear();
+    theEntry.fileSize = fileSize;
+
+    //The newest copy is tried first, as it is the least likely to have been changed since
+    theEntry.remotePaths.removeAll(remotePath);
+    theEntry.remotePaths.prepend(remotePath);
+    while (theEntry.remotePaths.size() > maxCopiesKept)
+    {
+        theEntry.remotePaths.removeLast();
+    }
+    scheduleSave();
+}
+
+void ContentIndex::forgetContent(QByteArray hexHash, QString remotePath)
+{
+    if (!contentEntries.contains(hexHash)) return;
+
+    contentEntries[hexHash].remotePaths.removeAll(remotePath);
+    if (contentEntries.value(hexHash).remotePaths.isEmpty())
+    {
+        contentEntries.remove(hexHash);
+    }
+    scheduleSave();
+}
+
+void ContentIndex::copyContent(QByteArray hexHash, qint64 fileSize, QString destPath)
+{
+    PendingCopy newCopy;
+    newCopy.hexHash = hexHash;
+    newCopy.fileSize = fileSize;
+    newCopy.destPath = destPath;
+    if (hasContent(hexHash, fileSize)) newCopy.candidates = contentEntries.value(hexHash).remotePaths;
+    tryNextSource(newCopy);
+}
+
+void ContentIndex::indexFetched()
+{
+    QNetworkReply * theReply = qobject_cast<QNetworkReply *>(sender());
+    if (theReply == nullptr) return;
+    theReply->deleteLater();
+    indexRead = true;
+
+    //A user with no index yet starts with an empty one
+    int httpStatus = theReply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (httpStatus == 404)
+    {
+        indexReadable = true;
+        emit indexOpened(RequestState::GOOD);
+        return;
+    }
+
+    QJsonDocument indexDoc = QJsonDocument::fromJson(theReply->readAll());
+    if ((theReply->error() != QNetworkReply::NoError) || !indexDoc.isObject())
+    {
+        //An index which cannot be read is not written over, so that it is not lost to a passing error
+        qCDebug(agaveAppLayer, "Content index not read: %s", qPrintable(getIndexPath()));
+        emit indexOpened(RequestState::NO_CONNECT);
+        return;
+    }
+    indexReadable = true;
+
+    QJsonObject rawEntries = indexDoc.object().value("entries").toObject();
+    for (auto itr = rawEntries.constBegin(); itr != rawEntries.constEnd(); itr++)
+    {
+        QByteArray hexHash = itr.key().toLatin1();
+        QJsonObject rawEntry = itr.value().toObject();
+        qint64 fileSize = qint64(rawEntry.value("size").toDouble(-1));
+        if (fileSize < 0) continue;
+
+        //Entries recorded in this session, before the index was read, come first
+        ContentEntry &theEntry = contentEntries[hexHash];
+        if ((theEntry.fileSize != fileSize) && !theEntry.remotePaths.isEmpty()) continue;
+        theEntry.fileSize = fileSize;
+        for (const QJsonValue &aPath : rawEntry.value("paths").toArray())
+        {
+            if (theEntry.remotePaths.size() >= maxCopiesKept) break;
+            if (!theEntry.remotePaths.contains(aPath.toString())) theEntry.remotePaths.append(aPath.toString());
+        }
+        if (theEntry.remotePaths.isEmpty()) contentEntries.remove(hexHash);
+    }
+
+    qCDebug(agaveAppLayer, "Content index read, %d entries", contentEntries.size());
+    emit indexOpened(RequestState::GOOD);
+    if (saveAgain || saveTimer.isActive()) scheduleSave();
+}
+
+void ContentIndex::scheduleSave()
+{
+    if (!indexRead || !indexReadable)
+    {
+        saveAgain = true;
+        return;
+    }
+    if (saveRunning)
+    {
+        saveAgain = true;
+        return;
+    }
+    saveAgain = false;
+    saveTimer.start();
+}
+
+void ContentIndex::saveIndex()
+{
+    if (saveRunning || indexFolder.isEmpty()) return;
+    saveRunning = true;
+
+    //The folder is made before the first save. If it is already there, the error is ignored
+    if (!folderMade)
+    {
+        ae_globals::get_rest_link()->getScheduler()->scheduleRequest(RequestPriority::BACKGROUND, this, [this]()
+        {
+            QNetworkReply * theReply = ae_globals::get_rest_link()->requestMakeFolder(indexFolder.section('/', 0, -2), indexFolder.section('/', -1));
+            if (theReply == nullptr)
+            {
+                saveRunning = false;
+                return theReply;
+            }
+            QObject::connect(theReply, SIGNAL(finished()), this, SLOT(indexFolderMade()));
+            return theReply;
+        });
+        return;
+    }
+
+    QJsonObject rawEntries;
+    for (auto itr = contentEntries.cbegin(); itr != contentEntries.cend(); itr++)
+    {
+        QJsonObject rawEntry;
+        rawEntry.insert("size", double(itr.value().fileSize));
+        rawEntry.insert("paths", QJsonArray::fromStringList(itr.value().remotePaths));
+        rawEntries.insert(QString::fromLatin1(itr.key()), rawEntry);
+    }
+    QJsonObject indexObject;
+    indexObject.insert("entries", rawEntries);
+    QByteArray indexText = QJsonDocument(indexObject).toJson(QJsonDocument::Compact);
+
+    ae_globals::get_rest_link()->getScheduler()->scheduleRequest(RequestPriority::BACKGROUND, this, [this, indexText]()
+    {
+        QBuffer * indexSource = new QBuffer();
+        indexSource->setData(indexText);
+        indexSource->open(QIODevice::ReadOnly);
+        QNetworkReply * theReply = ae_globals::get_rest_link()->requestStreamUpload(indexSource, indexFileName, indexFolder);
+        if (theReply == nullptr)
+        {
+            saveRunning = false;
+            return theReply;
+        }
+        QObject::connect(theReply, SIGNAL(finished()), this, SLOT(indexSaved()));
+        return theReply;
+    });
+}
+
+void ContentIndex::indexFolderMade()
+{
+    QNetworkReply * theReply = qobject_cast<QNetworkReply *>(sender());
+    if (theReply == nullptr) return;
+    theReply->deleteLater();
+
+    folderMade = true;
+    saveRunning = false;
+    saveIndex();
+}
+
+void ContentIndex::indexSaved()
+{
+    QNetworkReply * theReply = qobject_cast<QNetworkReply *>(sender());
+    if (theReply == nullptr) return;
+    theReply->deleteLater();
+    saveRunning = false;
+
+    if (theReply->error() != QNetworkReply::NoError)
+    {
+        qCDebug(agaveAppLayer, "Content index not saved: %s", qPrintable(theReply->errorString()));
+    }
+    if (saveAgain) scheduleSave();
+}
+
+void ContentIndex::tryNextSource(PendingCopy theCopy)
+{
+    if (theCopy.candidates.isEmpty())
+    {
+        emit contentCopied(theCopy.destPath, false);
+        return;
+    }
+    theCopy.sourcePath = theCopy.candidates.takeFirst();
+
+    ae_globals::get_rest_link()->getScheduler()->scheduleRequest(RequestPriority::BULK, this, [this, theCopy]()
+    {
+        QNetworkReply * theReply = ae_globals::get_rest_link()->requestListingPage(theCopy.sourcePath, 0, 1);
+        if (theReply == nullptr)
+        {
+            emit contentCopied(theCopy.destPath, false);
+            return theReply;
+        }
+        pendingCopies.insert(theReply, theCopy);
+        QObject::connect(theReply, SIGNAL(finished()), this, SLOT(sourceChecked()));
+        return theReply;
+    });
+}
+
+void ContentIndex::sourceChecked()
+{
+    QNetworkReply * theReply = qobject_cast<QNetworkReply *>(sender());
+    if (!pendingCopies.contains(theReply)) return;
+    PendingCopy theCopy = pendingCopies.take(theReply);
+    theReply->deleteLater();
+
+    //A remote file of the wrong size has been changed since it was recorded
+    FileMetaData sourceEntry;
+    qint64 sourceSize = -1;
+    QJsonArray rawEntries = AgaveRestLink::getReplyResult(theReply->readAll()).toArray();
+    bool sourceGood = (theReply->error() == QNetworkReply::NoError) && (rawEntries.size() == 1) &&
+            AgaveRestLink::parseFileEntry(rawEntries.at(0).toObject(), &sourceEntry, &sourceSize) &&
+            (sourceEntry.getFileType() == FileType::FILE) && (sourceSize == theCopy.fileSize);
+    if (!sourceGood)
+    {
+        qCDebug(agaveAppLayer, "Indexed copy no longer matches: %s", qPrintable(theCopy.sourcePath));
+        if (!RequestRetry::classifyReply(theReply).retryable) forgetContent(theCopy.hexHash, theCopy.sourcePath);
+        tryNextSource(theCopy);
+        return;
+    }
+
+    ae_globals::get_rest_link()->getScheduler()->scheduleRequest(RequestPriority::BULK, this, [this, theCopy]()
+    {
+        QNetworkReply * theReply = ae_globals::get_rest_link()->requestFileAction(theCopy.sourcePath, "copy", theCopy.destPath);
+        if (theReply == nullptr)
+        {
+            emit contentCopied(theCopy.destPath, false);
+            return theReply;
+        }
+        pendingCopies.insert(theReply, theCopy);
+        QObject::connect(theReply, SIGNAL(finished()), this, SLOT(sourceCopied()));
+        return theReply;
+    });
+}
+
+void ContentIndex::sourceCopied()
+{
+    QNetworkReply * theReply = qobject_cast<QNetworkReply *>(sender());
+    if (!pendingCopies.contains(theReply)) return;
+    PendingCopy theCopy = pendingCopies.take(theReply);
+    theReply->deleteLater();
+
+    if (theReply->error() != QNetworkReply::NoError)
+    {
+        qCDebug(agaveAppLayer, "Copy of indexed content failed: %s", qPrintable(theCopy.sourcePath));
+        if (!RequestRetry::classifyReply(theReply).retryable) forgetContent(theCopy.hexHash, theCopy.sourcePath);
+        tryNextSource(theCopy);
+        return;
+    }
+
+    qCDebug(agaveAppLayer, "Copied %lld bytes on the server instead of uploading: %s", theCopy.fileSize, qPrintable(theCopy.destPath));
+    recordContent(theCopy.hexHash, theCopy.fileSize, theCopy.destPath);
+    emit contentCopied(theCopy.destPath, true);
+}
@@ -0,0 +1,132 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef CONTENTINDEX_H
+#define CONTENTINDEX_H
+
+#include <QObject>
+#include <QMap>
+#include <QStringList>
+#include <QTimer>
+
+class QNetworkReply;
+enum class RequestState;
+
+/*! \brief The ContentIndex remembers where on the remote system the user already has a copy of some content, by its SHA-256, so that the content can be copied there instead of uploaded again.
+ *
+ *  The index is kept in a JSON file in the home folder of the user, so it carries over between sessions and machines. It is read by openIndex(), and written back a few seconds after each change.
+ *  Lookups before the index is read find nothing, and entries recorded before then are kept alongside those read.
+ *
+ *  A remote copy may have been changed or deleted since it was recorded. Before copying, the size of the copy is checked against the listing, and a copy which fails either way is dropped from the index.
+ *  Only uploads of at least minContentSize bytes are worth the extra requests.
+ *
+ *  Two sessions of the same user which change the index at the same time may each lose the other's entries. This costs only a later upload.
+ */
+class ContentIndex : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ContentIndex(QObject * parent = nullptr);
+
+    /*! \brief Reads the index of the given user. The indexOpened() signal is emitted once it is read.
+     */
+    void openIndex(QString userName);
+    bool isOpen();
+    QString getIndexPath();
+
+    /*! \brief Returns true if the index has at least one remote copy of content with this hash and size.
+     */
+    bool hasContent(QByteArray hexHash, qint64 fileSize);
+    /*! \brief Records that the remote file at remotePath holds content with this hash and size.
+     */
+    void recordContent(QByteArray hexHash, qint64 fileSize, QString remotePath);
+    void forgetContent(QByteArray hexHash, QString remotePath);
+
+    /*! \brief Begins a server-side copy of content with this hash to destPath, trying each known copy in turn.
+     *
+     *  The contentCopied() signal gives the result. If it is false, the content should be uploaded instead.
+     */
+    void copyContent(QByteArray hexHash, qint64 fileSize, QString destPath);
+
+    static const qint64 minContentSize = 1024 * 1024;
+    static const int maxCopiesKept = 4;
+    static const int saveDelayMs = 5000;
+
+signals:
+    void indexOpened(RequestState finalState);
+    void contentCopied(QString destPath, bool copied);
+
+private slots:
+    void indexFetched();
+    void saveIndex();
+    void indexFolderMade();
+    void indexSaved();
+    void sourceChecked();
+    void sourceCopied();
+
+private:
+    struct ContentEntry
+    {
+        qint64 fileSize = 0;
+        QStringList remotePaths;
+    };
+
+    struct PendingCopy
+    {
+        QByteArray hexHash;
+        qint64 fileSize = 0;
+        QString destPath;
+        QString sourcePath;
+        QStringList candidates;
+    };
+
+    void tryNextSource(PendingCopy theCopy);
+    void scheduleSave();
+
+    QString indexFolder;
+    QMap<QByteArray, ContentEntry> contentEntries;
+    QMap<QNetworkReply *, PendingCopy> pendingCopies;
+
+    bool indexRead = false;
+    bool indexReadable = false;
+    bool folderMade = false;
+    bool saveRunning = false;
+    bool saveAgain = false;
+    QTimer saveTimer;
+
+    static const QString indexFileName;
+};
+
+#endif // CONTENTINDEX_H
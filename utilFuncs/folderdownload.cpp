@@ -0,0 +1,200 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "folderdownload.h"
+
+#include "streamingdownload.h"
+#include "streamhasher.h"
+#include "remotetreecrawler.h"
+#include "remotedatainterface.h"
+#include "ae_globals.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QRegExp>
+
+FolderDownload::FolderDownload(QString remoteFolder, QString localDest, QObject * parent) : BulkTransfer(parent)
+{
+    while ((remoteFolder.length() > 1) && remoteFolder.endsWith('/'))
+    {
+        remoteFolder.chop(1);
+    }
+    myRemoteFolder = remoteFolder;
+    myLocalDest = localDest;
+}
+
+bool FolderDownload::startTransfer()
+{
+    if (!ae_globals::isExtantLocalFolder(myLocalDest)) return false;
+
+    QDir destDir(myLocalDest);
+    QString folderName = myRemoteFolder.section('/', -1);
+    if (folderName.isEmpty() || !destDir.mkpath(folderName)) return false;
+    localRoot = destDir.absoluteFilePath(folderName);
+    setChecksumManifest(localRoot + "." + StreamHasher::algorithmName(), localRoot);
+
+    RemoteTreeCrawler * theCrawler = new RemoteTreeCrawler(myRemoteFolder, nullptr, this);
+    QObject::connect(theCrawler, SIGNAL(folderListed(QString,QList<FileMetaData>,FileSizeMap)),
+                     this, SLOT(folderListed(QString,QList<FileMetaData>,FileSizeMap)));
+    QObject::connect(theCrawler, SIGNAL(crawlDone(RequestState,int)),
+                     this, SLOT(crawlDone(RequestState,int)));
+    if (!theCrawler->startCrawl())
+    {
+        theCrawler->deleteLater();
+        return false;
+    }
+    return true;
+}
+
+void FolderDownload::setFileFilter(QStringList includePatterns, QStringList excludePatterns)
+{
+    myIncludePatterns = includePatterns;
+    myExcludePatterns = excludePatterns;
+}
+
+void FolderDownload::setSkipExistingFiles(bool skipExisting)
+{
+    skipExistingFiles = skipExisting;
+}
+
+int FolderDownload::getFilesSkipped()
+{
+    return filesSkipped;
+}
+
+void FolderDownload::folderListed(QString, QList<FileMetaData> folderContents, FileSizeMap fileSizes)
+{
+    for (const FileMetaData &anEntry : folderContents)
+    {
+        QString localPath = getLocalPathFor(anEntry.getFullPath());
+        if (localPath.isEmpty()) continue;
+
+        if (anEntry.getFileType() == FileType::DIR)
+        {
+            QDir().mkpath(localPath);
+        }
+        else if (anEntry.getFileType() == FileType::FILE)
+        {
+            if (!fileIsWanted(anEntry.getFullPath())) continue;
+
+            qint64 remoteSize = fileSizes.value(anEntry.getFullPath(), -1);
+            QFileInfo localFile(localPath);
+            if (skipExistingFiles && (remoteSize >= 0) && localFile.isFile() && (localFile.size() == remoteSize))
+            {
+                filesSkipped++;
+                continue;
+            }
+
+            TransferUnit newUnit;
+            newUnit.remotePath = anEntry.getFullPath();
+            newUnit.localPath = localPath;
+            newUnit.fileSize = remoteSize;
+            enqueueUnit(newUnit);
+        }
+    }
+}
+
+void FolderDownload::crawlDone(RequestState finalState, int)
+{
+    if (filesSkipped > 0)
+    {
+        qCDebug(agaveAppLayer, "%d files of %s already present locally", filesSkipped, qPrintable(myRemoteFolder));
+    }
+    setPlanningDone(finalState == RequestState::GOOD);
+}
+
+void FolderDownload::fileDownloadDone(RequestState finalState, QString, qint64 bytesWritten)
+{
+    StreamingDownload * theDownload = qobject_cast<StreamingDownload *>(sender());
+    if (!runningDownloads.contains(theDownload)) return;
+
+    int unitId = runningDownloads.take(theDownload);
+    unitList[unitId].contentHash = theDownload->getContentHash();
+    unitComplete(unitId, finalState == RequestState::GOOD, bytesWritten, theDownload->getFailureHint());
+}
+
+bool FolderDownload::launchUnit(int unitId)
+{
+    const TransferUnit &theUnit = unitList.at(unitId);
+
+    StreamingDownload * theDownload = new StreamingDownload(theUnit.remotePath, theUnit.localPath, this);
+    theDownload->setExpectedSize(theUnit.fileSize);
+    QObject::connect(theDownload, SIGNAL(downloadDone(RequestState,QString,qint64)),
+                     this, SLOT(fileDownloadDone(RequestState,QString,qint64)));
+    if (!theDownload->startDownload())
+    {
+        theDownload->deleteLater();
+        return false;
+    }
+    runningDownloads.insert(theDownload, unitId);
+    return true;
+}
+
+void FolderDownload::abortRunningUnits()
+{
+    QList<StreamingDownload *> toCancel = runningDownloads.keys();
+    runningDownloads.clear();
+    for (StreamingDownload * aDownload : toCancel)
+    {
+        aDownload->cancelDownload();
+    }
+}
+
+QString FolderDownload::getLocalPathFor(QString remotePath)
+{
+    if (!remotePath.startsWith(myRemoteFolder + "/")) return QString();
+
+    QString relativePath = remotePath.mid(myRemoteFolder.length() + 1);
+    return QDir(localRoot).absoluteFilePath(relativePath);
+}
+
+bool FolderDownload::fileIsWanted(QString remotePath)
+{
+    QString relativePath = remotePath.mid(myRemoteFolder.length() + 1);
+
+    if (!myIncludePatterns.isEmpty() && !matchesAnyPattern(relativePath, myIncludePatterns)) return false;
+    return !matchesAnyPattern(relativePath, myExcludePatterns);
+}
+
+bool FolderDownload::matchesAnyPattern(QString relativePath, const QStringList &patternList)
+{
+    QString fileName = relativePath.section('/', -1);
+    for (const QString &aPattern : patternList)
+    {
+        QRegExp wildcardMatch(aPattern, Qt::CaseSensitive, QRegExp::Wildcard);
+        if (wildcardMatch.exactMatch(aPattern.contains('/') ? relativePath : fileName)) return true;
+    }
+    return false;
+}
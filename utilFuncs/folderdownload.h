@@ -0,0 +1,108 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef FOLDERDOWNLOAD_H
+#define FOLDERDOWNLOAD_H
+
+#include "bulktransfer.h"
+
+#include <QMap>
+#include <QStringList>
+
+#include "filemetadata.h"
+#include "pagedfolderlister.h"
+
+class StreamingDownload;
+
+/*! \brief The FolderDownload copies a remote folder, and everything in it, into a local folder.
+ *
+ *  The remote folder is listed with a RemoteTreeCrawler, and each file is copied with a StreamingDownload as soon as its folder is listed.
+ *  No file is held whole in memory.
+ *
+ *  Files can be picked out with wildcard patterns, and local files which already match the remote files can be left alone.
+ */
+class FolderDownload : public BulkTransfer
+{
+    Q_OBJECT
+public:
+    /*! \brief Constructs a new FolderDownload.
+     *
+     *  \param remoteFolder Full path of the remote folder to download
+     *  \param localDest An existing local folder. A folder with the name of the remote folder is created inside it.
+     *  \param parent The object requesting the download is typically the parent
+     */
+    explicit FolderDownload(QString remoteFolder, QString localDest, QObject * parent = nullptr);
+
+    virtual bool startTransfer();
+
+    /*! \brief Limits the download to some of the files in the folder. Must be called before startTransfer().
+     *
+     *  Patterns are wildcards, such as "*.vtk". A pattern with a '/' is matched against the path of the file within the folder, others against the file name alone.
+     *
+     *  \param includePatterns Only files matching one of these are downloaded. If empty, all files are.
+     *  \param excludePatterns Files matching one of these are not downloaded.
+     */
+    void setFileFilter(QStringList includePatterns, QStringList excludePatterns);
+    /*! \brief If set, files which already exist locally, with the same size as the remote file, are not downloaded again.
+     */
+    void setSkipExistingFiles(bool skipExisting);
+    int getFilesSkipped();
+
+private slots:
+    void folderListed(QString folderPath, QList<FileMetaData> folderContents, FileSizeMap fileSizes);
+    void crawlDone(RequestState finalState, int foldersListed);
+    void fileDownloadDone(RequestState finalState, QString localPath, qint64 bytesWritten);
+
+protected:
+    virtual bool launchUnit(int unitId);
+    virtual void abortRunningUnits();
+
+    QString getLocalPathFor(QString remotePath);
+    bool fileIsWanted(QString remotePath);
+    static bool matchesAnyPattern(QString relativePath, const QStringList &patternList);
+
+    QString myRemoteFolder;
+    QString myLocalDest;
+    QString localRoot;
+
+    QMap<StreamingDownload *, int> runningDownloads;
+
+    QStringList myIncludePatterns;
+    QStringList myExcludePatterns;
+    bool skipExistingFiles = false;
+    int filesSkipped = 0;
+};
+
+#endif // FOLDERDOWNLOAD_H
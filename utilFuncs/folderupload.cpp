@@ -0,0 +1,325 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "folderupload.h"
+
+#include "agaverestlink.h"
+#include "requestscheduler.h"
+#include "requestretry.h"
+#include "streamhasher.h"
+#include "contentindex.h"
+#include "remotedatainterface.h"
+#include "ae_globals.h"
+
+#include <QDirIterator>
+#include <QNetworkReply>
+#include <QFileInfo>
+#include <QDir>
+
+FolderUpload::FolderUpload(QString localFolder, QString remoteDest, QObject * parent) : BulkTransfer(parent)
+{
+    myLocalFolder = QDir(localFolder).absolutePath();
+    while ((remoteDest.length() > 1) && remoteDest.endsWith('/'))
+    {
+        remoteDest.chop(1);
+    }
+    myRemoteDest = remoteDest;
+}
+
+bool FolderUpload::startTransfer()
+{
+    if (!ae_globals::isExtantLocalFolder(myLocalFolder)) return false;
+
+    AgaveRestLink * theLink = ae_globals::get_rest_link();
+    if ((theLink == nullptr) || (!theLink->credentialsAvailable())) return false;
+
+    QString folderName = QDir(myLocalFolder).dirName();
+    if (folderName.isEmpty() || myRemoteDest.isEmpty()) return false;
+    remoteRoot = myRemoteDest;
+    if (!remoteRoot.endsWith('/')) remoteRoot.append('/');
+    remoteRoot.append(folderName);
+    setChecksumManifest(myLocalFolder + "." + StreamHasher::algorithmName(), myLocalFolder);
+
+    foldersByDepth.append(QStringList(myLocalFolder));
+    QDirIterator folderSearch(myLocalFolder, QDir::Dirs | QDir::Hidden | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+    while (folderSearch.hasNext())
+    {
+        QString aFolder = folderSearch.next();
+        int folderDepth = aFolder.mid(myLocalFolder.length()).count('/');
+        while (foldersByDepth.size() <= folderDepth)
+        {
+            foldersByDepth.append(QStringList());
+        }
+        foldersByDepth[folderDepth].append(aFolder);
+    }
+
+    makeNextFolderLevel();
+    return true;
+}
+
+void FolderUpload::setContentIndex(ContentIndex * theIndex, bool recordUploads)
+{
+    if (contentIndex != nullptr) QObject::disconnect(contentIndex, nullptr, this, nullptr);
+    contentIndex = theIndex;
+    recordToIndex = recordUploads;
+    if (contentIndex != nullptr)
+    {
+        QObject::connect(contentIndex, SIGNAL(contentCopied(QString,bool)), this, SLOT(contentCopied(QString,bool)));
+    }
+}
+
+void FolderUpload::folderMade()
+{
+    QNetworkReply * theReply = qobject_cast<QNetworkReply *>(sender());
+    if (uploadsAborted || !pendingFolders.contains(theReply)) return;
+
+    QString localPath = pendingFolders.take(theReply);
+    theReply->deleteLater();
+
+    //Making a folder which is already there, as on a resumed upload, may be reported as an error.
+    //The uploads into the folder will fail on their own if the folder is really missing.
+    if (theReply->error() != QNetworkReply::NoError)
+    {
+        qCDebug(agaveAppLayer, "Remote folder not made for upload: %s", qPrintable(getRemotePathFor(localPath)));
+    }
+    enqueueFilesOf(localPath);
+
+    foldersOutstanding--;
+    if (foldersOutstanding == 0)
+    {
+        makeNextFolderLevel();
+    }
+}
+
+void FolderUpload::fileUploadDone()
+{
+    QNetworkReply * theReply = qobject_cast<QNetworkReply *>(sender());
+    if (!runningUploads.contains(theReply)) return;
+
+    int unitId = runningUploads.take(theReply);
+    StreamHasher * theHasher = unitHashers.value(unitId, nullptr);
+    theReply->deleteLater();
+
+    if (theReply->error() != QNetworkReply::NoError)
+    {
+        unitHashers.remove(unitId);
+        if (theHasher != nullptr) theHasher->deleteLater();
+        unitComplete(unitId, false, 0, RequestRetry::classifyReply(theReply));
+        return;
+    }
+
+    //The unit is complete once the last bytes sent are hashed
+    theHasher->finishData();
+}
+
+void FolderUpload::uploadHashed(QByteArray hexHash)
+{
+    StreamHasher * theHasher = qobject_cast<StreamHasher *>(sender());
+    int unitId = unitHashers.key(theHasher, -1);
+    if (unitId == -1) return;
+
+    unitHashers.remove(unitId);
+    theHasher->deleteLater();
+
+    unitList[unitId].contentHash = hexHash;
+    if ((contentIndex != nullptr) && recordToIndex && (unitList.at(unitId).fileSize >= ContentIndex::minContentSize))
+    {
+        contentIndex->recordContent(hexHash, unitList.at(unitId).fileSize, unitList.at(unitId).remotePath);
+    }
+    unitComplete(unitId, true, unitList.at(unitId).fileSize);
+}
+
+void FolderUpload::localFileHashed(QByteArray hexHash)
+{
+    StreamHasher * theHasher = qobject_cast<StreamHasher *>(sender());
+    if (!localHashers.contains(theHasher)) return;
+
+    int unitId = localHashers.take(theHasher);
+    theHasher->deleteLater();
+    if (uploadsAborted) return;
+
+    if (hexHash.isEmpty())
+    {
+        unitComplete(unitId, false, 0);
+        return;
+    }
+
+    qint64 fileSize = unitList.at(unitId).fileSize;
+    QString remotePath = unitList.at(unitId).remotePath;
+    if ((contentIndex == nullptr) || !contentIndex->hasContent(hexHash, fileSize))
+    {
+        startUpload(unitId);
+        return;
+    }
+
+    unitList[unitId].contentHash = hexHash;
+    pendingCopies.insert(remotePath, unitId);
+    contentIndex->copyContent(hexHash, fileSize, remotePath);
+}
+
+void FolderUpload::contentCopied(QString destPath, bool copied)
+{
+    if (uploadsAborted || !pendingCopies.contains(destPath)) return;
+    int unitId = pendingCopies.take(destPath);
+
+    //If no known copy could be used, the file is uploaded after all
+    if (!copied)
+    {
+        startUpload(unitId);
+        return;
+    }
+    unitComplete(unitId, true, unitList.at(unitId).fileSize);
+}
+
+bool FolderUpload::launchUnit(int unitId)
+{
+    //Large files are hashed first, in parallel on the hashing pool, to see whether the server already has them
+    const TransferUnit &indexedUnit = unitList.at(unitId);
+    if ((contentIndex != nullptr) && contentIndex->isOpen() && (indexedUnit.fileSize >= ContentIndex::minContentSize))
+    {
+        StreamHasher * theHasher = new StreamHasher(this);
+        localHashers.insert(theHasher, unitId);
+        QObject::connect(theHasher, SIGNAL(hashReady(QByteArray)), this, SLOT(localFileHashed(QByteArray)));
+        theHasher->hashLocalFile(indexedUnit.localPath);
+        return true;
+    }
+
+    startUpload(unitId);
+    return true;
+}
+
+void FolderUpload::startUpload(int unitId)
+{
+    TransferUnit theUnit = unitList.at(unitId);
+    QString remoteFolder = theUnit.remotePath.section('/', 0, -2);
+
+    ae_globals::get_rest_link()->getScheduler()->scheduleRequest(RequestPriority::BULK, this, [this, unitId, theUnit, remoteFolder]()
+    {
+        if (uploadsAborted) return (QNetworkReply *) nullptr;
+
+        StreamHasher * theHasher = new StreamHasher(this);
+        QNetworkReply * theReply = ae_globals::get_rest_link()->requestFileUpload(theUnit.localPath, remoteFolder, theHasher);
+        if (theReply == nullptr)
+        {
+            delete theHasher;
+            unitComplete(unitId, false, 0);
+            return theReply;
+        }
+
+        QObject::connect(theHasher, SIGNAL(hashReady(QByteArray)), this, SLOT(uploadHashed(QByteArray)));
+        unitHashers.insert(unitId, theHasher);
+        runningUploads.insert(theReply, unitId);
+        QObject::connect(theReply, SIGNAL(finished()), this, SLOT(fileUploadDone()));
+        return theReply;
+    });
+}
+
+void FolderUpload::abortRunningUnits()
+{
+    uploadsAborted = true;
+    QList<QNetworkReply *> toAbort = pendingFolders.keys() + runningUploads.keys();
+    pendingFolders.clear();
+    runningUploads.clear();
+    for (StreamHasher * aHasher : unitHashers)
+    {
+        aHasher->deleteLater();
+    }
+    unitHashers.clear();
+    for (StreamHasher * aHasher : localHashers.keys())
+    {
+        aHasher->deleteLater();
+    }
+    localHashers.clear();
+    pendingCopies.clear();
+    foldersByDepth.clear();
+    for (QNetworkReply * aReply : toAbort)
+    {
+        aReply->abort();
+        aReply->deleteLater();
+    }
+}
+
+void FolderUpload::makeNextFolderLevel()
+{
+    if (uploadsAborted) return;
+    if (foldersByDepth.isEmpty())
+    {
+        setPlanningDone(true);
+        return;
+    }
+
+    QStringList folderLevel = foldersByDepth.takeFirst();
+    foldersOutstanding = folderLevel.size();
+
+    for (const QString &aFolder : folderLevel)
+    {
+        ae_globals::get_rest_link()->getScheduler()->scheduleRequest(RequestPriority::BACKGROUND, this, [this, aFolder]()
+        {
+            if (uploadsAborted) return (QNetworkReply *) nullptr;
+
+            QString remotePath = getRemotePathFor(aFolder);
+            QNetworkReply * theReply = ae_globals::get_rest_link()->requestMakeFolder(remotePath.section('/', 0, -2), remotePath.section('/', -1));
+            if (theReply == nullptr)
+            {
+                foldersByDepth.clear();
+                setPlanningDone(false);
+                return theReply;
+            }
+
+            pendingFolders.insert(theReply, aFolder);
+            QObject::connect(theReply, SIGNAL(finished()), this, SLOT(folderMade()));
+            return theReply;
+        });
+    }
+}
+
+void FolderUpload::enqueueFilesOf(QString localPath)
+{
+    for (const QFileInfo &aFile : QDir(localPath).entryInfoList(QDir::Files | QDir::Hidden))
+    {
+        TransferUnit newUnit;
+        newUnit.localPath = aFile.absoluteFilePath();
+        newUnit.remotePath = getRemotePathFor(newUnit.localPath);
+        newUnit.fileSize = aFile.size();
+        enqueueUnit(newUnit);
+    }
+}
+
+QString FolderUpload::getRemotePathFor(QString localPath)
+{
+    QString ret = remoteRoot;
+    ret.append(localPath.mid(myLocalFolder.length()));
+    return ret;
+}
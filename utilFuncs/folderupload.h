@@ -0,0 +1,107 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef FOLDERUPLOAD_H
+#define FOLDERUPLOAD_H
+
+#include "bulktransfer.h"
+
+#include <QMap>
+#include <QStringList>
+
+class QNetworkReply;
+class StreamHasher;
+class ContentIndex;
+
+/*! \brief The FolderUpload copies a local folder, and everything in it, into a remote folder.
+ *
+ *  Remote folders are made one level at a time, and the files of each folder are uploaded as soon as their remote folder exists.
+ *  Each file is read from disk as it is sent, and is not held whole in memory. Its checksum is computed from the same bytes, as they are sent.
+ *
+ *  If a ContentIndex is set, large files are hashed before they are sent, and content which the index already knows is copied on the server instead.
+ */
+class FolderUpload : public BulkTransfer
+{
+    Q_OBJECT
+public:
+    /*! \brief Constructs a new FolderUpload.
+     *
+     *  \param localFolder Full path of the local folder to upload
+     *  \param remoteDest Full path of an existing remote folder. A folder with the name of the local folder is made inside it.
+     *  \param parent The object requesting the upload is typically the parent
+     */
+    explicit FolderUpload(QString localFolder, QString remoteDest, QObject * parent = nullptr);
+
+    virtual bool startTransfer();
+
+    /*! \brief Sets an index of remote content, through which large files already on the remote system are copied instead of uploaded.
+     *
+     *  If recordUploads is true, files which are uploaded are added to the index. It should be false if the upload is to be moved once done.
+     */
+    void setContentIndex(ContentIndex * theIndex, bool recordUploads = true);
+
+private slots:
+    void folderMade();
+    void fileUploadDone();
+    void uploadHashed(QByteArray hexHash);
+    void localFileHashed(QByteArray hexHash);
+    void contentCopied(QString destPath, bool copied);
+
+protected:
+    virtual bool launchUnit(int unitId);
+    virtual void abortRunningUnits();
+
+    void startUpload(int unitId);
+    void makeNextFolderLevel();
+    void enqueueFilesOf(QString localPath);
+    QString getRemotePathFor(QString localPath);
+
+    QString myLocalFolder;
+    QString myRemoteDest;
+    QString remoteRoot;
+
+    QList<QStringList> foldersByDepth;
+    QMap<QNetworkReply *, QString> pendingFolders;
+    QMap<QNetworkReply *, int> runningUploads;
+    QMap<int, StreamHasher *> unitHashers;
+    QMap<StreamHasher *, int> localHashers;
+    QMap<QString, int> pendingCopies;
+    ContentIndex * contentIndex = nullptr;
+    bool recordToIndex = true;
+    int foldersOutstanding = 0;
+    bool uploadsAborted = false;
+};
+
+#endif // FOLDERUPLOAD_H
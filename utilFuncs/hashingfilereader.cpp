@@ -0,0 +1,100 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "hashingfilereader.h"
+
+#include "streamhasher.h"
+
+HashingFileReader::HashingFileReader(QString fileName, StreamHasher * theHasher, QObject * parent) :
+    QIODevice(parent), sourceFile(fileName)
+{
+    myHasher = theHasher;
+}
+
+bool HashingFileReader::open(OpenMode mode)
+{
+    if (mode != QIODevice::ReadOnly) return false;
+    if (!sourceFile.open(QIODevice::ReadOnly)) return false;
+    return QIODevice::open(mode);
+}
+
+void HashingFileReader::close()
+{
+    sourceFile.close();
+    QIODevice::close();
+}
+
+bool HashingFileReader::isSequential() const
+{
+    return false;
+}
+
+qint64 HashingFileReader::size() const
+{
+    return sourceFile.size();
+}
+
+bool HashingFileReader::seek(qint64 pos)
+{
+    if (!sourceFile.seek(pos)) return false;
+    return QIODevice::seek(pos);
+}
+
+bool HashingFileReader::atEnd() const
+{
+    return sourceFile.atEnd() && QIODevice::atEnd();
+}
+
+qint64 HashingFileReader::readData(char * data, qint64 maxSize)
+{
+    qint64 readStart = sourceFile.pos();
+    qint64 ret = sourceFile.read(data, maxSize);
+    if (ret <= 0) return ret;
+
+    //Only bytes past what was already hashed are new
+    qint64 readEnd = readStart + ret;
+    if ((readEnd > hashedUpTo) && (readStart <= hashedUpTo) && (myHasher != nullptr))
+    {
+        qint64 newOffset = hashedUpTo - readStart;
+        myHasher->addData(QByteArray(data + newOffset, int(readEnd - hashedUpTo)));
+        hashedUpTo = readEnd;
+    }
+    return ret;
+}
+
+qint64 HashingFileReader::writeData(const char *, qint64)
+{
+    return -1;
+}
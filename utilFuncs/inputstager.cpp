@@ -0,0 +1,481 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "inputstager.h"
+
+#include "streamhasher.h"
+#include "pagedfolderlister.h"
+#include "folderupload.h"
+#include "contentindex.h"
+#include "agaverestlink.h"
+#include "requestscheduler.h"
+#include "remotedatainterface.h"
+#include "ae_globals.h"
+
+#include <QNetworkReply>
+#include <QCryptographicHash>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QDir>
+
+InputStager::InputStager(QString stagingFolder, QObject * parent) : QObject(parent)
+{
+    while ((stagingFolder.length() > 1) && stagingFolder.endsWith('/'))
+    {
+        stagingFolder.chop(1);
+    }
+    myStagingFolder = stagingFolder;
+}
+
+QString InputStager::getStagingFolder()
+{
+    return myStagingFolder;
+}
+
+void InputStager::setContentIndex(ContentIndex * theIndex)
+{
+    if (contentIndex != nullptr) QObject::disconnect(contentIndex, nullptr, this, nullptr);
+    contentIndex = theIndex;
+    if (contentIndex != nullptr)
+    {
+        QObject::connect(contentIndex, SIGNAL(contentCopied(QString,bool)), this, SLOT(contentCopied(QString,bool)));
+    }
+}
+
+void InputStager::stageInputs(int ticket, QStringList localPaths)
+{
+    for (const QString &aPath : localPaths)
+    {
+        QFileInfo localInfo(aPath);
+        QString localPath = localInfo.absoluteFilePath();
+        if (stagedContent.contains(localPath) && (stagedContent.value(localPath).state != ContentState::FAILED)) continue;
+
+        StagedContent newContent;
+        newContent.isFolder = localInfo.isDir();
+        if (!localInfo.exists())
+        {
+            qCDebug(agaveAppLayer, "Local job input not found: %s", qPrintable(localPath));
+            newContent.state = ContentState::FAILED;
+            stagedContent.insert(localPath, newContent);
+            continue;
+        }
+
+        //A folder is hashed file by file, and the file hashes are then combined
+        QStringList filesToHash;
+        if (newContent.isFolder)
+        {
+            QDirIterator folderItr(localPath, QDir::Files | QDir::Hidden, QDirIterator::Subdirectories);
+            while (folderItr.hasNext())
+            {
+                filesToHash.append(folderItr.next());
+            }
+        }
+        else
+        {
+            filesToHash.append(localPath);
+        }
+        newContent.hashesOutstanding = filesToHash.size();
+        stagedContent.insert(localPath, newContent);
+
+        for (const QString &aFile : filesToHash)
+        {
+            StreamHasher * theHasher = new StreamHasher(this);
+            runningHashers.insert(theHasher, qMakePair(localPath, aFile));
+            QObject::connect(theHasher, SIGNAL(hashReady(QByteArray)), this, SLOT(fileHashed(QByteArray)));
+            theHasher->hashLocalFile(aFile);
+        }
+        if (filesToHash.isEmpty()) contentHashed(localPath);
+    }
+
+    waitingBatches.insert(ticket, localPaths);
+    startListing();
+    checkBatches();
+}
+
+void InputStager::fileHashed(QByteArray hexHash)
+{
+    StreamHasher * theHasher = qobject_cast<StreamHasher *>(sender());
+    if (!runningHashers.contains(theHasher)) return;
+    QPair<QString, QString> hashedFile = runningHashers.take(theHasher);
+    theHasher->deleteLater();
+
+    QString localPath = hashedFile.first;
+    StagedContent &theContent = stagedContent[localPath];
+    if (theContent.state != ContentState::HASHING) return;
+
+    if (hexHash.isEmpty())
+    {
+        qCDebug(agaveAppLayer, "Unable to read local job input: %s", qPrintable(hashedFile.second));
+        contentDone(localPath, false);
+        return;
+    }
+
+    theContent.fileHashes.insert(QDir(localPath).relativeFilePath(hashedFile.second), hexHash);
+    theContent.hashesOutstanding--;
+    if (theContent.hashesOutstanding == 0) contentHashed(localPath);
+}
+
+void InputStager::stagingListed(RequestState finalState, QString, QList<FileMetaData> allEntries)
+{
+    if (finalState == RequestState::GOOD)
+    {
+        for (const FileMetaData &anEntry : allEntries)
+        {
+            QString entryName = anEntry.getFullPath().section('/', -1);
+            if ((anEntry.getFileType() != FileType::DIR) || entryName.endsWith(".partial")) continue;
+            stagedHashes.insert(entryName.toLatin1());
+        }
+        stagingReady = true;
+        startWaitingUploads();
+        return;
+    }
+
+    //The staging folder is most likely missing, and is made before anything is uploaded into it
+    ae_globals::get_rest_link()->getScheduler()->scheduleRequest(RequestPriority::BULK, this, [this]()
+    {
+        QNetworkReply * theReply = ae_globals::get_rest_link()->requestMakeFolder(myStagingFolder.section('/', 0, -2), myStagingFolder.section('/', -1));
+        if (theReply == nullptr)
+        {
+            stagingReady = true;
+            startWaitingUploads();
+            return theReply;
+        }
+        QObject::connect(theReply, SIGNAL(finished()), this, SLOT(stagingFolderMade()));
+        return theReply;
+    });
+}
+
+void InputStager::stagingFolderMade()
+{
+    QNetworkReply * theReply = qobject_cast<QNetworkReply *>(sender());
+    if (theReply == nullptr) return;
+    theReply->deleteLater();
+
+    //If the folder was not made, the uploads into it will fail on their own
+    if (theReply->error() != QNetworkReply::NoError)
+    {
+        qCDebug(agaveAppLayer, "Staging folder not made: %s", qPrintable(myStagingFolder));
+    }
+    stagingReady = true;
+    startWaitingUploads();
+}
+
+void InputStager::partialFolderMade()
+{
+    QNetworkReply * theReply = qobject_cast<QNetworkReply *>(sender());
+    if (!pendingReplies.contains(theReply)) return;
+    QString localPath = pendingReplies.take(theReply);
+    theReply->deleteLater();
+
+    //A partial folder left by an earlier, failed, upload may already be there, so an error here is not a failure
+    QString partialFolder = getPartialFolder(localPath);
+    if (stagedContent.value(localPath).isFolder)
+    {
+        FolderUpload * theUpload = new FolderUpload(localPath, partialFolder, this);
+        //The upload is renamed once done, so its paths are recorded from here instead
+        if (contentIndex != nullptr) theUpload->setContentIndex(contentIndex, false);
+        theUpload->setMaxInFlight(ae_globals::get_rest_link()->getScheduler()->getClassMaxLimit(RequestPriority::BULK));
+        QObject::connect(theUpload, SIGNAL(transferDone(RequestState,int,int)), this, SLOT(folderUploadDone(RequestState,int,int)));
+        if (!theUpload->startTransfer())
+        {
+            QObject::disconnect(theUpload, nullptr, this, nullptr);
+            theUpload->cancelTransfer();
+            contentDone(localPath, false);
+            return;
+        }
+        runningFolderUploads.insert(theUpload, localPath);
+        return;
+    }
+
+    QByteArray contentHash = stagedContent.value(localPath).contentHash;
+    qint64 fileSize = QFileInfo(localPath).size();
+    if ((contentIndex != nullptr) && (fileSize >= ContentIndex::minContentSize) && contentIndex->hasContent(contentHash, fileSize))
+    {
+        QString destPath = QString("%1/%2").arg(partialFolder, QFileInfo(localPath).fileName());
+        pendingCopies.insert(destPath, localPath);
+        contentIndex->copyContent(contentHash, fileSize, destPath);
+        return;
+    }
+    uploadStagedFile(localPath);
+}
+
+void InputStager::contentCopied(QString destPath, bool copied)
+{
+    if (!pendingCopies.contains(destPath)) return;
+    QString localPath = pendingCopies.take(destPath);
+
+    //If no known copy could be used, the file is uploaded after all
+    if (!copied)
+    {
+        uploadStagedFile(localPath);
+        return;
+    }
+    renamePartialFolder(localPath);
+}
+
+void InputStager::uploadStagedFile(QString localPath)
+{
+    QString partialFolder = getPartialFolder(localPath);
+    ae_globals::get_rest_link()->getScheduler()->scheduleRequest(RequestPriority::BULK, this, [this, localPath, partialFolder]()
+    {
+        QNetworkReply * theReply = ae_globals::get_rest_link()->requestFileUpload(localPath, partialFolder);
+        if (theReply == nullptr)
+        {
+            contentDone(localPath, false);
+            return theReply;
+        }
+        pendingReplies.insert(theReply, localPath);
+        QObject::connect(theReply, SIGNAL(finished()), this, SLOT(fileUploadDone()));
+        return theReply;
+    });
+}
+
+void InputStager::fileUploadDone()
+{
+    QNetworkReply * theReply = qobject_cast<QNetworkReply *>(sender());
+    if (!pendingReplies.contains(theReply)) return;
+    QString localPath = pendingReplies.take(theReply);
+    theReply->deleteLater();
+
+    if (theReply->error() != QNetworkReply::NoError)
+    {
+        qCDebug(agaveAppLayer, "Upload of job input failed: %s", qPrintable(localPath));
+        contentDone(localPath, false);
+        return;
+    }
+    renamePartialFolder(localPath);
+}
+
+void InputStager::folderUploadDone(RequestState finalState, int, int unitsFailed)
+{
+    if (!runningFolderUploads.contains(sender())) return;
+    QString localPath = runningFolderUploads.take(sender());
+
+    if (finalState != RequestState::GOOD)
+    {
+        qCDebug(agaveAppLayer, "Upload of job input folder failed, %d files not sent: %s", unitsFailed, qPrintable(localPath));
+        contentDone(localPath, false);
+        return;
+    }
+    renamePartialFolder(localPath);
+}
+
+void InputStager::renamePartialFolder(QString localPath)
+{
+    ae_globals::get_rest_link()->getScheduler()->scheduleRequest(RequestPriority::BULK, this, [this, localPath]()
+    {
+        QNetworkReply * theReply = ae_globals::get_rest_link()->requestFileAction(getPartialFolder(localPath), "rename",
+                                                                                 QString::fromLatin1(stagedContent.value(localPath).contentHash));
+        if (theReply == nullptr)
+        {
+            contentDone(localPath, false);
+            return theReply;
+        }
+        pendingReplies.insert(theReply, localPath);
+        QObject::connect(theReply, SIGNAL(finished()), this, SLOT(partialFolderRenamed()));
+        return theReply;
+    });
+}
+
+void InputStager::partialFolderRenamed()
+{
+    QNetworkReply * theReply = qobject_cast<QNetworkReply *>(sender());
+    if (!pendingReplies.contains(theReply)) return;
+    QString localPath = pendingReplies.take(theReply);
+    theReply->deleteLater();
+
+    if (theReply->error() != QNetworkReply::NoError)
+    {
+        qCDebug(agaveAppLayer, "Staged job input could not be completed: %s", qPrintable(localPath));
+        contentDone(localPath, false);
+        return;
+    }
+    stagedHashes.insert(stagedContent.value(localPath).contentHash);
+    recordStagedContent(localPath);
+    contentDone(localPath, true);
+}
+
+void InputStager::recordStagedContent(QString localPath)
+{
+    if (contentIndex == nullptr) return;
+
+    const StagedContent &theContent = stagedContent[localPath];
+    if (!theContent.isFolder)
+    {
+        qint64 fileSize = QFileInfo(localPath).size();
+        if (fileSize >= ContentIndex::minContentSize) contentIndex->recordContent(theContent.contentHash, fileSize, getRemotePath(localPath));
+        return;
+    }
+
+    for (auto itr = theContent.fileHashes.cbegin(); itr != theContent.fileHashes.cend(); itr++)
+    {
+        qint64 fileSize = QFileInfo(QDir(localPath).absoluteFilePath(itr.key())).size();
+        if (fileSize < ContentIndex::minContentSize) continue;
+        contentIndex->recordContent(itr.value(), fileSize, QString("%1/%2").arg(getRemotePath(localPath), itr.key()));
+    }
+}
+
+void InputStager::startListing()
+{
+    if (listingStarted) return;
+    listingStarted = true;
+
+    PagedFolderLister * theLister = new PagedFolderLister(myStagingFolder, this);
+    theLister->setPriority(RequestPriority::BULK);
+    QObject::connect(theLister, SIGNAL(listingDone(RequestState,QString,QList<FileMetaData>,FileSizeMap)),
+                     this, SLOT(stagingListed(RequestState,QString,QList<FileMetaData>)));
+    if (!theLister->startListing())
+    {
+        theLister->deleteLater();
+        listingStarted = false;
+    }
+}
+
+void InputStager::contentHashed(QString localPath)
+{
+    StagedContent &theContent = stagedContent[localPath];
+    if (theContent.isFolder)
+    {
+        //The folder hash is the hash of its manifest, in the format of sha256sum, so it changes if any file is added, removed, renamed or changed
+        QCryptographicHash folderHash(QCryptographicHash::Sha256);
+        for (auto itr = theContent.fileHashes.cbegin(); itr != theContent.fileHashes.cend(); itr++)
+        {
+            folderHash.addData(itr.value() + "  " + itr.key().toUtf8() + "\n");
+        }
+        theContent.contentHash = folderHash.result().toHex();
+    }
+    else
+    {
+        theContent.contentHash = theContent.fileHashes.first();
+    }
+    //The file hashes are kept, so that staged files can be added to the content index
+    theContent.state = ContentState::WAITING;
+
+    startWaitingUploads();
+}
+
+void InputStager::startWaitingUploads()
+{
+    if (!stagingReady) return;
+
+    QSet<QByteArray> uploadingHashes;
+    for (const StagedContent &aContent : stagedContent)
+    {
+        if (aContent.state == ContentState::UPLOADING) uploadingHashes.insert(aContent.contentHash);
+    }
+
+    for (auto itr = stagedContent.begin(); itr != stagedContent.end(); itr++)
+    {
+        if (itr.value().state != ContentState::WAITING) continue;
+
+        if (stagedHashes.contains(itr.value().contentHash))
+        {
+            itr.value().state = ContentState::STAGED;
+            continue;
+        }
+        //The same content at two local paths is only uploaded once
+        if (uploadingHashes.contains(itr.value().contentHash)) continue;
+
+        uploadingHashes.insert(itr.value().contentHash);
+        itr.value().state = ContentState::UPLOADING;
+        startUpload(itr.key());
+    }
+    checkBatches();
+}
+
+void InputStager::startUpload(QString localPath)
+{
+    qCDebug(agaveAppLayer, "Staging job input: %s", qPrintable(localPath));
+    ae_globals::get_rest_link()->getScheduler()->scheduleRequest(RequestPriority::BULK, this, [this, localPath]()
+    {
+        QString partialFolder = getPartialFolder(localPath);
+        QNetworkReply * theReply = ae_globals::get_rest_link()->requestMakeFolder(myStagingFolder, partialFolder.section('/', -1));
+        if (theReply == nullptr)
+        {
+            contentDone(localPath, false);
+            return theReply;
+        }
+        pendingReplies.insert(theReply, localPath);
+        QObject::connect(theReply, SIGNAL(finished()), this, SLOT(partialFolderMade()));
+        return theReply;
+    });
+}
+
+void InputStager::contentDone(QString localPath, bool success)
+{
+    stagedContent[localPath].state = success ? ContentState::STAGED : ContentState::FAILED;
+    startWaitingUploads();
+}
+
+void InputStager::checkBatches()
+{
+    for (int aTicket : waitingBatches.keys())
+    {
+        if (!waitingBatches.contains(aTicket)) continue;
+
+        bool batchFailed = false;
+        bool batchDone = true;
+        QMap<QString, QString> remotePaths;
+        for (const QString &aPath : waitingBatches.value(aTicket))
+        {
+            QString localPath = QFileInfo(aPath).absoluteFilePath();
+            ContentState pathState = stagedContent.value(localPath).state;
+            if (pathState == ContentState::FAILED) batchFailed = true;
+            if (pathState != ContentState::STAGED) batchDone = false;
+            remotePaths.insert(aPath, getRemotePath(localPath));
+        }
+
+        if (batchFailed)
+        {
+            waitingBatches.remove(aTicket);
+            emit inputsStaged(aTicket, RequestState::EXPLICIT_ERROR, QMap<QString, QString>());
+        }
+        else if (batchDone)
+        {
+            waitingBatches.remove(aTicket);
+            emit inputsStaged(aTicket, RequestState::GOOD, remotePaths);
+        }
+    }
+}
+
+QString InputStager::getRemotePath(QString localPath)
+{
+    return QString("%1/%2/%3").arg(myStagingFolder, QString::fromLatin1(stagedContent.value(localPath).contentHash), QFileInfo(localPath).fileName());
+}
+
+QString InputStager::getPartialFolder(QString localPath)
+{
+    return QString("%1/%2.partial").arg(myStagingFolder, QString::fromLatin1(stagedContent.value(localPath).contentHash));
+}
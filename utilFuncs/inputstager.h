@@ -0,0 +1,135 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef INPUTSTAGER_H
+#define INPUTSTAGER_H
+
+#include <QObject>
+#include <QMap>
+#include <QSet>
+#include <QStringList>
+
+#include "filemetadata.h"
+
+class QNetworkReply;
+class StreamHasher;
+class ContentIndex;
+enum class RequestState;
+
+/*! \brief The InputStager uploads local files and folders given as job inputs into a remote staging folder, so that the jobs can use them.
+ *
+ *  Content is stored by its checksum: each input goes in a folder named for its SHA-256, under the staging folder, keeping its own name.
+ *  Content which is already there, from an earlier job, is not uploaded again. A folder input is identified by the checksums and paths of all its files.
+ *
+ *  Inputs are hashed on the worker pool of StreamHasher, while the staging folder is listed, and uploads of different inputs run at the same time.
+ *  Each upload goes into a folder ending in ".partial", which is renamed once the upload is complete, so a failed upload is never mistaken for staged content.
+ *
+ *  Several batches may be staged at once. An input shared by several batches is hashed and uploaded only once.
+ *
+ *  If a ContentIndex is set, large files which the user already has elsewhere on the remote system, such as in the staging folder of another sweep, are copied there instead of uploaded.
+ */
+class InputStager : public QObject
+{
+    Q_OBJECT
+public:
+    /*! \brief Constructs a new InputStager.
+     *
+     *  \param stagingFolder Full path of the remote staging folder, which is made if it does not exist. Its parent folder must exist.
+     *  \param parent The object requesting staging is typically the parent
+     */
+    explicit InputStager(QString stagingFolder, QObject * parent = nullptr);
+
+    QString getStagingFolder();
+    void setContentIndex(ContentIndex * theIndex);
+
+    /*! \brief Begins staging a batch of local files and folders, under the given ticket.
+     *
+     *  The inputsStaged() signal gives the remote path for each local path, once all the batch is staged, or once any part of it has failed.
+     */
+    void stageInputs(int ticket, QStringList localPaths);
+
+signals:
+    void inputsStaged(int ticket, RequestState finalState, QMap<QString, QString> remotePaths);
+
+private slots:
+    void fileHashed(QByteArray hexHash);
+    void stagingListed(RequestState finalState, QString folderPath, QList<FileMetaData> allEntries);
+    void stagingFolderMade();
+    void partialFolderMade();
+    void fileUploadDone();
+    void folderUploadDone(RequestState finalState, int unitsDone, int unitsFailed);
+    void partialFolderRenamed();
+    void contentCopied(QString destPath, bool copied);
+
+private:
+    enum class ContentState {HASHING, WAITING, UPLOADING, STAGED, FAILED};
+
+    struct StagedContent
+    {
+        ContentState state = ContentState::HASHING;
+        bool isFolder = false;
+        QByteArray contentHash;
+        QMap<QString, QByteArray> fileHashes;
+        int hashesOutstanding = 0;
+    };
+
+    void startListing();
+    void contentHashed(QString localPath);
+    void startWaitingUploads();
+    void startUpload(QString localPath);
+    void uploadStagedFile(QString localPath);
+    void renamePartialFolder(QString localPath);
+    void recordStagedContent(QString localPath);
+    void contentDone(QString localPath, bool success);
+    void checkBatches();
+
+    QString getRemotePath(QString localPath);
+    QString getPartialFolder(QString localPath);
+
+    QString myStagingFolder;
+    bool stagingReady = false;
+    bool listingStarted = false;
+    QSet<QByteArray> stagedHashes;
+
+    QMap<QString, StagedContent> stagedContent;
+    QMap<StreamHasher *, QPair<QString, QString>> runningHashers;
+    QMap<QNetworkReply *, QString> pendingReplies;
+    QMap<QObject *, QString> runningFolderUploads;
+    QMap<QString, QString> pendingCopies;
+    ContentIndex * contentIndex = nullptr;
+    QMap<int, QStringList> waitingBatches;
+};
+
+#endif // INPUTSTAGER_H
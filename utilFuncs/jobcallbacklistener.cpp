@@ -0,0 +1,394 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "jobcallbacklistener.h"
+
+#include "agaverestlink.h"
+#include "requestscheduler.h"
+#include "remotejobmodel.h"
+#include "jobrecord.h"
+#include "remotedatainterface.h"
+#include "ae_globals.h"
+
+#include <QTcpSocket>
+#include <QNetworkInterface>
+#include <QNetworkReply>
+#include <QHostAddress>
+#include <QUuid>
+#include <QUrl>
+#include <QTimer>
+#include <QJsonObject>
+#include <QJsonArray>
+
+JobCallbackListener::JobCallbackListener(QObject * parent) : QObject(parent)
+{
+    QObject::connect(&callbackServer, SIGNAL(newConnection()), this, SLOT(newConnection()));
+}
+
+bool JobCallbackListener::startListening(quint16 localPort, QString publicBaseUrl, QString bindAddress)
+{
+    if (callbackServer.isListening()) return true;
+
+    //The listener is only opened on the address the server is told to use, unless told otherwise
+    QHostAddress listenAddress(bindAddress);
+    QHostAddress advertisedAddress;
+    if (publicBaseUrl.isEmpty())
+    {
+        for (const QHostAddress &anAddress : QNetworkInterface::allAddresses())
+        {
+            if (anAddress.isLoopback() || (anAddress.protocol() != QAbstractSocket::IPv4Protocol)) continue;
+            advertisedAddress = anAddress;
+            break;
+        }
+        if (advertisedAddress.isNull())
+        {
+            qCDebug(agaveAppLayer, "No address found for job callbacks");
+            return false;
+        }
+        if (listenAddress.isNull()) listenAddress = advertisedAddress;
+    }
+    else if (listenAddress.isNull())
+    {
+        QHostAddress urlAddress(QUrl(publicBaseUrl).host());
+        bool isLocalAddress = !urlAddress.isNull() && QNetworkInterface::allAddresses().contains(urlAddress);
+        listenAddress = isLocalAddress ? urlAddress : QHostAddress(QHostAddress::LocalHost);
+    }
+
+    if (!callbackServer.listen(listenAddress, localPort))
+    {
+        qCDebug(agaveAppLayer, "Unable to listen for job callbacks on %s port %d: %s", qPrintable(listenAddress.toString()), localPort,
+                qPrintable(callbackServer.errorString()));
+        return false;
+    }
+
+    callbackBaseUrl = publicBaseUrl;
+    if (callbackBaseUrl.isEmpty())
+    {
+        callbackBaseUrl = QString("http://%1:%2").arg(advertisedAddress.toString()).arg(callbackServer.serverPort());
+    }
+    while (callbackBaseUrl.endsWith('/')) callbackBaseUrl.chop(1);
+
+    callbackToken = QString::fromLatin1(QUuid::createUuid().toRfc4122().toHex());
+    qCDebug(agaveAppLayer, "Listening for job callbacks on %s, at %s", qPrintable(listenAddress.toString()), qPrintable(callbackBaseUrl));
+    return true;
+}
+
+void JobCallbackListener::stopListening()
+{
+    callbackServer.close();
+    for (QTcpSocket * aSocket : requestBuffers.keys())
+    {
+        aSocket->abort();
+        aSocket->deleteLater();
+    }
+    requestBuffers.clear();
+}
+
+bool JobCallbackListener::isListening()
+{
+    return callbackServer.isListening();
+}
+
+QString JobCallbackListener::getCallbackUrl()
+{
+    if (!isListening()) return QString();
+    return QString("%1/jobs/%2/${JOB_ID}/${JOB_STATUS}").arg(callbackBaseUrl, callbackToken);
+}
+
+void JobCallbackListener::subscribeJob(QString jobId)
+{
+    if (!isListening() || jobId.isEmpty()) return;
+    if (subscribedJobs.contains(jobId)) return;
+    subscribedJobs.insert(jobId);
+
+    QString callbackUrl = getCallbackUrl();
+    ae_globals::get_rest_link()->getScheduler()->scheduleRequest(RequestPriority::BACKGROUND, this, [this, jobId, callbackUrl]()
+    {
+        QNetworkReply * theReply = ae_globals::get_rest_link()->requestJobNotification(jobId, callbackUrl);
+        if (theReply == nullptr)
+        {
+            qCDebug(agaveAppLayer, "Unable to subscribe to status of job %s", qPrintable(jobId));
+            subscribedJobs.remove(jobId);
+            return theReply;
+        }
+        subscriptionReplies.insert(theReply, jobId);
+        QObject::connect(theReply, SIGNAL(finished()), this, SLOT(subscriptionReplied()));
+        return theReply;
+    });
+}
+
+void JobCallbackListener::unsubscribeJob(QString jobId)
+{
+    if (!subscribedJobs.remove(jobId)) return;
+
+    QString notificationId = notificationOfJob.take(jobId);
+    if (notificationId.isEmpty())
+    {
+        //The subscription is deleted once the server returns it
+        endedBeforeSubscribed.insert(jobId);
+        return;
+    }
+    deleteNotification(notificationId);
+}
+
+void JobCallbackListener::jobListRefreshed(RequestState finalState)
+{
+    if (!isListening() || subscriptionsSynced || (finalState != RequestState::GOOD)) return;
+    subscriptionsSynced = true;
+
+    staleNotifications.clear();
+    requestNotificationPage(0);
+}
+
+void JobCallbackListener::newConnection()
+{
+    while (callbackServer.hasPendingConnections())
+    {
+        QTcpSocket * newSocket = callbackServer.nextPendingConnection();
+        requestBuffers.insert(newSocket, QByteArray());
+
+        QObject::connect(newSocket, SIGNAL(readyRead()), this, SLOT(socketReadable()));
+        QObject::connect(newSocket, SIGNAL(disconnected()), this, SLOT(socketClosed()));
+        //A client which never finishes its request is dropped
+        QTimer::singleShot(requestTimeoutMs, newSocket, [newSocket]() { newSocket->abort(); });
+    }
+}
+
+void JobCallbackListener::socketReadable()
+{
+    QTcpSocket * theSocket = qobject_cast<QTcpSocket *>(sender());
+    if ((theSocket == nullptr) || !requestBuffers.contains(theSocket)) return;
+
+    QByteArray &theBuffer = requestBuffers[theSocket];
+    theBuffer.append(theSocket->readAll());
+    if (theBuffer.size() > maxRequestBytes)
+    {
+        sendResponse(theSocket, 413);
+        return;
+    }
+
+    int headerEnd = theBuffer.indexOf("\r\n\r\n");
+    if (headerEnd < 0) return;
+
+    //The body is not used, but is read in full before replying
+    QList<QByteArray> headerLines = theBuffer.left(headerEnd).split('\n');
+    qint64 bodyLength = 0;
+    for (int i = 1; i < headerLines.size(); i++)
+    {
+        QByteArray aLine = headerLines.at(i).trimmed();
+        if (aLine.toLower().startsWith("content-length:"))
+        {
+            bodyLength = aLine.mid(15).trimmed().toLongLong();
+        }
+    }
+    if (theBuffer.size() < headerEnd + 4 + bodyLength) return;
+
+    QList<QByteArray> requestLine = headerLines.first().trimmed().split(' ');
+    if (requestLine.size() != 3)
+    {
+        sendResponse(theSocket, 400);
+        return;
+    }
+    sendResponse(theSocket, handleRequest(requestLine.at(0), requestLine.at(1)));
+}
+
+void JobCallbackListener::socketClosed()
+{
+    QTcpSocket * theSocket = qobject_cast<QTcpSocket *>(sender());
+    if (theSocket == nullptr) return;
+
+    requestBuffers.remove(theSocket);
+    theSocket->deleteLater();
+}
+
+void JobCallbackListener::subscriptionReplied()
+{
+    QNetworkReply * theReply = qobject_cast<QNetworkReply *>(sender());
+    if (theReply == nullptr) return;
+    theReply->deleteLater();
+    QString jobId = subscriptionReplies.take(theReply);
+
+    if (theReply->error() != QNetworkReply::NoError)
+    {
+        qCDebug(agaveAppLayer, "Job status subscription failed: %s", qPrintable(theReply->errorString()));
+        subscribedJobs.remove(jobId);
+        endedBeforeSubscribed.remove(jobId);
+        return;
+    }
+
+    QString notificationId = AgaveRestLink::getReplyResult(theReply->readAll()).toObject().value("id").toString();
+    if (notificationId.isEmpty()) return;
+
+    if (endedBeforeSubscribed.remove(jobId))
+    {
+        deleteNotification(notificationId);
+        return;
+    }
+    if (subscribedJobs.contains(jobId)) notificationOfJob.insert(jobId, notificationId);
+}
+
+void JobCallbackListener::notificationListReplied()
+{
+    QNetworkReply * theReply = qobject_cast<QNetworkReply *>(sender());
+    if (theReply == nullptr) return;
+    theReply->deleteLater();
+
+    if (theReply->error() != QNetworkReply::NoError)
+    {
+        qCDebug(agaveAppLayer, "Unable to list job status subscriptions: %s", qPrintable(theReply->errorString()));
+        subscribeActiveJobs();
+        return;
+    }
+
+    //Earlier runs used the same address with another token. Their posts would be refused, so their subscriptions only add load.
+    QString ownPrefix = callbackBaseUrl + "/jobs/";
+    QString currentPrefix = ownPrefix + callbackToken + "/";
+    QJsonArray rawNotifications = AgaveRestLink::getReplyResult(theReply->readAll()).toArray();
+    for (auto itr = rawNotifications.constBegin(); itr != rawNotifications.constEnd(); itr++)
+    {
+        QJsonObject aNotification = (*itr).toObject();
+        QString notificationUrl = aNotification.value("url").toString();
+        if (!notificationUrl.startsWith(ownPrefix) || notificationUrl.startsWith(currentPrefix)) continue;
+
+        QString notificationId = aNotification.value("id").toString();
+        if (!notificationId.isEmpty()) staleNotifications.append(notificationId);
+    }
+
+    if (rawNotifications.size() >= notificationPageSize)
+    {
+        requestNotificationPage(notificationListOffset + rawNotifications.size());
+        return;
+    }
+
+    //Deletions are only sent once the whole list is read, so that they do not shift the later pages
+    qCDebug(agaveAppLayer, "Deleting %d job status subscriptions of earlier runs", staleNotifications.size());
+    for (const QString &notificationId : staleNotifications)
+    {
+        deleteNotification(notificationId);
+    }
+    staleNotifications.clear();
+    subscribeActiveJobs();
+}
+
+void JobCallbackListener::notificationDeleted()
+{
+    QNetworkReply * theReply = qobject_cast<QNetworkReply *>(sender());
+    if (theReply == nullptr) return;
+    theReply->deleteLater();
+
+    if ((theReply->error() != QNetworkReply::NoError) && (theReply->error() != QNetworkReply::ContentNotFoundError))
+    {
+        qCDebug(agaveAppLayer, "Unable to delete job status subscription: %s", qPrintable(theReply->errorString()));
+    }
+}
+
+void JobCallbackListener::requestNotificationPage(int offset)
+{
+    notificationListOffset = offset;
+    ae_globals::get_rest_link()->getScheduler()->scheduleRequest(RequestPriority::BACKGROUND, this, [this, offset]()
+    {
+        QNetworkReply * theReply = ae_globals::get_rest_link()->requestNotificationList(offset, notificationPageSize);
+        if (theReply == nullptr)
+        {
+            subscribeActiveJobs();
+            return theReply;
+        }
+        QObject::connect(theReply, SIGNAL(finished()), this, SLOT(notificationListReplied()));
+        return theReply;
+    });
+}
+
+void JobCallbackListener::deleteNotification(QString notificationId)
+{
+    ae_globals::get_rest_link()->getScheduler()->scheduleRequest(RequestPriority::BACKGROUND, this, [this, notificationId]()
+    {
+        QNetworkReply * theReply = ae_globals::get_rest_link()->requestNotificationDelete(notificationId);
+        if (theReply == nullptr) return theReply;
+        QObject::connect(theReply, SIGNAL(finished()), this, SLOT(notificationDeleted()));
+        return theReply;
+    });
+}
+
+void JobCallbackListener::subscribeActiveJobs()
+{
+    RemoteJobModel * theModel = ae_globals::get_job_model();
+    if (theModel == nullptr) return;
+
+    for (const QString &jobId : theModel->getActiveJobIds())
+    {
+        subscribeJob(jobId);
+    }
+}
+
+int JobCallbackListener::handleRequest(const QByteArray &method, const QByteArray &path)
+{
+    if ((method != "POST") && (method != "GET")) return 405;
+
+    //Expected path: /jobs/<token>/<job ID>/<status>
+    QStringList pathParts = QUrl(QString::fromLatin1(path)).path().split('/');
+    pathParts.removeAll(QString());
+    if ((pathParts.size() != 4) || (pathParts.at(0) != "jobs") || (pathParts.at(1) != callbackToken))
+    {
+        return 404;
+    }
+
+    QString jobId = pathParts.at(2);
+    QString newStatus = pathParts.at(3).toUpper();
+    //Unfilled template variables mean the event did not concern a job status
+    if (jobId.startsWith('$') || newStatus.startsWith('$')) return 200;
+
+    qCDebug(agaveAppLayer, "Job %s pushed status %s", qPrintable(jobId), qPrintable(newStatus));
+    emit jobStatusPushed(jobId, newStatus);
+    if (JobRecord::isTerminalStatus(newStatus)) unsubscribeJob(jobId);
+    return 200;
+}
+
+void JobCallbackListener::sendResponse(QTcpSocket * theSocket, int statusCode)
+{
+    QByteArray reasonText;
+    switch (statusCode)
+    {
+    case 200: reasonText = "OK"; break;
+    case 400: reasonText = "Bad Request"; break;
+    case 404: reasonText = "Not Found"; break;
+    case 405: reasonText = "Method Not Allowed"; break;
+    case 413: reasonText = "Payload Too Large"; break;
+    default: reasonText = "Error"; break;
+    }
+
+    QObject::disconnect(theSocket, SIGNAL(readyRead()), this, SLOT(socketReadable()));
+    theSocket->write("HTTP/1.1 " + QByteArray::number(statusCode) + " " + reasonText + "\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+    theSocket->disconnectFromHost();
+}
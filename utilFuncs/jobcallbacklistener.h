@@ -0,0 +1,133 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef JOBCALLBACKLISTENER_H
+#define JOBCALLBACKLISTENER_H
+
+#include <QObject>
+#include <QTcpServer>
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+#include <QByteArray>
+
+class QTcpSocket;
+class QNetworkReply;
+enum class RequestState;
+
+/*! \brief The JobCallbackListener is a small local HTTP server, to which the Agave server posts status changes of jobs.
+ *
+ *  Once listening, subscribeJob() asks the server to post each status change of a job to getCallbackUrl(). Each post is turned into the jobStatusPushed() signal.
+ *  The callback URL holds a random token, and posts without it are refused. A new token is made for each run.
+ *
+ *  Subscriptions stay on the server until the job reaches a terminal status, when they are deleted. After the first good refresh of the job list,
+ *  subscriptions left by earlier runs at the same callback address are deleted, and the jobs still active are subscribed again with the new token.
+ *
+ *  The server must be able to reach the listener. If the client is behind NAT, a public URL forwarded to the local port should be given to startListening().
+ */
+class JobCallbackListener : public QObject
+{
+    Q_OBJECT
+public:
+    explicit JobCallbackListener(QObject * parent = nullptr);
+
+    /*! \brief Starts listening for callbacks. Returns false if the port cannot be opened.
+     *
+     *  \param localPort The local port to listen on
+     *  \param publicBaseUrl The URL through which the server reaches the listener, such as "http://myhost.org:8123". If empty, the first non-loopback address of this machine is used.
+     *  \param bindAddress The local address to listen on. If empty, the address of publicBaseUrl is used when it belongs to this machine, and localhost otherwise,
+     *  for a tunnel or forwarder running on this machine. Give "0.0.0.0" to listen on every interface.
+     */
+    bool startListening(quint16 localPort, QString publicBaseUrl = QString(), QString bindAddress = QString());
+    void stopListening();
+    bool isListening();
+
+    /*! \brief Returns the callback URL, with Agave template variables for the job ID and status.
+     */
+    QString getCallbackUrl();
+
+    /*! \brief Asks the Agave server to post the status changes of a job to this listener.
+     */
+    void subscribeJob(QString jobId);
+    /*! \brief Deletes the subscription of a job, if it has one.
+     */
+    void unsubscribeJob(QString jobId);
+
+public slots:
+    /*! \brief After the first good refresh, clears subscriptions left by earlier runs, and subscribes the jobs still active.
+     */
+    void jobListRefreshed(RequestState finalState);
+
+signals:
+    void jobStatusPushed(QString jobId, QString newStatus);
+
+private slots:
+    void newConnection();
+    void socketReadable();
+    void socketClosed();
+    void subscriptionReplied();
+    void notificationListReplied();
+    void notificationDeleted();
+
+private:
+    int handleRequest(const QByteArray &method, const QByteArray &path);
+    void sendResponse(QTcpSocket * theSocket, int statusCode);
+
+    void requestNotificationPage(int offset);
+    void deleteNotification(QString notificationId);
+    void subscribeActiveJobs();
+
+    QTcpServer callbackServer;
+    QString callbackBaseUrl;
+    QString callbackToken;
+    QHash<QTcpSocket *, QByteArray> requestBuffers;
+
+    QSet<QString> subscribedJobs;
+    QHash<QString, QString> notificationOfJob;
+    QHash<QNetworkReply *, QString> subscriptionReplies;
+    //Jobs which ended before the server returned their subscription
+    QSet<QString> endedBeforeSubscribed;
+
+    bool subscriptionsSynced = false;
+    int notificationListOffset = 0;
+    QStringList staleNotifications;
+
+    static const int notificationPageSize = 100;
+
+    static const int maxRequestBytes = 65536;
+    static const int requestTimeoutMs = 10000;
+};
+
+#endif // JOBCALLBACKLISTENER_H
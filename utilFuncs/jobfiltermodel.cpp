@@ -0,0 +1,169 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "jobfiltermodel.h"
+
+#include "remotejobmodel.h"
+
+#include <QDateTime>
+
+JobFilterModel::JobFilterModel(QObject * parent) : QSortFilterProxyModel(parent)
+{
+    this->setDynamicSortFilter(true);
+}
+
+void JobFilterModel::setJobModel(RemoteJobModel * jobModel)
+{
+    if (myJobModel != nullptr) QObject::disconnect(myJobModel, nullptr, this, nullptr);
+    myJobModel = jobModel;
+    recentRowsStale = true;
+
+    //Note: These are connected before the source is set, so that they run before the proxy filters the changed rows
+    if (myJobModel != nullptr)
+    {
+        QObject::connect(myJobModel, SIGNAL(rowsInserted(QModelIndex,int,int)), this, SLOT(sourceRowsInserted(QModelIndex,int,int)));
+        QObject::connect(myJobModel, SIGNAL(dataChanged(QModelIndex,QModelIndex)), this, SLOT(sourceRowsChanged(QModelIndex,QModelIndex)));
+        QObject::connect(myJobModel, SIGNAL(rowsRemoved(QModelIndex,int,int)), this, SLOT(sourceRowsRenumbered()));
+        QObject::connect(myJobModel, SIGNAL(modelReset()), this, SLOT(sourceRowsRenumbered()));
+    }
+    this->setSourceModel(jobModel);
+}
+
+void JobFilterModel::setTextFilter(QString filterText)
+{
+    //Note: Empty words are removed by hand, as QString::SkipEmptyParts is deprecated from Qt 5.14
+    QStringList newWords = filterText.toLower().split(' ');
+    newWords.removeAll(QString());
+    if (newWords == filterWords) return;
+
+    filterWords = newWords;
+    invalidateFilter();
+}
+
+void JobFilterModel::setAppFilter(QString appId)
+{
+    if (appFilter == appId) return;
+    appFilter = appId;
+    invalidateFilter();
+}
+
+void JobFilterModel::setStatusFilter(QString status)
+{
+    if (statusFilter == status) return;
+    statusFilter = status;
+    invalidateFilter();
+}
+
+void JobFilterModel::setMaxAgeDays(int maxDays)
+{
+    qint64 newCutoff = 0;
+    if (maxDays > 0)
+    {
+        newCutoff = QDateTime::currentDateTimeUtc().addDays(-maxDays).toMSecsSinceEpoch();
+    }
+    if (newCutoff == createdCutoff) return;
+
+    createdCutoff = newCutoff;
+    recentRowsStale = true;
+    invalidateFilter();
+}
+
+bool JobFilterModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
+{
+    if (sourceParent.isValid() || (myJobModel == nullptr)) return false;
+
+    if (!appFilter.isEmpty() && (myJobModel->getAppOfRow(sourceRow) != appFilter)) return false;
+    if (!statusFilter.isEmpty() && (myJobModel->getStatusOfRow(sourceRow) != statusFilter)) return false;
+    if (createdCutoff > 0)
+    {
+        if (recentRowsStale) reloadRecentRows();
+        if (!recentRows.contains(sourceRow)) return false;
+    }
+
+    for (const QString &aWord : filterWords)
+    {
+        if (!myJobModel->rowContainsText(sourceRow, aWord)) return false;
+    }
+    return true;
+}
+
+void JobFilterModel::sourceRowsInserted(const QModelIndex &parent, int first, int last)
+{
+    if (parent.isValid()) return;
+    for (int row = first; row <= last; row++)
+    {
+        updateRecentRow(row);
+    }
+}
+
+void JobFilterModel::sourceRowsChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+{
+    for (int row = topLeft.row(); row <= bottomRight.row(); row++)
+    {
+        updateRecentRow(row);
+    }
+}
+
+void JobFilterModel::sourceRowsRenumbered()
+{
+    //Note: The model rebuilds its indices only after the last of a batch of removals, so the reload waits until the set is next used
+    recentRowsStale = true;
+}
+
+void JobFilterModel::updateRecentRow(int row)
+{
+    if ((createdCutoff <= 0) || recentRowsStale) return;
+
+    if (myJobModel->getCreatedKeyOfRow(row) >= createdCutoff)
+    {
+        recentRows.insert(row);
+    }
+    else
+    {
+        recentRows.remove(row);
+    }
+}
+
+void JobFilterModel::reloadRecentRows() const
+{
+    recentRows = myJobModel->getRowsCreatedSince(createdCutoff);
+    recentRowsStale = false;
+}
+
+bool JobFilterModel::lessThan(const QModelIndex &left, const QModelIndex &right) const
+{
+    if (myJobModel == nullptr) return QSortFilterProxyModel::lessThan(left, right);
+    return myJobModel->compareRows(left.row(), right.row(), left.column()) < 0;
+}
@@ -0,0 +1,97 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef JOBFILTERMODEL_H
+#define JOBFILTERMODEL_H
+
+#include <QSortFilterProxyModel>
+#include <QStringList>
+#include <QSet>
+
+class RemoteJobModel;
+
+/*! \brief The JobFilterModel sorts and filters the rows of a RemoteJobModel for display.
+ *
+ *  Rows are compared with the sort keys stored in the RemoteJobModel, rather than through QVariant, so that sorting a long job history stays quick.
+ *  Rows can be filtered by text, which must appear in the name, app, status or ID of the job, and by app, status, and how recently the job was created.
+ *  The rows recent enough for the age filter are taken from the creation time index of the RemoteJobModel, and kept up to date as rows are added and changed.
+ */
+class JobFilterModel : public QSortFilterProxyModel
+{
+    Q_OBJECT
+public:
+    explicit JobFilterModel(QObject * parent = nullptr);
+
+    void setJobModel(RemoteJobModel * jobModel);
+
+    /*! \brief Shows only jobs which contain every word of the given text.
+     */
+    void setTextFilter(QString filterText);
+    /*! \brief Shows only jobs of the given app. An empty string shows all apps.
+     */
+    void setAppFilter(QString appId);
+    /*! \brief Shows only jobs with the given status. An empty string shows all statuses.
+     */
+    void setStatusFilter(QString status);
+    /*! \brief Shows only jobs created in the last given number of days. Zero shows all jobs.
+     */
+    void setMaxAgeDays(int maxDays);
+
+private slots:
+    void sourceRowsInserted(const QModelIndex &parent, int first, int last);
+    void sourceRowsChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+    void sourceRowsRenumbered();
+
+protected:
+    virtual bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const;
+    virtual bool lessThan(const QModelIndex &left, const QModelIndex &right) const;
+
+private:
+    RemoteJobModel * myJobModel = nullptr;
+
+    QStringList filterWords;
+    QString appFilter;
+    QString statusFilter;
+    qint64 createdCutoff = 0;
+
+    void updateRecentRow(int row);
+    void reloadRecentRows() const;
+
+    //Rows shift when rows are removed, so the set is reloaded from the index when next needed
+    mutable QSet<int> recentRows;
+    mutable bool recentRowsStale = false;
+};
+
+#endif // JOBFILTERMODEL_H
@@ -0,0 +1,312 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "jobhistorystore.h"
+
+#include "remotejobmodel.h"
+#include "remotedatainterface.h"
+#include "ae_globals.h"
+
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QStandardPaths>
+#include <QDir>
+#include <QVariant>
+
+#include <algorithm>
+
+JobHistoryStore::JobHistoryStore(RemoteJobModel * jobModel, QObject * parent) : QObject(parent)
+{
+    myJobModel = jobModel;
+
+    writeTimer.setSingleShot(true);
+    QObject::connect(&writeTimer, SIGNAL(timeout()), this, SLOT(writePendingJobs()));
+
+    QObject::connect(myJobModel, SIGNAL(dataChanged(QModelIndex,QModelIndex,QVector<int>)),
+                     this, SLOT(jobRowsChanged(QModelIndex,QModelIndex)));
+    QObject::connect(myJobModel, SIGNAL(rowsInserted(QModelIndex,int,int)),
+                     this, SLOT(jobRowsInserted(QModelIndex,int,int)));
+    QObject::connect(myJobModel, SIGNAL(rowsAboutToBeRemoved(QModelIndex,int,int)),
+                     this, SLOT(jobRowsRemoved(QModelIndex,int,int)));
+}
+
+JobHistoryStore::~JobHistoryStore()
+{
+    closeStore();
+}
+
+bool JobHistoryStore::openStore(QString userName)
+{
+    if (isOpen() || userName.isEmpty()) return isOpen();
+
+    QDir storeFolder(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation));
+    if (!storeFolder.mkpath("jobHistory")) return false;
+    QString storeFile = storeFolder.absoluteFilePath(QString("jobHistory/%1.sqlite").arg(userName));
+
+    connectionName = QString("jobHistory_%1").arg(userName);
+    QSqlDatabase storeDB = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+    storeDB.setDatabaseName(storeFile);
+    if (!storeDB.open() || !createTables())
+    {
+        qCDebug(agaveAppLayer, "Unable to open job history: %s", qPrintable(storeDB.lastError().text()));
+        storeDB = QSqlDatabase();
+        QSqlDatabase::removeDatabase(connectionName);
+        connectionName.clear();
+        return false;
+    }
+
+    loadIntoModel();
+    return true;
+}
+
+void JobHistoryStore::closeStore()
+{
+    if (!isOpen()) return;
+
+    writePendingJobs();
+    {
+        QSqlDatabase storeDB = QSqlDatabase::database(connectionName, false);
+        storeDB.close();
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+    connectionName.clear();
+    knownStatus.clear();
+}
+
+bool JobHistoryStore::isOpen()
+{
+    return !connectionName.isEmpty();
+}
+
+QList<JobTimingStats> JobHistoryStore::getTimingStats()
+{
+    QList<JobTimingStats> ret;
+    if (!isOpen()) return ret;
+    writePendingJobs();
+
+    //Server times are used where given, and the times the client saw each status otherwise
+    QSqlQuery timingQuery(QSqlDatabase::database(connectionName));
+    timingQuery.setForwardOnly(true);
+    if (!timingQuery.exec("SELECT j.appId, j.created, "
+                          "COALESCE(j.started, (SELECT MIN(seenAt) FROM statusSeen WHERE jobId = j.id AND status = 'RUNNING')), "
+                          "COALESCE(j.ended, (SELECT MIN(seenAt) FROM statusSeen WHERE jobId = j.id AND status = 'FINISHED')) "
+                          "FROM jobs j WHERE j.status = 'FINISHED'"))
+    {
+        qCDebug(agaveAppLayer, "Job timing query failed: %s", qPrintable(timingQuery.lastError().text()));
+        return ret;
+    }
+
+    QMap<QString, QList<qint64>> waitTimes;
+    QMap<QString, QList<qint64>> runTimes;
+    while (timingQuery.next())
+    {
+        QString appId = timingQuery.value(0).toString();
+        if (timingQuery.value(1).isNull() || timingQuery.value(2).isNull()) continue;
+
+        qint64 createdMs = timingQuery.value(1).toLongLong();
+        qint64 startedMs = timingQuery.value(2).toLongLong();
+        if (startedMs < createdMs) continue;
+        waitTimes[appId].append((startedMs - createdMs) / 1000);
+
+        if (timingQuery.value(3).isNull()) continue;
+        qint64 endedMs = timingQuery.value(3).toLongLong();
+        if (endedMs >= startedMs) runTimes[appId].append((endedMs - startedMs) / 1000);
+    }
+
+    for (auto itr = waitTimes.begin(); itr != waitTimes.end(); itr++)
+    {
+        QList<qint64> &appWaits = itr.value();
+        QList<qint64> &appRuns = runTimes[itr.key()];
+        std::sort(appWaits.begin(), appWaits.end());
+        std::sort(appRuns.begin(), appRuns.end());
+
+        JobTimingStats appStats;
+        appStats.appId = itr.key();
+        appStats.jobsTimed = appWaits.size();
+        appStats.waitP50 = percentile(appWaits, 50);
+        appStats.waitP90 = percentile(appWaits, 90);
+        appStats.waitMax = percentile(appWaits, 100);
+        appStats.runP50 = percentile(appRuns, 50);
+        appStats.runP90 = percentile(appRuns, 90);
+        appStats.runMax = percentile(appRuns, 100);
+        ret.append(appStats);
+    }
+    return ret;
+}
+
+void JobHistoryStore::jobRowsChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+{
+    for (int row = topLeft.row(); row <= bottomRight.row(); row++)
+    {
+        queueJob(myJobModel->getJob(row));
+    }
+}
+
+void JobHistoryStore::jobRowsInserted(const QModelIndex &, int first, int last)
+{
+    for (int row = first; row <= last; row++)
+    {
+        queueJob(myJobModel->getJob(row));
+    }
+}
+
+void JobHistoryStore::jobRowsRemoved(const QModelIndex &, int first, int last)
+{
+    if (!isOpen()) return;
+
+    for (int row = first; row <= last; row++)
+    {
+        QString jobId = myJobModel->getJob(row).id;
+        pendingJobs.remove(jobId);
+        pendingRemovals.append(jobId);
+    }
+    if (!writeTimer.isActive()) writeTimer.start(writeDelayMs);
+}
+
+void JobHistoryStore::writePendingJobs()
+{
+    writeTimer.stop();
+    if (!isOpen() || (pendingJobs.isEmpty() && pendingStatuses.isEmpty() && pendingRemovals.isEmpty())) return;
+
+    QSqlDatabase storeDB = QSqlDatabase::database(connectionName);
+    storeDB.transaction();
+
+    QSqlQuery jobQuery(storeDB);
+    jobQuery.prepare("INSERT OR REPLACE INTO jobs (id, name, appId, status, created, lastUpdated, started, ended, archivePath) "
+                     "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?)");
+    QSqlQuery statusQuery(storeDB);
+    statusQuery.prepare("INSERT OR IGNORE INTO statusSeen (jobId, status, seenAt) VALUES (?, ?, ?)");
+    QSqlQuery hideQuery(storeDB);
+    hideQuery.prepare("UPDATE jobs SET hidden = 1 WHERE id = ?");
+
+    for (const JobRecord &aJob : pendingJobs)
+    {
+        jobQuery.addBindValue(aJob.id);
+        jobQuery.addBindValue(aJob.name);
+        jobQuery.addBindValue(aJob.appId);
+        jobQuery.addBindValue(aJob.status);
+        jobQuery.addBindValue(aJob.created.isValid() ? QVariant(aJob.created.toMSecsSinceEpoch()) : QVariant(QVariant::LongLong));
+        jobQuery.addBindValue(aJob.lastUpdated.isValid() ? QVariant(aJob.lastUpdated.toMSecsSinceEpoch()) : QVariant(QVariant::LongLong));
+        jobQuery.addBindValue(aJob.started.isValid() ? QVariant(aJob.started.toMSecsSinceEpoch()) : QVariant(QVariant::LongLong));
+        jobQuery.addBindValue(aJob.ended.isValid() ? QVariant(aJob.ended.toMSecsSinceEpoch()) : QVariant(QVariant::LongLong));
+        jobQuery.addBindValue(aJob.archivePath);
+        jobQuery.exec();
+    }
+    for (const StatusSeen &aStatus : pendingStatuses)
+    {
+        statusQuery.addBindValue(aStatus.jobId);
+        statusQuery.addBindValue(aStatus.status);
+        statusQuery.addBindValue(aStatus.seenAt);
+        statusQuery.exec();
+    }
+    for (const QString &aJobId : pendingRemovals)
+    {
+        hideQuery.addBindValue(aJobId);
+        hideQuery.exec();
+    }
+
+    if (!storeDB.commit())
+    {
+        qCDebug(agaveAppLayer, "Unable to write job history: %s", qPrintable(storeDB.lastError().text()));
+    }
+    pendingJobs.clear();
+    pendingStatuses.clear();
+    pendingRemovals.clear();
+}
+
+bool JobHistoryStore::createTables()
+{
+    QSqlQuery setupQuery(QSqlDatabase::database(connectionName));
+    return setupQuery.exec("CREATE TABLE IF NOT EXISTS jobs (id TEXT PRIMARY KEY, name TEXT, appId TEXT, status TEXT, "
+                           "created INTEGER, lastUpdated INTEGER, started INTEGER, ended INTEGER, archivePath TEXT, hidden INTEGER DEFAULT 0)")
+            && setupQuery.exec("CREATE TABLE IF NOT EXISTS statusSeen (jobId TEXT, status TEXT, seenAt INTEGER, PRIMARY KEY (jobId, status))")
+            && setupQuery.exec("CREATE INDEX IF NOT EXISTS jobsByApp ON jobs (appId, status)");
+}
+
+void JobHistoryStore::loadIntoModel()
+{
+    QSqlQuery loadQuery(QSqlDatabase::database(connectionName));
+    loadQuery.setForwardOnly(true);
+    if (!loadQuery.exec("SELECT id, name, appId, status, created, lastUpdated, started, ended, archivePath FROM jobs WHERE hidden = 0")) return;
+
+    //Jobs read from the store need not be written back to it
+    loadingHistory = true;
+    int jobsLoaded = 0;
+    while (loadQuery.next())
+    {
+        JobRecord aJob;
+        aJob.id = loadQuery.value(0).toString();
+        aJob.name = loadQuery.value(1).toString();
+        aJob.appId = loadQuery.value(2).toString();
+        aJob.status = loadQuery.value(3).toString();
+        if (!loadQuery.value(4).isNull()) aJob.created = QDateTime::fromMSecsSinceEpoch(loadQuery.value(4).toLongLong(), Qt::UTC);
+        if (!loadQuery.value(5).isNull()) aJob.lastUpdated = QDateTime::fromMSecsSinceEpoch(loadQuery.value(5).toLongLong(), Qt::UTC);
+        if (!loadQuery.value(6).isNull()) aJob.started = QDateTime::fromMSecsSinceEpoch(loadQuery.value(6).toLongLong(), Qt::UTC);
+        if (!loadQuery.value(7).isNull()) aJob.ended = QDateTime::fromMSecsSinceEpoch(loadQuery.value(7).toLongLong(), Qt::UTC);
+        aJob.archivePath = loadQuery.value(8).toString();
+
+        knownStatus.insert(aJob.id, aJob.status);
+        myJobModel->upsertJob(aJob);
+        jobsLoaded++;
+    }
+    loadingHistory = false;
+    qCDebug(agaveAppLayer, "Loaded %d jobs from job history", jobsLoaded);
+}
+
+void JobHistoryStore::queueJob(const JobRecord &theJob)
+{
+    if (loadingHistory || !isOpen() || theJob.id.isEmpty()) return;
+
+    auto previousStatus = knownStatus.constFind(theJob.id);
+    if ((previousStatus != knownStatus.constEnd()) && (previousStatus.value() != theJob.status))
+    {
+        pendingStatuses.append({theJob.id, theJob.status, QDateTime::currentMSecsSinceEpoch()});
+    }
+    knownStatus.insert(theJob.id, theJob.status);
+
+    pendingRemovals.removeAll(theJob.id);
+    pendingJobs.insert(theJob.id, theJob);
+    if (!writeTimer.isActive()) writeTimer.start(writeDelayMs);
+}
+
+qint64 JobHistoryStore::percentile(const QList<qint64> &sortedValues, int percent)
+{
+    if (sortedValues.isEmpty()) return -1;
+
+    //Nearest rank
+    int rank = (percent * sortedValues.size() + 99) / 100;
+    return sortedValues.at(qBound(0, rank - 1, sortedValues.size() - 1));
+}
@@ -0,0 +1,123 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef JOBHISTORYSTORE_H
+#define JOBHISTORYSTORE_H
+
+#include <QObject>
+#include <QList>
+#include <QMap>
+#include <QHash>
+#include <QTimer>
+#include <QModelIndex>
+
+#include "jobrecord.h"
+
+class RemoteJobModel;
+
+/*! \brief The JobTimingStats hold the queue wait and run time percentiles of one app, in seconds.
+ */
+struct JobTimingStats
+{
+    QString appId;
+    int jobsTimed = 0;
+    qint64 waitP50 = -1;
+    qint64 waitP90 = -1;
+    qint64 waitMax = -1;
+    qint64 runP50 = -1;
+    qint64 runP90 = -1;
+    qint64 runMax = -1;
+};
+
+/*! \brief The JobHistoryStore keeps a local SQLite copy of the job list of the user, and of when each job was seen in each status.
+ *
+ *  The stored jobs are loaded into the RemoteJobModel when the store is opened, so the job table is filled before the server replies.
+ *  After that, every change to the model is written to the store, in batches. Jobs removed from the model are kept for their timings, but are not loaded again.
+ *
+ *  The history gives the queue wait and run time of each job, from the start and end times given by the server or, failing those,
+ *  from the times the client saw the job start running and finish.
+ */
+class JobHistoryStore : public QObject
+{
+    Q_OBJECT
+public:
+    explicit JobHistoryStore(RemoteJobModel * jobModel, QObject * parent = nullptr);
+    ~JobHistoryStore();
+
+    /*! \brief Opens the history of a user, and loads it into the job model. Returns false if the database cannot be opened.
+     */
+    bool openStore(QString userName);
+    void closeStore();
+    bool isOpen();
+
+    /*! \brief Returns the queue wait and run time percentiles of each app, for finished jobs.
+     */
+    QList<JobTimingStats> getTimingStats();
+
+private slots:
+    void jobRowsChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+    void jobRowsInserted(const QModelIndex &parent, int first, int last);
+    void jobRowsRemoved(const QModelIndex &parent, int first, int last);
+    void writePendingJobs();
+
+private:
+    bool createTables();
+    void loadIntoModel();
+    void queueJob(const JobRecord &theJob);
+
+    static qint64 percentile(const QList<qint64> &sortedValues, int percent);
+
+    RemoteJobModel * myJobModel;
+    QString connectionName;
+    bool loadingHistory = false;
+
+    struct StatusSeen
+    {
+        QString jobId;
+        QString status;
+        qint64 seenAt;
+    };
+
+    //Status changes are only recorded for jobs already known, since a job first seen in some status may have been in it for a long time
+    QHash<QString, QString> knownStatus;
+    QMap<QString, JobRecord> pendingJobs;
+    QList<StatusSeen> pendingStatuses;
+    QStringList pendingRemovals;
+    QTimer writeTimer;
+
+    static const int writeDelayMs = 2000;
+};
+
+#endif // JOBHISTORYSTORE_H
@@ -0,0 +1,245 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "joboutputfetcher.h"
+
+#include "remotejobmodel.h"
+#include "folderdownload.h"
+#include "transferjournal.h"
+#include "agaverestlink.h"
+#include "requestscheduler.h"
+#include "remotedatainterface.h"
+#include "ae_globals.h"
+
+#include <QNetworkReply>
+#include <QSettings>
+#include <QDir>
+
+JobOutputFetcher::JobOutputFetcher(RemoteJobModel * jobModel, QObject * parent) : QObject(parent)
+{
+    myJobModel = jobModel;
+
+    QSettings savedWatches("SimCenter", "AgaveExplorer");
+    savedWatches.beginGroup("jobOutputFetch");
+    for (const QString &aJobId : savedWatches.childKeys())
+    {
+        QStringList watchEntry = savedWatches.value(aJobId).toStringList();
+        if (!watchEntry.isEmpty()) watchedJobs.insert(aJobId, watchEntry);
+    }
+    savedWatches.endGroup();
+
+    QObject::connect(myJobModel, SIGNAL(dataChanged(QModelIndex,QModelIndex,QVector<int>)),
+                     this, SLOT(jobRowsChanged(QModelIndex,QModelIndex)));
+    QObject::connect(myJobModel, SIGNAL(rowsInserted(QModelIndex,int,int)),
+                     this, SLOT(jobRowsInserted(QModelIndex,int,int)));
+}
+
+void JobOutputFetcher::watchJob(QString jobId, QString localDest, QStringList includePatterns)
+{
+    if (jobId.isEmpty()) return;
+
+    watchedJobs.insert(jobId, QStringList(localDest) + includePatterns);
+    saveWatchList();
+
+    //The job may have finished already
+    if (myJobModel->hasJob(jobId))
+    {
+        checkJob(myJobModel->getJobById(jobId));
+    }
+}
+
+void JobOutputFetcher::unwatchJob(QString jobId)
+{
+    if (watchedJobs.remove(jobId) == 0) return;
+    saveWatchList();
+}
+
+bool JobOutputFetcher::isWatched(QString jobId)
+{
+    return watchedJobs.contains(jobId);
+}
+
+void JobOutputFetcher::setMaxConcurrentFetches(int newMax)
+{
+    if (newMax < 1) return;
+    maxConcurrentFetches = newMax;
+    startWaitingFetches();
+}
+
+void JobOutputFetcher::jobRowsChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+{
+    if (watchedJobs.isEmpty()) return;
+
+    for (int row = topLeft.row(); row <= bottomRight.row(); row++)
+    {
+        checkJob(myJobModel->getJob(row));
+    }
+}
+
+void JobOutputFetcher::jobRowsInserted(const QModelIndex &, int first, int last)
+{
+    if (watchedJobs.isEmpty()) return;
+
+    for (int row = first; row <= last; row++)
+    {
+        checkJob(myJobModel->getJob(row));
+    }
+}
+
+void JobOutputFetcher::jobDetailsReplied()
+{
+    QNetworkReply * theReply = qobject_cast<QNetworkReply *>(sender());
+    if (theReply == nullptr) return;
+    theReply->deleteLater();
+
+    QString jobId = theReply->property("jobId").toString();
+    detailsRequested.remove(jobId);
+    if (!watchedJobs.contains(jobId)) return;
+
+    JobRecord theJob;
+    QJsonValue replyResult = AgaveRestLink::getReplyResult(theReply->readAll());
+    if ((theReply->error() != QNetworkReply::NoError) || !JobRecord::parseJobEntry(replyResult.toObject(), &theJob) || theJob.archivePath.isEmpty())
+    {
+        qCDebug(agaveAppLayer, "Unable to find the output folder of job %s", qPrintable(jobId));
+        unwatchJob(jobId);
+        emit outputFetchDone(jobId, RequestState::EXPLICIT_ERROR, QString());
+        return;
+    }
+
+    myJobModel->upsertJob(theJob);
+    checkJob(theJob);
+}
+
+void JobOutputFetcher::fetchDone(RequestState finalState, int, int unitsFailed)
+{
+    FolderDownload * theDownload = qobject_cast<FolderDownload *>(sender());
+    if (!runningFetches.contains(theDownload)) return;
+
+    OutputFetch theFetch = runningFetches.take(theDownload);
+    QString localFolder = QDir(theFetch.localDest).absoluteFilePath(theFetch.remoteFolder.section('/', -1));
+    qCDebug(agaveAppLayer, "Output of job %s fetched, %d files failed", qPrintable(theFetch.jobId), unitsFailed);
+
+    emit outputFetchDone(theFetch.jobId, finalState, localFolder);
+    startWaitingFetches();
+}
+
+void JobOutputFetcher::checkJob(const JobRecord &theJob)
+{
+    if (!watchedJobs.contains(theJob.id) || !theJob.isTerminal()) return;
+
+    if (theJob.status != "FINISHED")
+    {
+        qCDebug(agaveAppLayer, "Job %s ended with %s, its output will not be fetched", qPrintable(theJob.id), qPrintable(theJob.status));
+        unwatchJob(theJob.id);
+        emit outputFetchDone(theJob.id, RequestState::EXPLICIT_ERROR, QString());
+        return;
+    }
+
+    //The job list does not give the archive path, which must be asked for separately
+    if (theJob.archivePath.isEmpty())
+    {
+        requestJobDetails(theJob.id);
+        return;
+    }
+
+    OutputFetch newFetch;
+    newFetch.jobId = theJob.id;
+    newFetch.remoteFolder = theJob.archivePath;
+    if (!newFetch.remoteFolder.startsWith('/')) newFetch.remoteFolder.prepend('/');
+    newFetch.localDest = watchedJobs.value(theJob.id).first();
+    newFetch.includePatterns = watchedJobs.value(theJob.id).mid(1);
+
+    unwatchJob(theJob.id);
+    waitingFetches.enqueue(newFetch);
+    startWaitingFetches();
+}
+
+void JobOutputFetcher::requestJobDetails(QString jobId)
+{
+    if (detailsRequested.contains(jobId)) return;
+    detailsRequested.insert(jobId);
+
+    ae_globals::get_rest_link()->getScheduler()->scheduleRequest(RequestPriority::BACKGROUND, this, [this, jobId]()
+    {
+        QNetworkReply * theReply = ae_globals::get_rest_link()->requestJobDetails(jobId);
+        if (theReply == nullptr)
+        {
+            detailsRequested.remove(jobId);
+            return theReply;
+        }
+        theReply->setProperty("jobId", jobId);
+        QObject::connect(theReply, SIGNAL(finished()), this, SLOT(jobDetailsReplied()));
+        return theReply;
+    });
+}
+
+void JobOutputFetcher::startWaitingFetches()
+{
+    while ((runningFetches.size() < maxConcurrentFetches) && !waitingFetches.isEmpty())
+    {
+        OutputFetch nextFetch = waitingFetches.dequeue();
+
+        FolderDownload * theDownload = new FolderDownload(nextFetch.remoteFolder, nextFetch.localDest, this);
+        theDownload->setFileFilter(nextFetch.includePatterns, QStringList());
+        theDownload->setSkipExistingFiles(true);
+        theDownload->setJournal(TransferJournal::createJournal("download", nextFetch.localDest, nextFetch.remoteFolder));
+        theDownload->setMaxInFlight(ae_globals::get_rest_link()->getScheduler()->getClassMaxLimit(RequestPriority::BULK));
+        QObject::connect(theDownload, SIGNAL(transferDone(RequestState,int,int)), this, SLOT(fetchDone(RequestState,int,int)));
+
+        if (!theDownload->startTransfer())
+        {
+            QObject::disconnect(theDownload, nullptr, this, nullptr);
+            theDownload->cancelTransfer();
+            qCDebug(agaveAppLayer, "Unable to start fetching output of job %s", qPrintable(nextFetch.jobId));
+            emit outputFetchDone(nextFetch.jobId, RequestState::NO_CONNECT, QString());
+            continue;
+        }
+
+        runningFetches.insert(theDownload, nextFetch);
+        emit outputFetchStarted(nextFetch.jobId);
+    }
+}
+
+void JobOutputFetcher::saveWatchList()
+{
+    QSettings savedWatches("SimCenter", "AgaveExplorer");
+    savedWatches.remove("jobOutputFetch");
+    savedWatches.beginGroup("jobOutputFetch");
+    for (auto itr = watchedJobs.cbegin(); itr != watchedJobs.cend(); itr++)
+    {
+        savedWatches.setValue(itr.key(), itr.value());
+    }
+    savedWatches.endGroup();
+}
@@ -0,0 +1,112 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef JOBOUTPUTFETCHER_H
+#define JOBOUTPUTFETCHER_H
+
+#include <QObject>
+#include <QMap>
+#include <QSet>
+#include <QQueue>
+#include <QStringList>
+#include <QModelIndex>
+
+#include "jobrecord.h"
+
+class RemoteJobModel;
+class FolderDownload;
+enum class RequestState;
+
+/*! \brief The JobOutputFetcher downloads the output of chosen jobs as soon as they finish.
+ *
+ *  Jobs are chosen with watchJob(), and the fetcher follows their status in the RemoteJobModel. When a watched job finishes,
+ *  its archive folder is downloaded with a FolderDownload, skipping files which are already present locally and files the job's filter leaves out.
+ *  A few downloads run at once, each with several files in flight. Jobs which end in any other terminal status are dropped, with no download.
+ *
+ *  The list of watched jobs is saved, so that jobs which finish while the client is closed are fetched the next time it runs.
+ */
+class JobOutputFetcher : public QObject
+{
+    Q_OBJECT
+public:
+    explicit JobOutputFetcher(RemoteJobModel * jobModel, QObject * parent = nullptr);
+
+    /*! \brief Downloads the output of a job into a local folder once the job finishes.
+     *
+     *  \param jobId The job to watch
+     *  \param localDest An existing local folder. A folder named after the archive folder of the job is made inside it.
+     *  \param includePatterns Wildcard patterns of the files to download, as for FolderDownload::setFileFilter(). If empty, all files are downloaded.
+     */
+    void watchJob(QString jobId, QString localDest, QStringList includePatterns = QStringList());
+    void unwatchJob(QString jobId);
+    bool isWatched(QString jobId);
+
+    void setMaxConcurrentFetches(int newMax);
+
+signals:
+    void outputFetchStarted(QString jobId);
+    void outputFetchDone(QString jobId, RequestState finalState, QString localFolder);
+
+private slots:
+    void jobRowsChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+    void jobRowsInserted(const QModelIndex &parent, int first, int last);
+    void jobDetailsReplied();
+    void fetchDone(RequestState finalState, int unitsDone, int unitsFailed);
+
+private:
+    struct OutputFetch
+    {
+        QString jobId;
+        QString remoteFolder;
+        QString localDest;
+        QStringList includePatterns;
+    };
+
+    void checkJob(const JobRecord &theJob);
+    void requestJobDetails(QString jobId);
+    void startWaitingFetches();
+    void saveWatchList();
+
+    RemoteJobModel * myJobModel;
+
+    //Each job maps to its local destination, followed by its include patterns
+    QMap<QString, QStringList> watchedJobs;
+    QSet<QString> detailsRequested;
+    QQueue<OutputFetch> waitingFetches;
+    QMap<FolderDownload *, OutputFetch> runningFetches;
+    int maxConcurrentFetches = 2;
+};
+
+#endif // JOBOUTPUTFETCHER_H
@@ -0,0 +1,182 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "jobpoller.h"
+
+#include "remotejobmodel.h"
+#include "remotedatainterface.h"
+#include "ae_globals.h"
+
+JobPoller::JobPoller(RemoteJobModel * jobModel, QObject * parent) : QObject(parent)
+{
+    myJobModel = jobModel;
+    idleIntervalMs = idleStartIntervalMs;
+    currentIntervalMs = activeIntervalMs;
+
+    pollTimer.setSingleShot(true);
+    QObject::connect(&pollTimer, SIGNAL(timeout()), this, SLOT(pollTimeout()));
+    QObject::connect(myJobModel, SIGNAL(jobListRefreshed(RequestState)), this, SLOT(refreshDone(RequestState)));
+    QObject::connect(myJobModel, SIGNAL(rowsInserted(QModelIndex,int,int)), this, SLOT(jobsAdded()));
+}
+
+void JobPoller::startPolling()
+{
+    pollingEnabled = true;
+    pollNow(true);
+}
+
+void JobPoller::stopPolling()
+{
+    pollingEnabled = false;
+    pollTimer.stop();
+}
+
+void JobPoller::setWindowVisible(bool isVisible)
+{
+    if (windowVisible == isVisible) return;
+    windowVisible = isVisible;
+
+    if (windowVisible)
+    {
+        bringPollForward(0);
+    }
+}
+
+void JobPoller::setPushActive(bool isActive)
+{
+    pushActive = isActive;
+}
+
+int JobPoller::getCurrentInterval()
+{
+    return currentIntervalMs;
+}
+
+void JobPoller::pollNow(bool fullRefresh)
+{
+    if (fullRefresh) nextPollFull = true;
+    idleIntervalMs = idleStartIntervalMs;
+    pollTimer.stop();
+    pollTimeout();
+}
+
+void JobPoller::jobStatusPushed(QString jobId, QString newStatus)
+{
+    if (myJobModel->updateJobStatus(jobId, newStatus)) return;
+    bringPollForward(0);
+}
+
+void JobPoller::credentialsAvailable()
+{
+    //Polling started before the first authenticated request could not fetch the list
+    if (!pollingEnabled || myJobModel->isRefreshing()) return;
+    pollNow(true);
+}
+
+void JobPoller::pollTimeout()
+{
+    if (!pollingEnabled) return;
+
+    //A refresh already running will schedule the next poll when it is done
+    if (myJobModel->isRefreshing()) return;
+
+    bool refreshStarted;
+    if (nextPollFull || (pollsSinceFullRefresh >= fullRefreshEvery))
+    {
+        refreshStarted = myJobModel->refreshJobList();
+        if (refreshStarted)
+        {
+            nextPollFull = false;
+            pollsSinceFullRefresh = 0;
+        }
+    }
+    else
+    {
+        refreshStarted = myJobModel->refreshChangedJobs();
+        if (refreshStarted) pollsSinceFullRefresh++;
+    }
+
+    if (!refreshStarted)
+    {
+        //Usually there are no session credentials yet. This is not a failed poll, so it does not lengthen the idle interval.
+        currentIntervalMs = startRetryIntervalMs;
+        pollTimer.start(currentIntervalMs);
+    }
+}
+
+void JobPoller::refreshDone(RequestState finalState)
+{
+    if (!pollingEnabled) return;
+    scheduleNextPoll(finalState != RequestState::GOOD);
+}
+
+void JobPoller::jobsAdded()
+{
+    //New jobs are usually active, and change state soon
+    if (!pollingEnabled || myJobModel->isRefreshing()) return;
+    bringPollForward(activeIntervalMs);
+}
+
+void JobPoller::scheduleNextPoll(bool refreshFailed)
+{
+    if (!refreshFailed && myJobModel->hasActiveJobs())
+    {
+        currentIntervalMs = pushActive ? pushActiveIntervalMs : activeIntervalMs;
+        idleIntervalMs = idleStartIntervalMs;
+    }
+    else
+    {
+        currentIntervalMs = idleIntervalMs;
+        idleIntervalMs = qMin(idleIntervalMs * 2, idleMaxIntervalMs);
+    }
+
+    if (!windowVisible)
+    {
+        currentIntervalMs = qMin(currentIntervalMs * hiddenFactor, idleMaxIntervalMs);
+    }
+
+    qCDebug(agaveAppLayer, "Next job poll in %d seconds", currentIntervalMs / 1000);
+    pollTimer.start(currentIntervalMs);
+}
+
+void JobPoller::bringPollForward(int maxDelayMs)
+{
+    if (!pollingEnabled || !pollTimer.isActive()) return;
+    if (pollTimer.remainingTime() <= maxDelayMs) return;
+
+    idleIntervalMs = idleStartIntervalMs;
+    currentIntervalMs = maxDelayMs;
+    pollTimer.start(maxDelayMs);
+}
@@ -0,0 +1,114 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef JOBPOLLER_H
+#define JOBPOLLER_H
+
+#include <QObject>
+#include <QTimer>
+
+class RemoteJobModel;
+enum class RequestState;
+
+/*! \brief The JobPoller keeps the RemoteJobModel up to date, polling the server more or less often depending on the state of the jobs.
+ *
+ *  Most polls fetch only the jobs changed since the last poll. Every so often, a full refresh is done instead, to drop jobs deleted by other clients.
+ *
+ *  While any job is active, the list is polled every few seconds. Once all jobs are terminal, the interval doubles after each poll, up to a limit.
+ *  While the window is minimized, the interval is longer still. Adding a job, or showing the window again, brings the next poll forward.
+ *
+ *  If job status changes are pushed to the client, polling of active jobs slows to a safety net, in case a push is lost.
+ */
+class JobPoller : public QObject
+{
+    Q_OBJECT
+public:
+    explicit JobPoller(RemoteJobModel * jobModel, QObject * parent = nullptr);
+
+    /*! \brief Does a full refresh of the job list, then keeps polling until stopPolling() is called.
+     */
+    void startPolling();
+    void stopPolling();
+
+    /*! \brief Tells the poller whether the job list can be seen. Polling slows down while it cannot.
+     */
+    void setWindowVisible(bool isVisible);
+    /*! \brief Tells the poller whether status changes are being pushed to the client.
+     */
+    void setPushActive(bool isActive);
+
+    int getCurrentInterval();
+
+public slots:
+    /*! \brief Polls at once, and goes back to the shortest interval.
+     */
+    void pollNow(bool fullRefresh = false);
+    /*! \brief Applies a status change pushed by the server. A job not yet in the list brings the next poll forward.
+     */
+    void jobStatusPushed(QString jobId, QString newStatus);
+    /*! \brief Polls at once, if polling is waiting on the session credentials.
+     */
+    void credentialsAvailable();
+
+private slots:
+    void pollTimeout();
+    void refreshDone(RequestState finalState);
+    void jobsAdded();
+
+private:
+    void scheduleNextPoll(bool refreshFailed = false);
+    void bringPollForward(int maxDelayMs);
+
+    RemoteJobModel * myJobModel;
+    QTimer pollTimer;
+
+    bool pollingEnabled = false;
+    bool windowVisible = true;
+    bool pushActive = false;
+    bool nextPollFull = false;
+    int pollsSinceFullRefresh = 0;
+    int idleIntervalMs;
+    int currentIntervalMs;
+
+    static const int activeIntervalMs = 10000;
+    static const int pushActiveIntervalMs = 60000;
+    static const int idleStartIntervalMs = 60000;
+    static const int idleMaxIntervalMs = 600000;
+    static const int startRetryIntervalMs = 2000;
+    static const int hiddenFactor = 6;
+    static const int fullRefreshEvery = 30;
+};
+
+#endif // JOBPOLLER_H
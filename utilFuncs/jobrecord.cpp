@@ -0,0 +1,93 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "jobrecord.h"
+
+#include <QStringList>
+
+bool JobRecord::isTerminal() const
+{
+    return isTerminalStatus(status);
+}
+
+bool JobRecord::operator==(const JobRecord &other) const
+{
+    return (id == other.id) && (name == other.name) && (appId == other.appId) && (status == other.status)
+            && (created == other.created) && (lastUpdated == other.lastUpdated) && (started == other.started) && (ended == other.ended)
+            && (archivePath == other.archivePath);
+}
+
+bool JobRecord::operator!=(const JobRecord &other) const
+{
+    return !(*this == other);
+}
+
+bool JobRecord::parseJobEntry(const QJsonObject &rawEntry, JobRecord * parsedEntry)
+{
+    QString jobId = rawEntry.value("id").toString();
+    if (jobId.isEmpty()) return false;
+
+    parsedEntry->id = jobId;
+    parsedEntry->name = rawEntry.value("name").toString();
+    parsedEntry->appId = rawEntry.value("appId").toString();
+    parsedEntry->status = rawEntry.value("status").toString();
+    parsedEntry->created = QDateTime::fromString(rawEntry.value("created").toString(), Qt::ISODate);
+    parsedEntry->lastUpdated = QDateTime::fromString(rawEntry.value("lastUpdated").toString(), Qt::ISODate);
+    parsedEntry->archivePath = rawEntry.value("archivePath").toString();
+    parsedEntry->started = parseFirstDate(rawEntry, {"startTime", "remoteStarted"});
+    parsedEntry->ended = parseFirstDate(rawEntry, {"endTime", "remoteEnded", "ended"});
+
+    if (!parsedEntry->lastUpdated.isValid())
+    {
+        parsedEntry->lastUpdated = parsedEntry->created;
+    }
+    return true;
+}
+
+QDateTime JobRecord::parseFirstDate(const QJsonObject &rawEntry, const QStringList &fieldNames)
+{
+    for (const QString &aField : fieldNames)
+    {
+        QDateTime fieldDate = QDateTime::fromString(rawEntry.value(aField).toString(), Qt::ISODate);
+        if (fieldDate.isValid()) return fieldDate;
+    }
+    return QDateTime();
+}
+
+bool JobRecord::isTerminalStatus(const QString &status)
+{
+    static const QStringList terminalStatuses = {"FINISHED", "FAILED", "STOPPED", "KILLED", "ARCHIVING_FAILED"};
+    return terminalStatuses.contains(status);
+}
@@ -0,0 +1,79 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef JOBRECORD_H
+#define JOBRECORD_H
+
+#include <QString>
+#include <QDateTime>
+#include <QJsonObject>
+#include <QStringList>
+#include <QMetaType>
+
+/*! \brief The JobRecord holds what the client knows of one remote job.
+ */
+struct JobRecord
+{
+    QString id;
+    QString name;
+    QString appId;
+    QString status;
+    QDateTime created;
+    QDateTime lastUpdated;
+    QDateTime started;
+    QDateTime ended;
+    QString archivePath;
+
+    /*! \brief Returns true if the job has reached a status it will not leave.
+     */
+    bool isTerminal() const;
+
+    bool operator==(const JobRecord &other) const;
+    bool operator!=(const JobRecord &other) const;
+
+    /*! \brief Converts a job object from the Agave jobs API into a JobRecord. Returns false if the object has no job ID.
+     */
+    static bool parseJobEntry(const QJsonObject &rawEntry, JobRecord * parsedEntry);
+    static bool isTerminalStatus(const QString &status);
+
+private:
+    /*! \brief Returns the first valid date among the given fields, since different versions of the jobs API name the run times differently.
+     */
+    static QDateTime parseFirstDate(const QJsonObject &rawEntry, const QStringList &fieldNames);
+};
+
+Q_DECLARE_METATYPE(JobRecord)
+
+#endif // JOBRECORD_H
@@ -0,0 +1,259 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "jobsubmitqueue.h"
+
+#include "remotejobmodel.h"
+#include "jobcallbacklistener.h"
+#include "inputstager.h"
+#include "remotedatainterface.h"
+#include "ae_globals.h"
+
+#include <QJsonObject>
+#include <QTimer>
+#include <QUrl>
+
+JobSubmitQueue::JobSubmitQueue(RemoteJobModel * jobModel, QObject * parent) : QObject(parent)
+{
+    myJobModel = jobModel;
+}
+
+int JobSubmitQueue::submitJob(QString appName, QMultiMap<QString, QString> inputs, QString workingDir)
+{
+    JobSubmission newSubmission;
+    newSubmission.ticket = nextTicket;
+    nextTicket++;
+    newSubmission.appName = appName;
+    newSubmission.inputs = inputs;
+    newSubmission.workingDir = workingDir;
+
+    QStringList localPaths;
+    for (const QString &aValue : inputs)
+    {
+        QUrl valueURL(aValue);
+        if (valueURL.isLocalFile()) localPaths.append(valueURL.toLocalFile());
+    }
+    if (!localPaths.isEmpty())
+    {
+        stagingSubmissions.insert(newSubmission.ticket, newSubmission);
+        emit queueChanged(getWaitingCount(), getRunningCount());
+
+        InputStager * theStager = getStager(workingDir);
+        int ticket = newSubmission.ticket;
+        QTimer::singleShot(0, theStager, [theStager, ticket, localPaths]() { theStager->stageInputs(ticket, localPaths); });
+        return ticket;
+    }
+
+    waitingSubmissions.enqueue(newSubmission);
+    emit queueChanged(getWaitingCount(), getRunningCount());
+
+    //Launch from the event loop, so the caller has the ticket before any signal refers to it
+    if (!launchTimerPending)
+    {
+        launchTimerPending = true;
+        QMetaObject::invokeMethod(this, "launchSubmissions", Qt::QueuedConnection);
+    }
+    return newSubmission.ticket;
+}
+
+bool JobSubmitQueue::cancelSubmission(int ticket)
+{
+    //The staging of its inputs goes on, since they may be used by a later job
+    if (stagingSubmissions.remove(ticket) > 0)
+    {
+        emit queueChanged(getWaitingCount(), getRunningCount());
+        return true;
+    }
+    for (auto itr = waitingSubmissions.begin(); itr != waitingSubmissions.end(); itr++)
+    {
+        if (itr->ticket == ticket)
+        {
+            waitingSubmissions.erase(itr);
+            emit queueChanged(getWaitingCount(), getRunningCount());
+            return true;
+        }
+    }
+    return false;
+}
+
+void JobSubmitQueue::setCallbackListener(JobCallbackListener * theListener)
+{
+    myCallbackListener = theListener;
+}
+
+void JobSubmitQueue::setStagingFolder(QString remoteFolder)
+{
+    stagingFolder = remoteFolder;
+}
+
+void JobSubmitQueue::setMaxInFlight(int newMax)
+{
+    if (newMax < 1) return;
+    maxInFlight = newMax;
+    launchSubmissions();
+}
+
+int JobSubmitQueue::getMaxInFlight()
+{
+    return maxInFlight;
+}
+
+void JobSubmitQueue::setMinSpacing(int newSpacingMs)
+{
+    if (newSpacingMs < 0) return;
+    minSpacingMs = newSpacingMs;
+}
+
+int JobSubmitQueue::getWaitingCount()
+{
+    return waitingSubmissions.size() + stagingSubmissions.size();
+}
+
+int JobSubmitQueue::getRunningCount()
+{
+    return runningSubmissions.size();
+}
+
+void JobSubmitQueue::jobReplied(RequestState finalState, QJsonDocument rawReply)
+{
+    RemoteDataReply * theReply = qobject_cast<RemoteDataReply *>(sender());
+    if (!runningSubmissions.contains(theReply)) return;
+    int ticket = runningSubmissions.take(theReply);
+
+    //The reply may be the whole Agave reply, or only its result
+    QJsonObject replyObject = rawReply.object();
+    if (replyObject.value("result").isObject())
+    {
+        replyObject = replyObject.value("result").toObject();
+    }
+
+    JobRecord newJob;
+    if ((finalState == RequestState::GOOD) && JobRecord::parseJobEntry(replyObject, &newJob))
+    {
+        myJobModel->upsertJob(newJob);
+        if ((myCallbackListener != nullptr) && myCallbackListener->isListening())
+        {
+            myCallbackListener->subscribeJob(newJob.id);
+        }
+    }
+    else if (finalState == RequestState::GOOD)
+    {
+        qCDebug(agaveAppLayer, "Job submitted, but no job record was returned");
+    }
+
+    emit submissionDone(ticket, finalState, newJob);
+    emit queueChanged(getWaitingCount(), getRunningCount());
+    launchSubmissions();
+}
+
+void JobSubmitQueue::inputsStaged(int ticket, RequestState finalState, QMap<QString, QString> remotePaths)
+{
+    if (!stagingSubmissions.contains(ticket)) return;
+    JobSubmission stagedSubmission = stagingSubmissions.take(ticket);
+
+    if (finalState != RequestState::GOOD)
+    {
+        qCDebug(agaveAppLayer, "Unable to upload the local inputs of job %d", ticket);
+        emit submissionDone(ticket, finalState, JobRecord());
+        emit queueChanged(getWaitingCount(), getRunningCount());
+        return;
+    }
+
+    for (auto itr = stagedSubmission.inputs.begin(); itr != stagedSubmission.inputs.end(); itr++)
+    {
+        QUrl valueURL(itr.value());
+        if (valueURL.isLocalFile()) itr.value() = remotePaths.value(valueURL.toLocalFile());
+    }
+
+    waitingSubmissions.enqueue(stagedSubmission);
+    launchSubmissions();
+}
+
+InputStager * JobSubmitQueue::getStager(QString workingDir)
+{
+    QString stagingPath = stagingFolder;
+    if (stagingPath.isEmpty())
+    {
+        stagingPath = workingDir;
+        if (!stagingPath.endsWith('/')) stagingPath.append('/');
+        stagingPath.append("stagedInputs");
+    }
+
+    InputStager * ret = inputStagers.value(stagingPath, nullptr);
+    if (ret != nullptr) return ret;
+
+    ret = new InputStager(stagingPath, this);
+    ret->setContentIndex(ae_globals::get_content_index());
+    QObject::connect(ret, SIGNAL(inputsStaged(int,RequestState,QMap<QString,QString>)),
+                     this, SLOT(inputsStaged(int,RequestState,QMap<QString,QString>)));
+    inputStagers.insert(stagingPath, ret);
+    return ret;
+}
+
+void JobSubmitQueue::launchSubmissions()
+{
+    launchTimerPending = false;
+
+    while ((runningSubmissions.size() < maxInFlight) && (!waitingSubmissions.isEmpty()))
+    {
+        //Keep the minimum spacing between submissions
+        if (lastLaunchTimer.isValid() && (lastLaunchTimer.elapsed() < minSpacingMs))
+        {
+            if (!launchTimerPending)
+            {
+                launchTimerPending = true;
+                QTimer::singleShot(int(minSpacingMs - lastLaunchTimer.elapsed()), this, SLOT(launchSubmissions()));
+            }
+            return;
+        }
+
+        JobSubmission nextSubmission = waitingSubmissions.dequeue();
+        lastLaunchTimer.start();
+
+        RemoteDataReply * theReply = ae_globals::get_connection()->runRemoteJob(nextSubmission.appName, nextSubmission.inputs, nextSubmission.workingDir);
+        if (theReply == nullptr)
+        {
+            qCDebug(agaveAppLayer, "Unable to invoke task");
+            emit submissionDone(nextSubmission.ticket, RequestState::NO_CONNECT, JobRecord());
+            continue;
+        }
+
+        runningSubmissions.insert(theReply, nextSubmission.ticket);
+        QObject::connect(theReply, SIGNAL(haveJobReply(RequestState,QJsonDocument)),
+                         this, SLOT(jobReplied(RequestState,QJsonDocument)));
+        emit submissionStarted(nextSubmission.ticket);
+    }
+    emit queueChanged(getWaitingCount(), getRunningCount());
+}
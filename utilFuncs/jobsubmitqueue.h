@@ -0,0 +1,137 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef JOBSUBMITQUEUE_H
+#define JOBSUBMITQUEUE_H
+
+#include <QObject>
+#include <QQueue>
+#include <QMap>
+#include <QMultiMap>
+#include <QJsonDocument>
+#include <QElapsedTimer>
+
+#include "jobrecord.h"
+
+class RemoteDataReply;
+class RemoteJobModel;
+class JobCallbackListener;
+class InputStager;
+enum class RequestState;
+
+/*! \brief The JobSubmitQueue submits remote jobs, several at a time, under a limit on the rate of submission.
+ *
+ *  Each submission is given a ticket number when queued. Up to getMaxInFlight() submissions wait on the server at once,
+ *  and new submissions are started no closer together than the minimum spacing, so that a large batch does not trip the rate limits of the server.
+ *
+ *  The job record returned for each submission is put straight into the RemoteJobModel, so the job list is not fetched again.
+ *  If a JobCallbackListener is set, each new job is subscribed to it, so that its status changes are pushed to the client.
+ *
+ *  An input given as a local file URL, such as file:///home/me/mesh.stl, is a local file or folder to upload. Such inputs are staged
+ *  by an InputStager, into the staging folder, and the job is queued with the inputs rewritten to the staged remote paths once they are all uploaded.
+ */
+class JobSubmitQueue : public QObject
+{
+    Q_OBJECT
+public:
+    explicit JobSubmitQueue(RemoteJobModel * jobModel, QObject * parent = nullptr);
+
+    /*! \brief Queues a job for submission, and returns its ticket number.
+     *
+     *  The submission is not started before control returns to the event loop, so no signal refers to the ticket before it is returned.
+     *  Local inputs begin uploading at that point, so the caller should check its inputs before submitting.
+     *
+     *  \param appName The Agave app to run
+     *  \param inputs The inputs and parameters of the job
+     *  \param workingDir The remote folder for the job
+     */
+    int submitJob(QString appName, QMultiMap<QString, QString> inputs, QString workingDir);
+
+    /*! \brief Removes a submission from the queue, if it has not been sent yet. Returns true if it was removed.
+     */
+    bool cancelSubmission(int ticket);
+
+    void setCallbackListener(JobCallbackListener * theListener);
+    /*! \brief Sets the remote folder into which local inputs are uploaded. If not set, a "stagedInputs" folder in the working folder of each job is used.
+     */
+    void setStagingFolder(QString remoteFolder);
+
+    void setMaxInFlight(int newMax);
+    int getMaxInFlight();
+    /*! \brief Sets the least time, in milliseconds, between the start of two submissions. The default is 1000.
+     */
+    void setMinSpacing(int newSpacingMs);
+
+    int getWaitingCount();
+    int getRunningCount();
+
+signals:
+    void submissionStarted(int ticket);
+    void submissionDone(int ticket, RequestState finalState, JobRecord newJob);
+    void queueChanged(int waitingCount, int runningCount);
+
+private slots:
+    void jobReplied(RequestState finalState, QJsonDocument rawReply);
+    void launchSubmissions();
+    void inputsStaged(int ticket, RequestState finalState, QMap<QString, QString> remotePaths);
+
+private:
+    struct JobSubmission
+    {
+        int ticket;
+        QString appName;
+        QMultiMap<QString, QString> inputs;
+        QString workingDir;
+    };
+
+    RemoteJobModel * myJobModel;
+    JobCallbackListener * myCallbackListener = nullptr;
+
+    InputStager * getStager(QString workingDir);
+
+    QQueue<JobSubmission> waitingSubmissions;
+    QMap<int, JobSubmission> stagingSubmissions;
+    QMap<QString, InputStager *> inputStagers;
+    QString stagingFolder;
+    QMap<RemoteDataReply *, int> runningSubmissions;
+
+    int nextTicket = 1;
+    int maxInFlight = 3;
+    int minSpacingMs = 1000;
+    QElapsedTimer lastLaunchTimer;
+    bool launchTimerPending = false;
+};
+
+#endif // JOBSUBMITQUEUE_H
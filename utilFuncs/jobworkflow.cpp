@@ -0,0 +1,528 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "jobworkflow.h"
+
+#include "remotejobmodel.h"
+#include "jobsubmitqueue.h"
+#include "agaverestlink.h"
+#include "requestscheduler.h"
+#include "remotedatainterface.h"
+#include "ae_globals.h"
+
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QNetworkReply>
+#include <QRegularExpression>
+
+//Matches ${step} and ${step.input}
+static const QRegularExpression stepReference("\\$\\{([^.}]+)(?:\\.([^}]+))?\\}");
+
+JobWorkflow::JobWorkflow(RemoteJobModel * jobModel, QObject * parent) : QObject(parent)
+{
+    myJobModel = jobModel;
+
+    QObject::connect(ae_globals::get_job_queue(), SIGNAL(submissionDone(int,RequestState,JobRecord)),
+                     this, SLOT(submissionDone(int,RequestState,JobRecord)));
+    QObject::connect(myJobModel, SIGNAL(dataChanged(QModelIndex,QModelIndex,QVector<int>)),
+                     this, SLOT(jobRowsChanged(QModelIndex,QModelIndex)));
+    QObject::connect(myJobModel, SIGNAL(rowsInserted(QModelIndex,int,int)),
+                     this, SLOT(jobRowsInserted(QModelIndex,int,int)));
+}
+
+bool JobWorkflow::loadFile(QString fileName, QString * errorText)
+{
+    QFile inputFile(fileName);
+    if (!inputFile.open(QIODevice::ReadOnly))
+    {
+        if (errorText != nullptr) *errorText = QString("Unable to read %1").arg(fileName);
+        return false;
+    }
+
+    QByteArray rawText = inputFile.readAll();
+    inputFile.close();
+    return loadJSON(rawText, errorText);
+}
+
+bool JobWorkflow::loadJSON(const QByteArray &rawText, QString * errorText)
+{
+    if (workflowRunning)
+    {
+        if (errorText != nullptr) *errorText = "A workflow may not be loaded while one is running";
+        return false;
+    }
+    workflowSteps.clear();
+    stepOrder.clear();
+    ticketSteps.clear();
+    jobSteps.clear();
+
+    QJsonParseError parseError;
+    QJsonDocument parsedDoc = QJsonDocument::fromJson(rawText, &parseError);
+    if (parsedDoc.isNull() || !parsedDoc.isObject() || !parsedDoc.object().value("steps").isArray())
+    {
+        if (errorText != nullptr)
+        {
+            *errorText = parsedDoc.isNull() ? parseError.errorString() : QString("The file must hold an object with an array of steps");
+        }
+        return false;
+    }
+
+    QString defaultDir = parsedDoc.object().value("workingDir").toString();
+    QStringList fileOrder;
+    QMap<QString, WorkflowStep> newSteps;
+
+    for (const QJsonValue &aValue : parsedDoc.object().value("steps").toArray())
+    {
+        QJsonObject stepObject = aValue.toObject();
+        QString stepName = stepObject.value("name").toString();
+        WorkflowStep newStep;
+        newStep.appName = stepObject.value("app").toString();
+        newStep.workingDir = stepObject.value("workingDir").toString(defaultDir);
+
+        QString problem;
+        if (stepName.isEmpty()) problem = QString("Step %1 has no name").arg(fileOrder.size() + 1);
+        else if (newSteps.contains(stepName)) problem = QString("The step name %1 is used twice").arg(stepName);
+        else if (newStep.appName.isEmpty()) problem = QString("Step %1 has no app").arg(stepName);
+        if (!problem.isEmpty())
+        {
+            if (errorText != nullptr) *errorText = problem;
+            return false;
+        }
+
+        QJsonObject inputObject = stepObject.value("inputs").toObject();
+        for (auto itr = inputObject.constBegin(); itr != inputObject.constEnd(); itr++)
+        {
+            QString inputValue = itr.value().isDouble() ? QString::number(itr.value().toDouble()) : itr.value().toString();
+            newStep.rawInputs.insert(itr.key(), inputValue);
+            for (const QString &aReference : findReferences(inputValue))
+            {
+                if (!newStep.dependsOn.contains(aReference)) newStep.dependsOn.append(aReference);
+            }
+        }
+        for (const QJsonValue &afterValue : stepObject.value("after").toArray())
+        {
+            if (!newStep.dependsOn.contains(afterValue.toString())) newStep.dependsOn.append(afterValue.toString());
+        }
+
+        newSteps.insert(stepName, newStep);
+        fileOrder.append(stepName);
+    }
+
+    if (newSteps.isEmpty())
+    {
+        if (errorText != nullptr) *errorText = "The workflow has no steps";
+        return false;
+    }
+
+    //Steps are ordered so that each comes after those it depends on. Any left over are part of a cycle.
+    QStringList newOrder;
+    QSet<QString> placed;
+    bool placedOne = true;
+    while (placedOne && (newOrder.size() < fileOrder.size()))
+    {
+        placedOne = false;
+        for (const QString &aStep : fileOrder)
+        {
+            if (placed.contains(aStep)) continue;
+
+            bool ready = true;
+            for (const QString &aDependency : newSteps.value(aStep).dependsOn)
+            {
+                if (!newSteps.contains(aDependency))
+                {
+                    if (errorText != nullptr) *errorText = QString("Step %1 refers to %2, which is not a step").arg(aStep, aDependency);
+                    return false;
+                }
+                if (!placed.contains(aDependency)) ready = false;
+            }
+            if (!ready) continue;
+
+            newOrder.append(aStep);
+            placed.insert(aStep);
+            placedOne = true;
+        }
+    }
+    if (newOrder.size() < fileOrder.size())
+    {
+        QStringList cycleSteps;
+        for (const QString &aStep : fileOrder)
+        {
+            if (!placed.contains(aStep)) cycleSteps.append(aStep);
+        }
+        if (errorText != nullptr) *errorText = QString("These steps depend on each other in a cycle: %1").arg(cycleSteps.join(", "));
+        return false;
+    }
+
+    workflowSteps = newSteps;
+    stepOrder = newOrder;
+    for (const QString &aStep : stepOrder)
+    {
+        workflowSteps[aStep].message = "Waiting";
+    }
+    return true;
+}
+
+bool JobWorkflow::startWorkflow()
+{
+    if (workflowRunning || workflowSteps.isEmpty()) return false;
+
+    //A workflow may be run again, to retry steps which did not finish
+    for (const QString &aStep : stepOrder)
+    {
+        if (workflowSteps.value(aStep).state != StepState::FINISHED)
+        {
+            setStepState(aStep, StepState::WAITING, "Waiting");
+        }
+    }
+
+    workflowRunning = true;
+    qCDebug(agaveAppLayer, "Workflow of %d steps started", stepOrder.size());
+    submitReadySteps();
+    return true;
+}
+
+void JobWorkflow::cancelWorkflow()
+{
+    if (!workflowRunning) return;
+
+    for (const QString &aStep : stepOrder)
+    {
+        WorkflowStep &theStep = workflowSteps[aStep];
+        if (theStep.state == StepState::WAITING)
+        {
+            setStepState(aStep, StepState::CANCELLED, "Cancelled");
+        }
+        else if ((theStep.state == StepState::SUBMITTING) && ae_globals::get_job_queue()->cancelSubmission(theStep.ticket))
+        {
+            ticketSteps.remove(theStep.ticket);
+            setStepState(aStep, StepState::CANCELLED, "Cancelled");
+        }
+    }
+    checkWorkflowDone();
+}
+
+bool JobWorkflow::isRunning()
+{
+    return workflowRunning;
+}
+
+QStringList JobWorkflow::getStepNames()
+{
+    return stepOrder;
+}
+
+QString JobWorkflow::getStepApp(QString stepName)
+{
+    return workflowSteps.value(stepName).appName;
+}
+
+QStringList JobWorkflow::getStepDependencies(QString stepName)
+{
+    return workflowSteps.value(stepName).dependsOn;
+}
+
+JobWorkflow::StepState JobWorkflow::getStepState(QString stepName)
+{
+    return workflowSteps.value(stepName).state;
+}
+
+QString JobWorkflow::getStepJobId(QString stepName)
+{
+    return workflowSteps.value(stepName).jobId;
+}
+
+QString JobWorkflow::getStepOutputPath(QString stepName)
+{
+    return workflowSteps.value(stepName).outputPath;
+}
+
+QString JobWorkflow::getStepMessage(QString stepName)
+{
+    return workflowSteps.value(stepName).message;
+}
+
+void JobWorkflow::submissionDone(int ticket, RequestState finalState, JobRecord newJob)
+{
+    if (!ticketSteps.contains(ticket)) return;
+    QString stepName = ticketSteps.take(ticket);
+
+    if (finalState != RequestState::GOOD)
+    {
+        setStepState(stepName, StepState::FAILED, "Submission failed");
+        skipDependents(stepName);
+        checkWorkflowDone();
+        return;
+    }
+    //Without a job ID, the job cannot be followed, so nothing may wait on it
+    if (newJob.id.isEmpty())
+    {
+        setStepState(stepName, StepState::FAILED, "Submitted, but no job ID was returned");
+        skipDependents(stepName);
+        checkWorkflowDone();
+        return;
+    }
+
+    workflowSteps[stepName].jobId = newJob.id;
+    jobSteps.insert(newJob.id, stepName);
+    setStepState(stepName, StepState::RUNNING, newJob.status);
+    checkJob(newJob);
+}
+
+void JobWorkflow::jobRowsChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+{
+    if (jobSteps.isEmpty()) return;
+
+    for (int row = topLeft.row(); row <= bottomRight.row(); row++)
+    {
+        checkJob(myJobModel->getJob(row));
+    }
+}
+
+void JobWorkflow::jobRowsInserted(const QModelIndex &, int first, int last)
+{
+    if (jobSteps.isEmpty()) return;
+
+    for (int row = first; row <= last; row++)
+    {
+        checkJob(myJobModel->getJob(row));
+    }
+}
+
+void JobWorkflow::jobDetailsReplied()
+{
+    QNetworkReply * theReply = qobject_cast<QNetworkReply *>(sender());
+    if (theReply == nullptr) return;
+    theReply->deleteLater();
+
+    QString jobId = theReply->property("jobId").toString();
+    detailsRequested.remove(jobId);
+    if (!jobSteps.contains(jobId)) return;
+
+    JobRecord theJob;
+    QJsonValue replyResult = AgaveRestLink::getReplyResult(theReply->readAll());
+    if ((theReply->error() != QNetworkReply::NoError) || !JobRecord::parseJobEntry(replyResult.toObject(), &theJob) || theJob.archivePath.isEmpty())
+    {
+        QString stepName = jobSteps.take(jobId);
+        setStepState(stepName, StepState::FAILED, "Unable to find the output folder of the job");
+        skipDependents(stepName);
+        checkWorkflowDone();
+        return;
+    }
+
+    myJobModel->upsertJob(theJob);
+    checkJob(theJob);
+}
+
+void JobWorkflow::setStepState(QString stepName, StepState newState, QString message)
+{
+    if (!workflowSteps.contains(stepName)) return;
+
+    WorkflowStep &theStep = workflowSteps[stepName];
+    if ((theStep.state == newState) && (theStep.message == message)) return;
+    theStep.state = newState;
+    theStep.message = message;
+    emit stepChanged(stepName);
+}
+
+void JobWorkflow::submitReadySteps()
+{
+    if (!workflowRunning) return;
+
+    for (const QString &aStep : stepOrder)
+    {
+        WorkflowStep &theStep = workflowSteps[aStep];
+        if (theStep.state != StepState::WAITING) continue;
+
+        bool ready = true;
+        for (const QString &aDependency : theStep.dependsOn)
+        {
+            if (workflowSteps.value(aDependency).state != StepState::FINISHED) ready = false;
+        }
+        if (!ready) continue;
+
+        QMultiMap<QString, QString> allInputs;
+        theStep.resolvedInputs.clear();
+        for (auto itr = theStep.rawInputs.cbegin(); itr != theStep.rawInputs.cend(); itr++)
+        {
+            QString resolvedValue = resolveInput(itr.value());
+            theStep.resolvedInputs.insert(itr.key(), resolvedValue);
+            allInputs.insert(itr.key(), resolvedValue);
+        }
+
+        theStep.ticket = ae_globals::get_job_queue()->submitJob(theStep.appName, allInputs, theStep.workingDir);
+        theStep.jobId.clear();
+        theStep.outputPath.clear();
+        ticketSteps.insert(theStep.ticket, aStep);
+        setStepState(aStep, StepState::SUBMITTING, "Submitting . . .");
+    }
+}
+
+void JobWorkflow::checkJob(const JobRecord &theJob)
+{
+    if (!jobSteps.contains(theJob.id)) return;
+    QString stepName = jobSteps.value(theJob.id);
+
+    if (!theJob.isTerminal())
+    {
+        setStepState(stepName, StepState::RUNNING, theJob.status);
+        return;
+    }
+
+    if (theJob.status != "FINISHED")
+    {
+        jobSteps.remove(theJob.id);
+        setStepState(stepName, StepState::FAILED, QString("Job ended with %1").arg(theJob.status));
+        skipDependents(stepName);
+        checkWorkflowDone();
+        return;
+    }
+
+    //The job list does not give the archive path, which must be asked for separately
+    if (theJob.archivePath.isEmpty())
+    {
+        requestJobDetails(theJob.id);
+        return;
+    }
+
+    jobSteps.remove(theJob.id);
+    QString outputPath = theJob.archivePath;
+    if (!outputPath.startsWith('/')) outputPath.prepend('/');
+    stepFinished(stepName, outputPath);
+}
+
+void JobWorkflow::requestJobDetails(QString jobId)
+{
+    if (detailsRequested.contains(jobId)) return;
+    detailsRequested.insert(jobId);
+
+    ae_globals::get_rest_link()->getScheduler()->scheduleRequest(RequestPriority::BACKGROUND, this, [this, jobId]()
+    {
+        QNetworkReply * theReply = ae_globals::get_rest_link()->requestJobDetails(jobId);
+        if (theReply == nullptr)
+        {
+            detailsRequested.remove(jobId);
+            return theReply;
+        }
+        theReply->setProperty("jobId", jobId);
+        QObject::connect(theReply, SIGNAL(finished()), this, SLOT(jobDetailsReplied()));
+        return theReply;
+    });
+}
+
+void JobWorkflow::stepFinished(QString stepName, QString outputPath)
+{
+    workflowSteps[stepName].outputPath = outputPath;
+    setStepState(stepName, StepState::FINISHED, QString("Finished: %1").arg(outputPath));
+    qCDebug(agaveAppLayer, "Workflow step %s finished", qPrintable(stepName));
+
+    submitReadySteps();
+    checkWorkflowDone();
+}
+
+void JobWorkflow::skipDependents(QString failedStep)
+{
+    //Steps are in dependency order, so one pass reaches every step downstream of the failure
+    QSet<QString> blockedSteps;
+    blockedSteps.insert(failedStep);
+    for (const QString &aStep : stepOrder)
+    {
+        const WorkflowStep &theStep = workflowSteps[aStep];
+        if (theStep.state != StepState::WAITING) continue;
+
+        for (const QString &aDependency : theStep.dependsOn)
+        {
+            if (!blockedSteps.contains(aDependency)) continue;
+
+            blockedSteps.insert(aStep);
+            setStepState(aStep, StepState::SKIPPED, QString("Skipped, since %1 did not finish").arg(aDependency));
+            break;
+        }
+    }
+}
+
+void JobWorkflow::checkWorkflowDone()
+{
+    if (!workflowRunning) return;
+
+    bool allFinished = true;
+    for (const WorkflowStep &aStep : workflowSteps)
+    {
+        if ((aStep.state == StepState::WAITING) || (aStep.state == StepState::SUBMITTING) || (aStep.state == StepState::RUNNING)) return;
+        if (aStep.state != StepState::FINISHED) allFinished = false;
+    }
+
+    workflowRunning = false;
+    qCDebug(agaveAppLayer, "Workflow done, %s", allFinished ? "all steps finished" : "some steps did not finish");
+    emit workflowDone(allFinished ? RequestState::GOOD : RequestState::EXPLICIT_ERROR);
+}
+
+QString JobWorkflow::resolveInput(const QString &rawValue)
+{
+    QString ret;
+    int readPos = 0;
+    QRegularExpressionMatchIterator matchItr = stepReference.globalMatch(rawValue);
+    while (matchItr.hasNext())
+    {
+        QRegularExpressionMatch aMatch = matchItr.next();
+        ret.append(rawValue.mid(readPos, aMatch.capturedStart() - readPos));
+
+        WorkflowStep refStep = workflowSteps.value(aMatch.captured(1));
+        if (aMatch.captured(2).isEmpty())
+        {
+            ret.append(refStep.outputPath);
+        }
+        else
+        {
+            ret.append(refStep.resolvedInputs.value(aMatch.captured(2)));
+        }
+        readPos = aMatch.capturedEnd();
+    }
+    ret.append(rawValue.mid(readPos));
+    return ret;
+}
+
+QStringList JobWorkflow::findReferences(const QString &rawValue)
+{
+    QStringList ret;
+    QRegularExpressionMatchIterator matchItr = stepReference.globalMatch(rawValue);
+    while (matchItr.hasNext())
+    {
+        ret.append(matchItr.next().captured(1));
+    }
+    return ret;
+}
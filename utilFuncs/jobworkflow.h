@@ -0,0 +1,145 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef JOBWORKFLOW_H
+#define JOBWORKFLOW_H
+
+#include <QObject>
+#include <QMap>
+#include <QSet>
+#include <QStringList>
+#include <QModelIndex>
+
+#include "jobrecord.h"
+
+class RemoteJobModel;
+enum class RequestState;
+
+/*! \brief The JobWorkflow runs a set of jobs in which some jobs take the output of others, such as compress, then simulate, then extract.
+ *
+ *  The workflow is read from a JSON file, which holds an object with a "steps" array and an optional "workingDir". Each step has a "name",
+ *  an "app", an "inputs" object, and, optionally, its own "workingDir" and an "after" list of steps which must finish before it starts.
+ *  An input may refer to an earlier step: "${step}" is replaced by the archive folder of that step's job, and "${step.input}" by the value
+ *  of one of that step's inputs. A step depends on every step it refers to, as well as those in its "after" list.
+ *
+ *  Each step is handed to the JobSubmitQueue as soon as all the steps it depends on have finished, so independent branches run at the same time.
+ *  The status of each job is followed in the RemoteJobModel. If a step fails, the steps which depend on it are skipped, and other branches go on.
+ */
+class JobWorkflow : public QObject
+{
+    Q_OBJECT
+public:
+    enum class StepState {WAITING, SUBMITTING, RUNNING, FINISHED, FAILED, SKIPPED, CANCELLED};
+
+    explicit JobWorkflow(RemoteJobModel * jobModel, QObject * parent = nullptr);
+
+    /*! \brief Reads the workflow from a JSON file.
+     *
+     *  Returns false, and sets errorText, if the file cannot be read, is malformed, refers to a step which does not exist, or has a cycle.
+     *  On failure, the workflow is left empty. A workflow may not be loaded while one is running.
+     */
+    bool loadFile(QString fileName, QString * errorText = nullptr);
+    bool loadJSON(const QByteArray &rawText, QString * errorText = nullptr);
+
+    /*! \brief Begins the workflow, submitting every step which depends on no other. Returns false if it is empty or already running.
+     */
+    bool startWorkflow();
+    /*! \brief Stops submitting steps. Jobs already on the server are left to run.
+     */
+    void cancelWorkflow();
+    bool isRunning();
+
+    /*! \brief Returns the names of the steps, in an order in which each step comes after those it depends on.
+     */
+    QStringList getStepNames();
+    QString getStepApp(QString stepName);
+    QStringList getStepDependencies(QString stepName);
+    StepState getStepState(QString stepName);
+    QString getStepJobId(QString stepName);
+    /*! \brief Returns the archive folder of a finished step's job, or an empty string if the step has not finished.
+     */
+    QString getStepOutputPath(QString stepName);
+    /*! \brief Returns a description of the current state of a step, for display.
+     */
+    QString getStepMessage(QString stepName);
+
+signals:
+    void stepChanged(QString stepName);
+    void workflowDone(RequestState finalState);
+
+private slots:
+    void submissionDone(int ticket, RequestState finalState, JobRecord newJob);
+    void jobRowsChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+    void jobRowsInserted(const QModelIndex &parent, int first, int last);
+    void jobDetailsReplied();
+
+private:
+    struct WorkflowStep
+    {
+        QString appName;
+        QString workingDir;
+        QMap<QString, QString> rawInputs;
+        QMap<QString, QString> resolvedInputs;
+        QStringList dependsOn;
+
+        StepState state = StepState::WAITING;
+        QString message;
+        int ticket = -1;
+        QString jobId;
+        QString outputPath;
+    };
+
+    void setStepState(QString stepName, StepState newState, QString message);
+    void submitReadySteps();
+    void checkJob(const JobRecord &theJob);
+    void requestJobDetails(QString jobId);
+    void stepFinished(QString stepName, QString outputPath);
+    void skipDependents(QString failedStep);
+    void checkWorkflowDone();
+
+    QString resolveInput(const QString &rawValue);
+    static QStringList findReferences(const QString &rawValue);
+
+    RemoteJobModel * myJobModel;
+
+    QMap<QString, WorkflowStep> workflowSteps;
+    QStringList stepOrder;
+    QMap<int, QString> ticketSteps;
+    QMap<QString, QString> jobSteps;
+    QSet<QString> detailsRequested;
+    bool workflowRunning = false;
+};
+
+#endif // JOBWORKFLOW_H
@@ -0,0 +1,273 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+#include "logtail.h"
+
+#include "jobrecord.h"
+#include "remotejobmodel.h"
+#include "agaverestlink.h"
+#include "requestscheduler.h"
+#include "requestretry.h"
+#include "remotedatainterface.h"
+#include "ae_globals.h"
+
+#include <QNetworkReply>
+#include <QRegExp>
+
+LogTail::LogTail(QString remotePath, QString jobId, QObject * parent) : QObject(parent)
+{
+    myRemotePath = remotePath;
+    myJobId = jobId;
+
+    pollTimer.setSingleShot(true);
+    QObject::connect(&pollTimer, SIGNAL(timeout()), this, SLOT(pollFile()));
+}
+
+bool LogTail::startTail()
+{
+    if (tailStarted) return false;
+    if (!ae_globals::get_rest_link()->credentialsAvailable()) return false;
+
+    tailStarted = true;
+    tailRunning = true;
+
+    if (!myJobId.isEmpty())
+    {
+        RemoteJobModel * jobModel = ae_globals::get_job_model();
+        QObject::connect(jobModel, SIGNAL(dataChanged(QModelIndex,QModelIndex,QVector<int>)),
+                         this, SLOT(jobRowsChanged(QModelIndex,QModelIndex)));
+        QObject::connect(jobModel, SIGNAL(rowsInserted(QModelIndex,int,int)),
+                         this, SLOT(jobRowsInserted(QModelIndex,int,int)));
+
+        //The job may have ended already, in which case one poll reads what is left
+        if (jobModel->hasJob(myJobId) && jobModel->getJobById(myJobId).isTerminal())
+        {
+            jobEnded = true;
+        }
+    }
+
+    pollFile();
+    return true;
+}
+
+void LogTail::stopTail()
+{
+    if (!tailRunning) return;
+    finishTail(RequestState::GOOD);
+}
+
+bool LogTail::isRunning()
+{
+    return tailRunning;
+}
+
+QString LogTail::getRemotePath()
+{
+    return myRemotePath;
+}
+
+QString LogTail::getJobId()
+{
+    return myJobId;
+}
+
+qint64 LogTail::getKnownSize()
+{
+    return knownSize;
+}
+
+int LogTail::getPollInterval()
+{
+    return pollInterval;
+}
+
+void LogTail::pollFile()
+{
+    if (!tailRunning || pollPending) return;
+    pollPending = true;
+
+    ae_globals::get_rest_link()->getScheduler()->scheduleRequest(RequestPriority::BACKGROUND, this, [this]()
+    {
+        QNetworkReply * theReply = nullptr;
+        if (tailRunning)
+        {
+            theReply = ae_globals::get_rest_link()->requestFileContents(myRemotePath, knownSize, knownSize + maxPollBytes - 1);
+        }
+        if (theReply == nullptr)
+        {
+            pollPending = false;
+            if (tailRunning) finishTail(RequestState::NO_CONNECT);
+            return theReply;
+        }
+        pendingReply = theReply;
+        QObject::connect(theReply, SIGNAL(finished()), this, SLOT(pollReplied()));
+        return theReply;
+    });
+}
+
+void LogTail::pollReplied()
+{
+    QNetworkReply * theReply = qobject_cast<QNetworkReply *>(sender());
+    if ((theReply == nullptr) || (theReply != pendingReply)) return;
+    theReply->deleteLater();
+    pendingReply = nullptr;
+    pollPending = false;
+
+    int httpStatus = theReply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+
+    //A range starting at the end of the file is not satisfiable, which means nothing new was written
+    if (httpStatus == 416)
+    {
+        failedPolls = 0;
+        QRegExp fullSizePattern("\\*/(\\d+)");
+        if ((fullSizePattern.indexIn(QString::fromLatin1(theReply->rawHeader("Content-Range"))) >= 0) && (fullSizePattern.cap(1).toLongLong() < knownSize))
+        {
+            knownSize = 0;
+            emit fileTruncated();
+            pollDone(false, true);
+            return;
+        }
+        pollDone(false, false);
+        return;
+    }
+
+    if (theReply->error() != QNetworkReply::NoError)
+    {
+        RetryHint theHint = RequestRetry::classifyReply(theReply);
+        failedPolls++;
+        if (!theHint.retryable || (failedPolls >= RequestRetry::maxAttempts))
+        {
+            qCDebug(agaveAppLayer, "Unable to follow %s: %s", qPrintable(myRemotePath), qPrintable(theReply->errorString()));
+            finishTail(theHint.retryable ? RequestState::NO_CONNECT : RequestState::EXPLICIT_ERROR);
+            return;
+        }
+        pollTimer.start(RequestRetry::backoffDelayMs(failedPolls, theHint));
+        return;
+    }
+    failedPolls = 0;
+
+    QByteArray newData = theReply->readAll();
+    //A full range means more of the file may be waiting
+    bool moreWaiting = (httpStatus == 206) && (newData.size() >= maxPollBytes);
+
+    //A server which ignores the range sends the whole file, of which only the new end is kept
+    if (httpStatus == 200)
+    {
+        if (newData.size() < knownSize)
+        {
+            knownSize = 0;
+            emit fileTruncated();
+        }
+        newData.remove(0, knownSize);
+    }
+
+    knownSize += newData.size();
+    if (!newData.isEmpty()) emit dataAppended(newData);
+    pollDone(!newData.isEmpty(), moreWaiting);
+}
+
+void LogTail::jobRowsChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+{
+    if (!tailRunning || jobEnded) return;
+
+    for (int row = topLeft.row(); row <= bottomRight.row(); row++)
+    {
+        checkJob(ae_globals::get_job_model()->getJob(row));
+    }
+}
+
+void LogTail::jobRowsInserted(const QModelIndex &, int first, int last)
+{
+    if (!tailRunning || jobEnded) return;
+
+    for (int row = first; row <= last; row++)
+    {
+        checkJob(ae_globals::get_job_model()->getJob(row));
+    }
+}
+
+void LogTail::checkJob(const JobRecord &theJob)
+{
+    if ((theJob.id != myJobId) || !theJob.isTerminal()) return;
+
+    //The job may have written its last lines since the previous poll, so one more is made at once
+    jobEnded = true;
+    if (!pollPending)
+    {
+        pollTimer.stop();
+        pollFile();
+    }
+}
+
+void LogTail::pollDone(bool gotData, bool moreWaiting)
+{
+    if (moreWaiting)
+    {
+        pollTimer.start(0);
+        return;
+    }
+
+    if (jobEnded)
+    {
+        finishTail(RequestState::GOOD);
+        return;
+    }
+
+    if (gotData)
+    {
+        pollInterval = minPollMs;
+    }
+    else
+    {
+        pollInterval = qMin(pollInterval * 2, maxPollMs);
+    }
+    pollTimer.start(pollInterval);
+}
+
+void LogTail::finishTail(RequestState finalState)
+{
+    tailRunning = false;
+    pollTimer.stop();
+    if (pendingReply != nullptr)
+    {
+        QObject::disconnect(pendingReply, nullptr, this, nullptr);
+        pendingReply->abort();
+        pendingReply->deleteLater();
+        pendingReply = nullptr;
+    }
+    pollPending = false;
+    QObject::disconnect(ae_globals::get_job_model(), nullptr, this, nullptr);
+
+    emit tailDone(finalState);
+}
@@ -0,0 +1,111 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+#ifndef LOGTAIL_H
+#define LOGTAIL_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QTimer>
+#include <QModelIndex>
+
+class QNetworkReply;
+class JobRecord;
+enum class RequestState;
+
+/*! \brief The LogTail follows a growing remote file, such as the log of a running job, fetching only the bytes added since the last poll.
+ *
+ *  Each poll asks for a byte range starting at the size already seen. The poll interval starts short and doubles while the file does not grow,
+ *  up to maxPollMs, and drops back once new data arrives. A backlog larger than maxPollBytes is fetched in several polls, one right after the other.
+ *
+ *  If a job ID is given, the tail follows the job's status in the RemoteJobModel, and stops after one last poll once the job reaches a terminal status.
+ *  Without one, the tail goes on until stopTail() is called.
+ */
+class LogTail : public QObject
+{
+    Q_OBJECT
+public:
+    explicit LogTail(QString remotePath, QString jobId = QString(), QObject * parent = nullptr);
+
+    /*! \brief Starts polling the file. A LogTail is only started once. Returns false if no direct request can be made to the server.
+     */
+    bool startTail();
+    bool isRunning();
+
+    QString getRemotePath();
+    QString getJobId();
+    qint64 getKnownSize();
+    int getPollInterval();
+
+    static const int minPollMs = 2000;
+    static const int maxPollMs = 30000;
+    static const qint64 maxPollBytes = 1024 * 1024;
+
+public slots:
+    void stopTail();
+
+signals:
+    void dataAppended(QByteArray newData);
+    //The file became shorter than what was already seen, and is read again from the start
+    void fileTruncated();
+    void tailDone(RequestState finalState);
+
+private slots:
+    void pollFile();
+    void pollReplied();
+    void jobRowsChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+    void jobRowsInserted(const QModelIndex &parent, int first, int last);
+
+private:
+    void checkJob(const JobRecord &theJob);
+    void pollDone(bool gotData, bool moreWaiting);
+    void finishTail(RequestState finalState);
+
+    QString myRemotePath;
+    QString myJobId;
+
+    QTimer pollTimer;
+    QNetworkReply * pendingReply = nullptr;
+    bool pollPending = false;
+
+    qint64 knownSize = 0;
+    int pollInterval = minPollMs;
+    int failedPolls = 0;
+
+    bool tailStarted = false;
+    bool tailRunning = false;
+    bool jobEnded = false;
+};
+
+#endif // LOGTAIL_H
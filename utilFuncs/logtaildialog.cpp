@@ -0,0 +1,129 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+#include "logtaildialog.h"
+#include "ui_logtaildialog.h"
+
+#include "remotedatainterface.h"
+#include "ae_globals.h"
+
+#include <QScrollBar>
+#include <QTextCodec>
+#include <QTextDecoder>
+
+LogTailDialog::LogTailDialog(QString remotePath, QString jobId, QWidget *parent) :
+    QDialog(parent),
+    ui(new Ui::LogTailDialog),
+    myTail(remotePath, jobId)
+{
+    ui->setupUi(this);
+    this->setAttribute(Qt::WA_DeleteOnClose);
+    this->setWindowTitle(QString("Following %1").arg(remotePath.section('/', -1)));
+
+    myDecoder = QTextCodec::codecForName("UTF-8")->makeDecoder();
+
+    ui->logView->setReadOnly(true);
+    ui->logView->setMaximumBlockCount(maxLines);
+    ui->logView->setLineWrapMode(QPlainTextEdit::NoWrap);
+
+    QObject::connect(ui->stopButton, SIGNAL(clicked(bool)), &myTail, SLOT(stopTail()));
+
+    QObject::connect(&myTail, SIGNAL(dataAppended(QByteArray)), this, SLOT(dataAppended(QByteArray)));
+    QObject::connect(&myTail, SIGNAL(fileTruncated()), this, SLOT(fileTruncated()));
+    QObject::connect(&myTail, SIGNAL(tailDone(RequestState)), this, SLOT(tailDone(RequestState)));
+}
+
+LogTailDialog::~LogTailDialog()
+{
+    QObject::disconnect(&myTail, nullptr, this, nullptr);
+    myTail.stopTail();
+    delete myDecoder;
+    delete ui;
+}
+
+bool LogTailDialog::startFollowing()
+{
+    if (!myTail.startTail()) return false;
+
+    if (myTail.getJobId().isEmpty())
+    {
+        statusText = "Following until stopped";
+    }
+    else
+    {
+        statusText = QString("Following until job %1 ends").arg(myTail.getJobId());
+    }
+    updateStatus();
+    return true;
+}
+
+void LogTailDialog::dataAppended(QByteArray newData)
+{
+    //The view only follows the end of the file if it was already scrolled to the bottom
+    QScrollBar * theScrollBar = ui->logView->verticalScrollBar();
+    bool atBottom = (theScrollBar->value() == theScrollBar->maximum());
+
+    ui->logView->moveCursor(QTextCursor::End);
+    ui->logView->insertPlainText(myDecoder->toUnicode(newData));
+
+    if (atBottom) theScrollBar->setValue(theScrollBar->maximum());
+    updateStatus();
+}
+
+void LogTailDialog::fileTruncated()
+{
+    ui->logView->clear();
+    delete myDecoder;
+    myDecoder = QTextCodec::codecForName("UTF-8")->makeDecoder();
+    updateStatus();
+}
+
+void LogTailDialog::tailDone(RequestState finalState)
+{
+    ui->stopButton->setEnabled(false);
+    if (finalState == RequestState::GOOD)
+    {
+        statusText = myTail.getJobId().isEmpty() ? "Stopped" : QString("Stopped, job %1 has ended").arg(myTail.getJobId());
+    }
+    else
+    {
+        statusText = "Stopped, the file could not be read";
+    }
+    updateStatus();
+}
+
+void LogTailDialog::updateStatus()
+{
+    ui->statusLabel->setText(QString("%1: %2 bytes read").arg(statusText).arg(myTail.getKnownSize()));
+}
@@ -0,0 +1,82 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+#ifndef LOGTAILDIALOG_H
+#define LOGTAILDIALOG_H
+
+#include <QDialog>
+
+#include "logtail.h"
+
+class QTextDecoder;
+enum class RequestState;
+
+namespace Ui {
+class LogTailDialog;
+}
+
+/*! \brief The LogTailDialog shows a remote file as it grows, using a LogTail to fetch only the new bytes.
+ *
+ *  The dialog is not modal, and deletes itself when closed, which stops following the file.
+ *  Only the last maxLines lines are kept in the view.
+ */
+class LogTailDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit LogTailDialog(QString remotePath, QString jobId = QString(), QWidget *parent = nullptr);
+    ~LogTailDialog();
+
+    bool startFollowing();
+
+    static const int maxLines = 20000;
+
+private slots:
+    void dataAppended(QByteArray newData);
+    void fileTruncated();
+    void tailDone(RequestState finalState);
+
+private:
+    void updateStatus();
+
+    Ui::LogTailDialog *ui;
+
+    LogTail myTail;
+    //Kept between polls, so that a character split across two polls is decoded whole
+    QTextDecoder * myDecoder;
+    QString statusText;
+};
+
+#endif // LOGTAILDIALOG_H
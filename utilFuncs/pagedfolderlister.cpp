@@ -0,0 +1,220 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "pagedfolderlister.h"
+
+#include "agaverestlink.h"
+#include "requestscheduler.h"
+#include "requestretry.h"
+#include "remotedatainterface.h"
+#include "ae_globals.h"
+
+#include <QJsonArray>
+#include <QTimer>
+
+PagedFolderLister::PagedFolderLister(QString folderPath, QObject * parent) : QObject(parent)
+{
+    myFolderPath = folderPath;
+}
+
+PagedFolderLister::~PagedFolderLister()
+{
+    QList<QNetworkReply *> openReplies = replyPageNums.keys();
+    for (QNetworkReply * aReply : openReplies)
+    {
+        aReply->disconnect(this);
+        aReply->abort();
+        aReply->deleteLater();
+    }
+}
+
+void PagedFolderLister::setPageSize(int newSize)
+{
+    if (newSize < 1) return;
+    pageSize = newSize;
+}
+
+void PagedFolderLister::setParallelPages(int newCount)
+{
+    if (newCount < 1) return;
+    parallelPages = newCount;
+}
+
+void PagedFolderLister::setPriority(RequestPriority newPriority)
+{
+    listingPriority = newPriority;
+}
+
+bool PagedFolderLister::startListing()
+{
+    AgaveRestLink * theLink = ae_globals::get_rest_link();
+    if ((theLink == nullptr) || (!theLink->credentialsAvailable())) return false;
+    if (nextPageToLaunch != 0) return false;
+
+    launchPages();
+    return true;
+}
+
+QString PagedFolderLister::getFolderPath()
+{
+    return myFolderPath;
+}
+
+void PagedFolderLister::pageReplied()
+{
+    QNetworkReply * theReply = qobject_cast<QNetworkReply *>(sender());
+    if (theReply == nullptr) return;
+    theReply->deleteLater();
+
+    int pageNum = replyPageNums.take(theReply);
+    pagesInFlight--;
+    if (listingFinished) return;
+
+    if (theReply->error() != QNetworkReply::NoError)
+    {
+        qCDebug(agaveAppLayer, "Listing page %d of %s failed: %s", pageNum, qPrintable(myFolderPath), qPrintable(theReply->errorString()));
+
+        RetryHint failureHint = RequestRetry::classifyReply(theReply);
+        int attemptNum = ++pageAttempts[pageNum];
+        if (failureHint.retryable && (attemptNum < RequestRetry::maxAttempts))
+        {
+            //The page stays in flight while it waits to be sent again
+            pagesInFlight++;
+            QTimer::singleShot(RequestRetry::backoffDelayMs(attemptNum, failureHint), this, [this, pageNum]()
+            {
+                ae_globals::get_rest_link()->getScheduler()->scheduleRequest(listingPriority, this, [this, pageNum]() { return sendPageRequest(pageNum); });
+            });
+            return;
+        }
+        finishListing(RequestState::NO_CONNECT);
+        return;
+    }
+
+    QJsonValue pageResult = AgaveRestLink::getReplyResult(theReply->readAll());
+    if (!pageResult.isArray())
+    {
+        finishListing(RequestState::EXPLICIT_ERROR);
+        return;
+    }
+
+    QJsonArray rawEntries = pageResult.toArray();
+    QList<FileMetaData> pageEntries;
+    for (auto itr = rawEntries.constBegin(); itr != rawEntries.constEnd(); itr++)
+    {
+        FileMetaData anEntry;
+        qint64 entrySize = 0;
+        if (AgaveRestLink::parseFileEntry((*itr).toObject(), &anEntry, &entrySize))
+        {
+            pageEntries.append(anEntry);
+            if (anEntry.getFileType() == FileType::FILE) fileSizes.insert(anEntry.getFullPath(), entrySize);
+        }
+    }
+
+    //A short page is the end of the folder, pages requested past it will come back empty
+    if ((rawEntries.size() < pageSize) && ((lastPage == -1) || (pageNum < lastPage)))
+    {
+        lastPage = pageNum;
+    }
+    unmergedPages.insert(pageNum, pageEntries);
+
+    QList<FileMetaData> newEntries;
+    while (unmergedPages.contains(nextPageToMerge))
+    {
+        newEntries.append(unmergedPages.take(nextPageToMerge));
+        nextPageToMerge++;
+    }
+    if (!newEntries.isEmpty())
+    {
+        mergedEntries.append(newEntries);
+        emit pageMerged(myFolderPath, newEntries);
+    }
+
+    if ((lastPage != -1) && (nextPageToMerge > lastPage))
+    {
+        finishListing(RequestState::GOOD);
+        return;
+    }
+    launchPages();
+}
+
+void PagedFolderLister::launchPages()
+{
+    RequestScheduler * theScheduler = ae_globals::get_rest_link()->getScheduler();
+
+    //Note: Pages waiting in the scheduler count as in flight
+    while ((pagesInFlight < parallelPages) && ((lastPage == -1) || (nextPageToLaunch <= lastPage)))
+    {
+        int pageNum = nextPageToLaunch;
+        nextPageToLaunch++;
+        pagesInFlight++;
+        theScheduler->scheduleRequest(listingPriority, this, [this, pageNum]() { return sendPageRequest(pageNum); });
+    }
+}
+
+QNetworkReply * PagedFolderLister::sendPageRequest(int pageNum)
+{
+    if (listingFinished || ((lastPage != -1) && (pageNum > lastPage)))
+    {
+        pagesInFlight--;
+        return nullptr;
+    }
+
+    QNetworkReply * pageReply = ae_globals::get_rest_link()->requestListingPage(myFolderPath, pageNum * pageSize, pageSize);
+    if (pageReply == nullptr)
+    {
+        pagesInFlight--;
+        finishListing(RequestState::NO_CONNECT);
+        return nullptr;
+    }
+
+    replyPageNums.insert(pageReply, pageNum);
+    QObject::connect(pageReply, SIGNAL(finished()), this, SLOT(pageReplied()));
+    return pageReply;
+}
+
+void PagedFolderLister::finishListing(RequestState finalState)
+{
+    if (listingFinished) return;
+    listingFinished = true;
+
+    QList<QNetworkReply *> openReplies = replyPageNums.keys();
+    for (QNetworkReply * aReply : openReplies)
+    {
+        aReply->abort();
+    }
+
+    emit listingDone(finalState, myFolderPath, mergedEntries, fileSizes);
+    this->deleteLater();
+}
@@ -0,0 +1,119 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef PAGEDFOLDERLISTER_H
+#define PAGEDFOLDERLISTER_H
+
+#include <QObject>
+#include <QMap>
+#include <QHash>
+#include <QList>
+
+#include "filemetadata.h"
+#include "requestscheduler.h"
+
+class QNetworkReply;
+enum class RequestState;
+
+//The full size of each listed file, by full path, as FileMetaData only holds an int
+typedef QHash<QString, qint64> FileSizeMap;
+
+/*! \brief The PagedFolderLister fetches the listing of a remote folder as several limit/offset pages, with several pages in flight at once.
+ *
+ *  Pages are merged in order as they arrive, so that the first entries of a very large folder are available before the last page is received.
+ *  After each merge, the pageMerged() signal gives the newly merged entries. The listingDone() signal is emitted once, at the end, with all entries.
+ *  A page which fails in a way which may be transient is requested again, after a backoff from RequestRetry.
+ *
+ *  The PagedFolderLister deletes itself after emitting listingDone().
+ */
+class PagedFolderLister : public QObject
+{
+    Q_OBJECT
+public:
+    /*! \brief Constructs a new PagedFolderLister for one remote folder.
+     *
+     *  \param folderPath The full path of the remote folder to list
+     *  \param parent The object requesting the listing is typically the parent
+     */
+    explicit PagedFolderLister(QString folderPath, QObject * parent = nullptr);
+    ~PagedFolderLister();
+
+    /*! \brief Sets the number of entries in each page. The default is 500.
+     */
+    void setPageSize(int newSize);
+    /*! \brief Sets the number of pages requested at the same time. The default is 4.
+     */
+    void setParallelPages(int newCount);
+    /*! \brief Sets the scheduling class for the page requests. The default is INTERACTIVE.
+     */
+    void setPriority(RequestPriority newPriority);
+
+    /*! \brief Begins the listing. Returns false if the listing could not be started.
+     */
+    bool startListing();
+
+    QString getFolderPath();
+
+signals:
+    void pageMerged(QString folderPath, QList<FileMetaData> newEntries);
+    void listingDone(RequestState finalState, QString folderPath, QList<FileMetaData> allEntries, FileSizeMap fileSizes);
+
+private slots:
+    void pageReplied();
+
+private:
+    void launchPages();
+    QNetworkReply * sendPageRequest(int pageNum);
+    void finishListing(RequestState finalState);
+
+    QString myFolderPath;
+    int pageSize = 500;
+    int parallelPages = 4;
+    RequestPriority listingPriority = RequestPriority::INTERACTIVE;
+
+    int nextPageToLaunch = 0;
+    int nextPageToMerge = 0;
+    int lastPage = -1;
+    int pagesInFlight = 0;
+    bool listingFinished = false;
+
+    QMap<QNetworkReply *, int> replyPageNums;
+    QHash<int, int> pageAttempts;
+    QMap<int, QList<FileMetaData>> unmergedPages;
+    QList<FileMetaData> mergedEntries;
+    FileSizeMap fileSizes;
+};
+
+#endif // PAGEDFOLDERLISTER_H
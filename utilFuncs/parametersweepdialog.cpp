@@ -0,0 +1,251 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "parametersweepdialog.h"
+#include "ui_parametersweepdialog.h"
+
+#include "jobsubmitqueue.h"
+#include "joboutputfetcher.h"
+#include "remotedatainterface.h"
+#include "ae_globals.h"
+
+#include <QTableWidgetItem>
+
+ParameterSweepDialog::ParameterSweepDialog(QString appName, QStringList requiredParams, QString workingDir, QWidget *parent) :
+    QDialog(parent),
+    ui(new Ui::ParameterSweepDialog)
+{
+    ui->setupUi(this);
+    this->setAttribute(Qt::WA_DeleteOnClose);
+
+    myAppName = appName;
+    myParams = requiredParams;
+    myWorkingDir = workingDir;
+
+    this->setWindowTitle(QString("Parameter Sweep: %1").arg(myAppName));
+    ui->workingDirLabel->setText(myWorkingDir);
+    ui->sweepTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    ui->submitButton->setEnabled(false);
+    ui->cancelButton->setEnabled(false);
+
+    QObject::connect(ui->loadButton, SIGNAL(clicked(bool)), this, SLOT(loadTable()));
+    QObject::connect(ui->submitButton, SIGNAL(clicked(bool)), this, SLOT(submitAll()));
+    QObject::connect(ui->cancelButton, SIGNAL(clicked(bool)), this, SLOT(cancelWaiting()));
+
+    QObject::connect(ae_globals::get_job_queue(), SIGNAL(submissionStarted(int)), this, SLOT(submissionStarted(int)));
+    QObject::connect(ae_globals::get_job_queue(), SIGNAL(submissionDone(int,RequestState,JobRecord)),
+                     this, SLOT(submissionDone(int,RequestState,JobRecord)));
+
+    updateSummary();
+}
+
+ParameterSweepDialog::~ParameterSweepDialog()
+{
+    delete ui;
+}
+
+void ParameterSweepDialog::setAutoFetch(QString localDest, QStringList includePatterns)
+{
+    autoFetchDest = localDest;
+    autoFetchPatterns = includePatterns;
+}
+
+void ParameterSweepDialog::loadTable()
+{
+    //A new table may not replace one which is still being sent
+    if (rowStates.contains(RowState::WAITING) || rowStates.contains(RowState::SENDING))
+    {
+        ae_globals::displayPopup("Please wait for the current sweep to be submitted.", "Sweep In Progress");
+        return;
+    }
+
+    QString errorText;
+    if (!sweepTable.loadFile(ui->tablePathInput->text(), &errorText))
+    {
+        ae_globals::displayPopup(errorText, "Unable to load parameter table");
+    }
+
+    //The app parameters come first, followed by any other columns of the file so they can be seen
+    QStringList shownColumns = myParams;
+    for (const QString &aColumn : sweepTable.getColumns())
+    {
+        if (!shownColumns.contains(aColumn)) shownColumns.append(aColumn);
+    }
+    statusColumn = shownColumns.size();
+
+    ui->sweepTable->clear();
+    ui->sweepTable->setColumnCount(statusColumn + 1);
+    ui->sweepTable->setRowCount(sweepTable.rowCount());
+    ui->sweepTable->setHorizontalHeaderLabels(QStringList(shownColumns) << "Status");
+
+    rowStates.clear();
+    ticketRows.clear();
+
+    for (int row = 0; row < sweepTable.rowCount(); row++)
+    {
+        QMap<QString, QString> rowData = sweepTable.getRow(row);
+        for (int col = 0; col < shownColumns.size(); col++)
+        {
+            ui->sweepTable->setItem(row, col, new QTableWidgetItem(rowData.value(shownColumns.at(col))));
+        }
+
+        rowStates.append(RowState::INVALID);
+        QString problem = sweepTable.validateRow(row, myParams);
+        if (problem.isEmpty())
+        {
+            setRowStatus(row, RowState::READY, "Ready");
+        }
+        else
+        {
+            setRowStatus(row, RowState::INVALID, problem);
+        }
+    }
+    ui->sweepTable->resizeColumnsToContents();
+
+    updateSummary();
+}
+
+void ParameterSweepDialog::submitAll()
+{
+    for (int row = 0; row < rowStates.size(); row++)
+    {
+        if ((rowStates.at(row) != RowState::READY) && (rowStates.at(row) != RowState::FAILED) && (rowStates.at(row) != RowState::CANCELLED))
+        {
+            continue;
+        }
+
+        QMap<QString, QString> rowData = sweepTable.getRow(row);
+        QMultiMap<QString, QString> allInputs;
+        for (const QString &aParam : myParams)
+        {
+            allInputs.insert(aParam, rowData.value(aParam));
+        }
+
+        int ticket = ae_globals::get_job_queue()->submitJob(myAppName, allInputs, myWorkingDir);
+        ticketRows.insert(ticket, row);
+        setRowStatus(row, RowState::WAITING, "Waiting");
+    }
+    qCDebug(agaveAppLayer, "Parameter sweep of %s queued, %d jobs waiting", qPrintable(myAppName), ticketRows.size());
+
+    updateSummary();
+}
+
+void ParameterSweepDialog::cancelWaiting()
+{
+    auto itr = ticketRows.begin();
+    while (itr != ticketRows.end())
+    {
+        if ((rowStates.at(itr.value()) == RowState::WAITING) && ae_globals::get_job_queue()->cancelSubmission(itr.key()))
+        {
+            setRowStatus(itr.value(), RowState::CANCELLED, "Cancelled");
+            itr = ticketRows.erase(itr);
+        }
+        else
+        {
+            itr++;
+        }
+    }
+    updateSummary();
+}
+
+void ParameterSweepDialog::submissionStarted(int ticket)
+{
+    if (!ticketRows.contains(ticket)) return;
+    setRowStatus(ticketRows.value(ticket), RowState::SENDING, "Submitting . . .");
+    updateSummary();
+}
+
+void ParameterSweepDialog::submissionDone(int ticket, RequestState finalState, JobRecord newJob)
+{
+    if (!ticketRows.contains(ticket)) return;
+    int row = ticketRows.take(ticket);
+
+    if (finalState != RequestState::GOOD)
+    {
+        setRowStatus(row, RowState::FAILED, "Submission failed");
+    }
+    else if (newJob.id.isEmpty())
+    {
+        setRowStatus(row, RowState::SUBMITTED, "Submitted");
+    }
+    else
+    {
+        setRowStatus(row, RowState::SUBMITTED, QString("Submitted: %1").arg(newJob.id));
+        if (!autoFetchDest.isEmpty())
+        {
+            ae_globals::get_output_fetcher()->watchJob(newJob.id, autoFetchDest, autoFetchPatterns);
+        }
+    }
+    updateSummary();
+}
+
+void ParameterSweepDialog::setRowStatus(int row, RowState newState, QString statusText)
+{
+    if ((row < 0) || (row >= rowStates.size())) return;
+    rowStates[row] = newState;
+
+    QTableWidgetItem * statusItem = ui->sweepTable->item(row, statusColumn);
+    if (statusItem == nullptr)
+    {
+        statusItem = new QTableWidgetItem();
+        ui->sweepTable->setItem(row, statusColumn, statusItem);
+    }
+    statusItem->setText(statusText);
+
+    if (newState == RowState::INVALID || newState == RowState::FAILED)
+    {
+        statusItem->setForeground(Qt::red);
+    }
+    else
+    {
+        statusItem->setForeground(this->palette().text());
+    }
+}
+
+void ParameterSweepDialog::updateSummary()
+{
+    int readyCount = rowStates.count(RowState::READY) + rowStates.count(RowState::FAILED) + rowStates.count(RowState::CANCELLED);
+    int pendingCount = rowStates.count(RowState::WAITING) + rowStates.count(RowState::SENDING);
+
+    ui->summaryLabel->setText(QString("%1 rows: %2 invalid, %3 to send, %4 in progress, %5 submitted")
+                              .arg(rowStates.size())
+                              .arg(rowStates.count(RowState::INVALID))
+                              .arg(readyCount)
+                              .arg(pendingCount)
+                              .arg(rowStates.count(RowState::SUBMITTED)));
+
+    ui->submitButton->setEnabled(readyCount > 0);
+    ui->cancelButton->setEnabled(rowStates.contains(RowState::WAITING));
+}
@@ -0,0 +1,104 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef PARAMETERSWEEPDIALOG_H
+#define PARAMETERSWEEPDIALOG_H
+
+#include <QDialog>
+#include <QMap>
+#include <QStringList>
+
+#include "parametertable.h"
+#include "jobrecord.h"
+
+enum class RequestState;
+
+namespace Ui {
+class ParameterSweepDialog;
+}
+
+/*! \brief The ParameterSweepDialog submits one job of an app for each row of a table of parameter sets.
+ *
+ *  The table is read by a ParameterTable, and every row is checked against the parameters of the app before anything is sent.
+ *  Valid rows are handed to the JobSubmitQueue, which throttles the submissions, and the status of each row is shown in the last column.
+ *
+ *  The dialog is not modal, and deletes itself when closed. Submissions already queued are still sent after it is closed.
+ */
+class ParameterSweepDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    /*! \param appName The Agave app to run for each row
+     *  \param requiredParams The parameters the app takes, each of which must have a value in every row
+     *  \param workingDir The remote folder for the jobs
+     *  \param parent The parent widget
+     */
+    explicit ParameterSweepDialog(QString appName, QStringList requiredParams, QString workingDir, QWidget *parent = nullptr);
+    ~ParameterSweepDialog();
+
+    /*! \brief Has the output of each job of the sweep downloaded once the job finishes, as by JobOutputFetcher::watchJob().
+     */
+    void setAutoFetch(QString localDest, QStringList includePatterns);
+
+private slots:
+    void loadTable();
+    void submitAll();
+    void cancelWaiting();
+
+    void submissionStarted(int ticket);
+    void submissionDone(int ticket, RequestState finalState, JobRecord newJob);
+
+private:
+    enum class RowState {INVALID, READY, WAITING, SENDING, SUBMITTED, FAILED, CANCELLED};
+
+    void setRowStatus(int row, RowState newState, QString statusText);
+    void updateSummary();
+
+    Ui::ParameterSweepDialog *ui;
+
+    QString myAppName;
+    QStringList myParams;
+    QString myWorkingDir;
+    QString autoFetchDest;
+    QStringList autoFetchPatterns;
+
+    ParameterTable sweepTable;
+    QList<RowState> rowStates;
+    QMap<int, int> ticketRows;
+    int statusColumn = 0;
+};
+
+#endif // PARAMETERSWEEPDIALOG_H
@@ -0,0 +1,280 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "parametertable.h"
+
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QJsonValue>
+
+ParameterTable::ParameterTable() {}
+
+bool ParameterTable::loadFile(QString fileName, QString * errorText)
+{
+    QFile inputFile(fileName);
+    if (!inputFile.open(QIODevice::ReadOnly))
+    {
+        if (errorText != nullptr) *errorText = QString("Unable to read %1").arg(fileName);
+        myColumns.clear();
+        myRows.clear();
+        return false;
+    }
+
+    QByteArray rawText = inputFile.readAll();
+    inputFile.close();
+
+    if (fileName.endsWith(".json", Qt::CaseInsensitive))
+    {
+        return loadJSON(rawText, errorText);
+    }
+    return loadCSV(rawText, errorText);
+}
+
+bool ParameterTable::loadCSV(const QByteArray &rawText, QString * errorText)
+{
+    myColumns.clear();
+    myRows.clear();
+
+    QString fullText = QString::fromUtf8(rawText);
+    int readPos = 0;
+    int lineNum = 0;
+    QStringList fields;
+
+    while (readPos < fullText.length())
+    {
+        lineNum++;
+        if (!splitCSVLine(fullText, &readPos, &fields))
+        {
+            if (errorText != nullptr) *errorText = QString("Unterminated quote on line %1").arg(lineNum);
+            myColumns.clear();
+            myRows.clear();
+            return false;
+        }
+
+        //Blank lines are skipped
+        if ((fields.size() == 1) && fields.first().isEmpty()) continue;
+
+        if (myColumns.isEmpty())
+        {
+            myColumns = fields;
+            if (myColumns.removeDuplicates() != 0)
+            {
+                if (errorText != nullptr) *errorText = "The header line repeats a parameter name";
+                myColumns.clear();
+                return false;
+            }
+            continue;
+        }
+
+        if (fields.size() != myColumns.size())
+        {
+            if (errorText != nullptr) *errorText = QString("Line %1 has %2 values, but the header has %3").arg(lineNum).arg(fields.size()).arg(myColumns.size());
+            myColumns.clear();
+            myRows.clear();
+            return false;
+        }
+
+        QMap<QString, QString> newRow;
+        for (int i = 0; i < fields.size(); i++)
+        {
+            newRow.insert(myColumns.at(i), fields.at(i));
+        }
+        myRows.append(newRow);
+    }
+
+    if (myColumns.isEmpty())
+    {
+        if (errorText != nullptr) *errorText = "The file has no header line";
+        return false;
+    }
+    return true;
+}
+
+bool ParameterTable::loadJSON(const QByteArray &rawText, QString * errorText)
+{
+    myColumns.clear();
+    myRows.clear();
+
+    QJsonParseError parseError;
+    QJsonDocument parsedDoc = QJsonDocument::fromJson(rawText, &parseError);
+    if (parsedDoc.isNull() || !parsedDoc.isArray())
+    {
+        if (errorText != nullptr)
+        {
+            *errorText = parsedDoc.isNull() ? parseError.errorString() : QString("The file must hold an array of parameter sets");
+        }
+        return false;
+    }
+
+    QJsonArray rowArray = parsedDoc.array();
+    for (int i = 0; i < rowArray.size(); i++)
+    {
+        if (!rowArray.at(i).isObject())
+        {
+            if (errorText != nullptr) *errorText = QString("Entry %1 is not an object").arg(i + 1);
+            myColumns.clear();
+            myRows.clear();
+            return false;
+        }
+
+        QJsonObject rowObject = rowArray.at(i).toObject();
+        QMap<QString, QString> newRow;
+        for (auto itr = rowObject.constBegin(); itr != rowObject.constEnd(); itr++)
+        {
+            QJsonValue aValue = itr.value();
+            QString valueText;
+            if (aValue.isString()) valueText = aValue.toString();
+            else if (aValue.isDouble()) valueText = QString::number(aValue.toDouble(), 'g', 15);
+            else if (aValue.isBool()) valueText = aValue.toBool() ? "true" : "false";
+            else if (!aValue.isNull())
+            {
+                if (errorText != nullptr) *errorText = QString("Entry %1 has a nested value for %2").arg(i + 1).arg(itr.key());
+                myColumns.clear();
+                myRows.clear();
+                return false;
+            }
+
+            newRow.insert(itr.key(), valueText);
+            if (!myColumns.contains(itr.key())) myColumns.append(itr.key());
+        }
+        myRows.append(newRow);
+    }
+    return true;
+}
+
+QStringList ParameterTable::getColumns() const
+{
+    return myColumns;
+}
+
+int ParameterTable::rowCount() const
+{
+    return myRows.size();
+}
+
+QMap<QString, QString> ParameterTable::getRow(int row) const
+{
+    if ((row < 0) || (row >= myRows.size())) return QMap<QString, QString>();
+    return myRows.at(row);
+}
+
+QString ParameterTable::validateRow(int row, const QStringList &requiredParams) const
+{
+    if ((row < 0) || (row >= myRows.size())) return "No such row";
+    const QMap<QString, QString> &theRow = myRows.at(row);
+
+    for (const QString &aParam : requiredParams)
+    {
+        if (theRow.value(aParam).trimmed().isEmpty())
+        {
+            return QString("Missing %1").arg(aParam);
+        }
+    }
+
+    for (auto itr = theRow.cbegin(); itr != theRow.cend(); itr++)
+    {
+        if (!requiredParams.contains(itr.key()) && !itr.value().isEmpty())
+        {
+            return QString("Unknown parameter %1").arg(itr.key());
+        }
+    }
+
+    for (int i = 0; i < row; i++)
+    {
+        if (myRows.at(i) == theRow)
+        {
+            return QString("Same as row %1").arg(i + 1);
+        }
+    }
+
+    return QString();
+}
+
+bool ParameterTable::splitCSVLine(const QString &rawText, int * readPos, QStringList * fields)
+{
+    fields->clear();
+    QString currentField;
+    bool inQuotes = false;
+    bool wasQuoted = false;
+    int i = *readPos;
+
+    for ( ; i < rawText.length(); i++)
+    {
+        QChar aChar = rawText.at(i);
+        if (inQuotes)
+        {
+            if (aChar != '"')
+            {
+                currentField.append(aChar);
+            }
+            else if ((i + 1 < rawText.length()) && (rawText.at(i + 1) == '"'))
+            {
+                currentField.append('"');
+                i++;
+            }
+            else
+            {
+                inQuotes = false;
+            }
+            continue;
+        }
+
+        if (aChar == '"')
+        {
+            inQuotes = true;
+            wasQuoted = true;
+        }
+        else if (aChar == ',')
+        {
+            fields->append(wasQuoted ? currentField : currentField.trimmed());
+            currentField.clear();
+            wasQuoted = false;
+        }
+        else if (aChar == '\n')
+        {
+            break;
+        }
+        else if (aChar != '\r')
+        {
+            currentField.append(aChar);
+        }
+    }
+
+    fields->append(wasQuoted ? currentField : currentField.trimmed());
+    *readPos = i + 1;
+    return !inQuotes;
+}
@@ -0,0 +1,80 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef PARAMETERTABLE_H
+#define PARAMETERTABLE_H
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QMap>
+#include <QByteArray>
+
+/*! \brief The ParameterTable holds a table of parameter sets for a batch of jobs, one set per row.
+ *
+ *  The table is read from a CSV file, with a header line of parameter names, or from a JSON file holding an array of objects.
+ *  Each row can be checked against the parameter list of an app before any job is submitted.
+ */
+class ParameterTable
+{
+public:
+    ParameterTable();
+
+    /*! \brief Reads the table from a file. Files ending in .json are read as JSON, anything else as CSV.
+     *
+     *  Returns false, and sets errorText, if the file cannot be read or is malformed. On failure, the table is left empty.
+     */
+    bool loadFile(QString fileName, QString * errorText = nullptr);
+    bool loadCSV(const QByteArray &rawText, QString * errorText = nullptr);
+    bool loadJSON(const QByteArray &rawText, QString * errorText = nullptr);
+
+    QStringList getColumns() const;
+    int rowCount() const;
+    QMap<QString, QString> getRow(int row) const;
+
+    /*! \brief Checks a row against the parameters of an app. Returns an empty string if the row is valid, or a description of the problem.
+     *
+     *  A row is invalid if it lacks a value for a required parameter, has a column the app does not take, or repeats an earlier row.
+     */
+    QString validateRow(int row, const QStringList &requiredParams) const;
+
+private:
+    static bool splitCSVLine(const QString &rawText, int * readPos, QStringList * fields);
+
+    QStringList myColumns;
+    QList<QMap<QString, QString>> myRows;
+};
+
+#endif // PARAMETERTABLE_H
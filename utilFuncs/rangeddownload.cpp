@@ -0,0 +1,391 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "rangeddownload.h"
+
+#include "agaverestlink.h"
+#include "agavenetmanager.h"
+#include "requestscheduler.h"
+#include "remotedatainterface.h"
+#include "ae_globals.h"
+
+#include <QNetworkReply>
+#include <QFile>
+#include <QTimer>
+
+const qint64 RangedDownload::minRangeSize;
+const qint64 RangedDownload::bufferSize;
+
+RangedDownload::RangedDownload(QString remotePath, QString localPath, qint64 fileSize, QObject * parent) : QObject(parent)
+{
+    myRemotePath = remotePath;
+    myLocalPath = localPath;
+    myFileSize = fileSize;
+}
+
+RangedDownload::~RangedDownload()
+{
+    for (int i = 0; i < byteRanges.size(); i++)
+    {
+        dropReply(i);
+        delete byteRanges[i].rangeFile;
+    }
+}
+
+void RangedDownload::setRangeCount(int newCount)
+{
+    if (downloadStarted || (newCount < 1)) return;
+    rangeCount = newCount;
+}
+
+void RangedDownload::setDirectSource(AgaveNetManager * theManager, QUrl sourceUrl)
+{
+    if (downloadStarted) return;
+    directManager = theManager;
+    directUrl = sourceUrl;
+}
+
+bool RangedDownload::startDownload()
+{
+    if (downloadStarted || (myFileSize < 0)) return false;
+
+    if (directManager == nullptr)
+    {
+        AgaveRestLink * theLink = ae_globals::get_rest_link();
+        if ((theLink == nullptr) || (!theLink->credentialsAvailable())) return false;
+    }
+
+    //The whole file is laid out first, so that each range can write at its own offset
+    QFile destFile(myLocalPath);
+    if (!destFile.open(QIODevice::WriteOnly | QIODevice::Truncate) || !destFile.resize(myFileSize))
+    {
+        qCDebug(agaveAppLayer, "Unable to write download destination: %s", qPrintable(myLocalPath));
+        return false;
+    }
+    destFile.close();
+
+    downloadStarted = true;
+    chunkBuffer.resize(bufferSize);
+
+    int usedRanges = int(qBound(qint64(1), (myFileSize + minRangeSize - 1) / minRangeSize, qint64(rangeCount)));
+    qint64 rangeLength = (myFileSize + usedRanges - 1) / usedRanges;
+    for (qint64 rangeStart = 0; rangeStart < myFileSize; rangeStart += rangeLength)
+    {
+        ByteRange newRange;
+        newRange.start = rangeStart;
+        newRange.end = qMin(rangeStart + rangeLength, myFileSize) - 1;
+        byteRanges.append(newRange);
+    }
+
+    if (byteRanges.isEmpty())
+    {
+        QTimer::singleShot(0, this, [this]() { finishDownload(RequestState::GOOD); });
+        return true;
+    }
+
+    for (int i = 0; i < byteRanges.size(); i++)
+    {
+        scheduleRange(i);
+    }
+    return true;
+}
+
+void RangedDownload::cancelDownload()
+{
+    finishDownload(RequestState::EXPLICIT_ERROR);
+}
+
+QString RangedDownload::getLocalPath()
+{
+    return myLocalPath;
+}
+
+qint64 RangedDownload::getContiguousBytes()
+{
+    return contiguousBytes;
+}
+
+void RangedDownload::scheduleRange(int rangeNum)
+{
+    if (directManager != nullptr)
+    {
+        sendRangeRequest(rangeNum);
+        return;
+    }
+    ae_globals::get_rest_link()->getScheduler()->scheduleRequest(RequestPriority::BULK, this, [this, rangeNum]() { return sendRangeRequest(rangeNum); });
+}
+
+QNetworkReply * RangedDownload::sendRangeRequest(int rangeNum)
+{
+    //A fallback to a single range may have happened since this request was scheduled
+    if (downloadFinished || (rangeNum >= byteRanges.size())) return nullptr;
+    ByteRange &theRange = byteRanges[rangeNum];
+    if (theRange.done || (theRange.rangeReply != nullptr)) return nullptr;
+
+    if (theRange.rangeFile == nullptr)
+    {
+        theRange.rangeFile = new QFile(myLocalPath);
+        if (!theRange.rangeFile->open(QIODevice::ReadWrite))
+        {
+            qCDebug(agaveAppLayer, "Unable to write download destination: %s", qPrintable(myLocalPath));
+            finishDownload(RequestState::EXPLICIT_ERROR);
+            return nullptr;
+        }
+    }
+    theRange.requestFrom = theRange.start + theRange.written;
+    theRange.rangeFile->seek(theRange.requestFrom);
+
+    if (directManager != nullptr)
+    {
+        QNetworkRequest rangeRequest(directUrl);
+        rangeRequest.setRawHeader("Range", QString("bytes=%1-%2").arg(theRange.requestFrom).arg(theRange.end).toLatin1());
+        theRange.rangeReply = directManager->get(rangeRequest);
+    }
+    else
+    {
+        theRange.rangeReply = ae_globals::get_rest_link()->requestFileContents(myRemotePath, theRange.requestFrom, theRange.end);
+    }
+
+    if (theRange.rangeReply == nullptr)
+    {
+        finishDownload(RequestState::NO_CONNECT);
+        return nullptr;
+    }
+
+    //Limiting the read buffer holds back the network, rather than letting the reply grow with the range
+    theRange.rangeReply->setReadBufferSize(bufferSize);
+    replyRanges.insert(theRange.rangeReply, rangeNum);
+
+    QObject::connect(theRange.rangeReply, SIGNAL(readyRead()), this, SLOT(dataAvailable()));
+    QObject::connect(theRange.rangeReply, SIGNAL(finished()), this, SLOT(replyFinished()));
+    return theRange.rangeReply;
+}
+
+void RangedDownload::dataAvailable()
+{
+    if (downloadFinished) return;
+
+    //From the bandwidth retry timer, every range is read
+    QNetworkReply * theReply = qobject_cast<QNetworkReply *>(sender());
+    if (theReply == nullptr)
+    {
+        readRetryPending = false;
+        for (int i = 0; i < byteRanges.size(); i++)
+        {
+            if (byteRanges.at(i).rangeReply == nullptr) continue;
+            if (!readRange(i)) return;
+        }
+    }
+    else if (replyRanges.contains(theReply))
+    {
+        if (!readRange(replyRanges.value(theReply))) return;
+    }
+    checkContiguous();
+}
+
+void RangedDownload::replyFinished()
+{
+    QNetworkReply * theReply = qobject_cast<QNetworkReply *>(sender());
+    if (downloadFinished || (theReply == nullptr) || !replyRanges.contains(theReply)) return;
+    int rangeNum = replyRanges.value(theReply);
+
+    if (theReply->error() != QNetworkReply::NoError)
+    {
+        qCDebug(agaveAppLayer, "Range of %s failed: %s", qPrintable(myRemotePath), qPrintable(theReply->errorString()));
+        RetryHint failureHint = RequestRetry::classifyReply(theReply);
+        dropReply(rangeNum);
+        rangeFailed(rangeNum, failureHint);
+        return;
+    }
+
+    if (!readRange(rangeNum)) return;
+    checkContiguous();
+}
+
+bool RangedDownload::readRange(int rangeNum)
+{
+    ByteRange &theRange = byteRanges[rangeNum];
+    QNetworkReply * theReply = theRange.rangeReply;
+
+    //A server which ignores ranges sends the whole file, which only fits a request for the whole file
+    int httpStatus = theReply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if ((httpStatus == 200) && ((theRange.requestFrom > 0) || (theRange.end < myFileSize - 1)))
+    {
+        fallBackToSingleRange();
+        return false;
+    }
+
+    RequestScheduler * theScheduler = nullptr;
+    if (directManager == nullptr) theScheduler = ae_globals::get_rest_link()->getScheduler();
+
+    while (theReply->bytesAvailable() > 0)
+    {
+        qint64 rangeLeft = theRange.end - theRange.start + 1 - theRange.written;
+        if (rangeLeft <= 0) break;
+
+        qint64 permittedSize = qMin(qMin(theReply->bytesAvailable(), bufferSize), rangeLeft);
+        if (theScheduler != nullptr) permittedSize = theScheduler->takeBulkBytes(permittedSize);
+        if (permittedSize <= 0)
+        {
+            //Over the bandwidth limit, the unread data holds back the sender until we try again
+            if (!readRetryPending)
+            {
+                readRetryPending = true;
+                QTimer::singleShot(50, this, SLOT(dataAvailable()));
+            }
+            return true;
+        }
+
+        qint64 chunkSize = theReply->read(chunkBuffer.data(), permittedSize);
+        if (chunkSize <= 0) break;
+
+        if (theRange.rangeFile->write(chunkBuffer.constData(), chunkSize) != chunkSize)
+        {
+            qCDebug(agaveAppLayer, "Write failed for download: %s", qPrintable(myLocalPath));
+            finishDownload(RequestState::EXPLICIT_ERROR);
+            return false;
+        }
+        theRange.written += chunkSize;
+    }
+    //Readers of the file open it separately, and only see what has been flushed
+    theRange.rangeFile->flush();
+
+    //Any bytes past the end of the range are not ours, and are dropped with the reply
+    bool rangeFull = (theRange.start + theRange.written > theRange.end);
+    if (!theReply->isFinished() || ((theReply->bytesAvailable() > 0) && !rangeFull)) return true;
+
+    dropReply(rangeNum);
+    if (theRange.start + theRange.written <= theRange.end)
+    {
+        qCDebug(agaveAppLayer, "Range of %s ended early, at %lld bytes", qPrintable(myRemotePath), theRange.start + theRange.written);
+        RetryHint shortHint;
+        shortHint.retryable = true;
+        rangeFailed(rangeNum, shortHint);
+        return !downloadFinished;
+    }
+
+    theRange.done = true;
+    theRange.rangeFile->close();
+
+    for (const ByteRange &aRange : byteRanges)
+    {
+        if (!aRange.done) return true;
+    }
+    checkContiguous();
+    finishDownload(RequestState::GOOD);
+    return false;
+}
+
+void RangedDownload::rangeFailed(int rangeNum, RetryHint failureHint)
+{
+    ByteRange &theRange = byteRanges[rangeNum];
+    theRange.attempts++;
+    if (!failureHint.retryable || (theRange.attempts >= RequestRetry::maxAttempts))
+    {
+        finishDownload(RequestState::NO_CONNECT);
+        return;
+    }
+
+    QTimer::singleShot(RequestRetry::backoffDelayMs(theRange.attempts, failureHint), this, [this, rangeNum]()
+    {
+        if (downloadFinished) return;
+        scheduleRange(rangeNum);
+    });
+}
+
+void RangedDownload::fallBackToSingleRange()
+{
+    qCDebug(agaveAppLayer, "Server ignored byte ranges for %s, downloading as one request", qPrintable(myRemotePath));
+
+    for (int i = 0; i < byteRanges.size(); i++)
+    {
+        dropReply(i);
+        delete byteRanges[i].rangeFile;
+    }
+    byteRanges.clear();
+
+    //Bytes already counted as contiguous are written again with the same data, so readers are not disturbed
+    ByteRange wholeFile;
+    wholeFile.end = myFileSize - 1;
+    byteRanges.append(wholeFile);
+    scheduleRange(0);
+}
+
+void RangedDownload::dropReply(int rangeNum)
+{
+    ByteRange &theRange = byteRanges[rangeNum];
+    if (theRange.rangeReply == nullptr) return;
+
+    replyRanges.remove(theRange.rangeReply);
+    theRange.rangeReply->disconnect(this);
+    if (!theRange.rangeReply->isFinished()) theRange.rangeReply->abort();
+    theRange.rangeReply->deleteLater();
+    theRange.rangeReply = nullptr;
+}
+
+void RangedDownload::checkContiguous()
+{
+    qint64 newContiguous = 0;
+    for (const ByteRange &aRange : byteRanges)
+    {
+        newContiguous = aRange.start + aRange.written;
+        if (!aRange.done) break;
+    }
+    if (newContiguous <= contiguousBytes) return;
+
+    contiguousBytes = newContiguous;
+    emit contiguousBytesChanged(contiguousBytes);
+}
+
+void RangedDownload::finishDownload(RequestState finalState)
+{
+    if (downloadFinished) return;
+    downloadFinished = true;
+
+    for (int i = 0; i < byteRanges.size(); i++)
+    {
+        dropReply(i);
+        delete byteRanges[i].rangeFile;
+        byteRanges[i].rangeFile = nullptr;
+    }
+
+    if (finalState != RequestState::GOOD)
+    {
+        QFile::remove(myLocalPath);
+    }
+
+    emit downloadDone(finalState, myLocalPath, (finalState == RequestState::GOOD) ? myFileSize : contiguousBytes);
+    this->deleteLater();
+}
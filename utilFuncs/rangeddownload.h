@@ -0,0 +1,141 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef RANGEDDOWNLOAD_H
+#define RANGEDDOWNLOAD_H
+
+#include <QObject>
+#include <QList>
+#include <QMap>
+#include <QUrl>
+#include <QByteArray>
+
+#include "requestretry.h"
+
+class QNetworkReply;
+class QFile;
+class AgaveNetManager;
+enum class RequestState;
+
+/*! \brief The RangedDownload copies one large remote file to a local file, fetching several byte ranges of it at once.
+ *
+ *  The file is split into up to setRangeCount() ranges, of at least minRangeSize bytes each, and each range writes directly to its own offset of the local file.
+ *  A range which fails is retried from the last byte it wrote. If the server ignores the Range header, the download falls back to a single request.
+ *
+ *  The contiguousBytesChanged() signal gives how much of the start of the file is complete and flushed, so that a reader may follow the download.
+ *
+ *  Downloads are scheduled as BULK requests, and read no faster than the bulk bandwidth limit of the RequestScheduler allows.
+ *  If a direct source is set, requests are sent straight to it instead, without the scheduler; this is used to benchmark the download on its own.
+ *
+ *  The RangedDownload deletes itself after emitting downloadDone(). A failed download removes the local file.
+ */
+class RangedDownload : public QObject
+{
+    Q_OBJECT
+public:
+    /*! \brief Constructs a new RangedDownload.
+     *
+     *  \param remotePath Full path of the remote file
+     *  \param localPath Full path of the local destination file, which is replaced if it exists
+     *  \param fileSize The size of the remote file, from its listing
+     *  \param parent The object requesting the download is typically the parent
+     */
+    explicit RangedDownload(QString remotePath, QString localPath, qint64 fileSize, QObject * parent = nullptr);
+    ~RangedDownload();
+
+    void setRangeCount(int newCount);
+    /*! \brief Sends requests for the given URL through the given manager, instead of the Agave server.
+     */
+    void setDirectSource(AgaveNetManager * theManager, QUrl sourceUrl);
+
+    /*! \brief Begins the download. Returns false if the destination cannot be written or direct requests are not available.
+     */
+    bool startDownload();
+    void cancelDownload();
+
+    QString getLocalPath();
+    qint64 getContiguousBytes();
+
+    static const qint64 minRangeSize = 4 * 1024 * 1024;
+    static const qint64 bufferSize = 256 * 1024;
+
+signals:
+    void contiguousBytesChanged(qint64 contiguousBytes);
+    void downloadDone(RequestState finalState, QString localPath, qint64 bytesWritten);
+
+private slots:
+    void dataAvailable();
+    void replyFinished();
+
+private:
+    struct ByteRange
+    {
+        qint64 start = 0;
+        qint64 end = 0;
+        qint64 written = 0;
+        qint64 requestFrom = 0;
+        int attempts = 0;
+        bool done = false;
+        QFile * rangeFile = nullptr;
+        QNetworkReply * rangeReply = nullptr;
+    };
+
+    void scheduleRange(int rangeNum);
+    QNetworkReply * sendRangeRequest(int rangeNum);
+    bool readRange(int rangeNum);
+    void rangeFailed(int rangeNum, RetryHint failureHint);
+    void fallBackToSingleRange();
+    void dropReply(int rangeNum);
+    void checkContiguous();
+    void finishDownload(RequestState finalState);
+
+    QString myRemotePath;
+    QString myLocalPath;
+    qint64 myFileSize;
+    int rangeCount = 4;
+
+    AgaveNetManager * directManager = nullptr;
+    QUrl directUrl;
+
+    QList<ByteRange> byteRanges;
+    QMap<QNetworkReply *, int> replyRanges;
+    QByteArray chunkBuffer;
+    qint64 contiguousBytes = 0;
+    bool downloadStarted = false;
+    bool readRetryPending = false;
+    bool downloadFinished = false;
+};
+
+#endif // RANGEDDOWNLOAD_H
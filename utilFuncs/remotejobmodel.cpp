@@ -0,0 +1,494 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "remotejobmodel.h"
+
+#include "agaverestlink.h"
+#include "requestscheduler.h"
+#include "remotedatainterface.h"
+#include "ae_globals.h"
+
+#include <QNetworkReply>
+#include <QJsonArray>
+
+#include <algorithm>
+
+RemoteJobModel::RemoteJobModel(QObject * parent) : QAbstractTableModel(parent) {}
+
+int RemoteJobModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) return 0;
+    return idColumn.size();
+}
+
+int RemoteJobModel::columnCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) return 0;
+    return NUM_COLS;
+}
+
+QVariant RemoteJobModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || (index.row() >= idColumn.size())) return QVariant();
+    if ((role != Qt::DisplayRole) && (role != Qt::EditRole)) return QVariant();
+
+    int row = index.row();
+    switch (index.column())
+    {
+    case NAME_COL: return nameColumn.at(row);
+    case APP_COL: return appColumn.at(row);
+    case STATUS_COL: return statusColumn.at(row);
+    case CREATED_COL:
+        if (role == Qt::EditRole) return createdColumn.at(row);
+        return createdColumn.at(row).toLocalTime().toString("yyyy-MM-dd hh:mm");
+    case ID_COL: return idColumn.at(row);
+    }
+    return QVariant();
+}
+
+QVariant RemoteJobModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if ((orientation != Qt::Horizontal) || (role != Qt::DisplayRole)) return QVariant();
+
+    switch (section)
+    {
+    case NAME_COL: return QString("Name");
+    case APP_COL: return QString("App");
+    case STATUS_COL: return QString("Status");
+    case CREATED_COL: return QString("Created");
+    case ID_COL: return QString("Job ID");
+    }
+    return QVariant();
+}
+
+void RemoteJobModel::upsertJob(const JobRecord &theJob)
+{
+    if (refreshRunning) upsertedDuringRefresh.insert(theJob.id);
+
+    auto found = rowOfJob.constFind(theJob.id);
+    if (found != rowOfJob.constEnd())
+    {
+        int theRow = found.value();
+        JobRecord mergedJob = theJob;
+        //Entries of the job list may leave out fields the model already knows
+        if (mergedJob.archivePath.isEmpty()) mergedJob.archivePath = archiveColumn.at(theRow);
+        if (!mergedJob.started.isValid()) mergedJob.started = startedColumn.at(theRow);
+        if (!mergedJob.ended.isValid()) mergedJob.ended = endedColumn.at(theRow);
+        if (getJob(theRow) == mergedJob) return;
+
+        writeRow(theRow, mergedJob);
+        emit dataChanged(index(theRow, 0), index(theRow, NUM_COLS - 1));
+        return;
+    }
+
+    int newRow = idColumn.size();
+    beginInsertRows(QModelIndex(), newRow, newRow);
+    idColumn.append(QString());
+    nameColumn.append(QString());
+    appColumn.append(QString());
+    statusColumn.append(QString());
+    createdColumn.append(QDateTime());
+    updatedColumn.append(QDateTime());
+    startedColumn.append(QDateTime());
+    endedColumn.append(QDateTime());
+    archiveColumn.append(QString());
+    nameKeys.append(QString());
+    createdKeys.append(0);
+    searchKeys.append(QString());
+    writeRow(newRow, theJob);
+    endInsertRows();
+}
+
+void RemoteJobModel::removeJob(QString jobId)
+{
+    removeJobs(QStringList(jobId));
+}
+
+void RemoteJobModel::removeJobs(const QStringList &jobIds)
+{
+    QVector<int> doomedRows;
+    for (const QString &aJobId : jobIds)
+    {
+        auto found = rowOfJob.constFind(aJobId);
+        if (found != rowOfJob.constEnd()) doomedRows.append(found.value());
+    }
+    if (doomedRows.isEmpty()) return;
+    std::sort(doomedRows.begin(), doomedRows.end());
+
+    //Runs of rows are removed from the bottom up, so that the rows above keep their numbers
+    int runEnd = doomedRows.size() - 1;
+    while (runEnd >= 0)
+    {
+        int runStart = runEnd;
+        while ((runStart > 0) && (doomedRows.at(runStart - 1) == doomedRows.at(runStart) - 1))
+        {
+            runStart--;
+        }
+        int firstRow = doomedRows.at(runStart);
+        int rowCount = runEnd - runStart + 1;
+
+        beginRemoveRows(QModelIndex(), firstRow, firstRow + rowCount - 1);
+        idColumn.remove(firstRow, rowCount);
+        nameColumn.remove(firstRow, rowCount);
+        appColumn.remove(firstRow, rowCount);
+        statusColumn.remove(firstRow, rowCount);
+        createdColumn.remove(firstRow, rowCount);
+        updatedColumn.remove(firstRow, rowCount);
+        startedColumn.remove(firstRow, rowCount);
+        endedColumn.remove(firstRow, rowCount);
+        archiveColumn.remove(firstRow, rowCount);
+        nameKeys.remove(firstRow, rowCount);
+        createdKeys.remove(firstRow, rowCount);
+        searchKeys.remove(firstRow, rowCount);
+        endRemoveRows();
+
+        runEnd = runStart - 1;
+    }
+    rebuildIndices();
+}
+
+bool RemoteJobModel::updateJobStatus(QString jobId, QString newStatus)
+{
+    if (!rowOfJob.contains(jobId)) return false;
+
+    JobRecord theJob = getJobById(jobId);
+    if (theJob.status == newStatus) return true;
+
+    theJob.status = newStatus;
+    theJob.lastUpdated = QDateTime::currentDateTimeUtc();
+    upsertJob(theJob);
+    return true;
+}
+
+JobRecord RemoteJobModel::getJob(int row) const
+{
+    JobRecord theJob;
+    if ((row < 0) || (row >= idColumn.size())) return theJob;
+
+    theJob.id = idColumn.at(row);
+    theJob.name = nameColumn.at(row);
+    theJob.appId = appColumn.at(row);
+    theJob.status = statusColumn.at(row);
+    theJob.created = createdColumn.at(row);
+    theJob.lastUpdated = updatedColumn.at(row);
+    theJob.started = startedColumn.at(row);
+    theJob.ended = endedColumn.at(row);
+    theJob.archivePath = archiveColumn.at(row);
+    return theJob;
+}
+
+bool RemoteJobModel::hasJob(QString jobId) const
+{
+    return rowOfJob.contains(jobId);
+}
+
+JobRecord RemoteJobModel::getJobById(QString jobId) const
+{
+    return getJob(rowOfJob.value(jobId, -1));
+}
+
+const QString &RemoteJobModel::getAppOfRow(int row) const
+{
+    return appColumn.at(row);
+}
+
+const QString &RemoteJobModel::getStatusOfRow(int row) const
+{
+    return statusColumn.at(row);
+}
+
+qint64 RemoteJobModel::getCreatedKeyOfRow(int row) const
+{
+    return createdKeys.at(row);
+}
+
+QSet<int> RemoteJobModel::getRowsCreatedSince(qint64 createdKey) const
+{
+    QSet<int> ret;
+    for (auto itr = rowsByCreated.lowerBound(createdKey); itr != rowsByCreated.constEnd(); itr++)
+    {
+        ret.unite(itr.value());
+    }
+    return ret;
+}
+
+int RemoteJobModel::compareRows(int leftRow, int rightRow, int column) const
+{
+    switch (column)
+    {
+    case NAME_COL: return nameKeys.at(leftRow).compare(nameKeys.at(rightRow));
+    case APP_COL: return appColumn.at(leftRow).compare(appColumn.at(rightRow));
+    case STATUS_COL: return statusColumn.at(leftRow).compare(statusColumn.at(rightRow));
+    case CREATED_COL:
+        if (createdKeys.at(leftRow) == createdKeys.at(rightRow)) return 0;
+        return (createdKeys.at(leftRow) < createdKeys.at(rightRow)) ? -1 : 1;
+    case ID_COL: return idColumn.at(leftRow).compare(idColumn.at(rightRow));
+    }
+    return 0;
+}
+
+bool RemoteJobModel::rowContainsText(int row, const QString &lowerText) const
+{
+    return searchKeys.at(row).contains(lowerText);
+}
+
+QStringList RemoteJobModel::getKnownApps() const
+{
+    QStringList ret = rowsOfApp.keys();
+    ret.sort();
+    return ret;
+}
+
+QStringList RemoteJobModel::getKnownStatuses() const
+{
+    QStringList ret = rowsOfStatus.keys();
+    ret.sort();
+    return ret;
+}
+
+int RemoteJobModel::countJobsWithStatus(QString status) const
+{
+    return rowsOfStatus.value(status).size();
+}
+
+bool RemoteJobModel::refreshJobList()
+{
+    return startRefresh(false);
+}
+
+bool RemoteJobModel::refreshChangedJobs()
+{
+    return startRefresh(lastSyncTime.isValid());
+}
+
+bool RemoteJobModel::isRefreshing()
+{
+    return refreshRunning;
+}
+
+bool RemoteJobModel::hasActiveJobs() const
+{
+    for (auto itr = rowsOfStatus.cbegin(); itr != rowsOfStatus.cend(); itr++)
+    {
+        if (!JobRecord::isTerminalStatus(itr.key()) && !itr.value().isEmpty()) return true;
+    }
+    return false;
+}
+
+QStringList RemoteJobModel::getActiveJobIds() const
+{
+    QStringList ret;
+    for (auto itr = rowsOfStatus.cbegin(); itr != rowsOfStatus.cend(); itr++)
+    {
+        if (JobRecord::isTerminalStatus(itr.key())) continue;
+        for (int aRow : itr.value())
+        {
+            ret.append(idColumn.at(aRow));
+        }
+    }
+    return ret;
+}
+
+void RemoteJobModel::jobPageReplied()
+{
+    QNetworkReply * theReply = qobject_cast<QNetworkReply *>(sender());
+    if ((theReply == nullptr) || (theReply != refreshReply)) return;
+    theReply->deleteLater();
+    refreshReply = nullptr;
+
+    if (theReply->error() != QNetworkReply::NoError)
+    {
+        qCDebug(agaveAppLayer, "Job list request failed: %s", qPrintable(theReply->errorString()));
+        finishRefresh(RequestState::NO_CONNECT);
+        return;
+    }
+
+    QJsonValue pageResult = AgaveRestLink::getReplyResult(theReply->readAll());
+    if (!pageResult.isArray())
+    {
+        finishRefresh(RequestState::EXPLICIT_ERROR);
+        return;
+    }
+
+    //Each page is shown as it arrives
+    QJsonArray rawJobs = pageResult.toArray();
+    bool lastJobSeen = refreshLastJob.isEmpty();
+    QString pageLastJob;
+    for (auto itr = rawJobs.constBegin(); itr != rawJobs.constEnd(); itr++)
+    {
+        JobRecord aJob;
+        if (!JobRecord::parseJobEntry((*itr).toObject(), &aJob)) continue;
+        if (aJob.id == refreshLastJob) lastJobSeen = true;
+        pageLastJob = aJob.id;
+        if (upsertedDuringRefresh.contains(aJob.id)) continue;
+
+        refreshedJobs.insert(aJob.id);
+        upsertJob(aJob);
+        upsertedDuringRefresh.remove(aJob.id);
+    }
+
+    //If the last job of the previous page is not in the overlap, the list shifted by more than the overlap, and jobs may have been skipped
+    if (!lastJobSeen && !rawJobs.isEmpty()) refreshStable = false;
+    refreshLastJob = pageLastJob;
+    refreshOffset += rawJobs.size();
+
+    if (rawJobs.size() < jobPageSize)
+    {
+        finishRefresh(RequestState::GOOD);
+        return;
+    }
+    if (!refreshChangedOnly) refreshOffset -= pageOverlap;
+    requestJobPage(refreshOffset);
+}
+
+bool RemoteJobModel::startRefresh(bool changedOnly)
+{
+    if (isRefreshing()) return false;
+
+    AgaveRestLink * theLink = ae_globals::get_rest_link();
+    if ((theLink == nullptr) || (!theLink->credentialsAvailable())) return false;
+
+    refreshedJobs.clear();
+    upsertedDuringRefresh.clear();
+    refreshRunning = true;
+    refreshChangedOnly = changedOnly;
+    refreshOffset = 0;
+    refreshLastJob.clear();
+    refreshStable = true;
+    refreshStartTime = QDateTime::currentDateTimeUtc();
+    requestJobPage(0);
+    return true;
+}
+
+void RemoteJobModel::requestJobPage(int offset)
+{
+    QDateTime updatedAfter;
+    if (refreshChangedOnly)
+    {
+        updatedAfter = lastSyncTime.addSecs(-syncOverlapSecs);
+    }
+
+    ae_globals::get_rest_link()->getScheduler()->scheduleRequest(RequestPriority::INTERACTIVE, this, [this, offset, updatedAfter]()
+    {
+        refreshReply = ae_globals::get_rest_link()->requestJobList(offset, jobPageSize, updatedAfter);
+        if (refreshReply == nullptr)
+        {
+            finishRefresh(RequestState::NO_CONNECT);
+            return refreshReply;
+        }
+        QObject::connect(refreshReply, SIGNAL(finished()), this, SLOT(jobPageReplied()));
+        return refreshReply;
+    });
+}
+
+void RemoteJobModel::finishRefresh(RequestState finalState)
+{
+    refreshReply = nullptr;
+    refreshRunning = false;
+
+    if (finalState == RequestState::GOOD)
+    {
+        //A full refresh also drops jobs the server no longer lists, unless they were added while the list was being fetched
+        if (!refreshChangedOnly && refreshStable)
+        {
+            QStringList goneJobs;
+            for (int row = 0; row < idColumn.size(); row++)
+            {
+                const QString &aJobId = idColumn.at(row);
+                if (refreshedJobs.contains(aJobId) || upsertedDuringRefresh.contains(aJobId)) continue;
+                if (createdColumn.at(row).isValid() && (createdColumn.at(row) >= refreshStartTime)) continue;
+                goneJobs.append(aJobId);
+            }
+            removeJobs(goneJobs);
+        }
+        else if (!refreshChangedOnly)
+        {
+            qCDebug(agaveAppLayer, "Job list changed during the refresh, no jobs are dropped this time");
+        }
+        lastSyncTime = refreshStartTime;
+    }
+    refreshedJobs.clear();
+    upsertedDuringRefresh.clear();
+
+    emit jobListRefreshed(finalState);
+}
+
+void RemoteJobModel::writeRow(int row, const JobRecord &theJob)
+{
+    //The old values of the row leave the indices before the new values go in
+    if (!idColumn.at(row).isEmpty())
+    {
+        rowsOfApp[appColumn.at(row)].remove(row);
+        if (rowsOfApp.value(appColumn.at(row)).isEmpty()) rowsOfApp.remove(appColumn.at(row));
+        rowsOfStatus[statusColumn.at(row)].remove(row);
+        if (rowsOfStatus.value(statusColumn.at(row)).isEmpty()) rowsOfStatus.remove(statusColumn.at(row));
+        rowsByCreated[createdKeys.at(row)].remove(row);
+        if (rowsByCreated.value(createdKeys.at(row)).isEmpty()) rowsByCreated.remove(createdKeys.at(row));
+    }
+
+    idColumn[row] = theJob.id;
+    nameColumn[row] = theJob.name;
+    appColumn[row] = theJob.appId;
+    statusColumn[row] = theJob.status;
+    createdColumn[row] = theJob.created;
+    updatedColumn[row] = theJob.lastUpdated;
+    startedColumn[row] = theJob.started;
+    endedColumn[row] = theJob.ended;
+    archiveColumn[row] = theJob.archivePath;
+
+    nameKeys[row] = theJob.name.toLower();
+    createdKeys[row] = theJob.created.isValid() ? theJob.created.toMSecsSinceEpoch() : 0;
+    searchKeys[row] = QString("%1\n%2\n%3\n%4").arg(theJob.name, theJob.appId, theJob.status, theJob.id).toLower();
+
+    rowOfJob.insert(theJob.id, row);
+    rowsOfApp[theJob.appId].insert(row);
+    rowsOfStatus[theJob.status].insert(row);
+    rowsByCreated[createdKeys.at(row)].insert(row);
+}
+
+void RemoteJobModel::rebuildIndices()
+{
+    rowOfJob.clear();
+    rowsOfApp.clear();
+    rowsOfStatus.clear();
+    rowsByCreated.clear();
+    for (int row = 0; row < idColumn.size(); row++)
+    {
+        rowOfJob.insert(idColumn.at(row), row);
+        rowsOfApp[appColumn.at(row)].insert(row);
+        rowsOfStatus[statusColumn.at(row)].insert(row);
+        rowsByCreated[createdKeys.at(row)].insert(row);
+    }
+}
@@ -0,0 +1,175 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef REMOTEJOBMODEL_H
+#define REMOTEJOBMODEL_H
+
+#include <QAbstractTableModel>
+#include <QVector>
+#include <QHash>
+#include <QMap>
+#include <QSet>
+
+#include "jobrecord.h"
+
+class QNetworkReply;
+enum class RequestState;
+
+/*! \brief The RemoteJobModel holds the list of the user's remote jobs, as a table for display.
+ *
+ *  The whole list can be fetched with refreshJobList(), or only the jobs changed since the last refresh with refreshChangedJobs().
+ *  Single jobs, such as newly submitted jobs, are added or updated in place with upsertJob(), so that the list does not need to be fetched again after each change.
+ *  Refreshes also update rows in place, so that views keep their selection and scroll position.
+ *
+ *  Rows are kept in the order jobs were first seen. Views should sort and filter with a JobFilterModel.
+ *
+ *  Jobs are stored by column, and the keys used to sort and search each row are worked out when the row changes, not on each comparison.
+ *  The rows of each app and each status are indexed, so that counts by app or status do not scan the table.
+ *  Rows are also indexed by creation time, in order, so that the jobs created since a given time can be found without a scan.
+ */
+class RemoteJobModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    enum JobColumn {NAME_COL, APP_COL, STATUS_COL, CREATED_COL, ID_COL, NUM_COLS};
+
+    explicit RemoteJobModel(QObject * parent = nullptr);
+
+    virtual int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    virtual int columnCount(const QModelIndex &parent = QModelIndex()) const;
+    virtual QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+    virtual QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+
+    /*! \brief Adds a job to the table, or updates the row of the job if it is already there.
+     */
+    void upsertJob(const JobRecord &theJob);
+    void removeJob(QString jobId);
+    /*! \brief Removes many jobs at once, with one removal per run of adjacent rows, and one rebuild of the indices.
+     */
+    void removeJobs(const QStringList &jobIds);
+    /*! \brief Sets the status of a job already in the table. Returns false if the job is not in the table.
+     */
+    bool updateJobStatus(QString jobId, QString newStatus);
+
+    JobRecord getJob(int row) const;
+    bool hasJob(QString jobId) const;
+    JobRecord getJobById(QString jobId) const;
+
+    const QString &getAppOfRow(int row) const;
+    const QString &getStatusOfRow(int row) const;
+    qint64 getCreatedKeyOfRow(int row) const;
+    /*! \brief Returns the rows of the jobs created at or after the given time, in milliseconds since the epoch.
+     */
+    QSet<int> getRowsCreatedSince(qint64 createdKey) const;
+    /*! \brief Compares two rows by one column, using the stored sort keys. Returns a negative number, zero, or a positive number, as for QString::compare().
+     */
+    int compareRows(int leftRow, int rightRow, int column) const;
+    /*! \brief Returns true if the name, app, status or ID of a row contains the given text. The text must be in lower case.
+     */
+    bool rowContainsText(int row, const QString &lowerText) const;
+
+    QStringList getKnownApps() const;
+    QStringList getKnownStatuses() const;
+    int countJobsWithStatus(QString status) const;
+
+    /*! \brief Fetches the whole job list from the server, and brings the table in line with it. Returns false if the refresh could not be started.
+     */
+    bool refreshJobList();
+    /*! \brief Fetches only the jobs updated since the last refresh, and updates their rows. Returns false if the refresh could not be started.
+     *
+     *  Jobs deleted by other clients are not seen by this refresh. If there has been no earlier refresh, the whole list is fetched.
+     */
+    bool refreshChangedJobs();
+    bool isRefreshing();
+
+    /*! \brief Returns true if any job in the table has not reached a terminal status.
+     */
+    bool hasActiveJobs() const;
+    /*! \brief Returns the IDs of the jobs in the table which have not reached a terminal status.
+     */
+    QStringList getActiveJobIds() const;
+
+signals:
+    void jobListRefreshed(RequestState finalState);
+
+private slots:
+    void jobPageReplied();
+
+private:
+    bool startRefresh(bool changedOnly);
+    void requestJobPage(int offset);
+    void finishRefresh(RequestState finalState);
+
+    void writeRow(int row, const JobRecord &theJob);
+    void rebuildIndices();
+
+    QVector<QString> idColumn;
+    QVector<QString> nameColumn;
+    QVector<QString> appColumn;
+    QVector<QString> statusColumn;
+    QVector<QDateTime> createdColumn;
+    QVector<QDateTime> updatedColumn;
+    QVector<QDateTime> startedColumn;
+    QVector<QDateTime> endedColumn;
+    QVector<QString> archiveColumn;
+
+    QVector<QString> nameKeys;
+    QVector<qint64> createdKeys;
+    QVector<QString> searchKeys;
+
+    QHash<QString, int> rowOfJob;
+    QHash<QString, QSet<int>> rowsOfApp;
+    QHash<QString, QSet<int>> rowsOfStatus;
+    QMap<qint64, QSet<int>> rowsByCreated;
+
+    QNetworkReply * refreshReply = nullptr;
+    bool refreshRunning = false;
+    bool refreshChangedOnly = false;
+    int refreshOffset = 0;
+    QString refreshLastJob;
+    bool refreshStable = true;
+    QDateTime refreshStartTime;
+    QDateTime lastSyncTime;
+    QSet<QString> refreshedJobs;
+    QSet<QString> upsertedDuringRefresh;
+
+    static const int jobPageSize = 100;
+    //Pages of a full refresh overlap, since jobs added or deleted during the refresh shift the later pages
+    static const int pageOverlap = 10;
+    //Changed jobs are fetched from a little before the last refresh, to allow for clock differences with the server
+    static const int syncOverlapSecs = 300;
+};
+
+#endif // REMOTEJOBMODEL_H
@@ -0,0 +1,286 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "remotenameindex.h"
+
+#include <QRegularExpression>
+
+#include <algorithm>
+#include <iterator>
+
+RemoteNameIndex::RemoteNameIndex(QObject * parent) : QObject(parent) {}
+
+void RemoteNameIndex::updateFolder(QString folderPath, const QList<FileMetaData> &folderContents)
+{
+    folderPath = cleanPath(folderPath);
+    listedFolders.insert(folderPath);
+
+    QSet<int> oldChildren = folderChildren.value(folderPath);
+    QSet<int> newChildren;
+
+    for (const FileMetaData &anEntry : folderContents)
+    {
+        QString entryPath = cleanPath(anEntry.getFullPath());
+        if (entryPath == folderPath) continue;
+
+        int entryId = addPath(entryPath, anEntry.getFileType() == FileType::DIR);
+        newChildren.insert(entryId);
+    }
+
+    for (int oldId : oldChildren)
+    {
+        if (!newChildren.contains(oldId))
+        {
+            removePath(oldId);
+        }
+    }
+    folderChildren.insert(folderPath, newChildren);
+
+    //Removed paths leave gaps in the path list and the trigram lists, which are cleared out once they outnumber the live paths
+    int removedCount = pathList.size() - livePathCount;
+    if ((removedCount >= minCompactCount) && (removedCount > livePathCount))
+    {
+        compact();
+    }
+
+    emit indexChanged();
+}
+
+QStringList RemoteNameIndex::search(QString pattern, int maxResults)
+{
+    QStringList ret;
+    pattern = pattern.trimmed().toLower();
+    if (pattern.isEmpty()) return ret;
+
+    bool isGlob = pattern.contains('*') || pattern.contains('?');
+    bool matchFullPath = pattern.contains('/');
+    QRegularExpression globMatcher;
+
+    QString candidateText = pattern;
+    if (isGlob)
+    {
+        globMatcher.setPattern(QRegularExpression::wildcardToRegularExpression(pattern));
+
+        //The longest literal fragment of the glob is used to narrow the candidates
+        //Note: Empty fragments are never the longest, so the split keeps them rather than using the deprecated QString::SkipEmptyParts
+        candidateText.clear();
+        for (const QString &aFragment : pattern.split(QRegularExpression("[*?]")))
+        {
+            if (aFragment.length() > candidateText.length()) candidateText = aFragment;
+        }
+    }
+
+    QVector<int> candidates = getCandidates(candidateText);
+
+    for (int pathId : candidates)
+    {
+        const QString &fullPath = pathList.at(pathId);
+        if (fullPath.isEmpty()) continue;
+
+        QString lowerPath = fullPath.toLower();
+        bool matches;
+        if (!isGlob)
+        {
+            matches = lowerPath.contains(pattern);
+        }
+        else if (matchFullPath)
+        {
+            matches = globMatcher.match(lowerPath).hasMatch();
+        }
+        else
+        {
+            matches = globMatcher.match(lowerPath.section('/', -1)).hasMatch();
+        }
+
+        if (!matches) continue;
+        ret.append(fullPath);
+        if (ret.size() >= maxResults) break;
+    }
+
+    ret.sort();
+    return ret;
+}
+
+bool RemoteNameIndex::folderIndexed(QString folderPath)
+{
+    return listedFolders.contains(cleanPath(folderPath));
+}
+
+int RemoteNameIndex::indexedPathCount()
+{
+    return livePathCount;
+}
+
+int RemoteNameIndex::addPath(const QString &fullPath, bool isFolder)
+{
+    int pathId = pathIds.value(fullPath, -1);
+    if (pathId != -1) return pathId;
+
+    pathId = pathList.size();
+    pathList.append(fullPath);
+    pathIds.insert(fullPath, pathId);
+    livePathCount++;
+
+    for (quint64 aTrigram : getTrigrams(fullPath.toLower()))
+    {
+        trigramLists[aTrigram].append(pathId);
+    }
+
+    if (isFolder)
+    {
+        folderChildren.insert(fullPath, QSet<int>());
+    }
+    return pathId;
+}
+
+void RemoteNameIndex::removePath(int pathId)
+{
+    QString fullPath = pathList.at(pathId);
+    if (fullPath.isEmpty()) return;
+
+    //Note: The trigram lists are left alone until the next compact(), removed ids are skipped at search time
+    pathList[pathId].clear();
+    pathIds.remove(fullPath);
+    livePathCount--;
+
+    if (folderChildren.contains(fullPath))
+    {
+        QSet<int> childIds = folderChildren.take(fullPath);
+        listedFolders.remove(fullPath);
+        for (int childId : childIds)
+        {
+            removePath(childId);
+        }
+    }
+}
+
+void RemoteNameIndex::compact()
+{
+    QVector<int> newIds(pathList.size(), -1);
+    QVector<QString> livePaths;
+    livePaths.reserve(livePathCount);
+    for (int oldId = 0; oldId < pathList.size(); oldId++)
+    {
+        if (pathList.at(oldId).isEmpty()) continue;
+        newIds[oldId] = livePaths.size();
+        livePaths.append(pathList.at(oldId));
+    }
+    pathList = livePaths;
+
+    //Paths are added in id order, so each trigram list stays sorted
+    pathIds.clear();
+    trigramLists.clear();
+    for (int pathId = 0; pathId < pathList.size(); pathId++)
+    {
+        pathIds.insert(pathList.at(pathId), pathId);
+        for (quint64 aTrigram : getTrigrams(pathList.at(pathId).toLower()))
+        {
+            trigramLists[aTrigram].append(pathId);
+        }
+    }
+
+    for (auto itr = folderChildren.begin(); itr != folderChildren.end(); itr++)
+    {
+        QSet<int> liveChildren;
+        for (int oldId : itr.value())
+        {
+            if (newIds.at(oldId) != -1) liveChildren.insert(newIds.at(oldId));
+        }
+        itr.value() = liveChildren;
+    }
+}
+
+QSet<quint64> RemoteNameIndex::getTrigrams(const QString &lowerText)
+{
+    QSet<quint64> ret;
+    for (int i = 0; i + 2 < lowerText.length(); i++)
+    {
+        ret.insert(trigramKey(lowerText.at(i), lowerText.at(i+1), lowerText.at(i+2)));
+    }
+    return ret;
+}
+
+QVector<int> RemoteNameIndex::getCandidates(const QString &lowerText)
+{
+    QSet<quint64> searchTrigrams = getTrigrams(lowerText);
+
+    if (searchTrigrams.isEmpty())
+    {
+        QVector<int> ret;
+        ret.reserve(pathList.size());
+        for (int i = 0; i < pathList.size(); i++)
+        {
+            ret.append(i);
+        }
+        return ret;
+    }
+
+    //Intersect the lists, beginning with the shortest
+    QList<const QVector<int> *> postingLists;
+    for (quint64 aTrigram : searchTrigrams)
+    {
+        auto found = trigramLists.constFind(aTrigram);
+        if (found == trigramLists.constEnd()) return QVector<int>();
+        postingLists.append(&(found.value()));
+    }
+    std::sort(postingLists.begin(), postingLists.end(),
+              [](const QVector<int> * a, const QVector<int> * b) { return a->size() < b->size(); });
+
+    QVector<int> ret = *(postingLists.first());
+    for (int i = 1; (i < postingLists.size()) && (!ret.isEmpty()); i++)
+    {
+        QVector<int> narrowed;
+        const QVector<int> * otherList = postingLists.at(i);
+        std::set_intersection(ret.constBegin(), ret.constEnd(), otherList->constBegin(), otherList->constEnd(),
+                              std::back_inserter(narrowed));
+        ret = narrowed;
+    }
+    return ret;
+}
+
+quint64 RemoteNameIndex::trigramKey(QChar first, QChar second, QChar third)
+{
+    return (quint64(first.unicode()) << 32) | (quint64(second.unicode()) << 16) | quint64(third.unicode());
+}
+
+QString RemoteNameIndex::cleanPath(QString fullPath)
+{
+    while ((fullPath.length() > 1) && fullPath.endsWith('/'))
+    {
+        fullPath.chop(1);
+    }
+    if (!fullPath.startsWith('/')) fullPath.prepend('/');
+    return fullPath;
+}
@@ -0,0 +1,100 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef REMOTENAMEINDEX_H
+#define REMOTENAMEINDEX_H
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QVector>
+#include <QStringList>
+
+#include "filemetadata.h"
+
+/*! \brief The RemoteNameIndex is an in-memory trigram index over the paths of all known remote files.
+ *
+ *  The index is kept current by giving it each folder listing as it arrives, with updateFolder().
+ *  Searches use the trigram lists to narrow the candidate paths, and then check each candidate, so that searches over many thousands of paths take milliseconds.
+ */
+class RemoteNameIndex : public QObject
+{
+    Q_OBJECT
+public:
+    explicit RemoteNameIndex(QObject * parent = nullptr);
+
+    /*! \brief Replaces the indexed contents of one folder with a new listing.
+     *
+     *  \param folderPath The full path of the listed folder
+     *  \param folderContents The entries of the folder. Entries previously indexed in this folder, but not in this list, are removed.
+     */
+    void updateFolder(QString folderPath, const QList<FileMetaData> &folderContents);
+
+    /*! \brief Returns the full paths which match a search pattern, up to maxResults of them.
+     *
+     *  If the pattern contains * or ?, it is a glob, matched against file names (or full paths, if the pattern contains a /). Otherwise, it is a case-insensitive substring of the full path.
+     */
+    QStringList search(QString pattern, int maxResults = 200);
+
+    /*! \brief Returns true if the folder has been listed into the index.
+     */
+    bool folderIndexed(QString folderPath);
+
+    int indexedPathCount();
+
+signals:
+    void indexChanged();
+
+private:
+    int addPath(const QString &fullPath, bool isFolder);
+    void removePath(int pathId);
+    void compact();
+    QSet<quint64> getTrigrams(const QString &lowerText);
+    QVector<int> getCandidates(const QString &lowerText);
+
+    static quint64 trigramKey(QChar first, QChar second, QChar third);
+    static QString cleanPath(QString fullPath);
+
+    QVector<QString> pathList;
+    QHash<QString, int> pathIds;
+    QHash<QString, QSet<int>> folderChildren;
+    QSet<QString> listedFolders;
+    QHash<quint64, QVector<int>> trigramLists;
+    int livePathCount = 0;
+
+    static const int minCompactCount = 1024;
+};
+
+#endif // REMOTENAMEINDEX_H
@@ -0,0 +1,137 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "remotetreecrawler.h"
+
+#include "pagedfolderlister.h"
+#include "remotenameindex.h"
+#include "agaverestlink.h"
+#include "remotedatainterface.h"
+#include "ae_globals.h"
+
+RemoteTreeCrawler::RemoteTreeCrawler(QString rootPath, RemoteNameIndex * theIndex, QObject * parent) : QObject(parent)
+{
+    myRootPath = rootPath;
+    myIndex = theIndex;
+}
+
+void RemoteTreeCrawler::setParallelFolders(int newCount)
+{
+    if (newCount < 1) return;
+    parallelFolders = newCount;
+}
+
+void RemoteTreeCrawler::setRelistIndexed(bool relist)
+{
+    relistIndexed = relist;
+}
+
+bool RemoteTreeCrawler::startCrawl()
+{
+    AgaveRestLink * theLink = ae_globals::get_rest_link();
+    if ((theLink == nullptr) || (!theLink->credentialsAvailable())) return false;
+
+    pendingFolders.enqueue(myRootPath);
+    launchListings();
+    return true;
+}
+
+void RemoteTreeCrawler::cancelCrawl()
+{
+    pendingFolders.clear();
+    finishCrawl(RequestState::EXPLICIT_ERROR);
+}
+
+void RemoteTreeCrawler::listingDone(RequestState finalState, QString folderPath, QList<FileMetaData> allEntries, FileSizeMap fileSizes)
+{
+    foldersInFlight--;
+    if (crawlFinished) return;
+
+    if (finalState != RequestState::GOOD)
+    {
+        qCDebug(agaveAppLayer, "Crawl could not list %s", qPrintable(folderPath));
+        anyFailure = true;
+    }
+    else
+    {
+        foldersListed++;
+        if (myIndex != nullptr)
+        {
+            myIndex->updateFolder(folderPath, allEntries);
+        }
+        emit folderListed(folderPath, allEntries, fileSizes);
+
+        for (const FileMetaData &anEntry : allEntries)
+        {
+            if (anEntry.getFileType() != FileType::DIR) continue;
+            if ((!relistIndexed) && (myIndex != nullptr) && myIndex->folderIndexed(anEntry.getFullPath())) continue;
+            pendingFolders.enqueue(anEntry.getFullPath());
+        }
+    }
+
+    launchListings();
+}
+
+void RemoteTreeCrawler::launchListings()
+{
+    while ((foldersInFlight < parallelFolders) && (!pendingFolders.isEmpty()))
+    {
+        PagedFolderLister * theLister = new PagedFolderLister(pendingFolders.dequeue(), this);
+        theLister->setPriority(RequestPriority::BACKGROUND);
+        QObject::connect(theLister, SIGNAL(listingDone(RequestState,QString,QList<FileMetaData>,FileSizeMap)),
+                         this, SLOT(listingDone(RequestState,QString,QList<FileMetaData>,FileSizeMap)));
+        if (!theLister->startListing())
+        {
+            theLister->deleteLater();
+            anyFailure = true;
+            continue;
+        }
+        foldersInFlight++;
+    }
+
+    if ((foldersInFlight == 0) && pendingFolders.isEmpty())
+    {
+        finishCrawl(anyFailure ? RequestState::EXPLICIT_ERROR : RequestState::GOOD);
+    }
+}
+
+void RemoteTreeCrawler::finishCrawl(RequestState finalState)
+{
+    if (crawlFinished) return;
+    crawlFinished = true;
+
+    emit crawlDone(finalState, foldersListed);
+    this->deleteLater();
+}
@@ -0,0 +1,100 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef REMOTETREECRAWLER_H
+#define REMOTETREECRAWLER_H
+
+#include <QObject>
+#include <QQueue>
+#include <QSet>
+
+#include "filemetadata.h"
+#include "pagedfolderlister.h"
+
+class RemoteNameIndex;
+enum class RequestState;
+
+/*! \brief The RemoteTreeCrawler lists every folder below a remote folder, several folders at a time.
+ *
+ *  Each listed folder is reported with the folderListed() signal, and, if an index is given, is added to that RemoteNameIndex.
+ *  Folders already in the index are not listed again, unless relistIndexed is set.
+ *  The RemoteTreeCrawler deletes itself after emitting crawlDone().
+ */
+class RemoteTreeCrawler : public QObject
+{
+    Q_OBJECT
+public:
+    /*! \brief Constructs a new RemoteTreeCrawler.
+     *
+     *  \param rootPath The full path of the remote folder at the top of the crawl
+     *  \param theIndex If not null, each listing is added to this index
+     *  \param parent The object requesting the crawl is typically the parent
+     */
+    explicit RemoteTreeCrawler(QString rootPath, RemoteNameIndex * theIndex = nullptr, QObject * parent = nullptr);
+
+    /*! \brief Sets the number of folders listed at the same time. The default is 4.
+     */
+    void setParallelFolders(int newCount);
+    void setRelistIndexed(bool relist);
+
+    /*! \brief Begins the crawl. Returns false if direct requests to the Agave server are not available.
+     */
+    bool startCrawl();
+    void cancelCrawl();
+
+signals:
+    void folderListed(QString folderPath, QList<FileMetaData> folderContents, FileSizeMap fileSizes);
+    void crawlDone(RequestState finalState, int foldersListed);
+
+private slots:
+    void listingDone(RequestState finalState, QString folderPath, QList<FileMetaData> allEntries, FileSizeMap fileSizes);
+
+private:
+    void launchListings();
+    void finishCrawl(RequestState finalState);
+
+    QString myRootPath;
+    RemoteNameIndex * myIndex;
+    int parallelFolders = 4;
+    bool relistIndexed = false;
+
+    QQueue<QString> pendingFolders;
+    int foldersInFlight = 0;
+    int foldersListed = 0;
+    bool crawlFinished = false;
+    bool anyFailure = false;
+};
+
+#endif // REMOTETREECRAWLER_H
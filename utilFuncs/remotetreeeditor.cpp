@@ -0,0 +1,327 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "remotetreeeditor.h"
+
+#include "agaverestlink.h"
+#include "requestscheduler.h"
+#include "remotedatainterface.h"
+#include "remoteFiles/fileoperator.h"
+#include "remoteFiles/filetreenode.h"
+#include "ae_globals.h"
+
+#include <QNetworkReply>
+#include <QJsonObject>
+
+RemoteTreeEditor::RemoteTreeEditor(QObject * parent) : QObject(parent) {}
+
+bool RemoteTreeEditor::startEdit(TreeEditKind kind, const FileNodeRef &targetNode, QString argument)
+{
+    AgaveRestLink * theLink = ae_globals::get_rest_link();
+    if ((theLink == nullptr) || (!theLink->credentialsAvailable())) return false;
+    if (targetNode.isNil()) return false;
+
+    FileTreeNode * theNode = ae_globals::get_file_handle()->getFileNodeFromNodeRef(targetNode);
+    if (theNode == nullptr) return false;
+
+    PendingEdit newEdit;
+    newEdit.kind = kind;
+    newEdit.oldEntry = theNode->getFileData();
+    newEdit.newEntry = newEdit.oldEntry;
+
+    QString targetPath = targetNode.getFullPath();
+    QString parentPath = getParentPath(targetPath);
+    QString newPath;
+
+    switch (kind)
+    {
+    case TreeEditKind::COPY:
+    case TreeEditKind::MOVE:
+        if (argument.isEmpty()) return false;
+        newPath = argument.startsWith('/') ? argument : parentPath + "/" + argument;
+        break;
+    case TreeEditKind::RENAME:
+        if (argument.isEmpty() || argument.contains('/')) return false;
+        newPath = parentPath + "/" + argument;
+        break;
+    case TreeEditKind::MKDIR:
+        if (argument.isEmpty() || argument.contains('/')) return false;
+        newPath = targetPath + "/" + argument;
+        newEdit.newEntry.setType(FileType::DIR);
+        newEdit.newEntry.setSize(0);
+        newEdit.refreshOnDone = targetNode;
+        break;
+    case TreeEditKind::REMOVE:
+        break;
+    }
+
+    //The folder holding the target, and the folder which will hold the result, if they are listed
+    if (kind != TreeEditKind::MKDIR)
+    {
+        newEdit.sourceFolder = theNode->getParentNode();
+    }
+    if (!newPath.isEmpty())
+    {
+        newEdit.newEntry.setFullFilePath(newPath);
+        newEdit.destFolder = findListedFolder(theNode, getParentPath(newPath));
+    }
+
+    switch (kind)
+    {
+    case TreeEditKind::COPY:
+        newEdit.description = QString("Copy %1 to %2").arg(targetPath, newPath);
+        break;
+    case TreeEditKind::MOVE:
+        newEdit.description = QString("Move %1 to %2").arg(targetPath, newPath);
+        break;
+    case TreeEditKind::RENAME:
+        newEdit.description = QString("Rename %1 to %2").arg(targetPath, argument);
+        break;
+    case TreeEditKind::MKDIR:
+        newEdit.description = QString("Create folder %1").arg(newPath);
+        break;
+    case TreeEditKind::REMOVE:
+        newEdit.description = QString("Delete %1").arg(targetPath);
+        break;
+    }
+
+    //Show the result right away
+    bool removesOld = (kind == TreeEditKind::MOVE) || (kind == TreeEditKind::RENAME) || (kind == TreeEditKind::REMOVE);
+    if (removesOld)
+    {
+        newEdit.sourceShown = changeFolderEntry(newEdit.sourceFolder, newEdit.oldEntry.getFullPath(), nullptr);
+        pendingPaths.append(newEdit.oldEntry.getFullPath());
+    }
+    if (!newPath.isEmpty())
+    {
+        newEdit.destShown = changeFolderEntry(newEdit.destFolder, QString(), &newEdit.newEntry);
+        pendingPaths.append(newPath);
+    }
+    editsPending++;
+
+    theLink->getScheduler()->scheduleRequest(RequestPriority::INTERACTIVE, this, [this, newEdit, argument]()
+    {
+        QNetworkReply * theReply = sendEditRequest(newEdit, argument);
+        if (theReply == nullptr)
+        {
+            finishEdit(newEdit, nullptr);
+            return theReply;
+        }
+
+        pendingEdits.insert(theReply, newEdit);
+        QObject::connect(theReply, SIGNAL(finished()), this, SLOT(editReplied()));
+        return theReply;
+    });
+
+    emit pendingCountChanged(editsPending);
+    return true;
+}
+
+bool RemoteTreeEditor::isPending(QString remotePath)
+{
+    for (const QString &aPath : pendingPaths)
+    {
+        if ((remotePath == aPath) || remotePath.startsWith(aPath + "/")) return true;
+    }
+    return false;
+}
+
+int RemoteTreeEditor::pendingCount()
+{
+    return editsPending;
+}
+
+void RemoteTreeEditor::editReplied()
+{
+    QNetworkReply * theReply = qobject_cast<QNetworkReply *>(sender());
+    if (!pendingEdits.contains(theReply)) return;
+
+    theReply->deleteLater();
+    finishEdit(pendingEdits.take(theReply), theReply);
+}
+
+void RemoteTreeEditor::finishEdit(PendingEdit theEdit, QNetworkReply * theReply)
+{
+    editsPending--;
+    pendingPaths.removeOne(theEdit.oldEntry.getFullPath());
+    pendingPaths.removeOne(theEdit.newEntry.getFullPath());
+
+    bool removesOld = (theEdit.kind == TreeEditKind::MOVE) || (theEdit.kind == TreeEditKind::RENAME) || (theEdit.kind == TreeEditKind::REMOVE);
+    bool addsNew = (theEdit.kind != TreeEditKind::REMOVE);
+
+    QJsonValue replyResult;
+    if ((theReply != nullptr) && (theReply->error() == QNetworkReply::NoError))
+    {
+        replyResult = AgaveRestLink::getReplyResult(theReply->readAll());
+    }
+
+    if ((theReply == nullptr) || (theReply->error() != QNetworkReply::NoError) || replyResult.isUndefined())
+    {
+        //Undo only this edit, so that other pending edits in the same folders are kept
+        if (addsNew && theEdit.destShown)
+        {
+            changeFolderEntry(theEdit.destFolder, theEdit.newEntry.getFullPath(), nullptr, true);
+        }
+        if (removesOld && theEdit.sourceShown)
+        {
+            changeFolderEntry(theEdit.sourceFolder, QString(), &theEdit.oldEntry, true);
+        }
+
+        emit pendingCountChanged(editsPending);
+        emit editDone((theReply == nullptr) ? RequestState::NO_CONNECT : RequestState::EXPLICIT_ERROR, theEdit.description);
+        return;
+    }
+
+    //The reply describes the new file, which may differ from our guess, such as in size or type
+    FileMetaData confirmedEntry;
+    if (addsNew && theEdit.destShown && replyResult.isObject() && AgaveRestLink::parseFileEntry(replyResult.toObject(), &confirmedEntry)
+            && (confirmedEntry.getFullPath() == theEdit.newEntry.getFullPath()))
+    {
+        changeFolderEntry(theEdit.destFolder, theEdit.newEntry.getFullPath(), &confirmedEntry, true);
+    }
+
+    //A new folder in a folder with nothing else listed could not be shown ahead of time
+    if ((theEdit.kind == TreeEditKind::MKDIR) && !theEdit.destShown && !theEdit.refreshOnDone.isNil())
+    {
+        theEdit.refreshOnDone.enactFolderRefresh();
+    }
+
+    emit pendingCountChanged(editsPending);
+    emit editDone(RequestState::GOOD, theEdit.description);
+}
+
+QNetworkReply * RemoteTreeEditor::sendEditRequest(const PendingEdit &theEdit, QString argument)
+{
+    AgaveRestLink * theLink = ae_globals::get_rest_link();
+    QString targetPath = theEdit.oldEntry.getFullPath();
+
+    switch (theEdit.kind)
+    {
+    case TreeEditKind::COPY:
+        return theLink->requestFileAction(targetPath, "copy", theEdit.newEntry.getFullPath());
+    case TreeEditKind::MOVE:
+        return theLink->requestFileAction(targetPath, "move", theEdit.newEntry.getFullPath());
+    case TreeEditKind::RENAME:
+        return theLink->requestFileAction(targetPath, "rename", argument);
+    case TreeEditKind::MKDIR:
+        return theLink->requestMakeFolder(targetPath, argument);
+    case TreeEditKind::REMOVE:
+        return theLink->requestDelete(targetPath);
+    }
+    return nullptr;
+}
+
+bool RemoteTreeEditor::changeFolderEntry(FileTreeNode * folderNode, QString removePath, const FileMetaData * addEntry, bool knownListed)
+{
+    if (folderNode == nullptr) return false;
+
+    QList<FileMetaData> folderContents = getFolderContents(folderNode);
+    //A listed folder with no entries cannot be told apart from one not yet listed, and is left alone
+    if (folderContents.isEmpty() && !knownListed) return false;
+
+    QString addPath;
+    if (addEntry != nullptr) addPath = addEntry->getFullPath();
+
+    for (auto itr = folderContents.begin(); itr != folderContents.end();)
+    {
+        if ((itr->getFullPath() == removePath) || (itr->getFullPath() == addPath))
+        {
+            itr = folderContents.erase(itr);
+        }
+        else
+        {
+            itr++;
+        }
+    }
+    if (addEntry != nullptr)
+    {
+        folderContents.append(*addEntry);
+    }
+
+    emit folderChanged(folderNode->getFileData().getFullPath(), folderContents);
+
+    //Note: LS data for a node begins with the entry for the folder itself
+    folderContents.prepend(folderNode->getFileData());
+    folderNode->deliverLSdata(RequestState::GOOD, &folderContents);
+    return true;
+}
+
+QList<FileMetaData> RemoteTreeEditor::getFolderContents(FileTreeNode * folderNode)
+{
+    QList<FileMetaData> ret;
+    for (FileTreeNode * aChild : folderNode->getChildList())
+    {
+        ret.append(aChild->getFileData());
+    }
+    return ret;
+}
+
+FileTreeNode * RemoteTreeEditor::findListedFolder(FileTreeNode * anyNode, QString folderPath)
+{
+    FileTreeNode * searchNode = anyNode;
+    while (searchNode->getParentNode() != nullptr)
+    {
+        searchNode = searchNode->getParentNode();
+    }
+
+    //Walk down from the root, through folders which are listed
+    while (searchNode != nullptr)
+    {
+        QString nodePath = searchNode->getFileData().getFullPath();
+        if (nodePath == folderPath) return searchNode;
+
+        FileTreeNode * nextNode = nullptr;
+        for (FileTreeNode * aChild : searchNode->getChildList())
+        {
+            QString childPath = aChild->getFileData().getFullPath();
+            if ((folderPath == childPath) || folderPath.startsWith(childPath + "/"))
+            {
+                nextNode = aChild;
+                break;
+            }
+        }
+        searchNode = nextNode;
+    }
+    return nullptr;
+}
+
+QString RemoteTreeEditor::getParentPath(QString remotePath)
+{
+    while ((remotePath.length() > 1) && remotePath.endsWith('/'))
+    {
+        remotePath.chop(1);
+    }
+    return remotePath.section('/', 0, -2);
+}
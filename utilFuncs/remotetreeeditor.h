@@ -0,0 +1,116 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef REMOTETREEEDITOR_H
+#define REMOTETREEEDITOR_H
+
+#include <QObject>
+#include <QMap>
+#include <QPointer>
+
+#include "filemetadata.h"
+#include "remoteFiles/filenoderef.h"
+
+class QNetworkReply;
+class FileTreeNode;
+enum class RequestState;
+
+enum class TreeEditKind {COPY, MOVE, RENAME, REMOVE, MKDIR};
+
+/*! \brief The RemoteTreeEditor makes changes to remote files, and shows them in the file tree at once, before the server replies.
+ *
+ *  When an edit is started, the listings of the affected folders in the file tree are changed to what they will be once the edit is done,
+ *  and the changed paths are marked as pending. When the reply arrives, the edit is either confirmed, with the entry updated from the reply,
+ *  or undone, leaving any other pending edits in the same folders in place. No folder is listed again from the server.
+ *
+ *  Folders which have not been listed yet are not changed, and will show the edit when they are listed.
+ *  Several edits may be pending at once.
+ */
+class RemoteTreeEditor : public QObject
+{
+    Q_OBJECT
+public:
+    explicit RemoteTreeEditor(QObject * parent = nullptr);
+
+    /*! \brief Starts an edit of a remote file or folder. Returns false if direct requests are not available, or the edit is not valid.
+     *
+     *  \param kind The kind of edit
+     *  \param targetNode The file or folder to edit. For MKDIR, the folder in which to make the new folder.
+     *  \param argument For COPY and MOVE, the destination, either a full path or a path relative to the folder of the target.
+     *  For RENAME, the new name. For MKDIR, the name of the new folder. Unused for REMOVE.
+     */
+    bool startEdit(TreeEditKind kind, const FileNodeRef &targetNode, QString argument = QString());
+
+    /*! \brief Returns true if the given path is changed by an edit still waiting on the server.
+     */
+    bool isPending(QString remotePath);
+    int pendingCount();
+
+signals:
+    void editDone(RequestState finalState, QString description);
+    void pendingCountChanged(int editsPending);
+    void folderChanged(QString folderPath, QList<FileMetaData> folderContents);
+
+private slots:
+    void editReplied();
+
+private:
+    struct PendingEdit
+    {
+        TreeEditKind kind;
+        FileMetaData oldEntry;
+        FileMetaData newEntry;
+        QPointer<FileTreeNode> sourceFolder;
+        QPointer<FileTreeNode> destFolder;
+        FileNodeRef refreshOnDone;
+        bool sourceShown = false;
+        bool destShown = false;
+        QString description;
+    };
+
+    QNetworkReply * sendEditRequest(const PendingEdit &theEdit, QString argument);
+    void finishEdit(PendingEdit theEdit, QNetworkReply * theReply);
+
+    bool changeFolderEntry(FileTreeNode * folderNode, QString removePath, const FileMetaData * addEntry, bool knownListed = false);
+    static QList<FileMetaData> getFolderContents(FileTreeNode * folderNode);
+    static FileTreeNode * findListedFolder(FileTreeNode * anyNode, QString folderPath);
+    static QString getParentPath(QString remotePath);
+
+    QMap<QNetworkReply *, PendingEdit> pendingEdits;
+    QStringList pendingPaths;
+    int editsPending = 0;
+};
+
+#endif // REMOTETREEEDITOR_H
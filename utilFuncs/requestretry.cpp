@@ -0,0 +1,108 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "requestretry.h"
+
+#include <QNetworkReply>
+#include <QRandomGenerator>
+#include <QDateTime>
+
+RetryHint RequestRetry::classifyReply(QNetworkReply * theReply)
+{
+    RetryHint ret;
+    if ((theReply == nullptr) || (theReply->error() == QNetworkReply::NoError)) return ret;
+
+    int httpStatus = theReply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (httpStatus > 0)
+    {
+        ret.throttled = (httpStatus == 429) || (httpStatus == 503);
+        ret.retryable = (httpStatus == 408) || (httpStatus == 429) || (httpStatus >= 500);
+    }
+    else
+    {
+        switch (theReply->error())
+        {
+        case QNetworkReply::ConnectionRefusedError:
+        case QNetworkReply::RemoteHostClosedError:
+        case QNetworkReply::TimeoutError:
+        case QNetworkReply::TemporaryNetworkFailureError:
+        case QNetworkReply::NetworkSessionFailedError:
+        case QNetworkReply::ProxyTimeoutError:
+        case QNetworkReply::UnknownNetworkError:
+            ret.retryable = true;
+            break;
+        default:
+            break;
+        }
+    }
+
+    //Retry-After may be either a number of seconds or an HTTP date
+    QByteArray retryAfter = theReply->rawHeader("Retry-After").trimmed();
+    if (!retryAfter.isEmpty())
+    {
+        bool isNumber = false;
+        int retrySeconds = retryAfter.toInt(&isNumber);
+        if (isNumber)
+        {
+            ret.retryAfterMs = retrySeconds * 1000;
+        }
+        else
+        {
+            QDateTime retryTime = QDateTime::fromString(QString::fromLatin1(retryAfter), Qt::RFC2822Date);
+            if (retryTime.isValid())
+            {
+                ret.retryAfterMs = qMax(qint64(0), QDateTime::currentDateTimeUtc().msecsTo(retryTime));
+            }
+        }
+        if (ret.retryAfterMs > maxDelayMs) ret.retryAfterMs = maxDelayMs;
+    }
+    return ret;
+}
+
+int RequestRetry::backoffDelayMs(int attempt, const RetryHint &hint)
+{
+    if (attempt < 1) attempt = 1;
+
+    qint64 delayCap = baseDelayMs;
+    for (int i = 1; (i < attempt) && (delayCap < maxDelayMs); i++)
+    {
+        delayCap *= 2;
+    }
+    if (delayCap > maxDelayMs) delayCap = maxDelayMs;
+
+    int ret = QRandomGenerator::global()->bounded(int(delayCap) + 1);
+    if (ret < hint.retryAfterMs) ret = hint.retryAfterMs;
+    return ret;
+}
@@ -0,0 +1,76 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef REQUESTRETRY_H
+#define REQUESTRETRY_H
+
+class QNetworkReply;
+
+/*! \brief The RetryHint describes why a request failed, and whether sending it again may succeed.
+ */
+struct RetryHint
+{
+    //True if the failure may be transient, such as a dropped connection or a 5xx status
+    bool retryable = false;
+    //True if the server is overloaded, or is limiting our rate of requests, with a 429 or 503 status
+    bool throttled = false;
+    //The delay asked for by a Retry-After header, or -1 if there was none
+    int retryAfterMs = -1;
+};
+
+/*! \brief The RequestRetry class holds the retry policy for direct requests to the Agave server.
+ *
+ *  Only idempotent requests, such as listings, file downloads and uploads which replace a file, should be retried.
+ *  Retries wait with exponential backoff and full jitter, so that many failed requests do not all come back at once.
+ */
+class RequestRetry
+{
+public:
+    /*! \brief Returns a RetryHint for a finished reply. A reply without error is not retryable.
+     */
+    static RetryHint classifyReply(QNetworkReply * theReply);
+
+    /*! \brief Returns the delay before the given retry attempt, counting from 1.
+     *
+     *  The delay is random, between zero and an exponentially growing cap, but never less than any Retry-After delay in the hint.
+     */
+    static int backoffDelayMs(int attempt, const RetryHint &hint);
+
+    static const int maxAttempts = 5;
+    static const int baseDelayMs = 500;
+    static const int maxDelayMs = 30000;
+};
+
+#endif // REQUESTRETRY_H
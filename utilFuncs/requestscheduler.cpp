@@ -0,0 +1,243 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "requestscheduler.h"
+
+#include "requestretry.h"
+
+#include <QNetworkReply>
+
+RequestScheduler::RequestScheduler(QObject * parent) : QObject(parent) {}
+
+void RequestScheduler::scheduleRequest(RequestPriority priority, QObject * owner, std::function<QNetworkReply *()> startFunc)
+{
+    WaitingRequest newRequest;
+    newRequest.owner = owner;
+    newRequest.startFunc = startFunc;
+    waitingRequests[classIndex(priority)].enqueue(newRequest);
+
+    launchWaitingRequests();
+}
+
+void RequestScheduler::setClassLimit(RequestPriority priority, int maxInFlight)
+{
+    if (maxInFlight < 1) return;
+    classLimits[classIndex(priority)] = maxInFlight;
+    launchWaitingRequests();
+}
+
+void RequestScheduler::setAdaptiveLimit(RequestPriority priority, int maxInFlight)
+{
+    int classIdx = classIndex(priority);
+    if (maxInFlight < 1)
+    {
+        adaptiveClasses[classIdx] = false;
+        return;
+    }
+
+    adaptiveLimits[classIdx] = ConcurrencyController(qMin(classLimits[classIdx], maxInFlight), 1, maxInFlight);
+    adaptiveClasses[classIdx] = true;
+    launchWaitingRequests();
+}
+
+int RequestScheduler::getClassLimit(RequestPriority priority)
+{
+    int classIdx = classIndex(priority);
+    if (adaptiveClasses[classIdx]) return adaptiveLimits[classIdx].getLimit();
+    return classLimits[classIdx];
+}
+
+int RequestScheduler::getClassMaxLimit(RequestPriority priority)
+{
+    int classIdx = classIndex(priority);
+    if (adaptiveClasses[classIdx]) return adaptiveLimits[classIdx].getMaxLimit();
+    return classLimits[classIdx];
+}
+
+void RequestScheduler::setBulkBandwidthLimit(qint64 bytesPerSecond)
+{
+    if (bytesPerSecond < 0) bytesPerSecond = 0;
+    bulkRateLimit = bytesPerSecond;
+    bulkTokens = bytesPerSecond;
+    bulkRefillTimer.start();
+}
+
+qint64 RequestScheduler::takeBulkBytes(qint64 wantedBytes)
+{
+    if (bulkRateLimit <= 0) return wantedBytes;
+
+    //Token bucket, holding at most one second of transfer
+    bulkTokens += bulkRefillTimer.restart() * bulkRateLimit / 1000.0;
+    if (bulkTokens > bulkRateLimit) bulkTokens = bulkRateLimit;
+
+    qint64 permitted = qMin(wantedBytes, qint64(bulkTokens));
+    if (permitted < 0) permitted = 0;
+    bulkTokens -= permitted;
+    return permitted;
+}
+
+bool RequestScheduler::bulkBandwidthLimited()
+{
+    return (bulkRateLimit > 0);
+}
+
+QNetworkRequest::Priority RequestScheduler::getLaunchPriority()
+{
+    return launchPriority;
+}
+
+int RequestScheduler::getWaitingCount(RequestPriority priority)
+{
+    return waitingRequests[classIndex(priority)].size();
+}
+
+int RequestScheduler::getRunningCount(RequestPriority priority)
+{
+    return runningCounts[classIndex(priority)];
+}
+
+void RequestScheduler::requestEnded()
+{
+    QObject * theReply = sender();
+    if (!runningReplies.contains(theReply)) return;
+
+    RunningRequest theRequest = runningReplies.take(theReply);
+    runningCounts[theRequest.classIdx]--;
+
+    //Note: A reply deleted before it finished has no outcome to learn from
+    QNetworkReply * finishedReply = qobject_cast<QNetworkReply *>(theReply);
+    if ((finishedReply != nullptr) && adaptiveClasses[theRequest.classIdx])
+    {
+        recordReplyOutcome(finishedReply, theRequest);
+    }
+    launchWaitingRequests();
+}
+
+void RequestScheduler::requestHeadersArrived()
+{
+    auto found = runningReplies.find(sender());
+    if (found == runningReplies.end()) return;
+
+    if (found.value().headerLatencyMs < 0)
+    {
+        found.value().headerLatencyMs = found.value().launchTimer.elapsed();
+    }
+}
+
+void RequestScheduler::requestBodySent(qint64 bytesSent)
+{
+    auto found = runningReplies.find(sender());
+    if (found == runningReplies.end()) return;
+    found.value().bytesSent = bytesSent;
+}
+
+void RequestScheduler::recordReplyOutcome(QNetworkReply * theReply, const RunningRequest &theRequest)
+{
+    if (theReply->error() == QNetworkReply::OperationCanceledError) return;
+
+    ConcurrencyController &theController = adaptiveLimits[theRequest.classIdx];
+    RetryHint theHint = RequestRetry::classifyReply(theReply);
+    int httpStatus = theReply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+
+    if (theHint.throttled || (httpStatus >= 500))
+    {
+        theController.recordCongestion();
+    }
+    else if (theReply->error() == QNetworkReply::NoError)
+    {
+        //Time to the first response is used, since the time of the whole reply depends on its size
+        qint64 latencyMs = theRequest.headerLatencyMs;
+        if (latencyMs < 0) latencyMs = theRequest.launchTimer.elapsed();
+        if (theRequest.bytesSent > maxSampledBodyBytes) latencyMs = -1;
+        theController.recordSuccess(latencyMs);
+    }
+}
+
+void RequestScheduler::launchWaitingRequests()
+{
+    //Note: A startFunc may schedule further requests, which are picked up by this loop
+    if (launchInProgress) return;
+    launchInProgress = true;
+
+    const QNetworkRequest::Priority netPriorities[numClasses] = {QNetworkRequest::HighPriority,
+                                                                 QNetworkRequest::NormalPriority,
+                                                                 QNetworkRequest::LowPriority};
+
+    bool launchedAny = true;
+    while (launchedAny)
+    {
+        launchedAny = false;
+        for (int i = 0; i < numClasses; i++)
+        {
+            int currentLimit = adaptiveClasses[i] ? adaptiveLimits[i].getLimit() : classLimits[i];
+            while ((runningCounts[i] < currentLimit) && (!waitingRequests[i].isEmpty()))
+            {
+                WaitingRequest nextRequest = waitingRequests[i].dequeue();
+                if (nextRequest.owner.isNull()) continue;
+
+                launchPriority = netPriorities[i];
+                QNetworkReply * theReply = nextRequest.startFunc();
+                launchPriority = QNetworkRequest::NormalPriority;
+                launchedAny = true;
+
+                if ((theReply == nullptr) || theReply->isFinished()) continue;
+
+                RunningRequest newRunning;
+                newRunning.classIdx = i;
+                newRunning.launchTimer.start();
+
+                runningCounts[i]++;
+                runningReplies.insert(theReply, newRunning);
+                QObject::connect(theReply, SIGNAL(metaDataChanged()), this, SLOT(requestHeadersArrived()));
+                QObject::connect(theReply, SIGNAL(uploadProgress(qint64,qint64)), this, SLOT(requestBodySent(qint64)));
+                QObject::connect(theReply, SIGNAL(finished()), this, SLOT(requestEnded()));
+                QObject::connect(theReply, SIGNAL(destroyed(QObject*)), this, SLOT(requestEnded()));
+            }
+        }
+    }
+
+    launchInProgress = false;
+}
+
+int RequestScheduler::classIndex(RequestPriority priority)
+{
+    switch (priority)
+    {
+    case RequestPriority::INTERACTIVE: return 0;
+    case RequestPriority::BACKGROUND: return 1;
+    case RequestPriority::BULK: return 2;
+    }
+    return 2;
+}
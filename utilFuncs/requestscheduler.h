@@ -0,0 +1,151 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef REQUESTSCHEDULER_H
+#define REQUESTSCHEDULER_H
+
+#include <QObject>
+#include <QQueue>
+#include <QHash>
+#include <QPointer>
+#include <QElapsedTimer>
+#include <QNetworkRequest>
+
+#include <functional>
+
+#include "concurrencycontroller.h"
+
+class QNetworkReply;
+
+/*! \brief The RequestPriority is the class of a request made through the RequestScheduler.
+ *
+ *  INTERACTIVE requests are made directly by the user, and someone is waiting on them, such as the listing of a folder.
+ *  BACKGROUND requests fill in data the user may want later, such as crawling the remote file tree.
+ *  BULK requests move file contents.
+ */
+enum class RequestPriority {INTERACTIVE, BACKGROUND, BULK};
+
+/*! \brief The RequestScheduler decides when direct requests to the Agave server are sent, so that bulk transfers do not delay interactive requests.
+ *
+ *  Each priority class has its own limit on the number of requests in flight. Waiting requests are started in order of class, and then in the order they were scheduled.
+ *  Requests are also given a matching QNetworkRequest priority, so that the network manager sends interactive requests first.
+ *  Optionally, the bandwidth used by bulk transfers can be capped, with takeBulkBytes().
+ *
+ *  The limit of a class may also be made adaptive, with setAdaptiveLimit(). The limit is then set by a ConcurrencyController,
+ *  from the latency and status of the replies in that class, so that it rises to what the server can take without being throttled.
+ */
+class RequestScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    explicit RequestScheduler(QObject * parent = nullptr);
+
+    /*! \brief Queues a request, to be started when its class has room.
+     *
+     *  \param priority The class of the request
+     *  \param owner If this object is deleted before the request starts, the request is dropped.
+     *  \param startFunc Sends the request and returns its reply. The request ends when the reply finishes or is deleted. May return nullptr if the request could not be sent.
+     */
+    void scheduleRequest(RequestPriority priority, QObject * owner, std::function<QNetworkReply *()> startFunc);
+
+    void setClassLimit(RequestPriority priority, int maxInFlight);
+
+    /*! \brief Lets the limit of a class adapt to the server, up to the given maximum. A maximum of zero returns the class to its fixed limit.
+     */
+    void setAdaptiveLimit(RequestPriority priority, int maxInFlight);
+    int getClassLimit(RequestPriority priority);
+    /*! \brief Returns the most requests the class may ever have in flight, which for an adaptive class is above its current limit.
+     */
+    int getClassMaxLimit(RequestPriority priority);
+
+    /*! \brief Sets the maximum rate, in bytes per second, at which bulk transfers may move data. Zero, the default, is unlimited.
+     */
+    void setBulkBandwidthLimit(qint64 bytesPerSecond);
+    /*! \brief Takes permission to move up to the given number of bulk bytes now. Returns the number of bytes permitted, which may be zero.
+     */
+    qint64 takeBulkBytes(qint64 wantedBytes);
+    bool bulkBandwidthLimited();
+
+    /*! \brief Returns the QNetworkRequest priority for the request being started, for use while startFunc runs.
+     */
+    QNetworkRequest::Priority getLaunchPriority();
+
+    int getWaitingCount(RequestPriority priority);
+    int getRunningCount(RequestPriority priority);
+
+private slots:
+    void requestEnded();
+    void requestHeadersArrived();
+    void requestBodySent(qint64 bytesSent);
+
+private:
+    struct WaitingRequest
+    {
+        QPointer<QObject> owner;
+        std::function<QNetworkReply *()> startFunc;
+    };
+
+    struct RunningRequest
+    {
+        int classIdx;
+        QElapsedTimer launchTimer;
+        qint64 headerLatencyMs = -1;
+        qint64 bytesSent = 0;
+    };
+
+    void launchWaitingRequests();
+    void recordReplyOutcome(QNetworkReply * theReply, const RunningRequest &theRequest);
+    static int classIndex(RequestPriority priority);
+
+    //The response to a larger body only starts once the body is sent, so its latency says little about the server
+    static const qint64 maxSampledBodyBytes = 64 * 1024;
+
+    static const int numClasses = 3;
+    QQueue<WaitingRequest> waitingRequests[numClasses];
+    int runningCounts[numClasses] = {0, 0, 0};
+    int classLimits[numClasses] = {6, 4, 2};
+    bool adaptiveClasses[numClasses] = {false, false, false};
+    ConcurrencyController adaptiveLimits[numClasses];
+    QHash<QObject *, RunningRequest> runningReplies;
+
+    QNetworkRequest::Priority launchPriority = QNetworkRequest::NormalPriority;
+    bool launchInProgress = false;
+
+    qint64 bulkRateLimit = 0;
+    double bulkTokens = 0;
+    QElapsedTimer bulkRefillTimer;
+};
+
+#endif // REQUESTSCHEDULER_H
@@ -0,0 +1,237 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "streamhasher.h"
+
+#include <QCryptographicHash>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QMutex>
+#include <QQueue>
+#include <QThread>
+#include <QFile>
+
+struct HashStreamState
+{
+    HashStreamState() : hashObject(QCryptographicHash::Sha256) {}
+
+    QMutex stateLock;
+    QQueue<QByteArray> pendingChunks;
+    qint64 pendingBytes = 0;
+    QCryptographicHash hashObject;
+    StreamHasher * owner = nullptr;
+    bool workerActive = false;
+    bool dataFinished = false;
+    bool drainWanted = false;
+};
+
+class HashWorker : public QRunnable
+{
+public:
+    explicit HashWorker(QSharedPointer<HashStreamState> theState) : myState(theState) {}
+
+    void run()
+    {
+        while (true)
+        {
+            QByteArray nextChunk;
+            {
+                QMutexLocker stateLocker(&myState->stateLock);
+                if (myState->pendingChunks.isEmpty())
+                {
+                    myState->workerActive = false;
+                    if (myState->dataFinished && (myState->owner != nullptr))
+                    {
+                        QMetaObject::invokeMethod(myState->owner, "deliverHash", Qt::QueuedConnection,
+                                                  Q_ARG(QByteArray, myState->hashObject.result().toHex()));
+                    }
+                    return;
+                }
+                nextChunk = myState->pendingChunks.dequeue();
+                myState->pendingBytes -= nextChunk.size();
+                if (myState->drainWanted && (myState->pendingBytes <= StreamHasher::maxPendingBytes / 2) && (myState->owner != nullptr))
+                {
+                    myState->drainWanted = false;
+                    QMetaObject::invokeMethod(myState->owner, "deliverDrained", Qt::QueuedConnection);
+                }
+            }
+            //Only one worker runs for each stream, so the hash object needs no lock while in use
+            myState->hashObject.addData(nextChunk);
+        }
+    }
+
+private:
+    QSharedPointer<HashStreamState> myState;
+};
+
+class FileHashWorker : public QRunnable
+{
+public:
+    FileHashWorker(QSharedPointer<HashStreamState> theState, QString fileName) : myState(theState), myFileName(fileName) {}
+
+    void run()
+    {
+        QByteArray hexHash;
+        QFile sourceFile(myFileName);
+        if (sourceFile.open(QIODevice::ReadOnly))
+        {
+            const qint64 chunkSize = 1024 * 1024;
+            while (!sourceFile.atEnd())
+            {
+                QByteArray nextChunk = sourceFile.read(chunkSize);
+                if (nextChunk.isEmpty()) break;
+                myState->hashObject.addData(nextChunk);
+            }
+            if (sourceFile.error() == QFile::NoError) hexHash = myState->hashObject.result().toHex();
+        }
+
+        QMutexLocker stateLocker(&myState->stateLock);
+        myState->workerActive = false;
+        if (myState->owner != nullptr)
+        {
+            QMetaObject::invokeMethod(myState->owner, "deliverHash", Qt::QueuedConnection, Q_ARG(QByteArray, hexHash));
+        }
+    }
+
+private:
+    QSharedPointer<HashStreamState> myState;
+    QString myFileName;
+};
+
+StreamHasher::StreamHasher(QObject * parent) : QObject(parent), streamState(new HashStreamState())
+{
+    streamState->owner = this;
+}
+
+StreamHasher::~StreamHasher()
+{
+    //A worker may still hold the state, but will no longer report to this object
+    QMutexLocker stateLocker(&streamState->stateLock);
+    streamState->owner = nullptr;
+    streamState->pendingChunks.clear();
+    streamState->pendingBytes = 0;
+}
+
+void StreamHasher::addData(QByteArray chunk)
+{
+    if (dataFinished || chunk.isEmpty()) return;
+
+    QMutexLocker stateLocker(&streamState->stateLock);
+    streamState->pendingChunks.enqueue(chunk);
+    streamState->pendingBytes += chunk.size();
+    launchWorker();
+}
+
+bool StreamHasher::canTakeData()
+{
+    QMutexLocker stateLocker(&streamState->stateLock);
+    if (streamState->pendingBytes < maxPendingBytes) return true;
+
+    streamState->drainWanted = true;
+    return false;
+}
+
+void StreamHasher::finishData()
+{
+    if (dataFinished) return;
+    dataFinished = true;
+
+    QMutexLocker stateLocker(&streamState->stateLock);
+    streamState->dataFinished = true;
+    launchWorker();
+}
+
+void StreamHasher::hashLocalFile(QString fileName)
+{
+    if (dataFinished) return;
+    dataFinished = true;
+
+    QMutexLocker stateLocker(&streamState->stateLock);
+    streamState->dataFinished = true;
+    streamState->workerActive = true;
+    hashPool()->start(new FileHashWorker(streamState, fileName));
+}
+
+bool StreamHasher::hashDone()
+{
+    return !finalHash.isEmpty();
+}
+
+QByteArray StreamHasher::getHash()
+{
+    return finalHash;
+}
+
+QString StreamHasher::algorithmName()
+{
+    return "sha256";
+}
+
+void StreamHasher::deliverDrained()
+{
+    emit dataDrained();
+}
+
+void StreamHasher::deliverHash(QByteArray hexHash)
+{
+    if (!finalHash.isEmpty()) return;
+    //An empty hash, from a file which could not be read, is still reported
+
+    finalHash = hexHash;
+    emit hashReady(finalHash);
+}
+
+QThreadPool * StreamHasher::hashPool()
+{
+    //Kept apart from the global pool, and one thread short of the core count, so that hashing never starves the network or GUI
+    //Note: The pool is destroyed at exit, which waits for any worker still running
+    static QThreadPool thePool;
+    static bool poolSetUp = false;
+    if (!poolSetUp)
+    {
+        thePool.setMaxThreadCount(qMax(1, QThread::idealThreadCount() - 1));
+        poolSetUp = true;
+    }
+    return &thePool;
+}
+
+void StreamHasher::launchWorker()
+{
+    //Note: Called with the state lock held
+    if (streamState->workerActive) return;
+
+    streamState->workerActive = true;
+    hashPool()->start(new HashWorker(streamState));
+}
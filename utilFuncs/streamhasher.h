@@ -0,0 +1,101 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef STREAMHASHER_H
+#define STREAMHASHER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QSharedPointer>
+
+class QThreadPool;
+struct HashStreamState;
+
+/*! \brief The StreamHasher computes the checksum of a file as its bytes stream through a transfer, on a shared pool of worker threads.
+ *
+ *  Chunks given to addData() are queued, and hashed in order by the worker pool, so that hashing does not slow the GUI thread or add a second pass over the file.
+ *  Many StreamHashers share one pool, and each uses at most one worker at a time.
+ *  A caller which reads data faster than it can be hashed should check canTakeData() before each chunk, so that the queue does not grow with the file.
+ *  After finishData(), the hashReady() signal is emitted in the thread of the StreamHasher once the last chunk is hashed.
+ *
+ *  A local file may also be hashed whole with hashLocalFile(), in which case the file is read by the worker, and not by the calling thread.
+ *
+ *  The checksum is SHA-256, written as lowercase hex.
+ */
+class StreamHasher : public QObject
+{
+    Q_OBJECT
+public:
+    explicit StreamHasher(QObject * parent = nullptr);
+    ~StreamHasher();
+
+    void addData(QByteArray chunk);
+    /*! \brief Returns false if too many bytes are waiting to be hashed. The dataDrained() signal is then emitted once half of them are hashed.
+     */
+    bool canTakeData();
+    void finishData();
+    /*! \brief Reads and hashes a whole local file on the worker pool, instead of taking chunks with addData().
+     *
+     *  If the file cannot be read, hashReady() gives an empty hash.
+     */
+    void hashLocalFile(QString fileName);
+
+    bool hashDone();
+    QByteArray getHash();
+
+    /*! \brief The name of the checksum, for use in journals and manifests.
+     */
+    static QString algorithmName();
+
+    static const qint64 maxPendingBytes = 4 * 1024 * 1024;
+
+signals:
+    void hashReady(QByteArray hexHash);
+    void dataDrained();
+
+private slots:
+    void deliverHash(QByteArray hexHash);
+    void deliverDrained();
+
+private:
+    static QThreadPool * hashPool();
+    void launchWorker();
+
+    QSharedPointer<HashStreamState> streamState;
+    QByteArray finalHash;
+    bool dataFinished = false;
+};
+
+#endif // STREAMHASHER_H
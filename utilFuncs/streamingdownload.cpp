@@ -0,0 +1,244 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "streamingdownload.h"
+
+#include "agaverestlink.h"
+#include "requestscheduler.h"
+#include "streamhasher.h"
+#include "remotedatainterface.h"
+#include "ae_globals.h"
+
+#include <QTimer>
+
+const qint64 StreamingDownload::bufferSize;
+
+StreamingDownload::StreamingDownload(QString remotePath, QString localPath, QObject * parent) :
+    QObject(parent), destFile(localPath)
+{
+    myRemotePath = remotePath;
+    myLocalPath = localPath;
+}
+
+StreamingDownload::~StreamingDownload()
+{
+    if (myReply != nullptr)
+    {
+        myReply->disconnect(this);
+        myReply->abort();
+        myReply->deleteLater();
+    }
+}
+
+bool StreamingDownload::startDownload()
+{
+    if (downloadStarted) return false;
+
+    AgaveRestLink * theLink = ae_globals::get_rest_link();
+    if ((theLink == nullptr) || (!theLink->credentialsAvailable())) return false;
+
+    if (!destFile.open(QIODevice::WriteOnly))
+    {
+        qCDebug(agaveAppLayer, "Unable to write download destination: %s", qPrintable(myLocalPath));
+        return false;
+    }
+
+    downloadStarted = true;
+    chunkBuffer.resize(bufferSize);
+    contentHasher = new StreamHasher(this);
+    QObject::connect(contentHasher, SIGNAL(hashReady(QByteArray)), this, SLOT(hashFinished()));
+    QObject::connect(contentHasher, SIGNAL(dataDrained()), this, SLOT(dataAvailable()));
+    theLink->getScheduler()->scheduleRequest(RequestPriority::BULK, this, [this]() { return sendDownloadRequest(); });
+    return true;
+}
+
+QNetworkReply * StreamingDownload::sendDownloadRequest()
+{
+    if (downloadFinished) return nullptr;
+
+    myReply = ae_globals::get_rest_link()->requestFileContents(myRemotePath);
+    if (myReply == nullptr)
+    {
+        finishDownload(RequestState::NO_CONNECT);
+        return nullptr;
+    }
+
+    //Limiting the read buffer holds back the network, rather than letting the reply grow with the file
+    myReply->setReadBufferSize(bufferSize);
+
+    QObject::connect(myReply, SIGNAL(readyRead()), this, SLOT(dataAvailable()));
+    QObject::connect(myReply, SIGNAL(finished()), this, SLOT(replyFinished()));
+    QObject::connect(myReply, SIGNAL(downloadProgress(qint64,qint64)), this, SIGNAL(downloadProgress(qint64,qint64)));
+    return myReply;
+}
+
+void StreamingDownload::cancelDownload()
+{
+    finishDownload(RequestState::EXPLICIT_ERROR);
+}
+
+QString StreamingDownload::getRemotePath()
+{
+    return myRemotePath;
+}
+
+QString StreamingDownload::getLocalPath()
+{
+    return myLocalPath;
+}
+
+RetryHint StreamingDownload::getFailureHint()
+{
+    return failureHint;
+}
+
+void StreamingDownload::setExpectedSize(qint64 newSize)
+{
+    expectedSize = newSize;
+}
+
+QByteArray StreamingDownload::getContentHash()
+{
+    if (contentHasher == nullptr) return QByteArray();
+    return contentHasher->getHash();
+}
+
+void StreamingDownload::dataAvailable()
+{
+    readRetryPending = false;
+    if (downloadFinished || (myReply == nullptr)) return;
+
+    RequestScheduler * theScheduler = ae_globals::get_rest_link()->getScheduler();
+
+    while (myReply->bytesAvailable() > 0)
+    {
+        //If hashing falls behind, the unread data holds back the sender until the hasher catches up
+        if (!contentHasher->canTakeData()) return;
+
+        qint64 permittedSize = theScheduler->takeBulkBytes(qMin(myReply->bytesAvailable(), bufferSize));
+        if (permittedSize <= 0)
+        {
+            //Over the bandwidth limit, the unread data holds back the sender until we try again
+            if (!readRetryPending)
+            {
+                readRetryPending = true;
+                QTimer::singleShot(50, this, SLOT(dataAvailable()));
+            }
+            return;
+        }
+
+        qint64 chunkSize = myReply->read(chunkBuffer.data(), permittedSize);
+        if (chunkSize <= 0) break;
+
+        if (destFile.write(chunkBuffer.constData(), chunkSize) != chunkSize)
+        {
+            qCDebug(agaveAppLayer, "Write failed for download: %s", qPrintable(myLocalPath));
+            finishDownload(RequestState::EXPLICIT_ERROR);
+            return;
+        }
+        contentHasher->addData(QByteArray(chunkBuffer.constData(), int(chunkSize)));
+        bytesWritten += chunkSize;
+    }
+
+    if (replyComplete && (myReply->bytesAvailable() == 0))
+    {
+        if ((expectedSize >= 0) && (bytesWritten != expectedSize))
+        {
+            qCDebug(agaveAppLayer, "Download of %s ended at %lld bytes, expected %lld", qPrintable(myRemotePath), bytesWritten, expectedSize);
+            //A reply cut short of its own length may succeed if tried again, but a full reply of another size means the file changed since it was listed
+            QVariant replyLength = myReply->header(QNetworkRequest::ContentLengthHeader);
+            failureHint.retryable = !replyLength.isValid() || (bytesWritten < replyLength.toLongLong());
+            finishDownload(RequestState::EXPLICIT_ERROR);
+            return;
+        }
+        //The file is committed once its last bytes are hashed
+        contentHasher->finishData();
+    }
+}
+
+void StreamingDownload::replyFinished()
+{
+    if (downloadFinished) return;
+
+    if (myReply->error() != QNetworkReply::NoError)
+    {
+        qCDebug(agaveAppLayer, "Download of %s failed: %s", qPrintable(myRemotePath), qPrintable(myReply->errorString()));
+        failureHint = RequestRetry::classifyReply(myReply);
+        finishDownload(RequestState::NO_CONNECT);
+        return;
+    }
+
+    replyComplete = true;
+    dataAvailable();
+}
+
+void StreamingDownload::hashFinished()
+{
+    if (downloadFinished) return;
+    commitDownload();
+}
+
+void StreamingDownload::commitDownload()
+{
+    if (!destFile.commit())
+    {
+        qCDebug(agaveAppLayer, "Unable to finalize download: %s", qPrintable(myLocalPath));
+        finishDownload(RequestState::EXPLICIT_ERROR);
+        return;
+    }
+    finishDownload(RequestState::GOOD);
+}
+
+void StreamingDownload::finishDownload(RequestState finalState)
+{
+    if (downloadFinished) return;
+    downloadFinished = true;
+
+    if ((finalState != RequestState::GOOD) && destFile.isOpen())
+    {
+        destFile.cancelWriting();
+        destFile.commit();
+    }
+    if (myReply != nullptr)
+    {
+        myReply->disconnect(this);
+        myReply->abort();
+        myReply->deleteLater();
+        myReply = nullptr;
+    }
+
+    emit downloadDone(finalState, myLocalPath, bytesWritten);
+    this->deleteLater();
+}
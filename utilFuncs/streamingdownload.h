@@ -0,0 +1,128 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef STREAMINGDOWNLOAD_H
+#define STREAMINGDOWNLOAD_H
+
+#include <QObject>
+#include <QSaveFile>
+#include <QByteArray>
+
+#include "requestretry.h"
+
+class QNetworkReply;
+class StreamHasher;
+enum class RequestState;
+
+/*! \brief The StreamingDownload copies one remote file to a local file, writing data to disk as it arrives.
+ *
+ *  Data is moved through a fixed-size buffer, and reading pauses while the StreamHasher has a backlog, so memory use does not depend on the size of the file.
+ *  The file is written to a temporary name, and only synced and renamed to the destination when the download is complete.
+ *  A failed download leaves no partial file at the destination.
+ *
+ *  The checksum of the file is computed by a StreamHasher as the data arrives, and is available from getContentHash() once the download is done.
+ *  If an expected size is given, a download of any other size fails.
+ *
+ *  Downloads are scheduled as BULK requests, and read no faster than the bulk bandwidth limit of the RequestScheduler allows.
+ *
+ *  The StreamingDownload deletes itself after emitting downloadDone().
+ */
+class StreamingDownload : public QObject
+{
+    Q_OBJECT
+public:
+    /*! \brief Constructs a new StreamingDownload.
+     *
+     *  \param remotePath Full path of the remote file
+     *  \param localPath Full path of the local destination file, which is replaced if it exists
+     *  \param parent The object requesting the download is typically the parent
+     */
+    explicit StreamingDownload(QString remotePath, QString localPath, QObject * parent = nullptr);
+    ~StreamingDownload();
+
+    /*! \brief Begins the download. Returns false if the destination cannot be written or direct requests are not available.
+     */
+    bool startDownload();
+    void cancelDownload();
+
+    QString getRemotePath();
+    QString getLocalPath();
+
+    /*! \brief After a failed download, describes whether the download may succeed if tried again.
+     */
+    RetryHint getFailureHint();
+
+    /*! \brief Sets the size the file is expected to have, from its listing. A download which ends at another size fails, and may be retried.
+     *
+     *  The default of -1 means the size is unknown, and is not checked. Zero is a real size.
+     */
+    void setExpectedSize(qint64 newSize);
+    /*! \brief Returns the checksum of the downloaded file, in hex, after a successful download.
+     */
+    QByteArray getContentHash();
+
+    static const qint64 bufferSize = 256 * 1024;
+
+signals:
+    void downloadProgress(qint64 bytesWritten, qint64 bytesTotal);
+    void downloadDone(RequestState finalState, QString localPath, qint64 bytesWritten);
+
+private slots:
+    void dataAvailable();
+    void replyFinished();
+    void hashFinished();
+
+private:
+    QNetworkReply * sendDownloadRequest();
+    void commitDownload();
+    void finishDownload(RequestState finalState);
+
+    QString myRemotePath;
+    QString myLocalPath;
+
+    QNetworkReply * myReply = nullptr;
+    QSaveFile destFile;
+    QByteArray chunkBuffer;
+    StreamHasher * contentHasher = nullptr;
+    qint64 bytesWritten = 0;
+    qint64 expectedSize = -1;
+    bool downloadStarted = false;
+    bool replyComplete = false;
+    bool readRetryPending = false;
+    bool downloadFinished = false;
+    RetryHint failureHint;
+};
+
+#endif // STREAMINGDOWNLOAD_H
@@ -0,0 +1,614 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "tarextractor.h"
+
+#include <QThread>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QFile>
+#include <QDir>
+#include <QFileInfo>
+
+#include <zlib.h>
+
+struct TarExtractState
+{
+    QMutex stateLock;
+    TarExtractor * owner = nullptr;
+    qint64 readableBytes = 0;
+    bool dataFinished = false;
+    bool cancelled = false;
+    bool workerActive = false;
+    bool resultSent = false;
+
+    //Only touched by the one active worker
+    enum class ParsePhase {HEADER, DATA, PADDING, DONE};
+    enum class EntryKind {SKIP, FILE, METADATA};
+
+    QString archivePath;
+    QDir localDest;
+    QFile archiveFile;
+    qint64 readPos = 0;
+
+    bool formatKnown = false;
+    bool isGzip = false;
+    bool inflaterOpen = false;
+    z_stream inflater;
+
+    ParsePhase phase = ParsePhase::HEADER;
+    QByteArray headerBuffer;
+    int zeroBlocks = 0;
+    QString longName;
+
+    EntryKind entryKind = EntryKind::SKIP;
+    char entryType = '0';
+    QString entryPath;
+    qint64 entryRemaining = 0;
+    qint64 entryPadding = 0;
+    QByteArray entryData;
+    QFile entryFile;
+
+    QString errorText;
+
+    //Shared with the writers
+    QThreadPool writePool;
+    QAtomicInt filesWritten;
+    QAtomicInt writeErrors;
+    qint64 queuedWriteBytes = 0;
+
+    ~TarExtractState()
+    {
+        writePool.waitForDone();
+        if (inflaterOpen) inflateEnd(&inflater);
+    }
+};
+
+//Files up to this size are held in memory and written by the writer pool, larger files are written by the parser as their data arrives
+static const qint64 smallFileLimit = 1024 * 1024;
+static const qint64 maxQueuedWriteBytes = 64 * 1024 * 1024;
+static const qint64 readChunkSize = 1024 * 1024;
+
+class TarFileWriter : public QRunnable
+{
+public:
+    TarFileWriter(QString filePath, QByteArray fileData, QAtomicInt * filesWritten, QAtomicInt * writeErrors) :
+        myFilePath(filePath), myFileData(fileData), myFilesWritten(filesWritten), myWriteErrors(writeErrors) {}
+
+    void run()
+    {
+        QFile outputFile(myFilePath);
+        if (outputFile.open(QIODevice::WriteOnly) && (outputFile.write(myFileData) == myFileData.size()))
+        {
+            myFilesWritten->ref();
+        }
+        else
+        {
+            myWriteErrors->ref();
+        }
+    }
+
+private:
+    QString myFilePath;
+    QByteArray myFileData;
+    QAtomicInt * myFilesWritten;
+    QAtomicInt * myWriteErrors;
+};
+
+class TarParseWorker : public QRunnable
+{
+public:
+    explicit TarParseWorker(QSharedPointer<TarExtractState> theState) : myState(theState) {}
+
+    void run()
+    {
+        while (true)
+        {
+            qint64 bytesToRead = 0;
+            bool dataFinished = false;
+            {
+                QMutexLocker stateLocker(&myState->stateLock);
+                if (myState->cancelled || myState->resultSent)
+                {
+                    myState->workerActive = false;
+                    return;
+                }
+                bytesToRead = qMin(myState->readableBytes - myState->readPos, readChunkSize);
+                dataFinished = myState->dataFinished;
+
+                //The first bytes say whether the archive is gzipped, so reading starts once there are enough of them
+                if ((bytesToRead <= 0) || (!myState->formatKnown && !dataFinished && (myState->readableBytes < TarExtractor::headerSize)))
+                {
+                    myState->workerActive = false;
+                    if (dataFinished && (bytesToRead <= 0)) finishArchive(&stateLocker);
+                    return;
+                }
+            }
+
+            if (!readChunk(bytesToRead))
+            {
+                QMutexLocker stateLocker(&myState->stateLock);
+                myState->workerActive = false;
+                sendResult(&stateLocker, false);
+                return;
+            }
+
+            QMutexLocker stateLocker(&myState->stateLock);
+            if (myState->owner != nullptr)
+            {
+                QMetaObject::invokeMethod(myState->owner, "deliverProgress", Qt::QueuedConnection,
+                                          Q_ARG(int, myState->filesWritten.load()));
+            }
+        }
+    }
+
+private:
+    bool readChunk(qint64 bytesToRead)
+    {
+        if (!myState->archiveFile.isOpen())
+        {
+            myState->archiveFile.setFileName(myState->archivePath);
+            if (!myState->archiveFile.open(QIODevice::ReadOnly))
+            {
+                myState->errorText = "Unable to read the archive";
+                return false;
+            }
+        }
+
+        myState->archiveFile.seek(myState->readPos);
+        QByteArray rawChunk = myState->archiveFile.read(bytesToRead);
+        if (rawChunk.isEmpty())
+        {
+            myState->errorText = "Unable to read the archive";
+            return false;
+        }
+        myState->readPos += rawChunk.size();
+
+        if (!myState->formatKnown)
+        {
+            myState->formatKnown = true;
+            myState->isGzip = (rawChunk.size() >= 2) && (uchar(rawChunk.at(0)) == 0x1f) && (uchar(rawChunk.at(1)) == 0x8b);
+            if (myState->isGzip)
+            {
+                memset(&myState->inflater, 0, sizeof(z_stream));
+                //Adding 16 to the window bits asks zlib for a gzip wrapper
+                if (inflateInit2(&myState->inflater, 16 + MAX_WBITS) != Z_OK)
+                {
+                    myState->errorText = "Unable to start decompression";
+                    return false;
+                }
+                myState->inflaterOpen = true;
+            }
+        }
+
+        if (!myState->isGzip) return parseTar(rawChunk.constData(), rawChunk.size());
+
+        QByteArray inflated(256 * 1024, Qt::Uninitialized);
+        z_stream &theStream = myState->inflater;
+        theStream.next_in = reinterpret_cast<Bytef *>(rawChunk.data());
+        theStream.avail_in = uInt(rawChunk.size());
+        while (theStream.avail_in > 0)
+        {
+            theStream.next_out = reinterpret_cast<Bytef *>(inflated.data());
+            theStream.avail_out = uInt(inflated.size());
+            int inflateResult = inflate(&theStream, Z_NO_FLUSH);
+            if ((inflateResult != Z_OK) && (inflateResult != Z_STREAM_END) && (inflateResult != Z_BUF_ERROR))
+            {
+                //Some writers pad the file after the archive is complete, which is not an error
+                if (myState->phase == TarExtractState::ParsePhase::DONE) return true;
+                myState->errorText = "The archive is not valid gzip data";
+                return false;
+            }
+
+            int producedBytes = inflated.size() - int(theStream.avail_out);
+            if ((producedBytes > 0) && !parseTar(inflated.constData(), producedBytes)) return false;
+
+            //A gzip file may hold several members, one after the other
+            if (inflateResult == Z_STREAM_END)
+            {
+                if (theStream.avail_in == 0) break;
+                inflateReset(&theStream);
+            }
+            else if ((inflateResult == Z_BUF_ERROR) && (producedBytes == 0))
+            {
+                break;
+            }
+        }
+        return true;
+    }
+
+    bool parseTar(const char * rawData, qint64 dataSize)
+    {
+        while (dataSize > 0)
+        {
+            if (myState->phase == TarExtractState::ParsePhase::DONE) return true;
+
+            if (myState->phase == TarExtractState::ParsePhase::HEADER)
+            {
+                qint64 takeSize = qMin(dataSize, qint64(TarExtractor::headerSize - myState->headerBuffer.size()));
+                myState->headerBuffer.append(rawData, int(takeSize));
+                rawData += takeSize;
+                dataSize -= takeSize;
+                if (myState->headerBuffer.size() < TarExtractor::headerSize) return true;
+
+                bool headerGood = beginEntry();
+                myState->headerBuffer.clear();
+                if (!headerGood) return false;
+                continue;
+            }
+
+            if (myState->phase == TarExtractState::ParsePhase::PADDING)
+            {
+                qint64 takeSize = qMin(dataSize, myState->entryPadding);
+                myState->entryPadding -= takeSize;
+                rawData += takeSize;
+                dataSize -= takeSize;
+                if (myState->entryPadding == 0) myState->phase = TarExtractState::ParsePhase::HEADER;
+                continue;
+            }
+
+            qint64 takeSize = qMin(dataSize, myState->entryRemaining);
+            if (myState->entryFile.isOpen())
+            {
+                if (myState->entryFile.write(rawData, takeSize) != takeSize)
+                {
+                    myState->errorText = QString("Unable to write %1").arg(myState->entryFile.fileName());
+                    return false;
+                }
+            }
+            else if (myState->entryKind != TarExtractState::EntryKind::SKIP)
+            {
+                myState->entryData.append(rawData, int(takeSize));
+            }
+            myState->entryRemaining -= takeSize;
+            rawData += takeSize;
+            dataSize -= takeSize;
+            if ((myState->entryRemaining == 0) && !endEntry()) return false;
+        }
+        return true;
+    }
+
+    bool beginEntry()
+    {
+        const char * rawHeader = myState->headerBuffer.constData();
+
+        bool allZero = true;
+        for (int i = 0; i < TarExtractor::headerSize; i++)
+        {
+            if (rawHeader[i] != 0) allZero = false;
+        }
+        if (allZero)
+        {
+            //Two empty blocks end the archive
+            myState->zeroBlocks++;
+            if (myState->zeroBlocks >= 2) myState->phase = TarExtractState::ParsePhase::DONE;
+            return true;
+        }
+        myState->zeroBlocks = 0;
+
+        //The checksum is the sum of the header bytes, with the checksum field taken as spaces
+        qint64 headerSum = 0;
+        for (int i = 0; i < TarExtractor::headerSize; i++)
+        {
+            headerSum += ((i >= 148) && (i < 156)) ? ' ' : uchar(rawHeader[i]);
+        }
+        if (headerSum != parseNumber(rawHeader + 148, 8))
+        {
+            myState->errorText = "The archive has a damaged header";
+            return false;
+        }
+
+        QString entryName = readField(rawHeader, 100);
+        if (QByteArray(rawHeader + 257, 5) == "ustar")
+        {
+            QString namePrefix = readField(rawHeader + 345, 155);
+            if (!namePrefix.isEmpty()) entryName = namePrefix + "/" + entryName;
+        }
+
+        myState->entryType = rawHeader[156];
+        myState->entryRemaining = parseNumber(rawHeader + 124, 12);
+        myState->entryPadding = (TarExtractor::headerSize - (myState->entryRemaining % TarExtractor::headerSize)) % TarExtractor::headerSize;
+        myState->entryData.clear();
+        myState->entryKind = TarExtractState::EntryKind::SKIP;
+
+        if ((myState->entryType == 'L') || (myState->entryType == 'x'))
+        {
+            if (myState->entryRemaining <= smallFileLimit) myState->entryKind = TarExtractState::EntryKind::METADATA;
+        }
+        else if (myState->entryType != 'g')
+        {
+            //A long name from the entry before applies to this entry
+            if (!myState->longName.isEmpty()) entryName = myState->longName;
+            myState->longName.clear();
+            myState->entryPath = getSafePath(entryName);
+
+            if (myState->entryPath.isEmpty())
+            {
+                //Unsafe or empty names are skipped
+            }
+            else if (myState->entryType == '5')
+            {
+                QDir().mkpath(myState->entryPath);
+            }
+            else if ((myState->entryType == '0') || (myState->entryType == '\0') || (myState->entryType == '7'))
+            {
+                myState->entryKind = TarExtractState::EntryKind::FILE;
+                QDir().mkpath(QFileInfo(myState->entryPath).absolutePath());
+                if (myState->entryRemaining > smallFileLimit)
+                {
+                    myState->entryFile.setFileName(myState->entryPath);
+                    if (!myState->entryFile.open(QIODevice::WriteOnly))
+                    {
+                        myState->errorText = QString("Unable to write %1").arg(myState->entryPath);
+                        return false;
+                    }
+                }
+            }
+        }
+
+        myState->phase = TarExtractState::ParsePhase::DATA;
+        if (myState->entryRemaining == 0) return endEntry();
+        return true;
+    }
+
+    bool endEntry()
+    {
+        myState->phase = (myState->entryPadding > 0) ? TarExtractState::ParsePhase::PADDING : TarExtractState::ParsePhase::HEADER;
+
+        if (myState->entryKind == TarExtractState::EntryKind::METADATA)
+        {
+            if (myState->entryType == 'L')
+            {
+                myState->longName = QString::fromUtf8(myState->entryData.constData());
+            }
+            else
+            {
+                parsePaxRecords(myState->entryData);
+            }
+        }
+        else if (myState->entryKind == TarExtractState::EntryKind::FILE)
+        {
+            if (myState->entryFile.isOpen())
+            {
+                myState->entryFile.close();
+                if (myState->entryFile.error() != QFile::NoError)
+                {
+                    myState->errorText = QString("Unable to write %1").arg(myState->entryPath);
+                    return false;
+                }
+                myState->filesWritten.ref();
+            }
+            else
+            {
+                //The writers are held back if they fall too far behind, so that memory use stays bounded
+                myState->queuedWriteBytes += myState->entryData.size();
+                if (myState->queuedWriteBytes > maxQueuedWriteBytes)
+                {
+                    myState->writePool.waitForDone();
+                    myState->queuedWriteBytes = myState->entryData.size();
+                }
+                myState->writePool.start(new TarFileWriter(myState->entryPath, myState->entryData,
+                                                           &myState->filesWritten, &myState->writeErrors));
+            }
+        }
+        myState->entryData.clear();
+        myState->entryKind = TarExtractState::EntryKind::SKIP;
+        return true;
+    }
+
+    void parsePaxRecords(const QByteArray &rawRecords)
+    {
+        //Each record is "<length> <key>=<value>\n", where the length counts the whole record
+        int readPos = 0;
+        while (readPos < rawRecords.size())
+        {
+            int spacePos = rawRecords.indexOf(' ', readPos);
+            if (spacePos < 0) return;
+            int recordLength = rawRecords.mid(readPos, spacePos - readPos).toInt();
+            if ((recordLength <= 0) || (readPos + recordLength > rawRecords.size())) return;
+
+            QByteArray keyValue = rawRecords.mid(spacePos + 1, readPos + recordLength - spacePos - 2);
+            if (keyValue.startsWith("path="))
+            {
+                myState->longName = QString::fromUtf8(keyValue.mid(5));
+            }
+            readPos += recordLength;
+        }
+    }
+
+    QString getSafePath(QString entryName)
+    {
+        QString cleanName = QDir::cleanPath(entryName);
+        while (cleanName.startsWith("./"))
+        {
+            cleanName = cleanName.mid(2);
+        }
+        if (cleanName.isEmpty() || (cleanName == ".") || (cleanName == "..") || cleanName.startsWith("../") ||
+                QDir::isAbsolutePath(cleanName))
+        {
+            return QString();
+        }
+        return myState->localDest.absoluteFilePath(cleanName);
+    }
+
+    static QString readField(const char * rawField, int fieldSize)
+    {
+        int fieldLength = 0;
+        while ((fieldLength < fieldSize) && (rawField[fieldLength] != 0))
+        {
+            fieldLength++;
+        }
+        return QString::fromUtf8(rawField, fieldLength);
+    }
+
+    static qint64 parseNumber(const char * rawField, int fieldSize)
+    {
+        //Large sizes are stored in base 256, marked by the high bit of the first byte
+        if (uchar(rawField[0]) & 0x80)
+        {
+            qint64 ret = uchar(rawField[0]) & 0x7f;
+            for (int i = 1; i < fieldSize; i++)
+            {
+                ret = (ret << 8) | uchar(rawField[i]);
+            }
+            return ret;
+        }
+
+        qint64 ret = 0;
+        for (int i = 0; i < fieldSize; i++)
+        {
+            char aDigit = rawField[i];
+            if ((aDigit == 0) || ((aDigit == ' ') && (ret > 0))) break;
+            if ((aDigit < '0') || (aDigit > '7')) continue;
+            ret = (ret * 8) + (aDigit - '0');
+        }
+        return ret;
+    }
+
+    void finishArchive(QMutexLocker * stateLocker)
+    {
+        bool success = true;
+        if (myState->readPos == 0)
+        {
+            myState->errorText = "The archive is empty";
+            success = false;
+        }
+        else if ((myState->phase != TarExtractState::ParsePhase::DONE) &&
+                 ((myState->phase != TarExtractState::ParsePhase::HEADER) || !myState->headerBuffer.isEmpty()))
+        {
+            myState->errorText = "The archive ends in the middle of an entry";
+            success = false;
+        }
+        sendResult(stateLocker, success);
+    }
+
+    void sendResult(QMutexLocker * stateLocker, bool success)
+    {
+        if (myState->resultSent) return;
+        myState->resultSent = true;
+
+        //The writers are waited for without the lock, so that the owner is not held up
+        stateLocker->unlock();
+        if (myState->entryFile.isOpen()) myState->entryFile.close();
+        myState->writePool.waitForDone();
+        myState->archiveFile.close();
+        stateLocker->relock();
+
+        if (myState->writeErrors.load() > 0)
+        {
+            success = false;
+            if (myState->errorText.isEmpty()) myState->errorText = QString("%1 files could not be written").arg(myState->writeErrors.load());
+        }
+        if (myState->owner != nullptr)
+        {
+            QMetaObject::invokeMethod(myState->owner, "deliverResult", Qt::QueuedConnection, Q_ARG(bool, success),
+                                      Q_ARG(int, myState->filesWritten.load()), Q_ARG(QString, myState->errorText));
+        }
+    }
+
+    QSharedPointer<TarExtractState> myState;
+};
+
+TarExtractor::TarExtractor(QString archivePath, QString localDest, QObject * parent) : QObject(parent), extractState(new TarExtractState())
+{
+    extractState->owner = this;
+    extractState->archivePath = archivePath;
+    extractState->localDest = QDir(localDest);
+    extractState->writePool.setMaxThreadCount(qMax(1, QThread::idealThreadCount()));
+}
+
+TarExtractor::~TarExtractor()
+{
+    //A worker may still hold the state, but will stop at its next chunk, and no longer report to this object
+    QMutexLocker stateLocker(&extractState->stateLock);
+    extractState->owner = nullptr;
+    extractState->cancelled = true;
+}
+
+void TarExtractor::dataAvailable(qint64 readableBytes)
+{
+    QMutexLocker stateLocker(&extractState->stateLock);
+    if (readableBytes <= extractState->readableBytes) return;
+    extractState->readableBytes = readableBytes;
+    launchWorker();
+}
+
+void TarExtractor::finishData(qint64 totalBytes)
+{
+    QMutexLocker stateLocker(&extractState->stateLock);
+    extractState->readableBytes = qMax(extractState->readableBytes, totalBytes);
+    extractState->dataFinished = true;
+    launchWorker();
+}
+
+void TarExtractor::cancelExtraction()
+{
+    {
+        QMutexLocker stateLocker(&extractState->stateLock);
+        extractState->cancelled = true;
+    }
+    deliverResult(false, filesWritten, "Extraction cancelled");
+}
+
+int TarExtractor::getFilesWritten()
+{
+    return filesWritten;
+}
+
+void TarExtractor::deliverProgress(int newFilesWritten)
+{
+    if (extractionFinished) return;
+    filesWritten = newFilesWritten;
+    emit extractionProgress(filesWritten);
+}
+
+void TarExtractor::deliverResult(bool success, int newFilesWritten, QString errorText)
+{
+    if (extractionFinished) return;
+    extractionFinished = true;
+    filesWritten = newFilesWritten;
+    emit extractionDone(success, filesWritten, errorText);
+}
+
+void TarExtractor::launchWorker()
+{
+    //Note: Called with the state lock held
+    if (extractState->workerActive || extractState->cancelled || extractState->resultSent) return;
+
+    extractState->workerActive = true;
+    QThreadPool::globalInstance()->start(new TarParseWorker(extractState));
+}
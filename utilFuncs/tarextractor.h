@@ -0,0 +1,93 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef TAREXTRACTOR_H
+#define TAREXTRACTOR_H
+
+#include <QObject>
+#include <QSharedPointer>
+
+struct TarExtractState;
+
+/*! \brief The TarExtractor unpacks a tar archive, which may be gzipped, into a local folder, while the archive is still being written.
+ *
+ *  The archive is read from disk as far as dataAvailable() says it is complete, so extraction can keep pace with a download.
+ *  Decompression and parsing run on a worker from the global thread pool, one worker at a time, and small files are written out by a separate pool of writers.
+ *  Entries with absolute paths, or paths leading out of the destination, are skipped. Links and special files are skipped.
+ *
+ *  The extractionDone() signal is emitted once, after finishData() is called and the whole archive is read, or as soon as the archive is found to be damaged.
+ */
+class TarExtractor : public QObject
+{
+    Q_OBJECT
+public:
+    /*! \brief Constructs a new TarExtractor.
+     *
+     *  \param archivePath Full path of the local archive file
+     *  \param localDest An existing local folder, into which the contents of the archive are written
+     *  \param parent The object requesting the extraction is typically the parent
+     */
+    explicit TarExtractor(QString archivePath, QString localDest, QObject * parent = nullptr);
+    ~TarExtractor();
+
+    /*! \brief Tells the extractor that the first readableBytes of the archive are on disk.
+     */
+    void dataAvailable(qint64 readableBytes);
+    /*! \brief Tells the extractor that the archive is complete, with the given size.
+     */
+    void finishData(qint64 totalBytes);
+    void cancelExtraction();
+
+    int getFilesWritten();
+
+    static const int headerSize = 512;
+
+signals:
+    void extractionProgress(int filesWritten);
+    void extractionDone(bool success, int filesWritten, QString errorText);
+
+private slots:
+    void deliverProgress(int filesWritten);
+    void deliverResult(bool success, int filesWritten, QString errorText);
+
+private:
+    void launchWorker();
+
+    QSharedPointer<TarExtractState> extractState;
+    int filesWritten = 0;
+    bool extractionFinished = false;
+};
+
+#endif // TAREXTRACTOR_H
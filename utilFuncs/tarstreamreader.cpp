@@ -0,0 +1,399 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "tarstreamreader.h"
+
+#include "tarextractor.h"
+
+#include <QThreadPool>
+#include <QRunnable>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QFile>
+#include <QDir>
+
+struct TarPackEntry
+{
+    QString localPath;
+    QByteArray headerBytes;
+    qint64 fileSize = 0;
+    bool isFolder = false;
+};
+
+struct TarPackState
+{
+    QMutex stateLock;
+    QWaitCondition dataReady;
+    QWaitCondition spaceReady;
+
+    QList<TarPackEntry> packEntries;
+    qint64 startOffset = 0;
+    qint64 streamOffset = 0;
+    bool workerStarted = false;
+
+    QByteArray pendingData;
+    int readOffset = 0;
+    bool producerDone = false;
+    bool cancelled = false;
+    QStringList failedFiles;
+};
+
+static qint64 paddedSize(qint64 rawSize)
+{
+    return ((rawSize + TarExtractor::headerSize - 1) / TarExtractor::headerSize) * TarExtractor::headerSize;
+}
+
+static void writeNumber(char * rawField, int fieldSize, qint64 value)
+{
+    //Values too large for the octal digits are stored in base 256, marked by the high bit of the first byte
+    if (value >= (qint64(1) << (3 * (fieldSize - 1))))
+    {
+        memset(rawField, 0, size_t(fieldSize));
+        rawField[0] = char(0x80);
+        for (int i = fieldSize - 1; (i > 0) && (value > 0); i--)
+        {
+            rawField[i] = char(value & 0xff);
+            value >>= 8;
+        }
+        return;
+    }
+
+    QByteArray octalText = QByteArray::number(value, 8).rightJustified(fieldSize - 1, '0');
+    memcpy(rawField, octalText.constData(), size_t(fieldSize - 1));
+    rawField[fieldSize - 1] = 0;
+}
+
+static QByteArray buildHeaderBlock(const QByteArray &entryName, const QByteArray &namePrefix, qint64 entrySize, char typeFlag, int fileMode, qint64 modTime)
+{
+    QByteArray ret(TarExtractor::headerSize, '\0');
+    char * rawHeader = ret.data();
+
+    memcpy(rawHeader, entryName.constData(), size_t(qMin(entryName.size(), 100)));
+    writeNumber(rawHeader + 100, 8, fileMode);
+    writeNumber(rawHeader + 108, 8, 0);
+    writeNumber(rawHeader + 116, 8, 0);
+    writeNumber(rawHeader + 124, 12, entrySize);
+    writeNumber(rawHeader + 136, 12, qMax(modTime, qint64(0)));
+    rawHeader[156] = typeFlag;
+    memcpy(rawHeader + 257, "ustar", 6);
+    memcpy(rawHeader + 263, "00", 2);
+    memcpy(rawHeader + 345, namePrefix.constData(), size_t(qMin(namePrefix.size(), 155)));
+
+    //The checksum is the sum of the header bytes, with the checksum field taken as spaces
+    memset(rawHeader + 148, ' ', 8);
+    qint64 headerSum = 0;
+    for (int i = 0; i < TarExtractor::headerSize; i++)
+    {
+        headerSum += uchar(rawHeader[i]);
+    }
+    QByteArray sumText = QByteArray::number(headerSum, 8).rightJustified(6, '0');
+    memcpy(rawHeader + 148, sumText.constData(), 6);
+    rawHeader[154] = 0;
+    rawHeader[155] = ' ';
+    return ret;
+}
+
+static QByteArray buildHeader(QString tarName, qint64 entrySize, bool isFolder, int fileMode, qint64 modTime)
+{
+    QByteArray nameBytes = tarName.toUtf8();
+    char typeFlag = isFolder ? '5' : '0';
+    if (nameBytes.size() <= 100) return buildHeaderBlock(nameBytes, QByteArray(), entrySize, typeFlag, fileMode, modTime);
+
+    //A long name may be split at a slash, between the prefix and name fields
+    for (int splitPos = qMin(nameBytes.size() - 2, 155); splitPos > 0; splitPos--)
+    {
+        if (nameBytes.at(splitPos) != '/') continue;
+        if (nameBytes.size() - splitPos - 1 > 100) break;
+        return buildHeaderBlock(nameBytes.mid(splitPos + 1), nameBytes.left(splitPos), entrySize, typeFlag, fileMode, modTime);
+    }
+
+    //Otherwise, the name goes in a GNU long name entry, before the entry itself
+    QByteArray nameData = nameBytes;
+    nameData.append('\0');
+    QByteArray ret = buildHeaderBlock("././@LongLink", QByteArray(), nameData.size(), 'L', 0644, 0);
+    nameData.append(QByteArray(int(paddedSize(nameData.size()) - nameData.size()), '\0'));
+    ret.append(nameData);
+    ret.append(buildHeaderBlock(nameBytes.left(100), QByteArray(), entrySize, typeFlag, fileMode, modTime));
+    return ret;
+}
+
+class TarPackWorker : public QRunnable
+{
+public:
+    explicit TarPackWorker(QSharedPointer<TarPackState> theState) : myState(theState) {}
+
+    void run()
+    {
+        skipRemaining = myState->startOffset;
+
+        for (const TarPackEntry &anEntry : myState->packEntries)
+        {
+            //Entries wholly before the start offset are not packed again
+            qint64 entrySpan = anEntry.headerBytes.size() + paddedSize(anEntry.fileSize);
+            if (skipRemaining >= entrySpan)
+            {
+                skipRemaining -= entrySpan;
+                continue;
+            }
+
+            if (!pushData(anEntry.headerBytes)) return;
+            if (anEntry.isFolder) continue;
+            if (!packFile(anEntry)) return;
+        }
+
+        if (!pushData(QByteArray(2 * TarExtractor::headerSize, '\0'))) return;
+
+        QMutexLocker stateLocker(&myState->stateLock);
+        myState->producerDone = true;
+        myState->dataReady.wakeAll();
+    }
+
+private:
+    bool packFile(const TarPackEntry &theEntry)
+    {
+        QFile sourceFile(theEntry.localPath);
+        bool fileGood = sourceFile.open(QIODevice::ReadOnly);
+
+        qint64 bytesLeft = theEntry.fileSize;
+        while (fileGood && (bytesLeft > 0))
+        {
+            QByteArray fileChunk = sourceFile.read(qMin(bytesLeft, qint64(256 * 1024)));
+            if (fileChunk.isEmpty())
+            {
+                fileGood = false;
+                break;
+            }
+            bytesLeft -= fileChunk.size();
+            if (!pushData(fileChunk)) return false;
+        }
+        if (fileGood && !sourceFile.atEnd()) fileGood = false;
+
+        if (!fileGood)
+        {
+            QMutexLocker stateLocker(&myState->stateLock);
+            if (!myState->failedFiles.contains(theEntry.localPath)) myState->failedFiles.append(theEntry.localPath);
+        }
+
+        //A short file is padded to its listed size, so that the archive keeps the size it was sent with
+        qint64 padBytes = bytesLeft + paddedSize(theEntry.fileSize) - theEntry.fileSize;
+        while (padBytes > 0)
+        {
+            qint64 chunkSize = qMin(padBytes, qint64(256 * 1024));
+            if (!pushData(QByteArray(int(chunkSize), '\0'))) return false;
+            padBytes -= chunkSize;
+        }
+        return true;
+    }
+
+    bool pushData(QByteArray newData)
+    {
+        if (skipRemaining > 0)
+        {
+            qint64 skipSize = qMin(skipRemaining, qint64(newData.size()));
+            newData.remove(0, int(skipSize));
+            skipRemaining -= skipSize;
+            if (newData.isEmpty()) return true;
+        }
+
+        QMutexLocker stateLocker(&myState->stateLock);
+        while (!myState->cancelled && (myState->pendingData.size() - myState->readOffset >= TarStreamReader::maxBufferedBytes))
+        {
+            myState->spaceReady.wait(&myState->stateLock);
+        }
+        if (myState->cancelled) return false;
+
+        myState->pendingData.append(newData);
+        myState->dataReady.wakeAll();
+        return true;
+    }
+
+    QSharedPointer<TarPackState> myState;
+    qint64 skipRemaining = 0;
+};
+
+TarStreamReader::TarStreamReader(QString localFolder, QObject * parent) : QIODevice(parent)
+{
+    myLocalFolder = QDir::cleanPath(localFolder);
+}
+
+TarStreamReader::~TarStreamReader()
+{
+    stopPacking();
+}
+
+bool TarStreamReader::open(OpenMode mode)
+{
+    if (mode != QIODevice::ReadOnly) return false;
+
+    QFileInfo rootInfo(myLocalFolder);
+    if (!rootInfo.isDir()) return false;
+
+    //Everything is listed up front, which fixes the layout and size of the archive
+    QSharedPointer<TarPackState> newState(new TarPackState());
+    QString rootName = rootInfo.fileName();
+
+    TarPackEntry rootEntry;
+    rootEntry.isFolder = true;
+    rootEntry.headerBytes = buildHeader(rootName + "/", 0, true, 0755, rootInfo.lastModified().toMSecsSinceEpoch() / 1000);
+    newState->packEntries.append(rootEntry);
+
+    QDir rootDir(myLocalFolder);
+    archiveSize = rootEntry.headerBytes.size();
+    fileCount = 0;
+
+    QDirIterator folderItr(myLocalFolder, QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden | QDir::System, QDirIterator::Subdirectories);
+    while (folderItr.hasNext())
+    {
+        folderItr.next();
+        QFileInfo entryInfo = folderItr.fileInfo();
+        if (entryInfo.isSymLink()) continue;
+        if (!entryInfo.isDir() && !entryInfo.isFile()) continue;
+
+        TarPackEntry newEntry;
+        newEntry.localPath = entryInfo.absoluteFilePath();
+        newEntry.isFolder = entryInfo.isDir();
+        newEntry.fileSize = newEntry.isFolder ? 0 : entryInfo.size();
+
+        QString tarName = rootName + "/" + rootDir.relativeFilePath(newEntry.localPath);
+        if (newEntry.isFolder) tarName.append('/');
+        int fileMode = (newEntry.isFolder || entryInfo.permission(QFile::ExeOwner)) ? 0755 : 0644;
+        newEntry.headerBytes = buildHeader(tarName, newEntry.fileSize, newEntry.isFolder, fileMode, entryInfo.lastModified().toMSecsSinceEpoch() / 1000);
+
+        archiveSize += newEntry.headerBytes.size() + paddedSize(newEntry.fileSize);
+        if (!newEntry.isFolder) fileCount++;
+        newState->packEntries.append(newEntry);
+    }
+    archiveSize += 2 * TarExtractor::headerSize;
+
+    stopPacking();
+    packState = newState;
+
+    //Without buffering, each readData() call follows on from the last, unless there was a seek
+    return QIODevice::open(mode | QIODevice::Unbuffered);
+}
+
+void TarStreamReader::close()
+{
+    stopPacking();
+    QIODevice::close();
+}
+
+bool TarStreamReader::isSequential() const
+{
+    return false;
+}
+
+qint64 TarStreamReader::size() const
+{
+    return archiveSize;
+}
+
+int TarStreamReader::getFileCount()
+{
+    return fileCount;
+}
+
+QStringList TarStreamReader::getFailedFiles()
+{
+    if (packState.isNull()) return QStringList();
+    QMutexLocker stateLocker(&packState->stateLock);
+    return packState->failedFiles;
+}
+
+qint64 TarStreamReader::readData(char * data, qint64 maxSize)
+{
+    if (packState.isNull()) return -1;
+    if (pos() >= archiveSize) return 0;
+
+    //The worker is started on the first read, and again after a seek
+    if (!packState->workerStarted || (pos() != packState->streamOffset))
+    {
+        startPacking(pos());
+    }
+
+    QMutexLocker stateLocker(&packState->stateLock);
+    while ((packState->pendingData.size() == packState->readOffset) && !packState->producerDone && !packState->cancelled)
+    {
+        packState->dataReady.wait(&packState->stateLock);
+    }
+
+    qint64 readSize = qMin(qint64(packState->pendingData.size() - packState->readOffset), maxSize);
+    if (readSize <= 0) return -1;
+
+    memcpy(data, packState->pendingData.constData() + packState->readOffset, size_t(readSize));
+    packState->readOffset += int(readSize);
+    packState->streamOffset += readSize;
+
+    if (packState->readOffset >= maxBufferedBytes / 2)
+    {
+        packState->pendingData.remove(0, packState->readOffset);
+        packState->readOffset = 0;
+    }
+    packState->spaceReady.wakeAll();
+    return readSize;
+}
+
+qint64 TarStreamReader::writeData(const char *, qint64)
+{
+    return -1;
+}
+
+void TarStreamReader::startPacking(qint64 startOffset)
+{
+    QSharedPointer<TarPackState> newState(new TarPackState());
+    newState->packEntries = packState->packEntries;
+    newState->failedFiles = getFailedFiles();
+    newState->startOffset = startOffset;
+    newState->streamOffset = startOffset;
+    newState->workerStarted = true;
+
+    stopPacking();
+    packState = newState;
+    QThreadPool::globalInstance()->start(new TarPackWorker(packState));
+}
+
+void TarStreamReader::stopPacking()
+{
+    if (packState.isNull()) return;
+
+    //The worker holds its own reference to the state, and stops at its next wait
+    QMutexLocker stateLocker(&packState->stateLock);
+    packState->cancelled = true;
+    packState->spaceReady.wakeAll();
+    packState->dataReady.wakeAll();
+}
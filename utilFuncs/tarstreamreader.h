@@ -0,0 +1,96 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef TARSTREAMREADER_H
+#define TARSTREAMREADER_H
+
+#include <QIODevice>
+#include <QSharedPointer>
+#include <QStringList>
+
+struct TarPackState;
+
+/*! \brief The TarStreamReader reads a local folder as a tar archive, for an upload, without writing the archive to disk.
+ *
+ *  The folder is listed when the reader is opened, which fixes the size of the archive, so the upload can be sent with a known length.
+ *  The archive is packed by a worker from the global thread pool, a few megabytes ahead of the reader. Reads wait for the worker, much as reads of a file wait for the disk.
+ *  The archive holds one folder, with the name of the local folder. Links and special files are left out.
+ *
+ *  The archive is not compressed, as its size must be known before it is sent.
+ *  A file which cannot be read, or which changes size while it is packed, is padded or cut to its listed size, and named by getFailedFiles().
+ *
+ *  Seeking back, as when a request is resent, packs the archive again from the start of the entry holding that position.
+ */
+class TarStreamReader : public QIODevice
+{
+    Q_OBJECT
+public:
+    /*! \brief Constructs a new TarStreamReader.
+     *
+     *  \param localFolder Full path of the local folder to pack
+     *  \param parent The reader is typically owned by the request body which uses it
+     */
+    explicit TarStreamReader(QString localFolder, QObject * parent = nullptr);
+    ~TarStreamReader();
+
+    virtual bool open(OpenMode mode);
+    virtual void close();
+    virtual bool isSequential() const;
+    virtual qint64 size() const;
+
+    /*! \brief Returns the number of files in the archive, not counting folders. Valid once the reader is open.
+     */
+    int getFileCount();
+    /*! \brief Returns the files which could not be packed as listed. The archive should not be trusted if there are any.
+     */
+    QStringList getFailedFiles();
+
+    static const qint64 maxBufferedBytes = 4 * 1024 * 1024;
+
+protected:
+    virtual qint64 readData(char * data, qint64 maxSize);
+    virtual qint64 writeData(const char * data, qint64 maxSize);
+
+private:
+    void startPacking(qint64 startOffset);
+    void stopPacking();
+
+    QString myLocalFolder;
+    QSharedPointer<TarPackState> packState;
+    qint64 archiveSize = 0;
+    int fileCount = 0;
+};
+
+#endif // TARSTREAMREADER_H
@@ -0,0 +1,251 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "transferjournal.h"
+
+#include "bulktransfer.h"
+#include "streamhasher.h"
+
+#include <QStandardPaths>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QUuid>
+#include <QDir>
+
+TransferJournal * TransferJournal::createJournal(QString direction, QString localPath, QString remotePath, QObject * parent)
+{
+    QString journalName = QUuid::createUuid().toString().remove('{').remove('}');
+    journalName.append(".journal");
+
+    TransferJournal * ret = new TransferJournal(QDir(journalFolder()).absoluteFilePath(journalName), parent);
+    if (!ret->openForAppend())
+    {
+        delete ret;
+        return nullptr;
+    }
+
+    ret->myDirection = direction;
+    ret->myLocalPath = localPath;
+    ret->myRemotePath = remotePath;
+
+    QJsonObject beginRecord;
+    beginRecord.insert("event", "begin");
+    beginRecord.insert("direction", direction);
+    beginRecord.insert("local", localPath);
+    beginRecord.insert("remote", remotePath);
+    beginRecord.insert("time", QDateTime::currentDateTimeUtc().toString(Qt::ISODate));
+    ret->appendRecord(beginRecord);
+    return ret;
+}
+
+TransferJournal * TransferJournal::openJournal(QString journalFile, QObject * parent)
+{
+    QFile journalInput(journalFile);
+    if (!journalInput.open(QIODevice::ReadOnly)) return nullptr;
+
+    TransferJournal * ret = new TransferJournal(journalFile, parent);
+
+    while (!journalInput.atEnd())
+    {
+        //Note: The last line may be cut short by a crash, and is then skipped
+        QJsonObject aRecord = QJsonDocument::fromJson(journalInput.readLine()).object();
+        QString eventName = aRecord.value("event").toString();
+
+        if (eventName == "begin")
+        {
+            ret->myDirection = aRecord.value("direction").toString();
+            ret->myLocalPath = aRecord.value("local").toString();
+            ret->myRemotePath = aRecord.value("remote").toString();
+        }
+        else if (eventName == "done")
+        {
+            ret->finishedUnits.insert(unitKey(aRecord.value("local").toString(), aRecord.value("remote").toString()), aRecord);
+        }
+    }
+    journalInput.close();
+
+    if (ret->myDirection.isEmpty() || !ret->openForAppend())
+    {
+        delete ret;
+        return nullptr;
+    }
+    return ret;
+}
+
+QStringList TransferJournal::findUnfinishedJournals()
+{
+    QStringList ret;
+    QDir journalDir(journalFolder());
+
+    //Finished journals are removed, so any journal left is unfinished
+    for (const QString &aJournal : journalDir.entryList({"*.journal"}, QDir::Files, QDir::Time))
+    {
+        ret.append(journalDir.absoluteFilePath(aJournal));
+    }
+    return ret;
+}
+
+TransferJournal::TransferJournal(QString journalFile, QObject * parent) : QObject(parent), journalOutput(journalFile) {}
+
+QString TransferJournal::getDirection()
+{
+    return myDirection;
+}
+
+QString TransferJournal::getLocalPath()
+{
+    return myLocalPath;
+}
+
+QString TransferJournal::getRemotePath()
+{
+    return myRemotePath;
+}
+
+QString TransferJournal::getJournalFile()
+{
+    return journalOutput.fileName();
+}
+
+bool TransferJournal::unitAlreadyDone(const TransferUnit &theUnit)
+{
+    auto found = finishedUnits.constFind(unitKey(theUnit.localPath, theUnit.remotePath));
+    if (found == finishedUnits.constEnd()) return false;
+
+    QFileInfo localFile(theUnit.localPath);
+    if (!localFile.exists()) return false;
+    if (localFile.size() != qint64(found.value().value("size").toDouble())) return false;
+
+    //An uploaded file must not have changed since it was sent
+    if (myDirection == "upload")
+    {
+        return (localFile.lastModified().toMSecsSinceEpoch() == qint64(found.value().value("mtime").toDouble()));
+    }
+
+    //A downloaded file must still match the size of the remote file
+    return ((theUnit.fileSize < 0) || (theUnit.fileSize == localFile.size()));
+}
+
+bool TransferJournal::hasFinishedUnits()
+{
+    return !finishedUnits.isEmpty();
+}
+
+void TransferJournal::recordPlanned(const TransferUnit &theUnit)
+{
+    appendRecord("planned", theUnit);
+}
+
+void TransferJournal::recordStarted(const TransferUnit &theUnit)
+{
+    appendRecord("started", theUnit);
+}
+
+void TransferJournal::recordDone(const TransferUnit &theUnit)
+{
+    appendRecord("done", theUnit, true);
+}
+
+void TransferJournal::recordFailed(const TransferUnit &theUnit)
+{
+    appendRecord("failed", theUnit);
+}
+
+void TransferJournal::recordComplete()
+{
+    QJsonObject completeRecord;
+    completeRecord.insert("event", "complete");
+    appendRecord(completeRecord);
+    discardJournal();
+}
+
+void TransferJournal::discardJournal()
+{
+    journalOutput.close();
+    journalOutput.remove();
+}
+
+bool TransferJournal::openForAppend()
+{
+    QDir().mkpath(journalFolder());
+    return journalOutput.open(QIODevice::WriteOnly | QIODevice::Append);
+}
+
+void TransferJournal::appendRecord(QString eventName, const TransferUnit &theUnit, bool withFileState)
+{
+    QJsonObject unitRecord;
+    unitRecord.insert("event", eventName);
+    unitRecord.insert("local", theUnit.localPath);
+    unitRecord.insert("remote", theUnit.remotePath);
+
+    if (withFileState)
+    {
+        QFileInfo localFile(theUnit.localPath);
+        unitRecord.insert("size", double(localFile.size()));
+        unitRecord.insert("mtime", double(localFile.lastModified().toMSecsSinceEpoch()));
+        if (!theUnit.contentHash.isEmpty())
+        {
+            unitRecord.insert(StreamHasher::algorithmName(), QString::fromLatin1(theUnit.contentHash));
+        }
+    }
+    else
+    {
+        unitRecord.insert("size", double(theUnit.fileSize));
+    }
+    appendRecord(unitRecord);
+}
+
+void TransferJournal::appendRecord(QJsonObject theRecord)
+{
+    if (!journalOutput.isOpen()) return;
+
+    journalOutput.write(QJsonDocument(theRecord).toJson(QJsonDocument::Compact));
+    journalOutput.write("\n");
+    journalOutput.flush();
+}
+
+QString TransferJournal::journalFolder()
+{
+    return QDir(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)).absoluteFilePath("transferJournals");
+}
+
+QString TransferJournal::unitKey(const QString &localPath, const QString &remotePath)
+{
+    QString ret = localPath;
+    ret.append('\n');
+    ret.append(remotePath);
+    return ret;
+}
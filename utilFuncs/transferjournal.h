@@ -0,0 +1,115 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef TRANSFERJOURNAL_H
+#define TRANSFERJOURNAL_H
+
+#include <QObject>
+#include <QFile>
+#include <QHash>
+#include <QJsonObject>
+
+struct TransferUnit;
+
+/*! \brief The TransferJournal is an append-only record, on disk, of the progress of one BulkTransfer.
+ *
+ *  Each planned, started, finished and failed unit is written as one line of JSON, and flushed right away, so that the record survives a crash or forced exit.
+ *  A journal which does not end with a completion record belongs to an unfinished transfer. On the next launch, it can be reopened with openJournal(),
+ *  and units already finished, whose files have not changed since, are skipped.
+ */
+class TransferJournal : public QObject
+{
+    Q_OBJECT
+public:
+    /*! \brief Creates a new journal for a transfer. Returns nullptr if the journal cannot be written.
+     *
+     *  \param direction Either "upload" or "download"
+     *  \param localPath The local folder of the transfer
+     *  \param remotePath The remote folder of the transfer
+     */
+    static TransferJournal * createJournal(QString direction, QString localPath, QString remotePath, QObject * parent = nullptr);
+
+    /*! \brief Reopens the journal of an unfinished transfer, to resume it. Returns nullptr if the journal cannot be read.
+     */
+    static TransferJournal * openJournal(QString journalFile, QObject * parent = nullptr);
+
+    /*! \brief Returns the file names of all journals of unfinished transfers.
+     */
+    static QStringList findUnfinishedJournals();
+
+    QString getDirection();
+    QString getLocalPath();
+    QString getRemotePath();
+    QString getJournalFile();
+
+    /*! \brief Returns true if the journal shows this unit finished, and the local file still matches what was recorded.
+     */
+    bool unitAlreadyDone(const TransferUnit &theUnit);
+    /*! \brief Returns true if this journal was reopened with units already finished.
+     */
+    bool hasFinishedUnits();
+
+    void recordPlanned(const TransferUnit &theUnit);
+    void recordStarted(const TransferUnit &theUnit);
+    void recordDone(const TransferUnit &theUnit);
+    void recordFailed(const TransferUnit &theUnit);
+
+    /*! \brief Records that the transfer is over, and removes the journal, since there is nothing left to resume.
+     */
+    void recordComplete();
+
+    /*! \brief Removes the journal of a transfer which will not be resumed.
+     */
+    void discardJournal();
+
+private:
+    explicit TransferJournal(QString journalFile, QObject * parent = nullptr);
+
+    bool openForAppend();
+    void appendRecord(QString eventName, const TransferUnit &theUnit, bool withFileState = false);
+    void appendRecord(QJsonObject theRecord);
+
+    static QString journalFolder();
+    static QString unitKey(const QString &localPath, const QString &remotePath);
+
+    QFile journalOutput;
+    QString myDirection;
+    QString myLocalPath;
+    QString myRemotePath;
+
+    QHash<QString, QJsonObject> finishedUnits;
+};
+
+#endif // TRANSFERJOURNAL_H
@@ -0,0 +1,143 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "transportbenchmark.h"
+
+#include <QCoreApplication>
+#include <QNetworkReply>
+#include <QUrl>
+
+TransportBenchmark * TransportBenchmark::createFromArgs(int argc, char *argv[])
+{
+    QString urlTemplate;
+    int fileCount = 200;
+
+    for (int i = 0; i < argc; i++)
+    {
+        if (strncmp(argv[i],"transportBenchmark=",19) == 0)
+        {
+            urlTemplate = QString(argv[i] + 19);
+        }
+        if (strncmp(argv[i],"benchmarkCount=",15) == 0)
+        {
+            fileCount = QString(argv[i] + 15).toInt();
+        }
+    }
+
+    if (urlTemplate.isEmpty() || (fileCount < 1)) return nullptr;
+    return new TransportBenchmark(urlTemplate, fileCount);
+}
+
+TransportBenchmark::TransportBenchmark(QString urlTemplate, int fileCount, QObject * parent) : QObject(parent)
+{
+    myUrlTemplate = urlTemplate;
+    myFileCount = fileCount;
+}
+
+void TransportBenchmark::startBenchmark()
+{
+    qInfo("Transport benchmark: %d files from %s", myFileCount, qPrintable(myUrlTemplate));
+    runMode(TransportMode::HTTP1);
+}
+
+void TransportBenchmark::replyDone()
+{
+    QNetworkReply * theReply = qobject_cast<QNetworkReply *>(sender());
+    if (theReply == nullptr) return;
+
+    if (theReply->error() != QNetworkReply::NoError)
+    {
+        replyErrors++;
+    }
+    bytesReceived += theReply->readAll().size();
+    theReply->deleteLater();
+
+    repliesLeft--;
+    if (repliesLeft == 0)
+    {
+        finishMode();
+    }
+}
+
+void TransportBenchmark::ignoreSslErrors()
+{
+    QNetworkReply * theReply = qobject_cast<QNetworkReply *>(sender());
+    if (theReply == nullptr) return;
+    theReply->ignoreSslErrors();
+}
+
+void TransportBenchmark::runMode(TransportMode theMode)
+{
+    currentMode = theMode;
+    currentManager = new AgaveNetManager(this);
+    currentManager->setTransportMode(theMode);
+
+    repliesLeft = myFileCount;
+    replyErrors = 0;
+    bytesReceived = 0;
+    modeTimer.start();
+
+    for (int i = 0; i < myFileCount; i++)
+    {
+        QNetworkRequest fileRequest(QUrl(myUrlTemplate.arg(i)));
+        QNetworkReply * theReply = currentManager->get(fileRequest);
+        QObject::connect(theReply, SIGNAL(sslErrors(QList<QSslError>)), this, SLOT(ignoreSslErrors()));
+        QObject::connect(theReply, SIGNAL(finished()), this, SLOT(replyDone()));
+    }
+}
+
+void TransportBenchmark::finishMode()
+{
+    qint64 elapsedTime = modeTimer.elapsed();
+    QString modeName = (currentMode == TransportMode::HTTP2) ? "HTTP2 mode" : "HTTP1 mode";
+
+    results.append(QString("%1: %2 ms, %3 bytes, %4 errors, %5").arg(modeName).arg(elapsedTime)
+                   .arg(bytesReceived).arg(replyErrors).arg(currentManager->getTransportMetrics().toString()));
+
+    currentManager->deleteLater();
+    currentManager = nullptr;
+
+    if (currentMode == TransportMode::HTTP1)
+    {
+        runMode(TransportMode::HTTP2);
+        return;
+    }
+
+    for (const QString &aResult : results)
+    {
+        qInfo("%s", qPrintable(aResult));
+    }
+    QCoreApplication::instance()->exit(0);
+}
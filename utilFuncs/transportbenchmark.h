@@ -0,0 +1,89 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef TRANSPORTBENCHMARK_H
+#define TRANSPORTBENCHMARK_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QList>
+
+#include "agavenetmanager.h"
+
+class QNetworkReply;
+
+/*! \brief The TransportBenchmark compares the HTTP1 and HTTP2 transport modes of the AgaveNetManager, by fetching many small files from a test server.
+ *
+ *  The benchmark is run from the command line, instead of the normal program, with:
+ *
+ *  AgaveExplorer transportBenchmark=https://localhost:8443/small/file%1.txt benchmarkCount=500
+ *
+ *  Where %1 is replaced by the numbers 0 to benchmarkCount - 1. The server should be a local TLS stand-in for the Agave server, which supports both HTTP/1.1 and HTTP/2.
+ *  Certificate errors are ignored, so that a self-signed certificate may be used. Each mode is run with a new AgaveNetManager, and the results are printed when both are done.
+ */
+class TransportBenchmark : public QObject
+{
+    Q_OBJECT
+public:
+    /*! \brief Returns a new TransportBenchmark if the command line asks for one, or nullptr otherwise.
+     */
+    static TransportBenchmark * createFromArgs(int argc, char *argv[]);
+
+    void startBenchmark();
+
+private slots:
+    void replyDone();
+    void ignoreSslErrors();
+
+private:
+    explicit TransportBenchmark(QString urlTemplate, int fileCount, QObject * parent = nullptr);
+
+    void runMode(TransportMode theMode);
+    void finishMode();
+
+    QString myUrlTemplate;
+    int myFileCount;
+
+    AgaveNetManager * currentManager = nullptr;
+    TransportMode currentMode = TransportMode::HTTP1;
+    QElapsedTimer modeTimer;
+    int repliesLeft = 0;
+    int replyErrors = 0;
+    qint64 bytesReceived = 0;
+
+    QList<QString> results;
+};
+
+#endif // TRANSPORTBENCHMARK_H
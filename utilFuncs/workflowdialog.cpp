@@ -0,0 +1,195 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "workflowdialog.h"
+#include "ui_workflowdialog.h"
+
+#include "remotedatainterface.h"
+#include "ae_globals.h"
+
+#include <QTableWidgetItem>
+#include <QCloseEvent>
+
+WorkflowDialog::WorkflowDialog(QWidget *parent) :
+    QDialog(parent),
+    ui(new Ui::WorkflowDialog),
+    myWorkflow(ae_globals::get_job_model())
+{
+    ui->setupUi(this);
+    this->setAttribute(Qt::WA_DeleteOnClose);
+
+    ui->stepTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    ui->stepTable->setColumnCount(5);
+    ui->stepTable->setHorizontalHeaderLabels({"Step", "App", "After", "Job ID", "Status"});
+    ui->runButton->setEnabled(false);
+    ui->cancelButton->setEnabled(false);
+
+    QObject::connect(ui->loadButton, SIGNAL(clicked(bool)), this, SLOT(loadWorkflow()));
+    QObject::connect(ui->runButton, SIGNAL(clicked(bool)), this, SLOT(runWorkflow()));
+    QObject::connect(ui->cancelButton, SIGNAL(clicked(bool)), this, SLOT(cancelWaiting()));
+
+    QObject::connect(&myWorkflow, SIGNAL(stepChanged(QString)), this, SLOT(stepChanged(QString)));
+    QObject::connect(&myWorkflow, SIGNAL(workflowDone(RequestState)), this, SLOT(workflowDone(RequestState)));
+}
+
+WorkflowDialog::~WorkflowDialog()
+{
+    delete ui;
+}
+
+void WorkflowDialog::closeEvent(QCloseEvent * theEvent)
+{
+    //The workflow needs this dialog to go on, so it is hidden until the workflow is done
+    if (myWorkflow.isRunning())
+    {
+        this->hide();
+        theEvent->ignore();
+        return;
+    }
+    QDialog::closeEvent(theEvent);
+}
+
+void WorkflowDialog::loadWorkflow()
+{
+    QString errorText;
+    if (!myWorkflow.loadFile(ui->workflowPathInput->text(), &errorText))
+    {
+        ae_globals::displayPopup(errorText, "Unable to load workflow");
+    }
+
+    ui->stepTable->setRowCount(0);
+    stepRows.clear();
+
+    QStringList allSteps = myWorkflow.getStepNames();
+    ui->stepTable->setRowCount(allSteps.size());
+    for (int row = 0; row < allSteps.size(); row++)
+    {
+        QString aStep = allSteps.at(row);
+        stepRows.insert(aStep, row);
+        ui->stepTable->setItem(row, 0, new QTableWidgetItem(aStep));
+        ui->stepTable->setItem(row, 1, new QTableWidgetItem(myWorkflow.getStepApp(aStep)));
+        ui->stepTable->setItem(row, 2, new QTableWidgetItem(myWorkflow.getStepDependencies(aStep).join(", ")));
+        ui->stepTable->setItem(row, 3, new QTableWidgetItem());
+        ui->stepTable->setItem(row, 4, new QTableWidgetItem());
+        stepChanged(aStep);
+    }
+    ui->stepTable->resizeColumnsToContents();
+
+    updateSummary();
+}
+
+void WorkflowDialog::runWorkflow()
+{
+    if (!myWorkflow.startWorkflow())
+    {
+        ae_globals::displayPopup("Unable to start the workflow.", "Workflow Not Started");
+    }
+    updateSummary();
+}
+
+void WorkflowDialog::cancelWaiting()
+{
+    myWorkflow.cancelWorkflow();
+    updateSummary();
+}
+
+void WorkflowDialog::stepChanged(QString stepName)
+{
+    if (!stepRows.contains(stepName)) return;
+    int row = stepRows.value(stepName);
+
+    ui->stepTable->item(row, 3)->setText(myWorkflow.getStepJobId(stepName));
+
+    QTableWidgetItem * statusItem = ui->stepTable->item(row, 4);
+    statusItem->setText(myWorkflow.getStepMessage(stepName));
+    JobWorkflow::StepState stepState = myWorkflow.getStepState(stepName);
+    if ((stepState == JobWorkflow::StepState::FAILED) || (stepState == JobWorkflow::StepState::SKIPPED))
+    {
+        statusItem->setForeground(Qt::red);
+    }
+    else
+    {
+        statusItem->setForeground(this->palette().text());
+    }
+
+    updateSummary();
+}
+
+void WorkflowDialog::workflowDone(RequestState finalState)
+{
+    updateSummary();
+    if (this->isVisible()) return;
+
+    if (finalState == RequestState::GOOD)
+    {
+        ae_globals::displayPopup("Every step of the workflow has finished.", "Workflow Complete");
+    }
+    else
+    {
+        ae_globals::displayPopup("The workflow is done, but some of its steps did not finish.", "Workflow Incomplete");
+    }
+    this->deleteLater();
+}
+
+void WorkflowDialog::updateSummary()
+{
+    QMap<JobWorkflow::StepState, int> stateCounts;
+    QStringList allSteps = myWorkflow.getStepNames();
+    for (const QString &aStep : allSteps)
+    {
+        stateCounts[myWorkflow.getStepState(aStep)]++;
+    }
+
+    if (allSteps.isEmpty())
+    {
+        ui->summaryLabel->setText("No workflow loaded");
+    }
+    else
+    {
+        ui->summaryLabel->setText(QString("%1 steps: %2 waiting, %3 submitting, %4 running, %5 finished, %6 failed or skipped")
+                                  .arg(allSteps.size())
+                                  .arg(stateCounts.value(JobWorkflow::StepState::WAITING))
+                                  .arg(stateCounts.value(JobWorkflow::StepState::SUBMITTING))
+                                  .arg(stateCounts.value(JobWorkflow::StepState::RUNNING))
+                                  .arg(stateCounts.value(JobWorkflow::StepState::FINISHED))
+                                  .arg(stateCounts.value(JobWorkflow::StepState::FAILED) + stateCounts.value(JobWorkflow::StepState::SKIPPED)));
+    }
+
+    bool anyLeft = (stateCounts.value(JobWorkflow::StepState::FINISHED) < allSteps.size());
+    ui->runButton->setEnabled(!myWorkflow.isRunning() && anyLeft);
+    ui->loadButton->setEnabled(!myWorkflow.isRunning());
+    ui->cancelButton->setEnabled(myWorkflow.isRunning() && (stateCounts.value(JobWorkflow::StepState::WAITING) > 0 ||
+                                                            stateCounts.value(JobWorkflow::StepState::SUBMITTING) > 0));
+}
@@ -0,0 +1,84 @@
+/*********************************************************************************
+**
+** Copyright (c) 2018 The University of Notre Dame
+** Copyright (c) 2018 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef WORKFLOWDIALOG_H
+#define WORKFLOWDIALOG_H
+
+#include <QDialog>
+#include <QMap>
+
+#include "jobworkflow.h"
+
+class QCloseEvent;
+enum class RequestState;
+
+namespace Ui {
+class WorkflowDialog;
+}
+
+/*! \brief The WorkflowDialog loads a JobWorkflow from a file, runs it, and shows the state of each of its steps.
+ *
+ *  The dialog is not modal. If it is closed while the workflow runs, it is only hidden, and the workflow goes on.
+ *  A hidden dialog reports the outcome of the workflow with a popup, and deletes itself once the workflow is done.
+ */
+class WorkflowDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit WorkflowDialog(QWidget *parent = nullptr);
+    ~WorkflowDialog();
+
+protected:
+    void closeEvent(QCloseEvent * theEvent);
+
+private slots:
+    void loadWorkflow();
+    void runWorkflow();
+    void cancelWaiting();
+
+    void stepChanged(QString stepName);
+    void workflowDone(RequestState finalState);
+
+private:
+    void updateSummary();
+
+    Ui::WorkflowDialog *ui;
+
+    JobWorkflow myWorkflow;
+    QMap<QString, int> stepRows;
+};
+
+#endif // WORKFLOWDIALOG_H